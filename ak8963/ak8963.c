@@ -115,3 +115,25 @@ err_code_t ak8963_get_sens_adj(imu_func_read_bytes read_bytes, float *sens_adj_x
 	return ERR_CODE_SUCCESS;
 }
 
+err_code_t ak8963_get_mag_raw_status(imu_func_read_bytes read_bytes, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z, bool *overflow)
+{
+	if ((raw_x == NULL) || (raw_y == NULL) || (raw_z == NULL) || (overflow == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err_ret;
+	uint8_t mag_raw_data[7];
+
+	err_ret = read_bytes(AK8963_XOUT_L, mag_raw_data, 7, AK8963_READ_TIMEOUT);
+	if (err_ret != ERR_CODE_SUCCESS) {
+		return err_ret;
+	}
+
+	*overflow = (mag_raw_data[6] & 0x08) ? true : false;
+	*raw_x = (int16_t)((int16_t)(mag_raw_data[1] << 8) | mag_raw_data[0]);
+	*raw_y = (int16_t)((int16_t)(mag_raw_data[3] << 8) | mag_raw_data[2]);
+	*raw_z = (int16_t)((int16_t)(mag_raw_data[5] << 8) | mag_raw_data[4]);
+
+	return ERR_CODE_SUCCESS;
+}
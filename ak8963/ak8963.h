@@ -8,6 +8,8 @@ extern "C" {
 #include "err_code.h"
 #include "imu.h"
 
+#define AK8963_WHO_AM_I_DEFAULT     0x48        /*!< WHO_AM_I register value */
+
 /**
  * @brief   Mode selection.
  */
@@ -78,6 +80,22 @@ err_code_t ak8963_get_sens_adj(imu_func_read_bytes read_bytes, float *sens_adj_x
  */
 err_code_t ak8963_get_mag_raw(imu_func_read_bytes read_bytes, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z);
 
+/*
+ * @brief   Get magnetometer raw value and overflow status. Unlike
+ *          ak8963_get_mag_raw a magnetic sensor overflow is not an error.
+ *
+ * @param   read_bytes Function read bytes.
+ * @param   raw_x Raw data x axis.
+ * @param   raw_y Raw data y axis.
+ * @param   raw_z Raw data z axis.
+ * @param   overflow Magnetic sensor overflow, raw data is not valid when set.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t ak8963_get_mag_raw_status(imu_func_read_bytes read_bytes, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z, bool *overflow);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,743 @@
+/*
+ * Bus and CPU cost per sample of the IMU read and calibration paths.
+ *
+ * Every path runs against simulated devices behind a counting transport. The
+ * simulator has no bus latency, so host time is the library plus the mock
+ * transport, and bus time is estimated from the counted transfers.
+ *
+ * Build on a host with the Makefile next to this file, ERR_CODE_DIR is the
+ * directory holding err_code.h:
+ *   make -C bench ERR_CODE_DIR=<dir>
+ *
+ * The backend is the one selected in imu.c. Magnetometer paths need
+ * USE_AK8963 and are reported as unavailable without it.
+ *
+ * Usage: imu_bench [iterations], writes one JSON document to stdout.
+ */
+#define _POSIX_C_SOURCE 199309L
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+#include "math.h"
+
+#include "imu.h"
+#include "imu_bus/imu_bus.h"
+#include "imu_sim/imu_sim.h"
+#include "imu_decim/imu_decim.h"
+#include "imu_filter/imu_filter.h"
+#include "imu_fft/imu_fft.h"
+#include "imu_preint/imu_preint.h"
+
+#define BENCH_ITERATIONS_DEFAULT 	1000
+#define BENCH_SAMPLE_PERIOD_US 		5000.0f 	/*!< Output data rate set by the drivers, 200 Hz */
+#define BENCH_MAG_PERIOD_US 		10000.0f 	/*!< AK8963 continuous measurement 2, 100 Hz */
+#define BENCH_FIFO_FRAMES 			10 			/*!< Frames accumulated per FIFO read */
+
+/* I2C clocks of one register transfer: start, address, register, and for
+ * reads a repeated start and address, then data and stop. Every byte is 9
+ * clocks with the acknowledge.
+ */
+#define BENCH_I2C_READ_CLOCKS(len) 	(9 * (3 + (len)) + 2)
+#define BENCH_I2C_WRITE_CLOCKS(len) (9 * (2 + (len)) + 1)
+#define BENCH_SPI_CLOCKS(len) 		(8 * (1 + (len)))
+
+#define BENCH_BUS_DEV 				3
+
+#define BENCH_DECIM_SAMPLES 		1000 		/*!< Input samples per decimator call, one second at 1 kHz */
+#define BENCH_PREINT_INTERVAL 		33 			/*!< Samples per pre-integrated interval, a 30 Hz camera at 1 kHz */
+
+
+typedef enum {
+	BENCH_DEV_MPU6050 = 0,
+	BENCH_DEV_MPU6500,
+	BENCH_DEV_AK8963,
+} bench_dev_t;
+
+typedef struct {
+	imu_sim_handle_t 			sim; 						/*!< Simulated device */
+	uint64_t 					transactions; 				/*!< Transport calls, a batch counts once */
+	uint64_t 					bytes; 						/*!< Data bytes */
+	uint64_t 					i2c_clocks; 				/*!< Estimated I2C clocks */
+	uint64_t 					spi_clocks; 				/*!< Estimated SPI clocks */
+} bench_bus_t;
+
+typedef struct {
+	const char 					*name; 						/*!< Case name */
+	uint8_t 					ratio; 						/*!< Decimation ratio */
+	uint16_t 					taps; 						/*!< Filter length */
+	uint8_t 					scale; 						/*!< Feed scaled samples */
+} bench_decim_case_t;
+
+typedef struct {
+	const char 					*name; 						/*!< Case name */
+	float 						sample_rate_hz; 			/*!< Sample rate */
+	uint8_t 					dyn_notch; 					/*!< Enable the dynamic notch */
+} bench_filter_case_t;
+
+typedef struct {
+	const char 					*name; 						/*!< Case name */
+	uint16_t 					points; 					/*!< Frame length */
+	imu_fft_format_t 			format; 					/*!< Arithmetic format */
+} bench_fft_case_t;
+
+typedef struct {
+	const char 					*name; 						/*!< Path name */
+	err_code_t 					(*func)(imu_handle_t handle, uint32_t *samples);	/*!< One call, reports samples delivered */
+	float 						advance_us; 				/*!< Virtual time between calls, outside the timing */
+	uint8_t 					batched; 					/*!< Use the batched transfer callback */
+	uint8_t 					fifo; 						/*!< Enable FIFO before the run */
+	uint8_t 					per_sample; 				/*!< Report per delivered sample, otherwise per call */
+	uint8_t 					mag; 						/*!< Needs the magnetometer */
+	uint32_t 					iterations; 				/*!< Fixed number of calls, 0 uses the command line */
+} bench_case_t;
+
+static bench_bus_t bench_bus[BENCH_BUS_DEV];
+
+static err_code_t bench_transfer(void *ctx, imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms)
+{
+	bench_bus_t *bus = (bench_bus_t *)ctx;
+
+	bus->transactions++;
+	for (uint8_t i = 0; i < num_transfers; i++)
+	{
+		bus->bytes += transfers[i].len;
+		bus->spi_clocks += BENCH_SPI_CLOCKS(transfers[i].len);
+		if (transfers[i].dir == IMU_TRANSFER_READ) {
+			bus->i2c_clocks += BENCH_I2C_READ_CLOCKS(transfers[i].len);
+		} else {
+			bus->i2c_clocks += BENCH_I2C_WRITE_CLOCKS(transfers[i].len);
+		}
+	}
+
+	return imu_sim_get_ops()->transfer(bus->sim, transfers, num_transfers, timeout_ms);
+}
+
+static err_code_t bench_read_bytes(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	imu_transfer_t transfer = {reg_addr, buf, len, IMU_TRANSFER_READ};
+
+	return bench_transfer(ctx, &transfer, 1, timeout_ms);
+}
+
+static err_code_t bench_write_bytes(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	imu_transfer_t transfer = {reg_addr, buf, len, IMU_TRANSFER_WRITE};
+
+	return bench_transfer(ctx, &transfer, 1, timeout_ms);
+}
+
+static const imu_bus_ops_t bench_ops = {
+	.read_bytes = bench_read_bytes,
+	.write_bytes = bench_write_bytes,
+	.transfer = bench_transfer,
+	.set_bus_clock = NULL,
+	.get_time_us = NULL,
+};
+
+static uint64_t bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_bus_clear(void)
+{
+	for (uint8_t i = 0; i < BENCH_BUS_DEV; i++)
+	{
+		bench_bus[i].transactions = 0;
+		bench_bus[i].bytes = 0;
+		bench_bus[i].i2c_clocks = 0;
+		bench_bus[i].spi_clocks = 0;
+	}
+}
+
+static imu_handle_t bench_setup(uint8_t batched)
+{
+	imu_sim_cfg_t sim_cfg;
+	imu_bus_func_t func[BENCH_BUS_DEV];
+	const imu_sim_chip_t chip[BENCH_BUS_DEV] = {IMU_SIM_CHIP_MPU6050, IMU_SIM_CHIP_MPU6500, IMU_SIM_CHIP_AK8963};
+
+	for (uint8_t i = 0; i < BENCH_BUS_DEV; i++)
+	{
+		if (bench_bus[i].sim == NULL)
+		{
+			bench_bus[i].sim = imu_sim_init();
+		}
+
+		memset(&sim_cfg, 0, sizeof(sim_cfg));
+		sim_cfg.chip = chip[i];
+		sim_cfg.seed = 1 + i;
+		sim_cfg.signal.accel_offset_g[2] = 1.0f;
+		sim_cfg.signal.accel_noise_g = 0.002f;
+		sim_cfg.signal.gyro_noise_dps = 0.05f;
+		sim_cfg.signal.mag_offset_ut[0] = 20.0f;
+		sim_cfg.signal.mag_offset_ut[2] = -40.0f;
+		sim_cfg.signal.temp_c = 25.0f;
+
+		if ((imu_sim_set_config(bench_bus[i].sim, sim_cfg) != ERR_CODE_SUCCESS) ||
+		        (imu_sim_config(bench_bus[i].sim) != ERR_CODE_SUCCESS) ||
+		        (imu_bus_bind(i, &bench_ops, &bench_bus[i], &func[i]) != ERR_CODE_SUCCESS))
+		{
+			return NULL;
+		}
+	}
+
+	imu_handle_t handle = imu_init();
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	imu_cfg_t cfg;
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.mpu6050_read_bytes = func[BENCH_DEV_MPU6050].read_bytes;
+	cfg.mpu6050_write_bytes = func[BENCH_DEV_MPU6050].write_bytes;
+	cfg.mpu6050_transfer = batched ? func[BENCH_DEV_MPU6050].transfer : NULL;
+	cfg.mpu6500_read_bytes = func[BENCH_DEV_MPU6500].read_bytes;
+	cfg.mpu6500_write_bytes = func[BENCH_DEV_MPU6500].write_bytes;
+	cfg.mpu6500_transfer = batched ? func[BENCH_DEV_MPU6500].transfer : NULL;
+	cfg.ak8963_read_bytes = func[BENCH_DEV_AK8963].read_bytes;
+	cfg.ak8963_write_bytes = func[BENCH_DEV_AK8963].write_bytes;
+	cfg.func_delay = imu_sim_delay;
+	cfg.func_get_time_us = imu_sim_get_time_us;
+
+	if ((imu_set_config(handle, cfg) != ERR_CODE_SUCCESS) || (imu_config(handle) != ERR_CODE_SUCCESS))
+	{
+		free(handle);
+		return NULL;
+	}
+
+	/* Let the first samples arrive */
+	imu_sim_delay(20);
+
+	return handle;
+}
+
+static err_code_t bench_config(imu_handle_t handle, uint32_t *samples)
+{
+	*samples = 0;
+	return imu_config(handle);
+}
+
+static err_code_t bench_accel_raw(imu_handle_t handle, uint32_t *samples)
+{
+	int16_t x, y, z;
+	*samples = 1;
+	return imu_get_accel_raw(handle, &x, &y, &z);
+}
+
+static err_code_t bench_accel_calib(imu_handle_t handle, uint32_t *samples)
+{
+	int16_t x, y, z;
+	*samples = 1;
+	return imu_get_accel_calib(handle, &x, &y, &z);
+}
+
+static err_code_t bench_accel_scale(imu_handle_t handle, uint32_t *samples)
+{
+	float x, y, z;
+	*samples = 1;
+	return imu_get_accel_scale(handle, &x, &y, &z);
+}
+
+static err_code_t bench_gyro_raw(imu_handle_t handle, uint32_t *samples)
+{
+	int16_t x, y, z;
+	*samples = 1;
+	return imu_get_gyro_raw(handle, &x, &y, &z);
+}
+
+static err_code_t bench_gyro_calib(imu_handle_t handle, uint32_t *samples)
+{
+	int16_t x, y, z;
+	*samples = 1;
+	return imu_get_gyro_calib(handle, &x, &y, &z);
+}
+
+static err_code_t bench_gyro_scale(imu_handle_t handle, uint32_t *samples)
+{
+	float x, y, z;
+	*samples = 1;
+	return imu_get_gyro_scale(handle, &x, &y, &z);
+}
+
+static err_code_t bench_mag_raw(imu_handle_t handle, uint32_t *samples)
+{
+	int16_t x, y, z;
+	*samples = 1;
+	return imu_get_mag_raw(handle, &x, &y, &z);
+}
+
+static err_code_t bench_mag_calib(imu_handle_t handle, uint32_t *samples)
+{
+	float x, y, z;
+	*samples = 1;
+	return imu_get_mag_calib(handle, &x, &y, &z);
+}
+
+static err_code_t bench_mag_scale(imu_handle_t handle, uint32_t *samples)
+{
+	float x, y, z;
+	*samples = 1;
+	return imu_get_mag_scale(handle, &x, &y, &z);
+}
+
+static err_code_t bench_poll_sample(imu_handle_t handle, uint32_t *samples)
+{
+	imu_sample_t sample;
+	bool data_ready;
+	err_code_t err = imu_poll_sample(handle, &sample, &data_ready);
+	*samples = data_ready ? 1 : 0;
+	return err;
+}
+
+static err_code_t bench_read_channels(imu_handle_t handle, uint32_t *samples)
+{
+	imu_sample_t sample;
+	*samples = 1;
+	return imu_read_channels(handle, IMU_CHANNEL_ACCEL | IMU_CHANNEL_GYRO, &sample);
+}
+
+static err_code_t bench_poll_scale(imu_handle_t handle, uint32_t *samples)
+{
+	imu_sample_t sample;
+	imu_sample_scale_t scale;
+	bool data_ready;
+	err_code_t err = imu_poll_sample(handle, &sample, &data_ready);
+	if ((err == ERR_CODE_SUCCESS) && data_ready) {
+		err = imu_scale_sample(handle, &sample, &scale);
+	}
+	*samples = data_ready ? 1 : 0;
+	return err;
+}
+
+static err_code_t bench_read_fifo(imu_handle_t handle, uint32_t *samples)
+{
+	imu_sample_t sample[2 * BENCH_FIFO_FRAMES];
+	uint16_t num = 0;
+	err_code_t err = imu_read_fifo(handle, sample, 2 * BENCH_FIFO_FRAMES, &num);
+	*samples = num;
+	return err;
+}
+
+static err_code_t bench_auto_calib(imu_handle_t handle, uint32_t *samples)
+{
+	*samples = 0;
+	return imu_auto_calib(handle);
+}
+
+static const bench_case_t bench_case[] = {
+	{"config",              bench_config,           0,                                          0, 0, 0, 0, 10},
+	{"get_accel_raw",       bench_accel_raw,        BENCH_SAMPLE_PERIOD_US,                     0, 0, 1, 0, 0},
+	{"get_accel_calib",     bench_accel_calib,      BENCH_SAMPLE_PERIOD_US,                     0, 0, 1, 0, 0},
+	{"get_accel_scale",     bench_accel_scale,      BENCH_SAMPLE_PERIOD_US,                     0, 0, 1, 0, 0},
+	{"get_gyro_raw",        bench_gyro_raw,         BENCH_SAMPLE_PERIOD_US,                     0, 0, 1, 0, 0},
+	{"get_gyro_calib",      bench_gyro_calib,       BENCH_SAMPLE_PERIOD_US,                     0, 0, 1, 0, 0},
+	{"get_gyro_scale",      bench_gyro_scale,       BENCH_SAMPLE_PERIOD_US,                     0, 0, 1, 0, 0},
+	{"get_mag_raw",         bench_mag_raw,          BENCH_MAG_PERIOD_US,                        0, 0, 1, 1, 0},
+	{"get_mag_calib",       bench_mag_calib,        BENCH_MAG_PERIOD_US,                        0, 0, 1, 1, 0},
+	{"get_mag_scale",       bench_mag_scale,        BENCH_MAG_PERIOD_US,                        0, 0, 1, 1, 0},
+	{"poll_sample",         bench_poll_sample,      BENCH_SAMPLE_PERIOD_US,                     0, 0, 1, 0, 0},
+	{"poll_sample_stale",   bench_poll_sample,      0,                                          0, 0, 0, 0, 0},
+	{"poll_sample_batched", bench_poll_sample,      BENCH_SAMPLE_PERIOD_US,                     1, 0, 1, 0, 0},
+	{"poll_scale_sample",   bench_poll_scale,       BENCH_SAMPLE_PERIOD_US,                     0, 0, 1, 0, 0},
+	{"read_channels",       bench_read_channels,    BENCH_SAMPLE_PERIOD_US,                     0, 0, 1, 0, 0},
+	{"read_fifo",           bench_read_fifo,        BENCH_FIFO_FRAMES * BENCH_SAMPLE_PERIOD_US, 0, 1, 1, 0, 0},
+	{"read_fifo_batched",   bench_read_fifo,        BENCH_FIFO_FRAMES * BENCH_SAMPLE_PERIOD_US, 1, 1, 1, 0, 0},
+	{"auto_calib",          bench_auto_calib,       0,                                          0, 0, 0, 0, 3},
+};
+
+static const bench_decim_case_t bench_decim_case[] = {
+	{"decim_8_raw",         8,  127, 0},
+	{"decim_8_scale",       8,  127, 1},
+	{"decim_10_raw",        10, 159, 0},
+	{"decim_10_scale",      10, 159, 1},
+};
+
+static imu_sample_t bench_decim_raw[BENCH_DECIM_SAMPLES];
+static imu_sample_scale_t bench_decim_scale[BENCH_DECIM_SAMPLES];
+static imu_decim_sample_t bench_decim_out[BENCH_DECIM_SAMPLES / 2 + 1];
+
+static void bench_decim_fill(void)
+{
+	/* 1 kHz stream with a 20 Hz motion and a 310 Hz vibration */
+	for (uint32_t i = 0; i < BENCH_DECIM_SAMPLES; i++)
+	{
+		float motion = sinf(2.0f * 3.14159265f * 20.0f * i / 1000.0f);
+		float vibration = sinf(2.0f * 3.14159265f * 310.0f * i / 1000.0f);
+
+		memset(&bench_decim_raw[i], 0, sizeof(imu_sample_t));
+		bench_decim_raw[i].seq = i;
+		bench_decim_raw[i].timestamp_us = i * 1000;
+		bench_decim_raw[i].accel_raw_x = (int16_t)(4000.0f * vibration);
+		bench_decim_raw[i].accel_raw_z = (int16_t)(16384.0f + 2000.0f * vibration);
+		bench_decim_raw[i].gyro_raw_x = (int16_t)(3000.0f * motion + 500.0f * vibration);
+		bench_decim_raw[i].gyro_raw_y = (int16_t)(1000.0f * motion);
+		bench_decim_raw[i].temp_raw = 1000;
+
+		memset(&bench_decim_scale[i], 0, sizeof(imu_sample_scale_t));
+		bench_decim_scale[i].seq = i;
+		bench_decim_scale[i].timestamp_us = i * 1000;
+		bench_decim_scale[i].accel_x = bench_decim_raw[i].accel_raw_x / 16384.0f;
+		bench_decim_scale[i].accel_z = bench_decim_raw[i].accel_raw_z / 16384.0f;
+		bench_decim_scale[i].gyro_x = bench_decim_raw[i].gyro_raw_x / 131.0f;
+		bench_decim_scale[i].gyro_y = bench_decim_raw[i].gyro_raw_y / 131.0f;
+		bench_decim_scale[i].temp = 25.0f;
+	}
+}
+
+static void bench_decim_run(const bench_decim_case_t *bench, uint32_t iterations, uint8_t last)
+{
+	imu_decim_handle_t handle = imu_decim_init();
+	imu_decim_cfg_t cfg = {
+		.ratio = bench->ratio,
+		.taps = bench->taps,
+		.attenuation_db = 60.0f,
+		.coeffs = NULL,
+	};
+
+	if ((handle == NULL) || (imu_decim_set_config(handle, cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_decim_config(handle) != ERR_CODE_SUCCESS))
+	{
+		printf("    {\"name\": \"%s\", \"error\": \"setup failed\"}%s\n", bench->name, last ? "" : ",");
+		free(handle);
+		return;
+	}
+
+	uint64_t host_ns = 0, outputs = 0;
+	uint16_t num_out;
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		/* Continue the sequence so the filter never restarts */
+		for (uint32_t k = 0; k < BENCH_DECIM_SAMPLES; k++)
+		{
+			bench_decim_raw[k].seq = i * BENCH_DECIM_SAMPLES + k;
+			bench_decim_scale[k].seq = i * BENCH_DECIM_SAMPLES + k;
+		}
+
+		uint64_t start = bench_now_ns();
+		if (bench->scale) {
+			imu_decim_write_scale(handle, bench_decim_scale, BENCH_DECIM_SAMPLES, bench_decim_out, BENCH_DECIM_SAMPLES / 2 + 1, &num_out);
+		} else {
+			imu_decim_write(handle, bench_decim_raw, BENCH_DECIM_SAMPLES, bench_decim_out, BENCH_DECIM_SAMPLES / 2 + 1, &num_out);
+		}
+		host_ns += bench_now_ns() - start;
+		outputs += num_out;
+	}
+
+	imu_decim_status_t status;
+	imu_decim_get_status(handle, &status);
+
+	double inputs = (double)iterations * BENCH_DECIM_SAMPLES;
+
+	printf("    {\"name\": \"%s\", \"ratio\": %u, \"taps\": %u, \"inputs\": %.0f, \"outputs\": %llu, "
+	       "\"restarts\": %u, \"ns_per_input\": %.2f, \"ns_per_output\": %.1f, \"msamples_per_s\": %.2f}%s\n",
+	       bench->name, bench->ratio, bench->taps, inputs, (unsigned long long)outputs, status.restarts,
+	       host_ns / inputs, outputs ? (double)host_ns / outputs : 0.0, inputs * 1000.0 / host_ns,
+	       last ? "" : ",");
+
+	free(handle);
+}
+
+static const bench_filter_case_t bench_filter_case[] = {
+	{"filter_1k",           1000.0f,    0},
+	{"filter_1k_dyn_notch", 1000.0f,    1},
+	{"filter_8k_dyn_notch", 8000.0f,    1},
+};
+
+static void bench_filter_run(const bench_filter_case_t *bench, uint32_t iterations, uint8_t last)
+{
+	imu_filter_handle_t handle = imu_filter_init();
+	imu_filter_cfg_t cfg;
+
+	/* Gyroscope and accelerometer low-pass, a fixed notch on the gyroscope */
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.sample_rate_hz = bench->sample_rate_hz;
+	cfg.accel_stages[0] = (imu_filter_stage_t) {IMU_FILTER_LOWPASS, 100.0f, 0.7071f};
+	cfg.gyro_stages[0] = (imu_filter_stage_t) {IMU_FILTER_LOWPASS, 250.0f, 0.7071f};
+	cfg.gyro_stages[1] = (imu_filter_stage_t) {IMU_FILTER_NOTCH, 310.0f, 5.0f};
+	cfg.dyn_notch_enable = bench->dyn_notch;
+	cfg.dyn_notch_min_hz = 80.0f;
+	cfg.dyn_notch_max_hz = 400.0f;
+	cfg.dyn_notch_q = 3.0f;
+	cfg.dyn_notch_block = (uint16_t)(bench->sample_rate_hz / 16);
+
+	if ((handle == NULL) || (imu_filter_set_config(handle, cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_filter_config(handle) != ERR_CODE_SUCCESS))
+	{
+		printf("    {\"name\": \"%s\", \"error\": \"setup failed\"}%s\n", bench->name, last ? "" : ",");
+		free(handle);
+		return;
+	}
+
+	static imu_sample_scale_t samples[BENCH_DECIM_SAMPLES];
+	uint64_t host_ns = 0;
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		memcpy(samples, bench_decim_scale, sizeof(samples));
+
+		uint64_t start = bench_now_ns();
+		imu_filter_apply(handle, samples, BENCH_DECIM_SAMPLES);
+		host_ns += bench_now_ns() - start;
+	}
+
+	imu_filter_status_t status;
+	imu_filter_get_status(handle, &status);
+
+	double inputs = (double)iterations * BENCH_DECIM_SAMPLES;
+
+	printf("    {\"name\": \"%s\", \"sample_rate_hz\": %.0f, \"samples\": %.0f, \"retunes\": %u, "
+	       "\"dyn_notch_hz\": %.1f, \"ns_per_sample\": %.2f, \"cpu_percent\": %.4f}%s\n",
+	       bench->name, bench->sample_rate_hz, inputs, status.retunes, status.dyn_notch_hz,
+	       host_ns / inputs, host_ns / inputs * bench->sample_rate_hz * 1e-7, last ? "" : ",");
+
+	free(handle);
+}
+
+static const bench_fft_case_t bench_fft_case[] = {
+	{"fft_256_float",       256,        IMU_FFT_FORMAT_FLOAT},
+	{"fft_256_q15",         256,        IMU_FFT_FORMAT_Q15},
+	{"fft_1024_float",      1024,       IMU_FFT_FORMAT_FLOAT},
+	{"fft_1024_q15",        1024,       IMU_FFT_FORMAT_Q15},
+	{"fft_4096_float",      4096,       IMU_FFT_FORMAT_FLOAT},
+	{"fft_4096_q15",        4096,       IMU_FFT_FORMAT_Q15},
+};
+
+static void bench_fft_features(const imu_fft_features_t *features)
+{
+	(void)features;
+}
+
+static void bench_fft_run(const bench_fft_case_t *bench, uint32_t iterations, uint8_t last)
+{
+	static float buf[(IMU_FFT_MAX_AXES + 1) * IMU_FFT_MAX_POINTS];
+	imu_fft_handle_t handle = imu_fft_init();
+	imu_fft_cfg_t cfg = {
+		.points = bench->points,
+		.format = bench->format,
+		.window = IMU_FFT_WINDOW_HANN,
+		.channels = IMU_CHANNEL_ACCEL | IMU_CHANNEL_GYRO,
+		.sample_rate_hz = 1000.0f,
+		.band_edges_hz = {0.0f, 5.0f, 20.0f, 50.0f, 100.0f, 200.0f, 500.0f},
+		.num_bands = 6,
+		.buf = buf,
+		.buf_size = sizeof(buf),
+		.func_features = bench_fft_features,
+		.func_get_cycles = NULL,
+	};
+
+	if ((handle == NULL) || (imu_fft_set_config(handle, cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_fft_config(handle) != ERR_CODE_SUCCESS))
+	{
+		printf("    {\"name\": \"%s\", \"error\": \"setup failed\"}%s\n", bench->name, last ? "" : ",");
+		free(handle);
+		return;
+	}
+
+	uint64_t host_ns = 0;
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		/* Continue the sequence so no frame restarts */
+		for (uint32_t k = 0; k < BENCH_DECIM_SAMPLES; k++)
+		{
+			bench_decim_raw[k].seq = i * BENCH_DECIM_SAMPLES + k;
+		}
+
+		uint64_t start = bench_now_ns();
+		imu_fft_write(handle, bench_decim_raw, BENCH_DECIM_SAMPLES);
+		host_ns += bench_now_ns() - start;
+	}
+
+	imu_fft_status_t status;
+	imu_fft_get_status(handle, &status);
+
+	double inputs = (double)iterations * BENCH_DECIM_SAMPLES;
+
+	printf("    {\"name\": \"%s\", \"points\": %u, \"frames\": %u, \"restarts\": %u, "
+	       "\"features_bytes\": %u, \"ns_per_sample\": %.2f, \"us_per_frame\": %.1f, \"cpu_percent_1k\": %.4f}%s\n",
+	       bench->name, bench->points, status.frames, status.restarts, (unsigned)sizeof(imu_fft_features_t),
+	       host_ns / inputs, status.frames ? host_ns / 1000.0 / status.frames : 0.0, host_ns / inputs * 1000.0 * 1e-7,
+	       last ? "" : ",");
+
+	free(handle);
+}
+
+static void bench_preint_run(uint32_t iterations)
+{
+	imu_preint_handle_t handle = imu_preint_init();
+	imu_preint_cfg_t cfg = {
+		.sample_rate_hz = 1000.0f,
+		.noise = {
+			.gyro_noise_density = 1.7e-4f,
+			.accel_noise_density = 2.0e-3f,
+			.gyro_bias_rw = 2.0e-5f,
+			.accel_bias_rw = 3.0e-3f,
+		},
+	};
+
+	if ((handle == NULL) || (imu_preint_set_config(handle, cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_preint_config(handle) != ERR_CODE_SUCCESS))
+	{
+		printf("    {\"name\": \"preint_1k\", \"error\": \"setup failed\"}\n");
+		free(handle);
+		return;
+	}
+
+	imu_preint_result_t result;
+	uint64_t host_ns = 0;
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		for (uint32_t k = 0; k < BENCH_DECIM_SAMPLES; k++)
+		{
+			bench_decim_scale[k].seq = i * BENCH_DECIM_SAMPLES + k;
+			bench_decim_scale[k].timestamp_us = (uint64_t)bench_decim_scale[k].seq * 1000;
+		}
+
+		/* One read per camera frame */
+		uint64_t start = bench_now_ns();
+		for (uint32_t k = 0; k < BENCH_DECIM_SAMPLES; k += BENCH_PREINT_INTERVAL)
+		{
+			uint32_t n = BENCH_DECIM_SAMPLES - k;
+			imu_preint_write(handle, &bench_decim_scale[k], (n < BENCH_PREINT_INTERVAL) ? n : BENCH_PREINT_INTERVAL);
+			imu_preint_read(handle, &result);
+		}
+		host_ns += bench_now_ns() - start;
+	}
+
+	imu_preint_status_t status;
+	imu_preint_get_status(handle, &status);
+
+	double inputs = (double)iterations * BENCH_DECIM_SAMPLES;
+
+	printf("    {\"name\": \"preint_1k\", \"samples\": %u, \"intervals\": %u, \"gaps\": %u, "
+	       "\"result_bytes\": %u, \"ns_per_sample\": %.2f, \"cpu_percent\": %.4f}\n",
+	       status.samples, status.intervals, status.gaps, (unsigned)sizeof(imu_preint_result_t),
+	       host_ns / inputs, host_ns / inputs * 1000.0 * 1e-7);
+
+	free(handle);
+}
+
+static void bench_run(const bench_case_t *bench, uint32_t iterations, uint8_t last)
+{
+	uint64_t samples = 0, errors = 0, host_ns = 0;
+	uint32_t delivered;
+
+	imu_handle_t handle = bench_setup(bench->batched);
+	if (handle == NULL)
+	{
+		printf("    {\"name\": \"%s\", \"error\": \"setup failed\"}%s\n", bench->name, last ? "" : ",");
+		return;
+	}
+
+	imu_config_regs_t regs;
+	if (bench->mag && ((imu_get_config_regs(handle, &regs) != ERR_CODE_SUCCESS) || (regs.mag_present == 0)))
+	{
+		printf("    {\"name\": \"%s\", \"error\": \"unavailable, built without USE_AK8963\"}%s\n", bench->name, last ? "" : ",");
+		free(handle);
+		return;
+	}
+
+	if (bench->fifo)
+	{
+		imu_config_fifo(handle, true);
+	}
+
+	if (bench->iterations != 0)
+	{
+		iterations = bench->iterations;
+	}
+
+	bench_bus_clear();
+
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		imu_sim_advance_us(bench->advance_us);
+
+		uint64_t start = bench_now_ns();
+		err_code_t err = bench->func(handle, &delivered);
+		host_ns += bench_now_ns() - start;
+
+		samples += delivered;
+		errors += (err != ERR_CODE_SUCCESS) ? 1 : 0;
+	}
+
+	uint64_t transactions = 0, bytes = 0, i2c_clocks = 0, spi_clocks = 0;
+	for (uint8_t i = 0; i < BENCH_BUS_DEV; i++)
+	{
+		transactions += bench_bus[i].transactions;
+		bytes += bench_bus[i].bytes;
+		i2c_clocks += bench_bus[i].i2c_clocks;
+		spi_clocks += bench_bus[i].spi_clocks;
+	}
+
+	double per = (bench->per_sample && (samples != 0)) ? (double)samples : (double)iterations;
+
+	printf("    {\"name\": \"%s\", \"calls\": %u, \"samples\": %llu, \"errors\": %llu, "
+	       "\"per\": \"%s\", \"transactions\": %.3f, \"bytes\": %.3f, \"ns_per_call\": %.1f, "
+	       "\"bus_us\": {\"i2c_100k\": %.2f, \"i2c_400k\": %.2f, \"spi_1m\": %.2f, \"spi_20m\": %.3f}}%s\n",
+	       bench->name, iterations, (unsigned long long)samples, (unsigned long long)errors,
+	       (bench->per_sample && (samples != 0)) ? "sample" : "call", transactions / per, bytes / per, (double)host_ns / iterations,
+	       i2c_clocks / per / 0.1, i2c_clocks / per / 0.4, spi_clocks / per / 1.0, spi_clocks / per / 20.0,
+	       last ? "" : ",");
+
+	free(handle);
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t iterations = BENCH_ITERATIONS_DEFAULT;
+	uint32_t num_case = sizeof(bench_case) / sizeof(bench_case[0]);
+
+	if (argc > 1)
+	{
+		iterations = (uint32_t)strtoul(argv[1], NULL, 0);
+		if (iterations == 0)
+		{
+			fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	printf("{\n  \"bench\": \"imu\",\n  \"iterations\": %u,\n  \"results\": [\n", iterations);
+	for (uint32_t i = 0; i < num_case; i++)
+	{
+		bench_run(&bench_case[i], iterations, i == (num_case - 1));
+	}
+	printf("  ],\n  \"decim\": [\n");
+
+	uint32_t num_decim = sizeof(bench_decim_case) / sizeof(bench_decim_case[0]);
+	bench_decim_fill();
+	for (uint32_t i = 0; i < num_decim; i++)
+	{
+		bench_decim_run(&bench_decim_case[i], iterations, i == (num_decim - 1));
+	}
+	printf("  ],\n  \"filter\": [\n");
+
+	uint32_t num_filter = sizeof(bench_filter_case) / sizeof(bench_filter_case[0]);
+	for (uint32_t i = 0; i < num_filter; i++)
+	{
+		bench_filter_run(&bench_filter_case[i], iterations, i == (num_filter - 1));
+	}
+	printf("  ],\n  \"fft\": [\n");
+
+	uint32_t num_fft = sizeof(bench_fft_case) / sizeof(bench_fft_case[0]);
+	for (uint32_t i = 0; i < num_fft; i++)
+	{
+		bench_fft_run(&bench_fft_case[i], iterations, i == (num_fft - 1));
+	}
+	printf("  ],\n  \"preint\": [\n");
+
+	bench_preint_run(iterations);
+	printf("  ]\n}\n");
+
+	return 0;
+}
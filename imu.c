@@ -1,10 +1,16 @@
 #include "stdlib.h"
 #include "stddef.h"
+#include "string.h"
+#include "stdatomic.h"
 
 #include "imu.h"
+#include "imu_clock/imu_clock.h"
 
+/* Backend, may also be selected on the compiler command line */
+#if !defined(USE_MPU6050) && !defined(USE_MPU6500)
 #define USE_MPU6050
 // #define USE_MPU6500
+#endif
 // #define USE_AK8963
 
 #define AK8963_OPR_MODE  			AK8963_MODE_CONT_MEASUREMENT_2
@@ -21,8 +27,28 @@
 #define MPU6500_SLEEP_MODE  		MPU6500_DISABLE_SLEEP_MODE
 #define MPU6500_GFS_SEL  			MPU6500_GFS_SEL_2000
 #define MPU6500_AFS_SEL   			MPU6500_AFS_SEL_8G
+#define MPU6500_TRANSPORT 			MPU6500_TRANSPORT_I2C
+
+// #define IMU_ENABLE_STATS 					/*!< Bus and sample statistics, wraps every transport call */
 
 #define BUFFER_CALIB_DEFAULT 		1000
+#define BUFFER_CALIB_DISMISS 		100
+#define CALIB_POLL_MARGIN 			2 			/*!< Polls allowed per millisecond of output data rate period */
+
+#define FIFO_FRAME_SIZE 			14 			/*!< Accelerometer, temperature and gyroscope */
+
+#define CALIB_BLOB_MAGIC 			"IMUC"
+#define CALIB_BLOB_VERSION 			2
+#define CALIB_BLOB_CRC_OFFSET 		(IMU_CALIB_BLOB_SIZE - 4)
+#define CALIB_TEMP_MODEL_NONE 		0 			/*!< No temperature compensation */
+#define FIFO_CHUNK_FRAMES 			(1024 / FIFO_FRAME_SIZE) 	/*!< Frames read from FIFO per transaction, a full FIFO */
+
+#define CLOCK_FORGET_FACTOR 		0.999f 		/*!< Sensor clock fit memory, about 1000 observations */
+#define CLOCK_MIN_OBSERVATIONS 		16
+
+#define HEALTH_SATURATION_DEFAULT 	32767
+#define HEALTH_SCORE_WINDOW_DEFAULT 100
+#define HEALTH_AXES 				6 			/*!< Accelerometer then gyroscope axes */
 
 
 #ifdef USE_MPU6050
@@ -38,7 +64,7 @@
 #endif
 
 
-typedef struct imu {
+typedef struct {
 	int16_t                     accel_bias_x;               /*!< Accelerometer bias of x axis */
 	int16_t                     accel_bias_y;               /*!< Accelerometer bias of y axis */
 	int16_t                     accel_bias_z;               /*!< Accelerometer bias of z axis */
@@ -53,516 +79,2515 @@ typedef struct imu {
 	float                       mag_soft_iron_bias_z;       /*!< Magnetometer soft iron bias of z axis */
 	float 						accel_scaling_factor;		/*!< Accelerometer scaling factor */
 	float 						gyro_scaling_factor;		/*!< Gyroscope scaling factor */
+	float 						accel_bias_scaling_factor;	/*!< Accelerometer scaling factor of the range the bias is in */
+	float 						gyro_bias_scaling_factor;	/*!< Gyroscope scaling factor of the range the bias is in */
 	float 						mag_scaling_factor;			/*!< Magnetometer scaling factor */
 	float  						mag_sens_adj_x; 			/*!< Magnetometer sensitive adjust of x axis */
 	float  						mag_sens_adj_y;				/*!< Magnetometer sensitive adjust of y axis */
 	float  						mag_sens_adj_z;				/*!< Magnetometer sensitive adjust of z axis */
+} imu_calib_t;
+
+typedef struct imu {
+	imu_calib_t 				calib; 						/*!< Calibration, protected by calib_lock */
+	atomic_uint 				calib_lock; 				/*!< Calibration seqlock sequence, odd while written */
 	imu_func_read_bytes         mpu6050_read_bytes;         /*!< MPU6050 read bytes */
 	imu_func_write_bytes        mpu6050_write_bytes;        /*!< MPU6050 write bytes */
+	imu_func_transfer 			mpu6050_transfer; 			/*!< MPU6050 batched transfer */
 	imu_func_read_bytes         ak8963_read_bytes;          /*!< AK8963 write bytes */
 	imu_func_write_bytes        ak8963_write_bytes;         /*!< AK8963 write bytes */
 	imu_func_read_bytes         mpu6500_read_bytes;         /*!< MPU6500 write bytes */
 	imu_func_write_bytes        mpu6500_write_bytes;        /*!< MPU6500 write bytes */
+	imu_func_set_bus_clock 		mpu6500_set_bus_clock; 		/*!< MPU6500 SPI clock select */
+#ifdef USE_MPU6500
+	mpu6500_dev_t 				mpu6500_dev; 				/*!< MPU6500 transport state */
+#endif
+	imu_func_transfer 			mpu6500_transfer; 			/*!< MPU6500 batched transfer */
 	imu_func_delay              func_delay;                 /*!< IMU delay function */
+	imu_func_get_time_us 		func_get_time_us; 			/*!< Timestamp source */
+	uint32_t 					sample_seq;					/*!< Sequence number of the next new sample */
+	uint32_t 					read_seq; 					/*!< Sequence number of the next channel read */
+	uint8_t 					sample_valid; 				/*!< At least one sample was read */
+	float 						sample_period_us; 			/*!< Nominal sample period */
+	float 						rate_prev_period_us; 		/*!< Sample period of FIFO frames from before the last rate change */
+	uint16_t 					rate_old_frames; 			/*!< FIFO frames still at the previous rate */
+	uint64_t 					last_timestamp_us; 			/*!< Timestamp of the last sample */
+	volatile uint64_t 			drdy_time_us; 				/*!< Time of the last data ready interrupt */
+	volatile uint8_t 			drdy_pending; 				/*!< Data ready interrupt occurred since last read */
+	volatile uint32_t 			drdy_count; 				/*!< Number of data ready interrupts */
+	uint32_t 					last_drdy_count; 			/*!< Data ready interrupt count at the last sample */
+	imu_clock_handle_t 			clock; 						/*!< Sensor clock estimator */
+	uint8_t 					fifo_enable; 				/*!< FIFO is enabled */
+	uint8_t 					fifo_buf[FIFO_FRAME_SIZE * FIFO_CHUNK_FRAMES];	/*!< FIFO read buffer */
+	imu_sample_t 				latest; 					/*!< Latest published sample, protected by latest_lock */
+	imu_sample_scale_t 			latest_scale; 				/*!< Latest published scaled sample, protected by latest_lock */
+	atomic_uint 				latest_lock; 				/*!< Latest sample seqlock sequence, 0 until first publish */
+	imu_config_regs_t 			regs; 						/*!< Configuration register values written */
+	imu_power_status_t 			power; 						/*!< Power state and wake-up latency */
+	uint8_t 					power_fifo_enable; 			/*!< FIFO to restart on wake-up */
+	uint64_t 					power_settle_us; 			/*!< Samples before this time are dropped after wake-up */
+	imu_auto_range_cfg_t 		range_cfg; 					/*!< Auto-range configuration */
+	uint8_t 					accel_range; 				/*!< Accelerometer range of new samples */
+	uint8_t 					gyro_range; 				/*!< Gyroscope range of new samples */
+	uint8_t 					accel_range_prev; 			/*!< Accelerometer range of FIFO frames from before the last change */
+	uint8_t 					gyro_range_prev; 			/*!< Gyroscope range of FIFO frames from before the last change */
+	uint16_t 					range_old_frames; 			/*!< FIFO frames still in the previous range */
+	uint16_t 					range_drop_frames; 			/*!< FIFO frames after those that may be in either range */
+	uint16_t 					accel_quiet; 				/*!< Samples below the auto-range down threshold */
+	uint16_t 					gyro_quiet;
+	imu_health_cfg_t 			health_cfg; 				/*!< Health monitoring configuration */
+	imu_health_status_t 		health; 					/*!< Health monitoring status */
+	int16_t 					health_prev[HEALTH_AXES]; 	/*!< Raw value of the last checked sample per axis */
+	uint16_t 					health_run[HEALTH_AXES]; 	/*!< Consecutive samples with the same raw value per axis */
+	uint8_t 					health_prev_range[2]; 		/*!< Accelerometer and gyroscope range of the last checked sample */
+	uint8_t 					health_prev_valid; 			/*!< imu_channel_t bits with a last checked sample */
+#ifdef IMU_ENABLE_STATS
+	imu_stats_t 				stats; 						/*!< Statistics */
+	imu_func_get_cycles 		func_get_cycles; 			/*!< Cycle counter */
+	uint32_t 					cycles_per_us; 				/*!< Cycle counter frequency in MHz */
+	uint64_t 					stats_read_us[2]; 			/*!< Time of the last direct accelerometer and gyroscope read */
+	imu_func_read_bytes 		stats_mpu6050_read_bytes; 	/*!< User transport functions, the handle holds the counting ones */
+	imu_func_write_bytes 		stats_mpu6050_write_bytes;
+	imu_func_transfer 			stats_mpu6050_transfer;
+	imu_func_read_bytes 		stats_mpu6500_read_bytes;
+	imu_func_write_bytes 		stats_mpu6500_write_bytes;
+	imu_func_transfer 			stats_mpu6500_transfer;
+	imu_func_read_bytes 		stats_ak8963_read_bytes;
+	imu_func_write_bytes 		stats_ak8963_write_bytes;
+#endif
 } imu_t;
 
-#ifdef USE_AK8963
-static err_code_t imu_config_ak8963(imu_handle_t handle)
+/* Seqlock: writers make the sequence odd, update the data and make it even
+ * again, the compare and swap also serializes concurrent writers. Readers
+ * retry until they copied the data while the sequence was even and unchanged.
+ */
+static void imu_seqlock_write_begin(atomic_uint *lock)
 {
-	/* Check if handle structure is NULL */
-	if (handle == NULL)
+	unsigned int seq = atomic_load_explicit(lock, memory_order_relaxed);
+
+	while ((seq & 1) || !atomic_compare_exchange_weak_explicit(lock, &seq, seq + 1,
+	        memory_order_acquire, memory_order_relaxed))
 	{
-		return ERR_CODE_NULL_PTR;
+		seq = atomic_load_explicit(lock, memory_order_relaxed);
 	}
 
-	err_code_t err;
+	atomic_thread_fence(memory_order_release);
+}
 
-	err = ak8963_init(handle->ak8963_read_bytes,
-	                  handle->ak8963_write_bytes,
-	                  handle->func_delay,
-	                  AK8963_OPR_MODE,
-	                  AK8963_MFS_SEL);
-	if (err != ERR_CODE_SUCCESS)
-	{
-		return ERR_CODE_FAIL;
-	}
+static void imu_seqlock_write_end(atomic_uint *lock)
+{
+	atomic_fetch_add_explicit(lock, 1, memory_order_release);
+}
 
-	ak8963_get_sens_adj(handle->ak8963_read_bytes,
-	                    &handle->mag_sens_adj_x,
-	                    &handle->mag_sens_adj_y,
-	                    &handle->mag_sens_adj_z);
+static unsigned int imu_seqlock_read_begin(atomic_uint *lock)
+{
+	unsigned int seq;
 
-	/* Update magnetometer scaling factor */
-	switch (AK8963_MFS_SEL)
+	do
 	{
-	case AK8963_MFS_14BIT:
-		handle->mag_scaling_factor = 10.0f * 4912.0f / 8190.0f;
-		break;
+		seq = atomic_load_explicit(lock, memory_order_acquire);
+	} while (seq & 1);
 
-	case AK8963_MFS_16BIT:
-		handle->mag_scaling_factor = 10.0f * 4912.0f / 32760.0f;
-		break;
+	return seq;
+}
 
-	default:
-		break;
-	}
+static bool imu_seqlock_read_retry(atomic_uint *lock, unsigned int seq)
+{
+	atomic_thread_fence(memory_order_acquire);
 
-	return ERR_CODE_SUCCESS;
+	return atomic_load_explicit(lock, memory_order_relaxed) != seq;
 }
-#endif
 
-#ifdef USE_MPU6050
-static err_code_t imu_config_mpu6050(imu_handle_t handle)
+static void imu_calib_write_begin(imu_handle_t handle)
 {
-	/* Check if handle structure is NULL */
-	if (handle == NULL)
+	imu_seqlock_write_begin(&handle->calib_lock);
+}
+
+static void imu_calib_write_end(imu_handle_t handle)
+{
+	imu_seqlock_write_end(&handle->calib_lock);
+}
+
+static void imu_read_calib(imu_handle_t handle, imu_calib_t *calib)
+{
+	unsigned int seq;
+
+	do
 	{
-		return ERR_CODE_NULL_PTR;
-	}
+		seq = imu_seqlock_read_begin(&handle->calib_lock);
+		memcpy(calib, &handle->calib, sizeof(imu_calib_t));
+	} while (imu_seqlock_read_retry(&handle->calib_lock, seq));
+}
 
-	err_code_t err;
+static uint32_t imu_calib_crc32(const uint8_t *data, uint32_t len)
+{
+	/* CRC-32 (IEEE 802.3), bitwise, the blob is small */
+	uint32_t crc = 0xFFFFFFFF;
 
-	err = mpu6050_init(handle->mpu6050_read_bytes,
-	                   handle->mpu6050_write_bytes,
-	                   handle->func_delay,
-	                   MPU6050_CLKSEL,
-	                   MPU6050_DLPF_CFG,
-	                   MPU6050_SLEEP_MODE,
-	                   MPU6050_AFS_SEL,
-	                   MPU6050_GFS_SEL);
-	if (err != ERR_CODE_SUCCESS)
+	for (uint32_t i = 0; i < len; i++)
 	{
-		return ERR_CODE_FAIL;
+		crc ^= data[i];
+		for (uint8_t bit = 0; bit < 8; bit++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1u)));
+		}
 	}
 
-	/* Update accelerometer scaling factor */
-	switch (MPU6050_AFS_SEL)
-	{
-	case MPU6050_AFS_SEL_2G:
-		handle->accel_scaling_factor = (2.0f / 32768.0f);
-		break;
+	return ~crc;
+}
 
-	case MPU6050_AFS_SEL_4G:
-		handle->accel_scaling_factor = (4.0f / 32768.0f);
-		break;
+static uint8_t *imu_calib_put_u32(uint8_t *p, uint32_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
 
-	case MPU6050_AFS_SEL_8G:
-		handle->accel_scaling_factor = (8.0f / 32768.0f);
-		break;
+	return p + 4;
+}
 
-	case MPU6050_AFS_SEL_16G:
-		handle->accel_scaling_factor = (16.0f / 32768.0f);
-		break;
+static uint8_t *imu_calib_put_i16(uint8_t *p, int16_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)((uint16_t)value >> 8);
 
-	default:
-		break;
-	}
+	return p + 2;
+}
 
-	/* Update gyroscope scaling factor */
-	switch (MPU6050_GFS_SEL)
-	{
-	case MPU6050_GFS_SEL_250:
-		handle->gyro_scaling_factor = 250.0f / 32768.0f;
-		break;
+static uint8_t *imu_calib_put_f32(uint8_t *p, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
 
-	case MPU6050_GFS_SEL_500:
-		handle->gyro_scaling_factor = 500.0f / 32768.0f;
-		break;
+	return imu_calib_put_u32(p, bits);
+}
 
-	case MPU6050_GFS_SEL_1000:
-		handle->gyro_scaling_factor = 1000.0f / 32768.0f;
-		break;
+static uint32_t imu_calib_get_u32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
 
-	case MPU6050_GFS_SEL_2000:
-		handle->gyro_scaling_factor = 2000.0f / 32768.0f;
-		break;
+static int16_t imu_calib_get_i16(const uint8_t *p)
+{
+	return (int16_t)(p[0] | (p[1] << 8));
+}
 
-	default:
-		break;
+static float imu_calib_get_f32(const uint8_t *p)
+{
+	uint32_t bits = imu_calib_get_u32(p);
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+/* Settings a calibration is only valid for. Not the full scale ranges,
+ * biases carry the scaling factor of the range they were taken in and
+ * auto-range may have moved the live range since.
+ */
+static void imu_calib_put_regs(uint8_t *p, const imu_config_regs_t *regs)
+{
+	p[0] = regs->who_am_i;
+	p[1] = 0;
+	p[2] = 0;
+	p[3] = regs->mag_present;
+	p[4] = regs->mag_cntl;
+	p[5] = regs->mag_asa[0];
+	p[6] = regs->mag_asa[1];
+	p[7] = regs->mag_asa[2];
+}
+
+static uint64_t imu_get_time_us(imu_handle_t handle)
+{
+	if (handle->func_get_time_us == NULL)
+	{
+		return 0;
 	}
 
-	return ERR_CODE_SUCCESS;
+	return handle->func_get_time_us();
 }
-#endif
 
-#ifdef USE_MPU6500
-static err_code_t imu_config_mpu6500(imu_handle_t handle)
+static float imu_get_period_us(imu_handle_t handle)
 {
-	/* Check if handle structure is NULL */
-	if (handle == NULL)
+	float period_us = handle->sample_period_us;
+
+	imu_clock_get_period(handle->clock, &period_us);
+
+	return period_us;
+}
+
+#ifdef IMU_ENABLE_STATS
+/* Transport functions have no context. Every public function that reaches
+ * the bus names its handle first, the counting transport functions find the
+ * user function and the counters through it.
+ */
+static _Thread_local imu_handle_t imu_stats_bus_handle;
+
+#define IMU_STATS_BUS_BEGIN(handle) 		(imu_stats_bus_handle = (handle))
+#define IMU_STATS_INC(handle, counter) 		((handle)->stats.counter++)
+
+#define IMU_STATS_STREAM_ACCEL 		0
+#define IMU_STATS_STREAM_GYRO 		1
+
+static uint8_t imu_stats_log2(uint32_t value)
+{
+#if defined(__GNUC__)
+	return (value == 0) ? 0 : (uint8_t)(31 - __builtin_clz(value));
+#else
+	uint8_t bin = 0;
+	while (value >>= 1)
 	{
-		return ERR_CODE_NULL_PTR;
+		bin++;
 	}
+	return bin;
+#endif
+}
 
-	err_code_t err;
+static uint32_t imu_stats_begin_cycles(imu_handle_t handle)
+{
+	return (handle->func_get_cycles != NULL) ? handle->func_get_cycles() : 0;
+}
 
-	err = mpu6500_init(handle->mpu6500_read_bytes,
-	                   handle->mpu6500_write_bytes,
-	                   handle->func_delay,
-	                   MPU6500_CLKSEL,
-	                   MPU6500_DLPF_CFG,
-	                   MPU6500_SLEEP_MODE,
-	                   MPU6500_AFS_SEL,
-	                   MPU6500_GFS_SEL);
-	if (err != ERR_CODE_SUCCESS)
+static void imu_stats_record(imu_handle_t handle, imu_transfer_dir_t dir, uint32_t start_cycles, err_code_t err, uint32_t timeout_ms)
+{
+	imu_stats_t *stats = &handle->stats;
+	uint32_t cycles = 0;
+
+	if (handle->func_get_cycles != NULL)
 	{
-		return ERR_CODE_FAIL;
+		cycles = handle->func_get_cycles() - start_cycles;
 	}
 
-	/* Update accelerometer scaling factor */
-	switch (MPU6500_AFS_SEL)
+	if (dir == IMU_TRANSFER_READ)
 	{
-	case MPU6500_AFS_SEL_2G:
-		handle->accel_scaling_factor = (2.0f / 32768.0f);
-		break;
+		stats->read_transactions++;
+		if (handle->func_get_cycles != NULL)
+		{
+			stats->read_latency_hist[imu_stats_log2(cycles)]++;
+			if (cycles > stats->read_cycles_max)
+			{
+				stats->read_cycles_max = cycles;
+			}
+		}
+	}
+	else
+	{
+		stats->write_transactions++;
+	}
 
-	case MPU6500_AFS_SEL_4G:
-		handle->accel_scaling_factor = (4.0f / 32768.0f);
-		break;
+	if (err == ERR_CODE_SUCCESS)
+	{
+		return;
+	}
 
-	case MPU6500_AFS_SEL_8G:
-		handle->accel_scaling_factor = (8.0f / 32768.0f);
-		break;
+	stats->errors++;
 
-	case MPU6500_AFS_SEL_16G:
-		handle->accel_scaling_factor = (16.0f / 32768.0f);
-		break;
+	uint8_t slot = 0;
+	while ((slot < IMU_STATS_ERR_SLOTS) && (stats->error_count[slot] != 0) && (stats->error_code[slot] != err))
+	{
+		slot++;
+	}
+	if (slot < IMU_STATS_ERR_SLOTS) {
+		stats->error_code[slot] = err;
+		stats->error_count[slot]++;
+	} else {
+		stats->error_other++;
+	}
 
-	default:
-		break;
+	/* A transaction that failed after the whole timeout timed out */
+	if ((handle->cycles_per_us != 0) && ((uint64_t)cycles >= (uint64_t)timeout_ms * 1000 * handle->cycles_per_us))
+	{
+		stats->timeouts++;
 	}
+}
 
-	/* Update gyroscope scaling factor */
-	switch (MPU6500_GFS_SEL)
+static void imu_stats_check_duplicate(imu_handle_t handle, uint8_t stream)
+{
+	if (handle->func_get_time_us == NULL)
 	{
-	case MPU6500_GFS_SEL_250:
-		handle->gyro_scaling_factor = 250.0f / 32768.0f;
-		break;
+		return;
+	}
 
-	case MPU6500_GFS_SEL_500:
-		handle->gyro_scaling_factor = 500.0f / 32768.0f;
-		break;
+	/* Output registers change once per sample period */
+	uint64_t time_us = handle->func_get_time_us();
+	if ((handle->stats_read_us[stream] != 0) && ((float)(time_us - handle->stats_read_us[stream]) < imu_get_period_us(handle)))
+	{
+		handle->stats.duplicate_samples++;
+	}
+	handle->stats_read_us[stream] = time_us;
+}
 
-	case MPU6500_GFS_SEL_1000:
-		handle->gyro_scaling_factor = 1000.0f / 32768.0f;
-		break;
+#define IMU_STATS_FUNC(chip) 																					\
+static err_code_t imu_stats_##chip##_read_bytes(uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms) 	\
+{ 																												\
+	imu_handle_t handle = imu_stats_bus_handle; 																\
+	if (handle == NULL) { 																						\
+		return ERR_CODE_FAIL; 																					\
+	} 																											\
+	uint32_t start = imu_stats_begin_cycles(handle); 															\
+	err_code_t err = handle->stats_##chip##_read_bytes(reg_addr, buf, len, timeout_ms); 						\
+	handle->stats.read_bytes += len; 																			\
+	imu_stats_record(handle, IMU_TRANSFER_READ, start, err, timeout_ms); 										\
+	return err; 																								\
+} 																												\
+static err_code_t imu_stats_##chip##_write_bytes(uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms) 	\
+{ 																												\
+	imu_handle_t handle = imu_stats_bus_handle; 																\
+	if (handle == NULL) { 																						\
+		return ERR_CODE_FAIL; 																					\
+	} 																											\
+	uint32_t start = imu_stats_begin_cycles(handle); 															\
+	err_code_t err = handle->stats_##chip##_write_bytes(reg_addr, buf, len, timeout_ms); 						\
+	handle->stats.write_bytes += len; 																			\
+	imu_stats_record(handle, IMU_TRANSFER_WRITE, start, err, timeout_ms); 										\
+	return err; 																								\
+}
 
-	case MPU6500_GFS_SEL_2000:
-		handle->gyro_scaling_factor = 2000.0f / 32768.0f;
-		break;
+#define IMU_STATS_TRANSFER_FUNC(chip) 																			\
+static err_code_t imu_stats_##chip##_transfer(imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms) 	\
+{ 																												\
+	imu_handle_t handle = imu_stats_bus_handle; 																\
+	imu_transfer_dir_t dir = IMU_TRANSFER_WRITE; 																\
+	if (handle == NULL) { 																						\
+		return ERR_CODE_FAIL; 																					\
+	} 																											\
+	uint32_t start = imu_stats_begin_cycles(handle); 															\
+	err_code_t err = handle->stats_##chip##_transfer(transfers, num_transfers, timeout_ms); 					\
+	for (uint8_t i = 0; i < num_transfers; i++) { 																\
+		if (transfers[i].dir == IMU_TRANSFER_READ) { 															\
+			handle->stats.read_bytes += transfers[i].len; 														\
+			dir = IMU_TRANSFER_READ; 																			\
+		} else { 																								\
+			handle->stats.write_bytes += transfers[i].len; 														\
+		} 																										\
+	} 																											\
+	imu_stats_record(handle, dir, start, err, timeout_ms); 														\
+	return err; 																								\
+}
 
-	default:
-		break;
-	}
+IMU_STATS_FUNC(mpu6050)
+IMU_STATS_FUNC(mpu6500)
+IMU_STATS_FUNC(ak8963)
+IMU_STATS_TRANSFER_FUNC(mpu6050)
+IMU_STATS_TRANSFER_FUNC(mpu6500)
 
-	return ERR_CODE_SUCCESS;
+static void imu_stats_set_config(imu_handle_t handle, const imu_cfg_t *config)
+{
+	handle->func_get_cycles = config->func_get_cycles;
+	handle->cycles_per_us = config->cycles_per_us;
+
+	handle->stats_mpu6050_read_bytes = config->mpu6050_read_bytes;
+	handle->stats_mpu6050_write_bytes = config->mpu6050_write_bytes;
+	handle->stats_mpu6050_transfer = config->mpu6050_transfer;
+	handle->stats_mpu6500_read_bytes = config->mpu6500_read_bytes;
+	handle->stats_mpu6500_write_bytes = config->mpu6500_write_bytes;
+	handle->stats_mpu6500_transfer = config->mpu6500_transfer;
+	handle->stats_ak8963_read_bytes = config->ak8963_read_bytes;
+	handle->stats_ak8963_write_bytes = config->ak8963_write_bytes;
+
+	/* Route the drivers through the counting functions */
+	handle->mpu6050_read_bytes = (config->mpu6050_read_bytes != NULL) ? imu_stats_mpu6050_read_bytes : NULL;
+	handle->mpu6050_write_bytes = (config->mpu6050_write_bytes != NULL) ? imu_stats_mpu6050_write_bytes : NULL;
+	handle->mpu6050_transfer = (config->mpu6050_transfer != NULL) ? imu_stats_mpu6050_transfer : NULL;
+	handle->mpu6500_read_bytes = (config->mpu6500_read_bytes != NULL) ? imu_stats_mpu6500_read_bytes : NULL;
+	handle->mpu6500_write_bytes = (config->mpu6500_write_bytes != NULL) ? imu_stats_mpu6500_write_bytes : NULL;
+	handle->mpu6500_transfer = (config->mpu6500_transfer != NULL) ? imu_stats_mpu6500_transfer : NULL;
+	handle->ak8963_read_bytes = (config->ak8963_read_bytes != NULL) ? imu_stats_ak8963_read_bytes : NULL;
+	handle->ak8963_write_bytes = (config->ak8963_write_bytes != NULL) ? imu_stats_ak8963_write_bytes : NULL;
 }
+#else
+#define IMU_STATS_BUS_BEGIN(handle)
+#define IMU_STATS_INC(handle, counter)
+#define imu_stats_check_duplicate(handle, stream)
 #endif
 
-imu_handle_t imu_init(void)
+#ifdef USE_AK8963
+static err_code_t imu_read_mag_raw(imu_handle_t handle, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z, bool *overflow)
 {
-	imu_handle_t imu_handle = calloc(1, sizeof(imu_t));
+	err_code_t err;
 
-	/* Check if handle structure is NULL */
-	if (imu_handle == NULL)
-	{
-		return NULL;
+	err = ak8963_get_mag_raw_status(handle->ak8963_read_bytes, raw_x, raw_y, raw_z, overflow);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
 	}
 
-	return imu_handle;
+	/* Data of an overflowed measurement is not valid, the caller decides
+	 * whether to fail or to flag the sample.
+	 */
+	if (*overflow) {
+		IMU_STATS_INC(handle, mag_overflows);
+	}
+
+	return ERR_CODE_SUCCESS;
 }
+#endif
 
-err_code_t imu_set_config(imu_handle_t handle, imu_cfg_t config)
+static void imu_update_clock(imu_handle_t handle, imu_sample_t *sample)
 {
-	/* Check if handle structure is NULL */
-	if (handle == NULL)
+	if (handle->func_get_time_us == NULL)
 	{
-		return ERR_CODE_FAIL;
+		sample->timestamp_corrected_us = 0;
+		return;
 	}
 
-	handle->accel_bias_x = config.accel_bias_x;
-	handle->accel_bias_y = config.accel_bias_y;
-	handle->accel_bias_z = config.accel_bias_z;
-	handle->gyro_bias_x = config.gyro_bias_x;
-	handle->gyro_bias_y = config.gyro_bias_y;
-	handle->gyro_bias_z = config.gyro_bias_z;
-	handle->mag_hard_iron_bias_x = config.mag_hard_iron_bias_x;
-	handle->mag_hard_iron_bias_y = config.mag_hard_iron_bias_y;
-	handle->mag_hard_iron_bias_z = config.mag_hard_iron_bias_z;
-	handle->mag_soft_iron_bias_x = config.mag_soft_iron_bias_x;
-	handle->mag_soft_iron_bias_y = config.mag_soft_iron_bias_y;
-	handle->mag_soft_iron_bias_z = config.mag_soft_iron_bias_z;
-	handle->func_delay = config.func_delay;
-	handle->ak8963_read_bytes = config.ak8963_read_bytes;
-	handle->ak8963_write_bytes = config.ak8963_write_bytes;
-	handle->mpu6050_read_bytes = config.mpu6050_read_bytes;
-	handle->mpu6050_write_bytes = config.mpu6050_write_bytes;
-	handle->mpu6500_read_bytes = config.mpu6500_read_bytes;
-	handle->mpu6500_write_bytes = config.mpu6500_write_bytes;
-
-	return ERR_CODE_SUCCESS;
+	imu_clock_update(handle->clock, sample->seq, sample->timestamp_us);
+	imu_clock_get_time(handle->clock, sample->seq, &sample->timestamp_corrected_us);
 }
 
-err_code_t imu_config(imu_handle_t handle)
+static err_code_t imu_config_clock(imu_handle_t handle)
 {
-	/* Check if handle structure is NULL */
-	if (handle == NULL)
+	imu_clock_cfg_t clock_cfg = {
+		.nominal_period_us = handle->sample_period_us,
+		.forget_factor = CLOCK_FORGET_FACTOR,
+		.min_observations = CLOCK_MIN_OBSERVATIONS,
+	};
+
+	err_code_t err = imu_clock_set_config(handle->clock, clock_cfg);
+	if (err != ERR_CODE_SUCCESS)
 	{
-		return ERR_CODE_NULL_PTR;
+		return err;
 	}
 
-#ifdef USE_MPU6050
-	imu_config_mpu6050(handle);
-#endif
+	return imu_clock_config(handle->clock);
+}
 
 #ifdef USE_MPU6500
-	imu_config_mpu6500(handle);
-#endif
+/* MPU6500 LP_ACCEL_ODR rates */
+static const float imu_lp_accel_odr_hz[MPU6500_LP_ACCEL_ODR_MAX] = {
+	0.24f, 0.49f, 0.98f, 1.95f, 3.91f, 7.81f, 15.63f, 31.25f, 62.5f, 125.0f, 250.0f, 500.0f
+};
 
-#ifdef USE_AK8963
-	imu_config_ak8963(handle);
-#endif
+static err_code_t imu_power_wake(imu_handle_t handle, uint64_t wake_time_us)
+{
+	err_code_t err = mpu6500_exit_wake_on_motion(&handle->mpu6500_dev, handle->mpu6500_write_bytes, MPU6500_CLKSEL,
+	                                                     handle->regs.accel_config2);
+	if (err != ERR_CODE_SUCCESS) {
+		return ERR_CODE_FAIL;
+	}
 
-	return ERR_CODE_SUCCESS;
+	/* Gyroscope output is zero until it started up, the sample that is
+	 * ready one period after that is the first valid one. Without a time
+	 * source the start-up is waited out here.
+	 */
+	if (handle->func_get_time_us != NULL) {
+		handle->power_settle_us = imu_get_time_us(handle) + MPU6500_GYRO_STARTUP_MS * 1000 + (uint64_t)handle->sample_period_us;
+	} else {
+		handle->func_delay(MPU6500_GYRO_STARTUP_MS);
+		handle->power_settle_us = 0;
+	}
+
+	handle->power.wakeups++;
+	handle->power.wake_time_us = wake_time_us;
+	handle->power.state = IMU_POWER_STARTUP;
+
+	/* No sample was missed while asleep, continue the sequence without a
+	 * gap. The sensor clock was stopped, so the fit starts over.
+	 */
+	handle->sample_valid = 0;
+	handle->drdy_pending = 0;
+	handle->last_drdy_count = handle->drdy_count;
+	handle->last_timestamp_us = imu_get_time_us(handle);
+
+	return imu_config_clock(handle);
 }
 
-err_code_t imu_get_accel_raw(imu_handle_t handle, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z)
+static err_code_t imu_power_check_motion(imu_handle_t handle, uint64_t time_us)
 {
-	/* Check if handle structure or pointer data is NULL */
-	if ((handle == NULL) || (raw_x == NULL) || (raw_y == NULL) || (raw_z == NULL))
+	uint8_t int_status = 0;
+
+	err_code_t err = mpu6500_get_int_status(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &int_status);
+	if (err != ERR_CODE_SUCCESS) {
+		return ERR_CODE_FAIL;
+	}
+
+	if ((int_status & MPU6500_INT_STATUS_WOM) == 0) {
+		return ERR_CODE_SUCCESS;
+	}
+
+	/* Prefer the motion interrupt time over the detection time */
+	if (handle->drdy_pending) {
+		time_us = handle->drdy_time_us;
+	}
+
+	return imu_power_wake(handle, time_us);
+}
+#endif
+
+static void imu_power_resumed(imu_handle_t handle, uint64_t time_us)
+{
+	handle->power.state = IMU_POWER_FULL;
+
+	if (handle->func_get_time_us == NULL) {
+		return;
+	}
+
+	handle->power.wake_latency_us = (time_us > handle->power.wake_time_us) ? (uint32_t)(time_us - handle->power.wake_time_us) : 0;
+	if (handle->power.wake_latency_us > handle->power.wake_latency_max_us) {
+		handle->power.wake_latency_max_us = handle->power.wake_latency_us;
+	}
+}
+
+static float imu_accel_range_scaling_factor(uint8_t range)
+{
+	/* 2, 4, 8 or 16 g, same on MPU6050 and MPU6500 */
+	return (float)(2 << (range & 0x03)) / 32768.0f;
+}
+
+static float imu_gyro_range_scaling_factor(uint8_t range)
+{
+	/* 250, 500, 1000 or 2000 deg/s, same on MPU6050 and MPU6500 */
+	return (float)(250 << (range & 0x03)) / 32768.0f;
+}
+
+static uint8_t imu_range_next(const imu_auto_range_cfg_t *cfg, uint8_t range, uint16_t *quiet,
+                              int16_t x, int16_t y, int16_t z)
+{
+	int32_t peak = abs(x);
+
+	if (abs(y) > peak) {
+		peak = abs(y);
+	}
+	if (abs(z) > peak) {
+		peak = abs(z);
+	}
+
+	if (peak >= cfg->up_threshold)
+	{
+		*quiet = 0;
+		return (range < 3) ? range + 1 : range;
+	}
+
+	if ((peak >= cfg->down_threshold) || (range == 0))
+	{
+		*quiet = 0;
+		return range;
+	}
+
+	if (++(*quiet) < cfg->window_samples)
+	{
+		return range;
+	}
+
+	*quiet = 0;
+
+	return range - 1;
+}
+
+/* Returns true if the sample asks for another range */
+static bool imu_range_evaluate(imu_handle_t handle, const imu_sample_t *sample, uint8_t *accel_range, uint8_t *gyro_range)
+{
+	*accel_range = handle->accel_range;
+	*gyro_range = handle->gyro_range;
+
+	/* Frames from before the last change or a change still in the FIFO */
+	if ((sample->accel_range != handle->accel_range) || (sample->gyro_range != handle->gyro_range) ||
+	        (handle->range_old_frames != 0) || (handle->range_drop_frames != 0))
+	{
+		return false;
+	}
+
+	if (handle->range_cfg.accel_enable)
+	{
+		*accel_range = imu_range_next(&handle->range_cfg, handle->accel_range, &handle->accel_quiet,
+		                              sample->accel_raw_x, sample->accel_raw_y, sample->accel_raw_z);
+	}
+
+	if (handle->range_cfg.gyro_enable)
+	{
+		*gyro_range = imu_range_next(&handle->range_cfg, handle->gyro_range, &handle->gyro_quiet,
+		                             sample->gyro_raw_x, sample->gyro_raw_y, sample->gyro_raw_z);
+	}
+
+	return (*accel_range != handle->accel_range) || (*gyro_range != handle->gyro_range);
+}
+
+static err_code_t imu_range_switch(imu_handle_t handle, uint8_t accel_range, uint8_t gyro_range)
+{
+	err_code_t err = ERR_CODE_SUCCESS;
+	uint16_t count_before = 0, count_after = 0;
+	uint8_t int_status = 0;
+
+	/* Frames in the FIFO before the write are in the old range */
+	if (handle->fifo_enable)
+	{
+#ifdef USE_MPU6050
+		err = mpu6050_get_fifo_count(handle->mpu6050_read_bytes, &count_before);
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_get_fifo_count(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &count_before);
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+	}
+
+	if (accel_range != handle->accel_range)
+	{
+#ifdef USE_MPU6050
+		err = mpu6050_set_accel_range(handle->mpu6050_write_bytes, (mpu6050_afs_sel_t)accel_range);
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_set_accel_range(&handle->mpu6500_dev, handle->mpu6500_write_bytes, (mpu6500_afs_sel_t)accel_range);
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+
+		handle->regs.accel_config = (accel_range << 3) & 0x18;
+	}
+
+	if (gyro_range != handle->gyro_range)
+	{
+#ifdef USE_MPU6050
+		err = mpu6050_set_gyro_range(handle->mpu6050_write_bytes, (mpu6050_gfs_sel_t)gyro_range);
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_set_gyro_range(&handle->mpu6500_dev, handle->mpu6500_write_bytes, (mpu6500_gfs_sel_t)gyro_range,
+		                             (mpu6500_gyro_fchoice_t)(handle->regs.gyro_config & 0x03));
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+
+		/* Keep FCHOICE_B, imu_set_bandwidth and the calibration blob read it */
+		handle->regs.gyro_config = ((gyro_range << 3) & 0x18) | (handle->regs.gyro_config & 0x03);
+	}
+
+	/* A sample produced while the registers were written may be in either
+	 * range. FIFO frames that arrived meanwhile are dropped when drained,
+	 * reading INT_STATUS clears data ready of a polled one so it is skipped.
+	 */
+#ifdef USE_MPU6050
+	if (handle->fifo_enable) {
+		err = mpu6050_get_fifo_count(handle->mpu6050_read_bytes, &count_after);
+	} else {
+		err = mpu6050_get_int_status(handle->mpu6050_read_bytes, &int_status);
+	}
+#endif
+
+#ifdef USE_MPU6500
+	if (handle->fifo_enable) {
+		err = mpu6500_get_fifo_count(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &count_after);
+	} else {
+		err = mpu6500_get_int_status(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &int_status);
+	}
+#endif
+
+	if (handle->fifo_enable)
+	{
+		handle->range_old_frames = count_before / FIFO_FRAME_SIZE;
+		handle->range_drop_frames = count_after / FIFO_FRAME_SIZE - count_before / FIFO_FRAME_SIZE;
+	}
+
+	handle->accel_range_prev = handle->accel_range;
+	handle->gyro_range_prev = handle->gyro_range;
+	handle->accel_range = accel_range;
+	handle->gyro_range = gyro_range;
+	IMU_STATS_INC(handle, range_switches);
+
+	return (err == ERR_CODE_SUCCESS) ? ERR_CODE_SUCCESS : ERR_CODE_FAIL;
+}
+
+/* Checks the channels of a sample read from the sensor and sets its health
+ * field, flags holds what the caller found already.
+ */
+static void imu_health_check(imu_handle_t handle, imu_sample_t *sample, uint8_t channels, uint16_t flags)
+{
+	static const uint8_t sensor_channel[2] = {IMU_CHANNEL_ACCEL, IMU_CHANNEL_GYRO};
+	static const uint16_t stuck_flag[2] = {IMU_HEALTH_ACCEL_STUCK, IMU_HEALTH_GYRO_STUCK};
+	static const uint16_t spike_flag[2] = {IMU_HEALTH_ACCEL_SPIKE, IMU_HEALTH_GYRO_SPIKE};
+	static const uint16_t saturated_flag[2] = {IMU_HEALTH_ACCEL_SATURATED, IMU_HEALTH_GYRO_SATURATED};
+	const imu_health_cfg_t *cfg = &handle->health_cfg;
+
+	if (!cfg->enable)
+	{
+		sample->health = flags;
+		return;
+	}
+
+	const int16_t raw[HEALTH_AXES] = {
+		sample->accel_raw_x, sample->accel_raw_y, sample->accel_raw_z,
+		sample->gyro_raw_x, sample->gyro_raw_y, sample->gyro_raw_z
+	};
+	const uint8_t range[2] = {sample->accel_range, sample->gyro_range};
+	const uint16_t max_step[2] = {cfg->accel_max_step, cfg->gyro_max_step};
+
+	/* A released or shorted bus reads every word the same */
+	uint16_t bits_and = 0xFFFF, bits_or = 0;
+	for (uint8_t s = 0; s < 2; s++)
+	{
+		if (channels & sensor_channel[s])
+		{
+			for (uint8_t i = 3 * s; i < 3 * s + 3; i++)
+			{
+				bits_and &= (uint16_t)raw[i];
+				bits_or |= (uint16_t)raw[i];
+			}
+		}
+	}
+	if (channels & IMU_CHANNEL_TEMP)
+	{
+		bits_and &= (uint16_t)sample->temp_raw;
+		bits_or |= (uint16_t)sample->temp_raw;
+	}
+
+	if ((channels & (IMU_CHANNEL_ACCEL | IMU_CHANNEL_TEMP | IMU_CHANNEL_GYRO)) &&
+	        ((bits_or == 0) || (bits_and == 0xFFFF)))
+	{
+		flags |= IMU_HEALTH_BUS_FAULT;
+	}
+	else
+	{
+		for (uint8_t s = 0; s < 2; s++)
+		{
+			if ((channels & sensor_channel[s]) == 0)
+			{
+				continue;
+			}
+
+			/* Raw values of another range are not comparable */
+			bool compare = (handle->health_prev_valid & sensor_channel[s]) && (handle->health_prev_range[s] == range[s]);
+
+			for (uint8_t i = 3 * s; i < 3 * s + 3; i++)
+			{
+				/* A saturated axis repeats the limit, that is not a stuck one */
+				bool saturated = (abs(raw[i]) >= cfg->saturation_threshold);
+				if (saturated)
+				{
+					flags |= saturated_flag[s];
+				}
+
+				if (compare && !saturated && (raw[i] == handle->health_prev[i]))
+				{
+					if (handle->health_run[i] < UINT16_MAX)
+					{
+						handle->health_run[i]++;
+					}
+				}
+				else
+				{
+					handle->health_run[i] = 1;
+				}
+
+				if ((cfg->stuck_samples != 0) && (handle->health_run[i] >= cfg->stuck_samples))
+				{
+					flags |= stuck_flag[s];
+				}
+
+				if (compare && (max_step[s] != 0) && (abs(raw[i] - handle->health_prev[i]) > max_step[s]))
+				{
+					flags |= spike_flag[s];
+				}
+
+				handle->health_prev[i] = raw[i];
+			}
+
+			handle->health_prev_range[s] = range[s];
+			handle->health_prev_valid |= sensor_channel[s];
+		}
+	}
+
+	imu_health_status_t *status = &handle->health;
+	status->samples++;
+	status->last_flags = flags;
+	status->flags |= flags;
+	if (flags != 0)
+	{
+		status->faulty_samples++;
+		status->stuck += (flags & (IMU_HEALTH_ACCEL_STUCK | IMU_HEALTH_GYRO_STUCK)) ? 1 : 0;
+		status->spikes += (flags & (IMU_HEALTH_ACCEL_SPIKE | IMU_HEALTH_GYRO_SPIKE)) ? 1 : 0;
+		status->saturated += (flags & (IMU_HEALTH_ACCEL_SATURATED | IMU_HEALTH_GYRO_SATURATED)) ? 1 : 0;
+		status->mag_overflows += (flags & IMU_HEALTH_MAG_OVERFLOW) ? 1 : 0;
+		status->bus_faults += (flags & IMU_HEALTH_BUS_FAULT) ? 1 : 0;
+	}
+	status->score += (((flags == 0) ? 1.0f : 0.0f) - status->score) / cfg->score_window;
+
+	sample->health = flags;
+}
+
+static void imu_publish_sample(imu_handle_t handle, const imu_sample_t *sample)
+{
+	imu_sample_scale_t scale;
+
+	/* Scale outside the write section to keep readers from spinning */
+	imu_scale_sample(handle, sample, &scale);
+
+	/* Direct reads scale by the range of the latest sample */
+	float accel_scaling_factor = imu_accel_range_scaling_factor(sample->accel_range);
+	float gyro_scaling_factor = imu_gyro_range_scaling_factor(sample->gyro_range);
+	if ((accel_scaling_factor != handle->calib.accel_scaling_factor) ||
+	        (gyro_scaling_factor != handle->calib.gyro_scaling_factor))
+	{
+		imu_calib_write_begin(handle);
+		handle->calib.accel_scaling_factor = accel_scaling_factor;
+		handle->calib.gyro_scaling_factor = gyro_scaling_factor;
+		imu_calib_write_end(handle);
+	}
+
+	imu_seqlock_write_begin(&handle->latest_lock);
+	memcpy(&handle->latest, sample, sizeof(imu_sample_t));
+	memcpy(&handle->latest_scale, &scale, sizeof(imu_sample_scale_t));
+	imu_seqlock_write_end(&handle->latest_lock);
+}
+
+static float imu_calc_sample_period_us(const imu_config_regs_t *regs)
+{
+	uint8_t dlpf_cfg = regs->config & 0x07;
+
+#ifdef USE_MPU6500
+	/* The sample rate divider only applies with the DLPF on */
+	if ((regs->gyro_config & 0x03) != 0)
+	{
+		return 1000000.0f / MPU6500_GYRO_FCHOICE_RATE_HZ;
+	}
+
+	if ((dlpf_cfg == 0) || (dlpf_cfg == 7))
+	{
+		return 1000000.0f / MPU6500_GYRO_DLPF_OFF_RATE_HZ;
+	}
+#endif
+
+	/* Gyroscope output rate is 8 kHz when DLPF is disabled, 1 kHz otherwise */
+	float gyro_rate_hz = ((dlpf_cfg == 0) || (dlpf_cfg == 7)) ? 8000.0f : 1000.0f;
+
+	return 1000000.0f * (1 + regs->smplrt_div) / gyro_rate_hz;
+}
+
+static void imu_parse_motion(const uint8_t *data, imu_sample_t *sample)
+{
+	sample->accel_raw_x = (int16_t)((data[0] << 8) + data[1]);
+	sample->accel_raw_y = (int16_t)((data[2] << 8) + data[3]);
+	sample->accel_raw_z = (int16_t)((data[4] << 8) + data[5]);
+	sample->temp_raw = (int16_t)((data[6] << 8) + data[7]);
+	sample->gyro_raw_x = (int16_t)((data[8] << 8) + data[9]);
+	sample->gyro_raw_y = (int16_t)((data[10] << 8) + data[11]);
+	sample->gyro_raw_z = (int16_t)((data[12] << 8) + data[13]);
+}
+
+#ifdef USE_AK8963
+static err_code_t imu_config_ak8963(imu_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+
+	err = ak8963_init(handle->ak8963_read_bytes,
+	                  handle->ak8963_write_bytes,
+	                  handle->func_delay,
+	                  AK8963_OPR_MODE,
+	                  AK8963_MFS_SEL);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	float sens_adj_x = 1.0f, sens_adj_y = 1.0f, sens_adj_z = 1.0f;
+	ak8963_get_sens_adj(handle->ak8963_read_bytes, &sens_adj_x, &sens_adj_y, &sens_adj_z);
+
+	/* Fuse values back from the adjustment, (ASA - 128) / 256 + 1 is exact */
+	handle->regs.mag_present = 1;
+	handle->regs.mag_cntl = (AK8963_OPR_MODE & 0x0F) | ((AK8963_MFS_SEL << 4) & 0x10);
+	handle->regs.mag_asa[0] = (uint8_t)((sens_adj_x - 1.0f) * 256.0f + 128.5f);
+	handle->regs.mag_asa[1] = (uint8_t)((sens_adj_y - 1.0f) * 256.0f + 128.5f);
+	handle->regs.mag_asa[2] = (uint8_t)((sens_adj_z - 1.0f) * 256.0f + 128.5f);
+
+	imu_calib_write_begin(handle);
+
+	handle->calib.mag_sens_adj_x = sens_adj_x;
+	handle->calib.mag_sens_adj_y = sens_adj_y;
+	handle->calib.mag_sens_adj_z = sens_adj_z;
+
+	/* Update magnetometer scaling factor */
+	switch (AK8963_MFS_SEL)
+	{
+	case AK8963_MFS_14BIT:
+		handle->calib.mag_scaling_factor = 10.0f * 4912.0f / 8190.0f;
+		break;
+
+	case AK8963_MFS_16BIT:
+		handle->calib.mag_scaling_factor = 10.0f * 4912.0f / 32760.0f;
+		break;
+
+	default:
+		break;
+	}
+
+	imu_calib_write_end(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+#endif
+
+#ifdef USE_MPU6050
+static err_code_t imu_config_mpu6050(imu_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+
+	err = mpu6050_init(handle->mpu6050_read_bytes,
+	                   handle->mpu6050_write_bytes,
+	                   handle->func_delay,
+	                   MPU6050_CLKSEL,
+	                   MPU6050_DLPF_CFG,
+	                   MPU6050_SLEEP_MODE,
+	                   MPU6050_AFS_SEL,
+	                   MPU6050_GFS_SEL);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->regs.who_am_i = MPU6050_WHO_AM_I_DEFAULT;
+	handle->regs.smplrt_div = MPU6050_SMPLRT_DIV_DEFAULT;
+	handle->regs.config = MPU6050_DLPF_CFG & 0x07;
+	handle->regs.gyro_config = (MPU6050_GFS_SEL << 3) & 0x18;
+	handle->regs.accel_config = (MPU6050_AFS_SEL << 3) & 0x18;
+	handle->regs.accel_config2 = 0;
+
+	handle->sample_period_us = imu_calc_sample_period_us(&handle->regs);
+
+	imu_calib_write_begin(handle);
+
+	/* Update accelerometer scaling factor */
+	switch (MPU6050_AFS_SEL)
+	{
+	case MPU6050_AFS_SEL_2G:
+		handle->calib.accel_scaling_factor = (2.0f / 32768.0f);
+		break;
+
+	case MPU6050_AFS_SEL_4G:
+		handle->calib.accel_scaling_factor = (4.0f / 32768.0f);
+		break;
+
+	case MPU6050_AFS_SEL_8G:
+		handle->calib.accel_scaling_factor = (8.0f / 32768.0f);
+		break;
+
+	case MPU6050_AFS_SEL_16G:
+		handle->calib.accel_scaling_factor = (16.0f / 32768.0f);
+		break;
+
+	default:
+		break;
+	}
+
+	/* Update gyroscope scaling factor */
+	switch (MPU6050_GFS_SEL)
+	{
+	case MPU6050_GFS_SEL_250:
+		handle->calib.gyro_scaling_factor = 250.0f / 32768.0f;
+		break;
+
+	case MPU6050_GFS_SEL_500:
+		handle->calib.gyro_scaling_factor = 500.0f / 32768.0f;
+		break;
+
+	case MPU6050_GFS_SEL_1000:
+		handle->calib.gyro_scaling_factor = 1000.0f / 32768.0f;
+		break;
+
+	case MPU6050_GFS_SEL_2000:
+		handle->calib.gyro_scaling_factor = 2000.0f / 32768.0f;
+		break;
+
+	default:
+		break;
+	}
+
+	/* Biases are measured in the configured range */
+	handle->calib.accel_bias_scaling_factor = handle->calib.accel_scaling_factor;
+	handle->calib.gyro_bias_scaling_factor = handle->calib.gyro_scaling_factor;
+
+	imu_calib_write_end(handle);
+
+	handle->accel_range = MPU6050_AFS_SEL;
+	handle->gyro_range = MPU6050_GFS_SEL;
+	handle->range_old_frames = 0;
+	handle->range_drop_frames = 0;
+	handle->rate_old_frames = 0;
+
+	return ERR_CODE_SUCCESS;
+}
+#endif
+
+#ifdef USE_MPU6500
+static err_code_t imu_config_mpu6500(imu_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+
+	err = mpu6500_init(&handle->mpu6500_dev,
+	                   handle->mpu6500_read_bytes,
+	                   handle->mpu6500_write_bytes,
+	                   handle->func_delay,
+	                   MPU6500_CLKSEL,
+	                   MPU6500_DLPF_CFG,
+	                   MPU6500_SLEEP_MODE,
+	                   MPU6500_AFS_SEL,
+	                   MPU6500_GFS_SEL,
+	                   MPU6500_TRANSPORT,
+	                   handle->mpu6500_set_bus_clock);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->regs.who_am_i = MPU6500_WHO_AM_I_DEFAULT;
+	handle->regs.smplrt_div = MPU6500_SMPLRT_DIV_DEFAULT;
+	handle->regs.config = MPU6500_DLPF_CFG & 0x07;
+	handle->regs.gyro_config = (MPU6500_GFS_SEL << 3) & 0x18;
+	handle->regs.accel_config = (MPU6500_AFS_SEL << 3) & 0x18;
+	handle->regs.accel_config2 = 0;
+
+	handle->sample_period_us = imu_calc_sample_period_us(&handle->regs);
+
+	imu_calib_write_begin(handle);
+
+	/* Update accelerometer scaling factor */
+	switch (MPU6500_AFS_SEL)
+	{
+	case MPU6500_AFS_SEL_2G:
+		handle->calib.accel_scaling_factor = (2.0f / 32768.0f);
+		break;
+
+	case MPU6500_AFS_SEL_4G:
+		handle->calib.accel_scaling_factor = (4.0f / 32768.0f);
+		break;
+
+	case MPU6500_AFS_SEL_8G:
+		handle->calib.accel_scaling_factor = (8.0f / 32768.0f);
+		break;
+
+	case MPU6500_AFS_SEL_16G:
+		handle->calib.accel_scaling_factor = (16.0f / 32768.0f);
+		break;
+
+	default:
+		break;
+	}
+
+	/* Update gyroscope scaling factor */
+	switch (MPU6500_GFS_SEL)
+	{
+	case MPU6500_GFS_SEL_250:
+		handle->calib.gyro_scaling_factor = 250.0f / 32768.0f;
+		break;
+
+	case MPU6500_GFS_SEL_500:
+		handle->calib.gyro_scaling_factor = 500.0f / 32768.0f;
+		break;
+
+	case MPU6500_GFS_SEL_1000:
+		handle->calib.gyro_scaling_factor = 1000.0f / 32768.0f;
+		break;
+
+	case MPU6500_GFS_SEL_2000:
+		handle->calib.gyro_scaling_factor = 2000.0f / 32768.0f;
+		break;
+
+	default:
+		break;
+	}
+
+	/* Biases are measured in the configured range */
+	handle->calib.accel_bias_scaling_factor = handle->calib.accel_scaling_factor;
+	handle->calib.gyro_bias_scaling_factor = handle->calib.gyro_scaling_factor;
+
+	imu_calib_write_end(handle);
+
+	handle->accel_range = MPU6500_AFS_SEL;
+	handle->gyro_range = MPU6500_GFS_SEL;
+	handle->range_old_frames = 0;
+	handle->range_drop_frames = 0;
+	handle->rate_old_frames = 0;
+
+	return ERR_CODE_SUCCESS;
+}
+#endif
+
+imu_handle_t imu_init(void)
+{
+	imu_handle_t imu_handle = calloc(1, sizeof(imu_t));
+
+	/* Check if handle structure is NULL */
+	if (imu_handle == NULL)
+	{
+		return NULL;
+	}
+
+	imu_handle->clock = imu_clock_init();
+	if (imu_handle->clock == NULL)
+	{
+		free(imu_handle);
+		return NULL;
+	}
+
+	return imu_handle;
+}
+
+err_code_t imu_set_config(imu_handle_t handle, imu_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	imu_calib_write_begin(handle);
+	handle->calib.accel_bias_x = config.accel_bias_x;
+	handle->calib.accel_bias_y = config.accel_bias_y;
+	handle->calib.accel_bias_z = config.accel_bias_z;
+	handle->calib.gyro_bias_x = config.gyro_bias_x;
+	handle->calib.gyro_bias_y = config.gyro_bias_y;
+	handle->calib.gyro_bias_z = config.gyro_bias_z;
+	handle->calib.mag_hard_iron_bias_x = config.mag_hard_iron_bias_x;
+	handle->calib.mag_hard_iron_bias_y = config.mag_hard_iron_bias_y;
+	handle->calib.mag_hard_iron_bias_z = config.mag_hard_iron_bias_z;
+	handle->calib.mag_soft_iron_bias_x = config.mag_soft_iron_bias_x;
+	handle->calib.mag_soft_iron_bias_y = config.mag_soft_iron_bias_y;
+	handle->calib.mag_soft_iron_bias_z = config.mag_soft_iron_bias_z;
+	imu_calib_write_end(handle);
+
+	handle->func_delay = config.func_delay;
+	handle->ak8963_read_bytes = config.ak8963_read_bytes;
+	handle->ak8963_write_bytes = config.ak8963_write_bytes;
+	handle->mpu6050_read_bytes = config.mpu6050_read_bytes;
+	handle->mpu6050_write_bytes = config.mpu6050_write_bytes;
+	handle->mpu6050_transfer = config.mpu6050_transfer;
+	handle->mpu6500_read_bytes = config.mpu6500_read_bytes;
+	handle->mpu6500_write_bytes = config.mpu6500_write_bytes;
+	handle->mpu6500_set_bus_clock = config.mpu6500_set_bus_clock;
+	handle->mpu6500_transfer = config.mpu6500_transfer;
+	handle->func_get_time_us = config.func_get_time_us;
+
+#ifdef IMU_ENABLE_STATS
+	imu_stats_set_config(handle, &config);
+#endif
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_config(imu_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+
+#ifdef USE_MPU6050
+	imu_config_mpu6050(handle);
+#endif
+
+#ifdef USE_MPU6500
+	imu_config_mpu6500(handle);
+#endif
+
+#ifdef USE_AK8963
+	imu_config_ak8963(handle);
+#endif
+
+	imu_config_clock(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_accel_raw(imu_handle_t handle, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (raw_x == NULL) || (raw_y == NULL) || (raw_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+	imu_stats_check_duplicate(handle, IMU_STATS_STREAM_ACCEL);
+
+	err_code_t err;
+
+#ifdef USE_MPU6050
+	err = mpu6050_get_accel_raw(handle->mpu6050_read_bytes, raw_x, raw_y, raw_z);
+#endif
+
+#ifdef USE_MPU6500
+	err = mpu6500_get_accel_raw(&handle->mpu6500_dev, handle->mpu6500_read_bytes, raw_x, raw_y, raw_z);
+#endif
+
+	if (err != ERR_CODE_SUCCESS) {
+		return ERR_CODE_FAIL;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_accel_calib(imu_handle_t handle, int16_t *calib_x, int16_t *calib_y, int16_t *calib_z)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (calib_x == NULL) || (calib_y == NULL) || (calib_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+	imu_stats_check_duplicate(handle, IMU_STATS_STREAM_ACCEL);
+
+	err_code_t err;
+	int16_t raw_x, raw_y, raw_z;
+
+#ifdef USE_MPU6050
+	err = mpu6050_get_accel_raw(handle->mpu6050_read_bytes, &raw_x, &raw_y, &raw_z);
+#endif
+
+#ifdef USE_MPU6500
+	err = mpu6500_get_accel_raw(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &raw_x, &raw_y, &raw_z);
+#endif
+
+	if (err != ERR_CODE_SUCCESS) {
+		return ERR_CODE_FAIL;
+	}
+
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	float bias_scale = calib.accel_bias_scaling_factor / calib.accel_scaling_factor;
+
+	*calib_x = raw_x - (int16_t)(calib.accel_bias_x * bias_scale);
+	*calib_y = raw_y - (int16_t)(calib.accel_bias_y * bias_scale);
+	*calib_z = raw_z - (int16_t)(calib.accel_bias_z * bias_scale);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_accel_scale(imu_handle_t handle, float *scale_x, float *scale_y, float *scale_z)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (scale_x == NULL) || (scale_y == NULL) || (scale_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+	imu_stats_check_duplicate(handle, IMU_STATS_STREAM_ACCEL);
+
+	err_code_t err;
+	int16_t raw_x, raw_y, raw_z;
+
+#ifdef USE_MPU6050
+	err = mpu6050_get_accel_raw(handle->mpu6050_read_bytes, &raw_x, &raw_y, &raw_z);
+#endif
+
+#ifdef USE_MPU6500
+	err = mpu6500_get_accel_raw(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &raw_x, &raw_y, &raw_z);
+#endif
+
+	if (err != ERR_CODE_SUCCESS) {
+		return ERR_CODE_FAIL;
+	}
+
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	*scale_x = raw_x * calib.accel_scaling_factor - calib.accel_bias_x * calib.accel_bias_scaling_factor;
+	*scale_y = raw_y * calib.accel_scaling_factor - calib.accel_bias_y * calib.accel_bias_scaling_factor;
+	*scale_z = raw_z * calib.accel_scaling_factor - calib.accel_bias_z * calib.accel_bias_scaling_factor;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_gyro_raw(imu_handle_t handle, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (raw_x == NULL) || (raw_y == NULL) || (raw_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+	imu_stats_check_duplicate(handle, IMU_STATS_STREAM_GYRO);
+
+	err_code_t err;
+
+#ifdef USE_MPU6050
+	err = mpu6050_get_gyro_raw(handle->mpu6050_read_bytes, raw_x, raw_y, raw_z);
+#endif
+
+#ifdef USE_MPU6500
+	err = mpu6500_get_gyro_raw(&handle->mpu6500_dev, handle->mpu6500_read_bytes, raw_x, raw_y, raw_z);
+#endif
+
+	if (err != ERR_CODE_SUCCESS) {
+		return ERR_CODE_FAIL;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_gyro_calib(imu_handle_t handle, int16_t *calib_x, int16_t *calib_y, int16_t *calib_z)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (calib_x == NULL) || (calib_y == NULL) || (calib_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+	imu_stats_check_duplicate(handle, IMU_STATS_STREAM_GYRO);
+
+	err_code_t err;
+	int16_t raw_x, raw_y, raw_z;
+
+#ifdef USE_MPU6050
+	err = mpu6050_get_gyro_raw(handle->mpu6050_read_bytes, &raw_x, &raw_y, &raw_z);
+#endif
+
+#ifdef USE_MPU6500
+	err = mpu6500_get_gyro_raw(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &raw_x, &raw_y, &raw_z);
+#endif
+
+	if (err != ERR_CODE_SUCCESS) {
+		return ERR_CODE_FAIL;
+	}
+
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	float bias_scale = calib.gyro_bias_scaling_factor / calib.gyro_scaling_factor;
+
+	*calib_x = raw_x - (int16_t)(calib.gyro_bias_x * bias_scale);
+	*calib_y = raw_y - (int16_t)(calib.gyro_bias_y * bias_scale);
+	*calib_z = raw_z - (int16_t)(calib.gyro_bias_z * bias_scale);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_gyro_scale(imu_handle_t handle, float *scale_x, float *scale_y, float *scale_z)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (scale_x == NULL) || (scale_y == NULL) || (scale_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+	imu_stats_check_duplicate(handle, IMU_STATS_STREAM_GYRO);
+
+	err_code_t err;
+	int16_t raw_x, raw_y, raw_z;
+
+#ifdef USE_MPU6050
+	err = mpu6050_get_gyro_raw(handle->mpu6050_read_bytes, &raw_x, &raw_y, &raw_z);
+#endif
+
+#ifdef USE_MPU6500
+	err = mpu6500_get_gyro_raw(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &raw_x, &raw_y, &raw_z);
+#endif
+
+	if (err != ERR_CODE_SUCCESS) {
+		return ERR_CODE_FAIL;
+	}
+
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	*scale_x = raw_x * calib.gyro_scaling_factor - calib.gyro_bias_x * calib.gyro_bias_scaling_factor;
+	*scale_y = raw_y * calib.gyro_scaling_factor - calib.gyro_bias_y * calib.gyro_bias_scaling_factor;
+	*scale_z = raw_z * calib.gyro_scaling_factor - calib.gyro_bias_z * calib.gyro_bias_scaling_factor;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_mag_raw(imu_handle_t handle, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (raw_x == NULL) || (raw_y == NULL) || (raw_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+
+#ifdef USE_AK8963
+	err_code_t err;
+	bool overflow;
+	err = imu_read_mag_raw(handle, raw_x, raw_y, raw_z, &overflow);
+	if ((err != ERR_CODE_SUCCESS) || overflow) {
+		return ERR_CODE_FAIL;
+	}
+#endif
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_mag_calib(imu_handle_t handle, float *calib_x, float *calib_y, float *calib_z)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (calib_x == NULL) || (calib_y == NULL) || (calib_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+
+	int16_t raw_x = 0, raw_y = 0, raw_z = 0;
+
+#ifdef USE_AK8963
+	err_code_t err;
+	bool overflow;
+	err = imu_read_mag_raw(handle, &raw_x, &raw_y, &raw_z, &overflow);
+	if ((err != ERR_CODE_SUCCESS) || overflow) {
+		return ERR_CODE_FAIL;
+	}
+#endif
+
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	*calib_x = ((float)raw_x * calib.mag_sens_adj_x - calib.mag_hard_iron_bias_x / calib.mag_scaling_factor) * calib.mag_soft_iron_bias_x;
+	*calib_y = ((float)raw_y * calib.mag_sens_adj_y - calib.mag_hard_iron_bias_y / calib.mag_scaling_factor) * calib.mag_soft_iron_bias_y;
+	*calib_z = ((float)raw_z * calib.mag_sens_adj_z - calib.mag_hard_iron_bias_z / calib.mag_scaling_factor) * calib.mag_soft_iron_bias_z;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_mag_scale(imu_handle_t handle, float *scale_x, float *scale_y, float *scale_z)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (scale_x == NULL) || (scale_y == NULL) || (scale_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+
+	int16_t raw_x = 0, raw_y = 0, raw_z = 0;
+
+#ifdef USE_AK8963
+	err_code_t err;
+	bool overflow;
+	err = imu_read_mag_raw(handle, &raw_x, &raw_y, &raw_z, &overflow);
+	if ((err != ERR_CODE_SUCCESS) || overflow) {
+		return ERR_CODE_FAIL;
+	}
+#endif
+
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	*scale_x = ((float)raw_x * calib.mag_sens_adj_x * calib.mag_scaling_factor - calib.mag_hard_iron_bias_x) * calib.mag_soft_iron_bias_x;
+	*scale_y = ((float)raw_y * calib.mag_sens_adj_y * calib.mag_scaling_factor - calib.mag_hard_iron_bias_y) * calib.mag_soft_iron_bias_y;
+	*scale_z = ((float)raw_z * calib.mag_sens_adj_z * calib.mag_scaling_factor - calib.mag_hard_iron_bias_z) * calib.mag_soft_iron_bias_z;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_poll_sample(imu_handle_t handle, imu_sample_t *sample, bool *data_ready)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (sample == NULL) || (data_ready == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+
+	err_code_t err;
+	uint8_t int_status = 0;
+	uint64_t time_us = imu_get_time_us(handle);
+	imu_func_transfer transfer = NULL;
+
+	*data_ready = false;
+
+#ifdef USE_MPU6050
+	transfer = handle->mpu6050_transfer;
+#endif
+
+#ifdef USE_MPU6500
+	transfer = handle->mpu6500_transfer;
+
+	if (handle->power.state == IMU_POWER_WAKE_ON_MOTION) {
+		return imu_power_check_motion(handle, time_us);
+	}
+#endif
+
+	if (transfer != NULL)
+	{
+		/* Status and output registers in one round trip */
+		uint8_t motion_raw_data[14];
+
+#ifdef USE_MPU6050
+		err = mpu6050_get_status_motion_block(transfer, &int_status, motion_raw_data);
+		int_status &= MPU6050_INT_STATUS_DATA_RDY;
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_get_status_motion_block(&handle->mpu6500_dev, transfer, &int_status, motion_raw_data);
+		int_status &= MPU6500_INT_STATUS_DATA_RDY;
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+
+		/* Output registers still hold the previous sample */
+		if (int_status == 0) {
+			IMU_STATS_INC(handle, stale_samples);
+			return ERR_CODE_SUCCESS;
+		}
+
+		imu_parse_motion(motion_raw_data, sample);
+	}
+	else
+	{
+#ifdef USE_MPU6050
+		err = mpu6050_get_int_status(handle->mpu6050_read_bytes, &int_status);
+		int_status &= MPU6050_INT_STATUS_DATA_RDY;
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_get_int_status(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &int_status);
+		int_status &= MPU6500_INT_STATUS_DATA_RDY;
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+
+		/* Output registers still hold the previous sample */
+		if (int_status == 0) {
+			IMU_STATS_INC(handle, stale_samples);
+			return ERR_CODE_SUCCESS;
+		}
+
+#ifdef USE_MPU6050
+		err = mpu6050_get_motion_raw(handle->mpu6050_read_bytes,
+		                             &sample->accel_raw_x, &sample->accel_raw_y, &sample->accel_raw_z,
+		                             &sample->temp_raw,
+		                             &sample->gyro_raw_x, &sample->gyro_raw_y, &sample->gyro_raw_z);
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_get_motion_raw(&handle->mpu6500_dev, handle->mpu6500_read_bytes,
+		                             &sample->accel_raw_x, &sample->accel_raw_y, &sample->accel_raw_z,
+		                             &sample->temp_raw,
+		                             &sample->gyro_raw_x, &sample->gyro_raw_y, &sample->gyro_raw_z);
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+	}
+
+	/* Count sensor output periods since the last sample, from the interrupt
+	 * count if the ISR reports data ready, otherwise from the elapsed time.
+	 */
+	uint32_t periods = 1;
+	if (handle->drdy_count != handle->last_drdy_count)
+	{
+		periods = handle->drdy_count - handle->last_drdy_count;
+		handle->last_drdy_count = handle->drdy_count;
+	}
+	else if ((handle->func_get_time_us != NULL) && (time_us > handle->last_timestamp_us))
+	{
+		float elapsed = (float)(time_us - handle->last_timestamp_us) / imu_get_period_us(handle);
+		periods = (elapsed > 1.5f) ? (uint32_t)(elapsed + 0.5f) : 1;
+	}
+
+	/* Prefer interrupt time, read time is only bounded by the polling interval */
+	if (handle->drdy_pending)
+	{
+		time_us = handle->drdy_time_us;
+		handle->drdy_pending = 0;
+	}
+
+	/* Drop samples taken while the gyroscope was starting up */
+	if (handle->power.state == IMU_POWER_STARTUP)
+	{
+		if (time_us < handle->power_settle_us) {
+			handle->last_timestamp_us = time_us;
+			return ERR_CODE_SUCCESS;
+		}
+
+		imu_power_resumed(handle, time_us);
+	}
+
+	if (handle->sample_valid)
+	{
+		handle->sample_seq += periods - 1;
+	}
+
+	sample->seq = handle->sample_seq++;
+	sample->timestamp_us = time_us;
+	imu_update_clock(handle, sample);
+	sample->period_us = imu_get_period_us(handle);
+	sample->accel_range = handle->accel_range;
+	sample->gyro_range = handle->gyro_range;
+	handle->last_timestamp_us = time_us;
+	handle->sample_valid = 1;
+	imu_health_check(handle, sample, IMU_CHANNEL_ACCEL | IMU_CHANNEL_TEMP | IMU_CHANNEL_GYRO, 0);
+	imu_publish_sample(handle, sample);
+	*data_ready = true;
+
+	uint8_t accel_range, gyro_range;
+	if (imu_range_evaluate(handle, sample, &accel_range, &gyro_range))
+	{
+		return imu_range_switch(handle, accel_range, gyro_range);
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_read_channels(imu_handle_t handle, uint8_t channels, imu_sample_t *sample)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (sample == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+
+	err_code_t err = ERR_CODE_SUCCESS;
+	uint8_t motion_raw_data[14];
+	uint8_t first = 14, last = 0;
+	uint16_t health = 0;
+
+	/* Offsets from ACCEL_XOUT_H: accelerometer 0..5, temperature 6..7, gyroscope 8..13.
+	 * Reading through an unselected channel is cheaper than a second transaction.
+	 */
+	if (channels & IMU_CHANNEL_ACCEL)
+	{
+		first = 0;
+		last = 6;
+	}
+	if (channels & IMU_CHANNEL_TEMP)
+	{
+		first = (first < 6) ? first : 6;
+		last = 8;
+	}
+	if (channels & IMU_CHANNEL_GYRO)
+	{
+		first = (first < 8) ? first : 8;
+		last = 14;
+	}
+
+	/* Reads are not tied to output periods, so they get their own count
+	 * and no sensor clock timestamp.
+	 */
+	sample->seq = handle->read_seq++;
+	sample->timestamp_us = imu_get_time_us(handle);
+	sample->timestamp_corrected_us = 0;
+	sample->period_us = imu_get_period_us(handle);
+	sample->accel_range = handle->accel_range;
+	sample->gyro_range = handle->gyro_range;
+
+	if (channels & IMU_CHANNEL_ACCEL)
+	{
+		imu_stats_check_duplicate(handle, IMU_STATS_STREAM_ACCEL);
+	}
+	if (channels & IMU_CHANNEL_GYRO)
+	{
+		imu_stats_check_duplicate(handle, IMU_STATS_STREAM_GYRO);
+	}
+
+	if (first < last)
+	{
+#ifdef USE_MPU6050
+		err = mpu6050_read_motion_block(handle->mpu6050_read_bytes, first, &motion_raw_data[first], last - first);
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_read_motion_block(&handle->mpu6500_dev, handle->mpu6500_read_bytes, first, &motion_raw_data[first], last - first);
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+
+		if (channels & IMU_CHANNEL_ACCEL)
+		{
+			sample->accel_raw_x = (int16_t)((motion_raw_data[0] << 8) + motion_raw_data[1]);
+			sample->accel_raw_y = (int16_t)((motion_raw_data[2] << 8) + motion_raw_data[3]);
+			sample->accel_raw_z = (int16_t)((motion_raw_data[4] << 8) + motion_raw_data[5]);
+		}
+		if (channels & IMU_CHANNEL_TEMP)
+		{
+			sample->temp_raw = (int16_t)((motion_raw_data[6] << 8) + motion_raw_data[7]);
+		}
+		if (channels & IMU_CHANNEL_GYRO)
+		{
+			sample->gyro_raw_x = (int16_t)((motion_raw_data[8] << 8) + motion_raw_data[9]);
+			sample->gyro_raw_y = (int16_t)((motion_raw_data[10] << 8) + motion_raw_data[11]);
+			sample->gyro_raw_z = (int16_t)((motion_raw_data[12] << 8) + motion_raw_data[13]);
+		}
+	}
+
+#ifdef USE_AK8963
+	if (channels & IMU_CHANNEL_MAG)
+	{
+		bool overflow;
+		err = imu_read_mag_raw(handle, &sample->mag_raw_x, &sample->mag_raw_y, &sample->mag_raw_z, &overflow);
+		if ((err != ERR_CODE_SUCCESS) || (overflow && !handle->health_cfg.enable)) {
+			return ERR_CODE_FAIL;
+		}
+
+		if (overflow) {
+			health |= IMU_HEALTH_MAG_OVERFLOW;
+		}
+	}
+#endif
+
+	/* Not published, its seq counts reads and would interleave with the
+	 * output periods of imu_poll_sample and imu_read_fifo samples.
+	 */
+	imu_health_check(handle, sample, channels, health);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_scale_sample(imu_handle_t handle, const imu_sample_t *sample, imu_sample_scale_t *scale)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (sample == NULL) || (scale == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	scale->seq = sample->seq;
+	scale->timestamp_us = (sample->timestamp_corrected_us != 0) ? sample->timestamp_corrected_us : sample->timestamp_us;
+
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	/* Scale by the range the sample was taken in */
+	float accel_scaling_factor = imu_accel_range_scaling_factor(sample->accel_range);
+	float gyro_scaling_factor = imu_gyro_range_scaling_factor(sample->gyro_range);
+
+	scale->accel_x = sample->accel_raw_x * accel_scaling_factor - calib.accel_bias_x * calib.accel_bias_scaling_factor;
+	scale->accel_y = sample->accel_raw_y * accel_scaling_factor - calib.accel_bias_y * calib.accel_bias_scaling_factor;
+	scale->accel_z = sample->accel_raw_z * accel_scaling_factor - calib.accel_bias_z * calib.accel_bias_scaling_factor;
+	scale->gyro_x = sample->gyro_raw_x * gyro_scaling_factor - calib.gyro_bias_x * calib.gyro_bias_scaling_factor;
+	scale->gyro_y = sample->gyro_raw_y * gyro_scaling_factor - calib.gyro_bias_y * calib.gyro_bias_scaling_factor;
+	scale->gyro_z = sample->gyro_raw_z * gyro_scaling_factor - calib.gyro_bias_z * calib.gyro_bias_scaling_factor;
+	scale->mag_x = ((float)sample->mag_raw_x * calib.mag_sens_adj_x * calib.mag_scaling_factor - calib.mag_hard_iron_bias_x) * calib.mag_soft_iron_bias_x;
+	scale->mag_y = ((float)sample->mag_raw_y * calib.mag_sens_adj_y * calib.mag_scaling_factor - calib.mag_hard_iron_bias_y) * calib.mag_soft_iron_bias_y;
+	scale->mag_z = ((float)sample->mag_raw_z * calib.mag_sens_adj_z * calib.mag_scaling_factor - calib.mag_hard_iron_bias_z) * calib.mag_soft_iron_bias_z;
+
+#ifdef USE_MPU6050
+	scale->temp = sample->temp_raw / 340.0f + 36.53f;
+#endif
+
+#ifdef USE_MPU6500
+	scale->temp = sample->temp_raw / 333.87f + 21.0f;
+#endif
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_latest_sample(imu_handle_t handle, imu_sample_t *sample, imu_sample_scale_t *scale)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	unsigned int seq;
+
+	do
+	{
+		seq = imu_seqlock_read_begin(&handle->latest_lock);
+		if (seq == 0)
+		{
+			return ERR_CODE_FAIL;
+		}
+
+		if (sample != NULL)
+		{
+			memcpy(sample, &handle->latest, sizeof(imu_sample_t));
+		}
+		if (scale != NULL)
+		{
+			memcpy(scale, &handle->latest_scale, sizeof(imu_sample_scale_t));
+		}
+	} while (imu_seqlock_read_retry(&handle->latest_lock, seq));
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_notify_data_ready(imu_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->drdy_time_us = imu_get_time_us(handle);
+	handle->drdy_pending = 1;
+	handle->drdy_count++;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_config_fifo(imu_handle_t handle, bool enable)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+
+	err_code_t err;
+
+#ifdef USE_MPU6050
+	err = mpu6050_config_fifo(handle->mpu6050_write_bytes,
+	                          enable ? (MPU6050_FIFO_EN_ACCEL | MPU6050_FIFO_EN_TEMP | MPU6050_FIFO_EN_GYRO) : 0);
+#endif
+
+#ifdef USE_MPU6500
+	err = mpu6500_config_fifo(&handle->mpu6500_dev, handle->mpu6500_write_bytes,
+	                          enable ? (MPU6500_FIFO_EN_ACCEL | MPU6500_FIFO_EN_TEMP | MPU6500_FIFO_EN_GYRO) : 0);
+#endif
+
+	if (err != ERR_CODE_SUCCESS) {
+		return ERR_CODE_FAIL;
+	}
+
+	handle->fifo_enable = enable ? 1 : 0;
+	handle->drdy_pending = 0;
+	handle->range_old_frames = 0;
+	handle->range_drop_frames = 0;
+	handle->rate_old_frames = 0;
+	handle->last_timestamp_us = imu_get_time_us(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_read_fifo(imu_handle_t handle, imu_sample_t *samples, uint16_t max_samples, uint16_t *num_samples)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL) || (num_samples == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+
+	*num_samples = 0;
+
+#ifdef USE_MPU6500
+	if (handle->power.state == IMU_POWER_WAKE_ON_MOTION)
+	{
+		return imu_power_check_motion(handle, imu_get_time_us(handle));
+	}
+
+	/* Restart FIFO once the gyroscope started up, frames follow from then on */
+	if ((handle->power.state == IMU_POWER_STARTUP) && handle->power_fifo_enable)
+	{
+		if (imu_get_time_us(handle) < handle->power_settle_us)
+		{
+			return ERR_CODE_SUCCESS;
+		}
+
+		handle->power_fifo_enable = 0;
+
+		return imu_config_fifo(handle, true);
+	}
+#endif
+
+	if (handle->fifo_enable == 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	err_code_t err;
+	uint8_t int_status = 0;
+	uint8_t fifo_oflow = 0;
+	uint16_t fifo_count = 0;
+	imu_func_transfer transfer = NULL;
+
+#ifdef USE_MPU6050
+	transfer = handle->mpu6050_transfer;
+	if (transfer != NULL) {
+		err = mpu6050_get_status_fifo_count(transfer, &int_status, &fifo_count);
+	} else {
+		err = mpu6050_get_int_status(handle->mpu6050_read_bytes, &int_status);
+	}
+	fifo_oflow = int_status & MPU6050_INT_STATUS_FIFO_OFLOW;
+#endif
+
+#ifdef USE_MPU6500
+	transfer = handle->mpu6500_transfer;
+	if (transfer != NULL) {
+		err = mpu6500_get_status_fifo_count(&handle->mpu6500_dev, transfer, &int_status, &fifo_count);
+	} else {
+		err = mpu6500_get_int_status(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &int_status);
+	}
+	fifo_oflow = int_status & MPU6500_INT_STATUS_FIFO_OFLOW;
+#endif
+
+	if (err != ERR_CODE_SUCCESS) {
+		return ERR_CODE_FAIL;
+	}
+
+	/* Overflow overwrites the oldest bytes and breaks frame alignment, restart
+	 * from an empty FIFO and account for the frames produced since the last one read.
+	 */
+	if (fifo_oflow)
+	{
+		uint64_t time_us = imu_get_time_us(handle);
+
+		/* Before the FIFO reset moves last_timestamp_us */
+		if ((time_us > handle->last_timestamp_us) && (handle->sample_period_us > 0))
+		{
+			handle->sample_seq += (uint32_t)((time_us - handle->last_timestamp_us) / imu_get_period_us(handle) + 0.5f);
+		}
+
+		err = imu_config_fifo(handle, true);
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+
+		return ERR_CODE_SUCCESS;
+	}
+
+	/* FIFO count came with the status on batched transports */
+	if (transfer == NULL)
+	{
+#ifdef USE_MPU6050
+		err = mpu6050_get_fifo_count(handle->mpu6050_read_bytes, &fifo_count);
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_get_fifo_count(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &fifo_count);
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+	}
+
+	uint64_t drain_time_us = imu_get_time_us(handle);
+	uint16_t total_frames = fifo_count / FIFO_FRAME_SIZE;
+
+	if (total_frames == 0)
+	{
+		IMU_STATS_INC(handle, stale_samples);
+	}
+	uint16_t frames = (total_frames < max_samples) ? total_frames : max_samples;
+	float period_us = imu_get_period_us(handle);
+
+	/* Frames queued before imu_set_rate are at the previous period, the new
+	 * rate frames follow them.
+	 */
+	float prev_period_us = handle->rate_prev_period_us;
+	uint16_t old_frames = (handle->rate_old_frames < total_frames) ? handle->rate_old_frames : total_frames;
+	uint16_t new_frames = total_frames - old_frames;
+
+	/* Newest frame time. Without interrupt time the newest frame is on average
+	 * half a sample period older than the drain.
+	 */
+	uint64_t half_period_us = (uint64_t)(((new_frames != 0) ? period_us : prev_period_us) / 2.0f);
+	uint64_t newest_time_us = (drain_time_us > half_period_us) ? (drain_time_us - half_period_us) : 0;
+	if (handle->drdy_pending)
+	{
+		newest_time_us = handle->drdy_time_us;
+		handle->drdy_pending = 0;
+	}
+	if (handle->func_get_time_us == NULL)
+	{
+		newest_time_us = 0;
+	}
+
+	uint16_t frame = 0;
+	uint16_t out = 0;
+	bool range_change = false;
+	uint8_t accel_range, gyro_range;
+
+	while (frame < frames)
+	{
+		uint16_t chunk = frames - frame;
+		if (chunk > FIFO_CHUNK_FRAMES)
+		{
+			chunk = FIFO_CHUNK_FRAMES;
+		}
+
+#ifdef USE_MPU6050
+		err = mpu6050_read_fifo(handle->mpu6050_read_bytes, handle->fifo_buf, chunk * FIFO_FRAME_SIZE);
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_read_fifo(&handle->mpu6500_dev, handle->mpu6500_read_bytes, handle->fifo_buf, chunk * FIFO_FRAME_SIZE);
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+
+		for (uint16_t i = 0; i < chunk; i++)
+		{
+			imu_sample_t *sample = &samples[out];
+			uint16_t index = frame + i;
+			bool old_rate = index < old_frames;
+			uint64_t age_us;
+
+			if (old_rate) {
+				age_us = (uint64_t)(new_frames * period_us + (old_frames - 1 - index) * prev_period_us + 0.5f);
+				handle->rate_old_frames--;
+			} else {
+				age_us = (uint64_t)((total_frames - 1 - index) * period_us + 0.5f);
+			}
+
+			/* Frames around a range change, see imu_range_switch */
+			if (handle->range_old_frames != 0)
+			{
+				sample->accel_range = handle->accel_range_prev;
+				sample->gyro_range = handle->gyro_range_prev;
+				handle->range_old_frames--;
+			}
+			else if (handle->range_drop_frames != 0)
+			{
+				handle->sample_seq++;
+				handle->range_drop_frames--;
+				continue;
+			}
+			else
+			{
+				sample->accel_range = handle->accel_range;
+				sample->gyro_range = handle->gyro_range;
+			}
+
+			imu_parse_motion(&handle->fifo_buf[i * FIFO_FRAME_SIZE], sample);
+			sample->seq = handle->sample_seq++;
+			sample->period_us = old_rate ? prev_period_us : period_us;
+			sample->timestamp_us = (newest_time_us > age_us) ? (newest_time_us - age_us) : 0;
+			handle->last_timestamp_us = sample->timestamp_us;
+			handle->sample_valid = 1;
+			imu_health_check(handle, sample, IMU_CHANNEL_ACCEL | IMU_CHANNEL_TEMP | IMU_CHANNEL_GYRO, 0);
+
+			/* Only the newest frame carries a measured time, older ones were
+			 * derived from the period and would just confirm the current fit.
+			 * The fit restarted at the rate change, older rate frames keep
+			 * their derived time.
+			 */
+			if (old_rate)
+			{
+				sample->timestamp_corrected_us = (handle->func_get_time_us != NULL) ? sample->timestamp_us : 0;
+			}
+			else if (index == (total_frames - 1))
+			{
+				imu_update_clock(handle, sample);
+			}
+			else if (handle->func_get_time_us != NULL)
+			{
+				imu_clock_get_time(handle->clock, sample->seq, &sample->timestamp_corrected_us);
+			}
+			else
+			{
+				sample->timestamp_corrected_us = 0;
+			}
+
+			/* Change the range only after the drain, frames still in the
+			 * FIFO then are known to be in the old range.
+			 */
+			if (!range_change)
+			{
+				range_change = imu_range_evaluate(handle, sample, &accel_range, &gyro_range);
+			}
+
+			out++;
+		}
+
+		frame += chunk;
+		*num_samples = out;
+	}
+
+	if (out != 0)
+	{
+		if (handle->power.state == IMU_POWER_STARTUP)
+		{
+			imu_power_resumed(handle, samples[0].timestamp_us);
+		}
+
+		imu_publish_sample(handle, &samples[out - 1]);
+	}
+
+	if (range_change)
+	{
+		return imu_range_switch(handle, accel_range, gyro_range);
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_set_rate(imu_handle_t handle, uint8_t dlpf_cfg, uint8_t smplrt_div)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	IMU_STATS_BUS_BEGIN(handle);
+
+	err_code_t err = ERR_CODE_SUCCESS;
+	uint8_t config = dlpf_cfg & 0x07;
+	uint16_t fifo_count = 0;
+
+	if ((config == handle->regs.config) && (smplrt_div == handle->regs.smplrt_div))
+	{
+		return ERR_CODE_SUCCESS;
+	}
+
+	/* Frames in the FIFO before the write are at the old rate */
+	if (handle->fifo_enable)
+	{
+#ifdef USE_MPU6050
+		err = mpu6050_get_fifo_count(handle->mpu6050_read_bytes, &fifo_count);
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_get_fifo_count(&handle->mpu6500_dev, handle->mpu6500_read_bytes, &fifo_count);
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+	}
+
+	if (config != handle->regs.config)
+	{
+#ifdef USE_MPU6050
+		err = mpu6050_set_dlpf(handle->mpu6050_write_bytes, (mpu6050_dlpf_cfg_t)config);
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_set_dlpf(&handle->mpu6500_dev, handle->mpu6500_write_bytes, (mpu6500_dlpf_cfg_t)config);
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+
+		handle->regs.config = config;
+	}
+
+	if (smplrt_div != handle->regs.smplrt_div)
+	{
+#ifdef USE_MPU6050
+		err = mpu6050_set_smplrt_div(handle->mpu6050_write_bytes, smplrt_div);
+#endif
+
+#ifdef USE_MPU6500
+		err = mpu6500_set_smplrt_div(&handle->mpu6500_dev, handle->mpu6500_write_bytes, smplrt_div);
+#endif
+
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+
+		handle->regs.smplrt_div = smplrt_div;
+	}
+
+	if (handle->fifo_enable)
+	{
+		handle->rate_prev_period_us = imu_get_period_us(handle);
+		handle->rate_old_frames = fifo_count / FIFO_FRAME_SIZE;
+	}
+
+	/* Periods counted from elapsed time would use the new period for the
+	 * gap since the last sample, continue the sequence without a gap instead.
+	 */
+	handle->sample_period_us = imu_calc_sample_period_us(&handle->regs);
+	handle->sample_valid = 0;
+	handle->last_drdy_count = handle->drdy_count;
+
+	return imu_config_clock(handle);
+}
+
+err_code_t imu_set_bandwidth(imu_handle_t handle, uint8_t gyro_fchoice, uint8_t accel_dlpf)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+#ifdef USE_MPU6500
+	if ((gyro_fchoice >= MPU6500_GYRO_FCHOICE_MAX) || (accel_dlpf >= MPU6500_ACCEL_DLPF_MAX))
 	{
-		return ERR_CODE_NULL_PTR;
+		return ERR_CODE_FAIL;
 	}
 
+	IMU_STATS_BUS_BEGIN(handle);
+
 	err_code_t err;
+	uint8_t gyro_config = (handle->regs.gyro_config & 0x18) | gyro_fchoice;
+	uint8_t accel_config2 = (accel_dlpf == MPU6500_ACCEL_DLPF_1130_HZ) ? 0x08 : accel_dlpf;
 
-#ifdef USE_MPU6050
-	err = mpu6050_get_accel_raw(handle->mpu6050_read_bytes, raw_x, raw_y, raw_z);
-#endif
+	if (accel_config2 != handle->regs.accel_config2)
+	{
+		err = mpu6500_set_accel_dlpf(&handle->mpu6500_dev, handle->mpu6500_write_bytes, (mpu6500_accel_dlpf_t)accel_dlpf);
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
 
-#ifdef USE_MPU6500
-	err = mpu6500_get_accel_raw(handle->mpu6500_read_bytes, raw_x, raw_y, raw_z);
-#endif
+		handle->regs.accel_config2 = accel_config2;
+	}
+
+	if (gyro_config == handle->regs.gyro_config)
+	{
+		return ERR_CODE_SUCCESS;
+	}
 
+	err = mpu6500_set_gyro_range(&handle->mpu6500_dev, handle->mpu6500_write_bytes, (mpu6500_gfs_sel_t)handle->gyro_range,
+	                             (mpu6500_gyro_fchoice_t)gyro_fchoice);
 	if (err != ERR_CODE_SUCCESS) {
 		return ERR_CODE_FAIL;
 	}
 
-	return ERR_CODE_SUCCESS;
+	handle->regs.gyro_config = gyro_config;
+
+	/* Same as imu_set_rate, the sequence continues at the new period */
+	handle->sample_period_us = imu_calc_sample_period_us(&handle->regs);
+	handle->sample_valid = 0;
+	handle->last_drdy_count = handle->drdy_count;
+
+	return imu_config_clock(handle);
+#else
+	/* FCHOICE and ACCEL_CONFIG2 are MPU6500 only */
+	(void)gyro_fchoice;
+	(void)accel_dlpf;
+
+	return ERR_CODE_FAIL;
+#endif
 }
 
-err_code_t imu_get_accel_calib(imu_handle_t handle, int16_t *calib_x, int16_t *calib_y, int16_t *calib_z)
+err_code_t imu_config_auto_range(imu_handle_t handle, imu_auto_range_cfg_t config)
 {
-	/* Check if handle structure or pointer data is NULL */
-	if ((handle == NULL) || (calib_x == NULL) || (calib_y == NULL) || (calib_z == NULL))
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
 	{
 		return ERR_CODE_NULL_PTR;
 	}
 
-	err_code_t err;
-	int16_t raw_x, raw_y, raw_z;
-
-#ifdef USE_MPU6050
-	err = mpu6050_get_accel_raw(handle->mpu6050_read_bytes, &raw_x, &raw_y, &raw_z);
-#endif
-
-#ifdef USE_MPU6500
-	err = mpu6500_get_accel_raw(handle->mpu6500_read_bytes, &raw_x, &raw_y, &raw_z);
-#endif
-
-	if (err != ERR_CODE_SUCCESS) {
+	/* A step down doubles the raw values, they must stay below up_threshold */
+	if ((config.accel_enable || config.gyro_enable) &&
+	        ((config.down_threshold >= 16384) || (2 * config.down_threshold >= config.up_threshold)))
+	{
 		return ERR_CODE_FAIL;
 	}
 
-	*calib_x = raw_x - handle->accel_bias_x;
-	*calib_y = raw_y - handle->accel_bias_y;
-	*calib_z = raw_z - handle->accel_bias_z;
+	handle->range_cfg = config;
+	handle->accel_quiet = 0;
+	handle->gyro_quiet = 0;
 
 	return ERR_CODE_SUCCESS;
 }
 
-err_code_t imu_get_accel_scale(imu_handle_t handle, float *scale_x, float *scale_y, float *scale_z)
+err_code_t imu_config_health(imu_handle_t handle, imu_health_cfg_t config)
 {
-	/* Check if handle structure or pointer data is NULL */
-	if ((handle == NULL) || (scale_x == NULL) || (scale_y == NULL) || (scale_z == NULL))
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
 	{
 		return ERR_CODE_NULL_PTR;
 	}
 
-	err_code_t err;
-	int16_t raw_x, raw_y, raw_z;
-
-#ifdef USE_MPU6050
-	err = mpu6050_get_accel_raw(handle->mpu6050_read_bytes, &raw_x, &raw_y, &raw_z);
-#endif
+	/* A run of one is every sample, -32768 is the largest raw magnitude */
+	if ((config.stuck_samples == 1) || (config.saturation_threshold > 32768))
+	{
+		return ERR_CODE_FAIL;
+	}
 
-#ifdef USE_MPU6500
-	err = mpu6500_get_accel_raw(handle->mpu6500_read_bytes, &raw_x, &raw_y, &raw_z);
-#endif
+	if (config.saturation_threshold == 0)
+	{
+		config.saturation_threshold = HEALTH_SATURATION_DEFAULT;
+	}
 
-	if (err != ERR_CODE_SUCCESS) {
-		return ERR_CODE_FAIL;
+	if (config.score_window == 0)
+	{
+		config.score_window = HEALTH_SCORE_WINDOW_DEFAULT;
 	}
 
-	*scale_x = (raw_x - handle->accel_bias_x) * handle->accel_scaling_factor;
-	*scale_y = (raw_y - handle->accel_bias_y) * handle->accel_scaling_factor;
-	*scale_z = (raw_z - handle->accel_bias_z) * handle->accel_scaling_factor;
+	handle->health_cfg = config;
+	memset(&handle->health, 0, sizeof(imu_health_status_t));
+	handle->health.score = 1.0f;
+	handle->health_prev_valid = 0;
 
 	return ERR_CODE_SUCCESS;
 }
 
-err_code_t imu_get_gyro_raw(imu_handle_t handle, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z)
+err_code_t imu_get_health_status(imu_handle_t handle, imu_health_status_t *status)
 {
 	/* Check if handle structure or pointer data is NULL */
-	if ((handle == NULL) || (raw_x == NULL) || (raw_y == NULL) || (raw_z == NULL))
+	if ((handle == NULL) || (status == NULL))
 	{
 		return ERR_CODE_NULL_PTR;
 	}
 
-	err_code_t err;
-
-#ifdef USE_MPU6050
-	err = mpu6050_get_gyro_raw(handle->mpu6050_read_bytes, raw_x, raw_y, raw_z);
-#endif
-
-#ifdef USE_MPU6500
-	err = mpu6500_get_gyro_raw(handle->mpu6500_read_bytes, raw_x, raw_y, raw_z);
-#endif
-
-	if (err != ERR_CODE_SUCCESS) {
-		return ERR_CODE_FAIL;
-	}
+	memcpy(status, &handle->health, sizeof(imu_health_status_t));
 
 	return ERR_CODE_SUCCESS;
 }
 
-err_code_t imu_get_gyro_calib(imu_handle_t handle, int16_t *calib_x, int16_t *calib_y, int16_t *calib_z)
+err_code_t imu_enter_low_power(imu_handle_t handle, uint16_t threshold_mg, float wake_rate_hz)
 {
-	/* Check if handle structure or pointer data is NULL */
-	if ((handle == NULL) || (calib_x == NULL) || (calib_y == NULL) || (calib_z == NULL))
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
 	{
 		return ERR_CODE_NULL_PTR;
 	}
 
+#ifdef USE_MPU6500
+	IMU_STATS_BUS_BEGIN(handle);
+
 	err_code_t err;
-	int16_t raw_x, raw_y, raw_z;
 
-#ifdef USE_MPU6050
-	err = mpu6050_get_gyro_raw(handle->mpu6050_read_bytes, &raw_x, &raw_y, &raw_z);
-#endif
+	if (handle->power.state == IMU_POWER_WAKE_ON_MOTION)
+	{
+		return ERR_CODE_FAIL;
+	}
 
-#ifdef USE_MPU6500
-	err = mpu6500_get_gyro_raw(handle->mpu6500_read_bytes, &raw_x, &raw_y, &raw_z);
-#endif
+	/* Lowest rate that is not below wake_rate_hz */
+	uint8_t lp_odr = 0;
+	while ((lp_odr < MPU6500_LP_ACCEL_ODR_MAX - 1) && (imu_lp_accel_odr_hz[lp_odr] < wake_rate_hz))
+	{
+		lp_odr++;
+	}
+
+	uint32_t threshold = (threshold_mg + MPU6500_WOM_THR_MG_PER_LSB / 2) / MPU6500_WOM_THR_MG_PER_LSB;
+	if (threshold > 0xFF)
+	{
+		threshold = 0xFF;
+	}
+
+	if (handle->fifo_enable)
+	{
+		err = imu_config_fifo(handle, false);
+		if (err != ERR_CODE_SUCCESS) {
+			return ERR_CODE_FAIL;
+		}
+
+		handle->power_fifo_enable = 1;
+	}
 
+	err = mpu6500_enter_wake_on_motion(&handle->mpu6500_dev, handle->mpu6500_write_bytes, MPU6500_CLKSEL,
+	                                   (mpu6500_lp_accel_odr_t)lp_odr, (uint8_t)threshold);
 	if (err != ERR_CODE_SUCCESS) {
 		return ERR_CODE_FAIL;
 	}
 
-	*calib_x = raw_x - handle->gyro_bias_x;
-	*calib_y = raw_y - handle->gyro_bias_y;
-	*calib_z = raw_z - handle->gyro_bias_z;
+	handle->drdy_pending = 0;
+	handle->power.state = IMU_POWER_WAKE_ON_MOTION;
 
 	return ERR_CODE_SUCCESS;
+#else
+	(void)threshold_mg;
+	(void)wake_rate_hz;
+
+	return ERR_CODE_FAIL;
+#endif
 }
 
-err_code_t imu_get_gyro_scale(imu_handle_t handle, float *scale_x, float *scale_y, float *scale_z)
+err_code_t imu_exit_low_power(imu_handle_t handle)
 {
-	/* Check if handle structure or pointer data is NULL */
-	if ((handle == NULL) || (scale_x == NULL) || (scale_y == NULL) || (scale_z == NULL))
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
 	{
 		return ERR_CODE_NULL_PTR;
 	}
 
-	err_code_t err;
-	int16_t raw_x, raw_y, raw_z;
-
-#ifdef USE_MPU6050
-	err = mpu6050_get_gyro_raw(handle->mpu6050_read_bytes, &raw_x, &raw_y, &raw_z);
-#endif
-
 #ifdef USE_MPU6500
-	err = mpu6500_get_gyro_raw(handle->mpu6500_read_bytes, &raw_x, &raw_y, &raw_z);
-#endif
+	IMU_STATS_BUS_BEGIN(handle);
 
-	if (err != ERR_CODE_SUCCESS) {
-		return ERR_CODE_FAIL;
+	if (handle->power.state != IMU_POWER_WAKE_ON_MOTION)
+	{
+		return ERR_CODE_SUCCESS;
 	}
 
-	*scale_x = (raw_x - handle->gyro_bias_x) * handle->gyro_scaling_factor;
-	*scale_y = (raw_y - handle->gyro_bias_y) * handle->gyro_scaling_factor;
-	*scale_z = (raw_z - handle->gyro_bias_z) * handle->gyro_scaling_factor;
-
+	return imu_power_wake(handle, imu_get_time_us(handle));
+#else
 	return ERR_CODE_SUCCESS;
+#endif
 }
 
-err_code_t imu_get_mag_raw(imu_handle_t handle, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z)
+err_code_t imu_get_power_status(imu_handle_t handle, imu_power_status_t *status)
 {
 	/* Check if handle structure or pointer data is NULL */
-	if ((handle == NULL) || (raw_x == NULL) || (raw_y == NULL) || (raw_z == NULL))
+	if ((handle == NULL) || (status == NULL))
 	{
 		return ERR_CODE_NULL_PTR;
 	}
 
-#ifdef USE_AK8963
-	err_code_t err;
-	err = ak8963_get_mag_raw(handle->ak8963_read_bytes, raw_x, raw_y, raw_z);
-	if (err != ERR_CODE_SUCCESS) {
-		return ERR_CODE_FAIL;
-	}
-#endif
+	*status = handle->power;
 
 	return ERR_CODE_SUCCESS;
 }
 
-err_code_t imu_get_mag_calib(imu_handle_t handle, float *calib_x, float *calib_y, float *calib_z)
+err_code_t imu_get_sample_period(imu_handle_t handle, float *period_us)
 {
 	/* Check if handle structure or pointer data is NULL */
-	if ((handle == NULL) || (calib_x == NULL) || (calib_y == NULL) || (calib_z == NULL))
+	if ((handle == NULL) || (period_us == NULL))
 	{
 		return ERR_CODE_NULL_PTR;
 	}
 
-	int16_t raw_x = 0, raw_y = 0, raw_z = 0;
+	*period_us = handle->sample_period_us;
 
-#ifdef USE_AK8963
-	err_code_t err;
-	err = ak8963_get_mag_raw(handle->ak8963_read_bytes, &raw_x, &raw_y, &raw_z);
-	if (err != ERR_CODE_SUCCESS) {
-		return ERR_CODE_FAIL;
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_clock_period(imu_handle_t handle, float *period_us)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (period_us == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
 	}
-#endif
 
-	*calib_x = ((float)raw_x * handle->mag_sens_adj_x - handle->mag_hard_iron_bias_x / handle->mag_scaling_factor) * handle->mag_soft_iron_bias_x;
-	*calib_y = ((float)raw_y * handle->mag_sens_adj_y - handle->mag_hard_iron_bias_y / handle->mag_scaling_factor) * handle->mag_soft_iron_bias_y;
-	*calib_z = ((float)raw_z * handle->mag_sens_adj_z - handle->mag_hard_iron_bias_z / handle->mag_scaling_factor) * handle->mag_soft_iron_bias_z;
+	*period_us = imu_get_period_us(handle);
 
 	return ERR_CODE_SUCCESS;
 }
 
-err_code_t imu_get_mag_scale(imu_handle_t handle, float *scale_x, float *scale_y, float *scale_z)
+err_code_t imu_get_clock_drift(imu_handle_t handle, float *drift_ppm)
 {
 	/* Check if handle structure or pointer data is NULL */
-	if ((handle == NULL) || (scale_x == NULL) || (scale_y == NULL) || (scale_z == NULL))
+	if ((handle == NULL) || (drift_ppm == NULL))
 	{
 		return ERR_CODE_NULL_PTR;
 	}
 
-	int16_t raw_x = 0, raw_y = 0, raw_z = 0;
-
-#ifdef USE_AK8963
-	err_code_t err;
-	err = ak8963_get_mag_raw(handle->ak8963_read_bytes, &raw_x, &raw_y, &raw_z);
-	if (err != ERR_CODE_SUCCESS) {
+	/* Nothing to measure against */
+	if (handle->func_get_time_us == NULL)
+	{
 		return ERR_CODE_FAIL;
 	}
-#endif
-
-	*scale_x = ((float)raw_x * handle->mag_sens_adj_x * handle->mag_scaling_factor - handle->mag_hard_iron_bias_x) * handle->mag_soft_iron_bias_x;
-	*scale_y = ((float)raw_y * handle->mag_sens_adj_y * handle->mag_scaling_factor - handle->mag_hard_iron_bias_y) * handle->mag_soft_iron_bias_y;
-	*scale_z = ((float)raw_z * handle->mag_sens_adj_z * handle->mag_scaling_factor - handle->mag_hard_iron_bias_z) * handle->mag_soft_iron_bias_z;
 
-	return ERR_CODE_SUCCESS;
+	return imu_clock_get_drift(handle->clock, drift_ppm);
 }
 
 err_code_t imu_set_accel_bias(imu_handle_t handle, int16_t bias_x, int16_t bias_y, int16_t bias_z)
@@ -573,9 +2598,11 @@ err_code_t imu_set_accel_bias(imu_handle_t handle, int16_t bias_x, int16_t bias_
 		return ERR_CODE_NULL_PTR;
 	}
 
-	handle->accel_bias_x = bias_x;
-	handle->accel_bias_y = bias_y;
-	handle->accel_bias_z = bias_z;
+	imu_calib_write_begin(handle);
+	handle->calib.accel_bias_x = bias_x;
+	handle->calib.accel_bias_y = bias_y;
+	handle->calib.accel_bias_z = bias_z;
+	imu_calib_write_end(handle);
 
 	return ERR_CODE_SUCCESS;
 }
@@ -588,9 +2615,11 @@ err_code_t imu_set_gyro_bias(imu_handle_t handle, int16_t bias_x, int16_t bias_y
 		return ERR_CODE_NULL_PTR;
 	}
 
-	handle->gyro_bias_x = bias_x;
-	handle->gyro_bias_y = bias_y;
-	handle->gyro_bias_z = bias_z;
+	imu_calib_write_begin(handle);
+	handle->calib.gyro_bias_x = bias_x;
+	handle->calib.gyro_bias_y = bias_y;
+	handle->calib.gyro_bias_z = bias_z;
+	imu_calib_write_end(handle);
 
 	return ERR_CODE_SUCCESS;
 }
@@ -603,9 +2632,11 @@ err_code_t imu_set_mag_hard_iron_bias(imu_handle_t handle, float bias_x, float b
 		return ERR_CODE_NULL_PTR;
 	}
 
-	handle->mag_hard_iron_bias_x = bias_x;
-	handle->mag_hard_iron_bias_y = bias_y;
-	handle->mag_hard_iron_bias_z = bias_z;
+	imu_calib_write_begin(handle);
+	handle->calib.mag_hard_iron_bias_x = bias_x;
+	handle->calib.mag_hard_iron_bias_y = bias_y;
+	handle->calib.mag_hard_iron_bias_z = bias_z;
+	imu_calib_write_end(handle);
 
 	return ERR_CODE_SUCCESS;
 }
@@ -618,9 +2649,11 @@ err_code_t imu_set_mag_soft_iron_bias(imu_handle_t handle, float bias_x, float b
 		return ERR_CODE_NULL_PTR;
 	}
 
-	handle->mag_soft_iron_bias_x = bias_x;
-	handle->mag_soft_iron_bias_y = bias_y;
-	handle->mag_soft_iron_bias_z = bias_z;
+	imu_calib_write_begin(handle);
+	handle->calib.mag_soft_iron_bias_x = bias_x;
+	handle->calib.mag_soft_iron_bias_y = bias_y;
+	handle->calib.mag_soft_iron_bias_z = bias_z;
+	imu_calib_write_end(handle);
 
 	return ERR_CODE_SUCCESS;
 }
@@ -633,9 +2666,12 @@ err_code_t imu_get_accel_bias(imu_handle_t handle, int16_t *bias_x, int16_t *bia
 		return ERR_CODE_NULL_PTR;
 	}
 
-	*bias_x = handle->accel_bias_x;
-	*bias_y = handle->accel_bias_y;
-	*bias_z = handle->accel_bias_z;
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	*bias_x = calib.accel_bias_x;
+	*bias_y = calib.accel_bias_y;
+	*bias_z = calib.accel_bias_z;
 
 	return ERR_CODE_SUCCESS;
 }
@@ -648,9 +2684,12 @@ err_code_t imu_get_gyro_bias(imu_handle_t handle, int16_t *bias_x, int16_t *bias
 		return ERR_CODE_NULL_PTR;
 	}
 
-	*bias_x = handle->gyro_bias_x;
-	*bias_y = handle->gyro_bias_y;
-	*bias_z = handle->gyro_bias_z;
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	*bias_x = calib.gyro_bias_x;
+	*bias_y = calib.gyro_bias_y;
+	*bias_z = calib.gyro_bias_z;
 
 	return ERR_CODE_SUCCESS;
 }
@@ -663,9 +2702,12 @@ err_code_t imu_get_mag_hard_iron_bias(imu_handle_t handle, float *bias_x, float
 		return ERR_CODE_NULL_PTR;
 	}
 
-	*bias_x = handle->mag_hard_iron_bias_x;
-	*bias_y = handle->mag_hard_iron_bias_y;
-	*bias_z = handle->mag_hard_iron_bias_z;
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	*bias_x = calib.mag_hard_iron_bias_x;
+	*bias_y = calib.mag_hard_iron_bias_y;
+	*bias_z = calib.mag_hard_iron_bias_z;
 
 	return ERR_CODE_SUCCESS;
 }
@@ -678,61 +2720,260 @@ err_code_t imu_get_mag_soft_iron_bias(imu_handle_t handle, float *bias_x, float
 		return ERR_CODE_NULL_PTR;
 	}
 
-	*bias_x = handle->mag_soft_iron_bias_x;
-	*bias_y = handle->mag_soft_iron_bias_y;
-	*bias_z = handle->mag_soft_iron_bias_z;
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	*bias_x = calib.mag_soft_iron_bias_x;
+	*bias_y = calib.mag_soft_iron_bias_y;
+	*bias_z = calib.mag_soft_iron_bias_z;
 
 	return ERR_CODE_SUCCESS;
 }
 
 err_code_t imu_auto_calib(imu_handle_t handle)
 {
-	int buffersize = BUFFER_CALIB_DEFAULT;
-	int mean_ax, mean_ay, mean_az, mean_gx, mean_gy, mean_gz;
-	long i = 0, buff_ax = 0, buff_ay = 0, buff_az = 0, buff_gx = 0, buff_gy = 0, buff_gz = 0;
-
-	while (i < (buffersize + 101))                  /*!< Dismiss 100 first value */
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
 	{
-		int16_t accel_raw_x, accel_raw_y, accel_raw_z;
-		int16_t gyro_raw_x, gyro_raw_y, gyro_raw_z;
+		return ERR_CODE_NULL_PTR;
+	}
 
-#ifdef USE_MPU6050
-		mpu6050_get_accel_raw(handle->mpu6050_read_bytes, &accel_raw_x, &accel_raw_y, &accel_raw_z);
-		mpu6050_get_gyro_raw(handle->mpu6050_read_bytes, &gyro_raw_x, &gyro_raw_y, &gyro_raw_z);
-#endif
+	IMU_STATS_BUS_BEGIN(handle);
 
-#ifdef USE_MPU6500
-		mpu6500_get_accel_raw(handle->mpu6500_read_bytes, &accel_raw_x, &accel_raw_y, &accel_raw_z);
-		mpu6500_get_gyro_raw(handle->mpu6500_read_bytes, &gyro_raw_x, &gyro_raw_y, &gyro_raw_z);
-#endif
+	err_code_t err;
+	imu_sample_t sample;
+	bool data_ready;
+	int buffersize = BUFFER_CALIB_DEFAULT;
+	long i = 0, poll_cnt = 0;
+	long poll_max = (buffersize + BUFFER_CALIB_DISMISS) * ((long)(handle->sample_period_us / 1000.0f) + 1) * CALIB_POLL_MARGIN;
+	float buff_ax = 0, buff_ay = 0, buff_az = 0, buff_gx = 0, buff_gy = 0, buff_gz = 0;
+	imu_calib_t calib;
+
+	/* Only average new samples, polling faster than the output data rate
+	 * would otherwise count the same sample several times. A miss waits 1 ms,
+	 * so the poll limit scales with the sample period.
+	 */
+	while (i < (buffersize + BUFFER_CALIB_DISMISS))
+	{
+		if (poll_cnt++ >= poll_max)
+		{
+			return ERR_CODE_FAIL;
+		}
+
+		err = imu_poll_sample(handle, &sample, &data_ready);
+		if (err != ERR_CODE_SUCCESS)
+		{
+			return ERR_CODE_FAIL;
+		}
 
-		if (i > 100 && i <= (buffersize + 100))
+		if (data_ready == false)
 		{
-			buff_ax += accel_raw_x;
-			buff_ay += accel_raw_y;
-			buff_az += accel_raw_z;
-			buff_gx += gyro_raw_x;
-			buff_gy += gyro_raw_y;
-			buff_gz += gyro_raw_z;
-		}
-		if (i == (buffersize + 100))
+			handle->func_delay(1);
+			continue;
+		}
+
+		if (i >= BUFFER_CALIB_DISMISS)                  /*!< Dismiss first values */
 		{
-			mean_ax = buff_ax / buffersize;
-			mean_ay = buff_ay / buffersize;
-			mean_az = buff_az / buffersize;
-			mean_gx = buff_gx / buffersize;
-			mean_gy = buff_gy / buffersize;
-			mean_gz = buff_gz / buffersize;
+			/* Average in the range the biases are kept in, auto-range may
+			 * change the range meanwhile.
+			 */
+			imu_read_calib(handle, &calib);
+			float accel_scale = imu_accel_range_scaling_factor(sample.accel_range) / calib.accel_bias_scaling_factor;
+			float gyro_scale = imu_gyro_range_scaling_factor(sample.gyro_range) / calib.gyro_bias_scaling_factor;
+
+			buff_ax += sample.accel_raw_x * accel_scale;
+			buff_ay += sample.accel_raw_y * accel_scale;
+			buff_az += sample.accel_raw_z * accel_scale;
+			buff_gx += sample.gyro_raw_x * gyro_scale;
+			buff_gy += sample.gyro_raw_y * gyro_scale;
+			buff_gz += sample.gyro_raw_z * gyro_scale;
 		}
 		i++;
 	}
 
-	handle->accel_bias_x = mean_ax;
-	handle->accel_bias_y = mean_ay;
-	handle->accel_bias_z = mean_az - 1.0f / handle->accel_scaling_factor;
-	handle->gyro_bias_x = mean_gx;
-	handle->gyro_bias_y = mean_gy;
-	handle->gyro_bias_z = mean_gz;
+	imu_calib_write_begin(handle);
+	handle->calib.accel_bias_x = buff_ax / buffersize;
+	handle->calib.accel_bias_y = buff_ay / buffersize;
+	handle->calib.accel_bias_z = buff_az / buffersize - 1.0f / handle->calib.accel_bias_scaling_factor;
+	handle->calib.gyro_bias_x = buff_gx / buffersize;
+	handle->calib.gyro_bias_y = buff_gy / buffersize;
+	handle->calib.gyro_bias_z = buff_gz / buffersize;
+	imu_calib_write_end(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_calib_save(imu_handle_t handle, uint8_t *blob, uint32_t blob_size, uint32_t *len)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (blob == NULL) || (len == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (blob_size < IMU_CALIB_BLOB_SIZE)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	imu_calib_t calib;
+	imu_read_calib(handle, &calib);
+
+	uint8_t *p = blob;
+	memcpy(p, CALIB_BLOB_MAGIC, 4);
+	p[4] = (uint8_t)CALIB_BLOB_VERSION;
+	p[5] = (uint8_t)(CALIB_BLOB_VERSION >> 8);
+	p[6] = (uint8_t)IMU_CALIB_BLOB_SIZE;
+	p[7] = (uint8_t)(IMU_CALIB_BLOB_SIZE >> 8);
+	imu_calib_put_regs(p + 8, &handle->regs);
+	p += 16;
+
+	p = imu_calib_put_i16(p, calib.accel_bias_x);
+	p = imu_calib_put_i16(p, calib.accel_bias_y);
+	p = imu_calib_put_i16(p, calib.accel_bias_z);
+	p = imu_calib_put_i16(p, calib.gyro_bias_x);
+	p = imu_calib_put_i16(p, calib.gyro_bias_y);
+	p = imu_calib_put_i16(p, calib.gyro_bias_z);
+	p = imu_calib_put_f32(p, calib.mag_hard_iron_bias_x);
+	p = imu_calib_put_f32(p, calib.mag_hard_iron_bias_y);
+	p = imu_calib_put_f32(p, calib.mag_hard_iron_bias_z);
+	p = imu_calib_put_f32(p, calib.mag_soft_iron_bias_x);
+	p = imu_calib_put_f32(p, calib.mag_soft_iron_bias_y);
+	p = imu_calib_put_f32(p, calib.mag_soft_iron_bias_z);
+	p = imu_calib_put_f32(p, calib.accel_bias_scaling_factor);
+	p = imu_calib_put_f32(p, calib.gyro_bias_scaling_factor);
+	p = imu_calib_put_f32(p, calib.mag_scaling_factor);
+	p = imu_calib_put_f32(p, calib.mag_sens_adj_x);
+	p = imu_calib_put_f32(p, calib.mag_sens_adj_y);
+	p = imu_calib_put_f32(p, calib.mag_sens_adj_z);
+
+	/* Temperature model and reserved */
+	p[0] = CALIB_TEMP_MODEL_NONE;
+	p[1] = 0;
+	p[2] = 0;
+	p[3] = 0;
+	p += 4;
+
+	imu_calib_put_u32(p, imu_calib_crc32(blob, CALIB_BLOB_CRC_OFFSET));
+
+	*len = IMU_CALIB_BLOB_SIZE;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_calib_load(imu_handle_t handle, const uint8_t *blob, uint32_t len)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (blob == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((len < IMU_CALIB_BLOB_SIZE) || (memcmp(blob, CALIB_BLOB_MAGIC, 4) != 0))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	if (((blob[4] | (blob[5] << 8)) != CALIB_BLOB_VERSION) || ((blob[6] | (blob[7] << 8)) != IMU_CALIB_BLOB_SIZE))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	if (imu_calib_crc32(blob, CALIB_BLOB_CRC_OFFSET) != imu_calib_get_u32(blob + CALIB_BLOB_CRC_OFFSET))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	/* The magnetometer fuse values identify the part */
+	uint8_t regs[8];
+	imu_calib_put_regs(regs, &handle->regs);
+	if ((handle->regs.who_am_i == 0) || (memcmp(regs, blob + 8, sizeof(regs)) != 0))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	/* Biases are converted from the range of their scaling factor */
+	if (!(imu_calib_get_f32(blob + 52) > 0) || !(imu_calib_get_f32(blob + 56) > 0))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	if (blob[76] != CALIB_TEMP_MODEL_NONE)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	const uint8_t *p = blob + 16;
+
+	imu_calib_write_begin(handle);
+	handle->calib.accel_bias_x = imu_calib_get_i16(p + 0);
+	handle->calib.accel_bias_y = imu_calib_get_i16(p + 2);
+	handle->calib.accel_bias_z = imu_calib_get_i16(p + 4);
+	handle->calib.gyro_bias_x = imu_calib_get_i16(p + 6);
+	handle->calib.gyro_bias_y = imu_calib_get_i16(p + 8);
+	handle->calib.gyro_bias_z = imu_calib_get_i16(p + 10);
+	handle->calib.mag_hard_iron_bias_x = imu_calib_get_f32(p + 12);
+	handle->calib.mag_hard_iron_bias_y = imu_calib_get_f32(p + 16);
+	handle->calib.mag_hard_iron_bias_z = imu_calib_get_f32(p + 20);
+	handle->calib.mag_soft_iron_bias_x = imu_calib_get_f32(p + 24);
+	handle->calib.mag_soft_iron_bias_y = imu_calib_get_f32(p + 28);
+	handle->calib.mag_soft_iron_bias_z = imu_calib_get_f32(p + 32);
+	handle->calib.accel_bias_scaling_factor = imu_calib_get_f32(p + 36);
+	handle->calib.gyro_bias_scaling_factor = imu_calib_get_f32(p + 40);
+	handle->calib.mag_scaling_factor = imu_calib_get_f32(p + 44);
+	handle->calib.mag_sens_adj_x = imu_calib_get_f32(p + 48);
+	handle->calib.mag_sens_adj_y = imu_calib_get_f32(p + 52);
+	handle->calib.mag_sens_adj_z = imu_calib_get_f32(p + 56);
+	imu_calib_write_end(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_config_regs(imu_handle_t handle, imu_config_regs_t *regs)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (regs == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*regs = handle->regs;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_get_stats(imu_handle_t handle, imu_stats_t *stats)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (stats == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+#ifdef IMU_ENABLE_STATS
+	memcpy(stats, &handle->stats, sizeof(imu_stats_t));
+
+	return ERR_CODE_SUCCESS;
+#else
+	return ERR_CODE_FAIL;
+#endif
+}
+
+err_code_t imu_reset_stats(imu_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+#ifdef IMU_ENABLE_STATS
+	memset(&handle->stats, 0, sizeof(imu_stats_t));
+	handle->stats_read_us[IMU_STATS_STREAM_ACCEL] = 0;
+	handle->stats_read_us[IMU_STATS_STREAM_GYRO] = 0;
 
 	return ERR_CODE_SUCCESS;
+#else
+	return ERR_CODE_FAIL;
+#endif
 }
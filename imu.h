@@ -5,15 +5,43 @@
 extern "C" {
 #endif
 
+#include "stdbool.h"
+
 #include "err_code.h"
 #include "imu.h"
 
+/**
+ * @brief   Register transfer direction.
+ */
+typedef enum {
+    IMU_TRANSFER_READ = 0,                                  /*!< Read registers */
+    IMU_TRANSFER_WRITE,                                     /*!< Write registers */
+} imu_transfer_dir_t;
+
+/**
+ * @brief   One register transfer of a batch.
+ */
+typedef struct {
+    uint8_t                     reg_addr;                   /*!< First register address */
+    uint8_t                     *buf;                       /*!< Data buffer */
+    uint16_t                    len;                        /*!< Number of bytes */
+    imu_transfer_dir_t          dir;                        /*!< Transfer direction */
+} imu_transfer_t;
+
 typedef err_code_t (*imu_func_read_bytes)(uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms);
 typedef err_code_t (*imu_func_write_bytes)(uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms);
 typedef void (*imu_func_delay)(uint32_t ms);
+typedef uint64_t (*imu_func_get_time_us)(void);
+typedef void (*imu_func_set_bus_clock)(uint32_t clock_hz);
+typedef err_code_t (*imu_func_transfer)(imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms);
+typedef uint32_t (*imu_func_get_cycles)(void);
 
 typedef struct imu* imu_handle_t;
 
+#define IMU_STATS_HIST_BINS             32          /*!< Read latency histogram bins, one per power of two cycles */
+#define IMU_STATS_ERR_SLOTS             4           /*!< Distinct error codes counted separately */
+#define IMU_CALIB_BLOB_SIZE             84          /*!< Size of a calibration blob of imu_calib_save */
+
 /**
  * @brief   IMU configuration structure.
  */
@@ -32,13 +60,179 @@ typedef struct {
     float                       mag_soft_iron_bias_z;       /*!< Magnetometer soft iron bias of z axis */
     imu_func_read_bytes         mpu6050_read_bytes;         /*!< MPU6050 read bytes */
     imu_func_write_bytes        mpu6050_write_bytes;        /*!< MPU6050 write bytes */
+    imu_func_transfer           mpu6050_transfer;           /*!< Optional MPU6050 batched transfer, executes all transfers in one call */
     imu_func_read_bytes         ak8963_read_bytes;          /*!< AK8963 write bytes */
     imu_func_write_bytes        ak8963_write_bytes;         /*!< AK8963 write bytes */
     imu_func_read_bytes         mpu6500_read_bytes;         /*!< MPU6500 write bytes */
     imu_func_write_bytes        mpu6500_write_bytes;        /*!< MPU6500 write bytes */
+    imu_func_set_bus_clock      mpu6500_set_bus_clock;      /*!< MPU6500 SPI clock select, only used in SPI mode */
+    imu_func_transfer           mpu6500_transfer;           /*!< Optional MPU6500 batched transfer, executes all transfers in one call */
     imu_func_delay              func_delay;                 /*!< IMU delay function */
+    imu_func_get_time_us        func_get_time_us;           /*!< Optional timestamp source in microseconds, NULL disables timestamps */
+    imu_func_get_cycles         func_get_cycles;            /*!< Optional free running cycle counter for statistics, NULL disables latency and timeouts */
+    uint32_t                    cycles_per_us;              /*!< Cycle counter frequency in MHz, 0 disables timeout detection */
 } imu_cfg_t;
 
+/**
+ * @brief   Configuration register values written by imu_config.
+ */
+typedef struct {
+    uint8_t                     who_am_i;                   /*!< WHO_AM_I of the motion sensor, 0x68 MPU6050, 0x70 MPU6500 */
+    uint8_t                     smplrt_div;                 /*!< SMPLRT_DIV */
+    uint8_t                     config;                     /*!< CONFIG */
+    uint8_t                     gyro_config;                /*!< GYRO_CONFIG */
+    uint8_t                     accel_config;               /*!< ACCEL_CONFIG */
+    uint8_t                     accel_config2;              /*!< ACCEL_CONFIG2, MPU6500 only */
+    uint8_t                     mag_present;                /*!< AK8963 is configured */
+    uint8_t                     mag_cntl;                   /*!< AK8963 CNTL */
+    uint8_t                     mag_asa[3];                 /*!< AK8963 sensitivity adjustment fuse values */
+} imu_config_regs_t;
+
+/**
+ * @brief   Sensor channel, used as bit mask.
+ */
+typedef enum {
+    IMU_CHANNEL_ACCEL = 0x01,                               /*!< Accelerometer */
+    IMU_CHANNEL_TEMP = 0x02,                                /*!< Temperature */
+    IMU_CHANNEL_GYRO = 0x04,                                /*!< Gyroscope */
+    IMU_CHANNEL_MAG = 0x08,                                 /*!< Magnetometer */
+} imu_channel_t;
+
+/**
+ * @brief   IMU sample structure. One sample holds the data of one sensor output period.
+ */
+typedef struct {
+    uint32_t                    seq;                        /*!< Sample sequence number, counts sensor output periods so skipped samples show up as gaps */
+    uint64_t                    timestamp_us;               /*!< Time the sample was produced in microseconds, 0 without timestamp source */
+    uint64_t                    timestamp_corrected_us;     /*!< Timestamp on the host clock from the sensor clock estimate, 0 without timestamp source */
+    float                       period_us;                  /*!< Sample period the sample was taken at, sensor clock estimate if available */
+    uint8_t                     accel_range;                /*!< Accelerometer full scale the sample was taken in, 0..3 for 2, 4, 8, 16 g */
+    uint8_t                     gyro_range;                 /*!< Gyroscope full scale the sample was taken in, 0..3 for 250, 500, 1000, 2000 deg/s */
+    int16_t                     accel_raw_x;                /*!< Accelerometer raw data x axis */
+    int16_t                     accel_raw_y;                /*!< Accelerometer raw data y axis */
+    int16_t                     accel_raw_z;                /*!< Accelerometer raw data z axis */
+    int16_t                     temp_raw;                   /*!< Temperature raw data */
+    int16_t                     gyro_raw_x;                 /*!< Gyroscope raw data x axis */
+    int16_t                     gyro_raw_y;                 /*!< Gyroscope raw data y axis */
+    int16_t                     gyro_raw_z;                 /*!< Gyroscope raw data z axis */
+    int16_t                     mag_raw_x;                  /*!< Magnetometer raw data x axis */
+    int16_t                     mag_raw_y;                  /*!< Magnetometer raw data y axis */
+    int16_t                     mag_raw_z;                  /*!< Magnetometer raw data z axis */
+    uint16_t                    health;                     /*!< imu_health_flag_t bits of the health checks, 0 if healthy or health monitoring is off */
+} imu_sample_t;
+
+/**
+ * @brief   IMU statistics structure. Only available with IMU_ENABLE_STATS.
+ */
+typedef struct {
+    uint32_t                    read_transactions;          /*!< Read transactions, a batched transfer counts once */
+    uint32_t                    write_transactions;         /*!< Write transactions */
+    uint64_t                    read_bytes;                 /*!< Bytes read */
+    uint64_t                    write_bytes;                /*!< Bytes written */
+    uint32_t                    errors;                     /*!< Failed transactions */
+    err_code_t                  error_code[IMU_STATS_ERR_SLOTS];    /*!< Error codes in order of first occurrence */
+    uint32_t                    error_count[IMU_STATS_ERR_SLOTS];   /*!< Failed transactions per error code */
+    uint32_t                    error_other;                /*!< Failed transactions with codes beyond IMU_STATS_ERR_SLOTS */
+    uint32_t                    timeouts;                   /*!< Failed transactions that took the full timeout */
+    uint32_t                    stale_samples;              /*!< Polls and FIFO reads without new data */
+    uint32_t                    duplicate_samples;          /*!< Direct reads faster than the output data rate, returning the previous sample again */
+    uint32_t                    mag_overflows;              /*!< Magnetic sensor overflows */
+    uint32_t                    range_switches;             /*!< Full scale changes of auto-range */
+    uint32_t                    read_cycles_max;            /*!< Longest read transaction in cycles */
+    uint32_t                    read_latency_hist[IMU_STATS_HIST_BINS];     /*!< Read transactions of 2^n to 2^(n+1) - 1 cycles in bin n */
+} imu_stats_t;
+
+/**
+ * @brief   Auto-range configuration structure.
+ */
+typedef struct {
+    bool                        accel_enable;               /*!< Auto-range the accelerometer */
+    bool                        gyro_enable;                /*!< Auto-range the gyroscope */
+    uint16_t                    up_threshold;               /*!< Step to the next wider range when an axis reaches this raw magnitude */
+    uint16_t                    down_threshold;             /*!< Step to the next narrower range when all axes stayed below this raw magnitude, below 16384 */
+    uint16_t                    window_samples;             /*!< Samples all axes must stay below down_threshold */
+} imu_auto_range_cfg_t;
+
+/**
+ * @brief   Sample health flag, used as bit mask.
+ */
+typedef enum {
+    IMU_HEALTH_ACCEL_STUCK = 0x0001,                        /*!< An accelerometer axis repeated the same raw value stuck_samples times */
+    IMU_HEALTH_GYRO_STUCK = 0x0002,                         /*!< A gyroscope axis repeated the same raw value stuck_samples times */
+    IMU_HEALTH_ACCEL_SPIKE = 0x0004,                        /*!< An accelerometer axis changed by more than accel_max_step */
+    IMU_HEALTH_GYRO_SPIKE = 0x0008,                         /*!< A gyroscope axis changed by more than gyro_max_step */
+    IMU_HEALTH_ACCEL_SATURATED = 0x0010,                    /*!< An accelerometer axis reached saturation_threshold */
+    IMU_HEALTH_GYRO_SATURATED = 0x0020,                     /*!< A gyroscope axis reached saturation_threshold */
+    IMU_HEALTH_MAG_OVERFLOW = 0x0040,                       /*!< Magnetic sensor overflow, magnetometer data is not valid */
+    IMU_HEALTH_BUS_FAULT = 0x0080,                          /*!< All motion words read 0x0000 or all 0xFFFF, data is not valid */
+} imu_health_flag_t;
+
+/**
+ * @brief   Health monitoring configuration structure.
+ */
+typedef struct {
+    bool                        enable;                     /*!< Check every sample */
+    uint16_t                    stuck_samples;              /*!< Identical consecutive raw values of an axis that count as stuck, 0 disables */
+    uint16_t                    accel_max_step;             /*!< Largest raw change of an accelerometer axis between samples, 0 disables */
+    uint16_t                    gyro_max_step;              /*!< Largest raw change of a gyroscope axis between samples, 0 disables */
+    uint16_t                    saturation_threshold;       /*!< Raw magnitude that counts as saturated, 0 for 32767 */
+    uint16_t                    score_window;               /*!< Samples the health score averages over, 0 for 100 */
+} imu_health_cfg_t;
+
+/**
+ * @brief   Health monitoring status structure.
+ */
+typedef struct {
+    float                       score;                      /*!< Moving average of healthy samples, 1 all healthy, 0 all flagged */
+    uint16_t                    flags;                      /*!< imu_health_flag_t bits of all samples since imu_config_health */
+    uint16_t                    last_flags;                 /*!< imu_health_flag_t bits of the last sample */
+    uint32_t                    samples;                    /*!< Samples checked */
+    uint32_t                    faulty_samples;             /*!< Samples with any flag */
+    uint32_t                    stuck;                      /*!< Samples with a stuck flag */
+    uint32_t                    spikes;                     /*!< Samples with a spike flag */
+    uint32_t                    saturated;                  /*!< Samples with a saturated flag */
+    uint32_t                    mag_overflows;              /*!< Samples with a magnetic sensor overflow */
+    uint32_t                    bus_faults;                 /*!< Samples with a bus fault */
+} imu_health_status_t;
+
+/**
+ * @brief   Power state.
+ */
+typedef enum {
+    IMU_POWER_FULL = 0,                                     /*!< Full rate acquisition */
+    IMU_POWER_WAKE_ON_MOTION,                               /*!< Accelerometer cycling, gyroscope off, waiting for motion */
+    IMU_POWER_STARTUP,                                      /*!< Woken up, waiting for the gyroscope to start */
+} imu_power_state_t;
+
+/**
+ * @brief   Power status structure.
+ */
+typedef struct {
+    imu_power_state_t           state;                      /*!< Power state */
+    uint32_t                    wakeups;                    /*!< Wake-ups, by motion or imu_exit_low_power */
+    uint64_t                    wake_time_us;               /*!< Time of the last wake-up, motion interrupt time if reported */
+    uint32_t                    wake_latency_us;            /*!< Last wake-up to first full rate sample */
+    uint32_t                    wake_latency_max_us;        /*!< Longest wake_latency_us */
+} imu_power_status_t;
+
+/**
+ * @brief   IMU scaled sample structure. Biases are removed.
+ */
+typedef struct {
+    uint32_t                    seq;                        /*!< Sample sequence number */
+    uint64_t                    timestamp_us;               /*!< Sample timestamp in microseconds */
+    float                       accel_x;                    /*!< Accelerometer x axis in g */
+    float                       accel_y;                    /*!< Accelerometer y axis in g */
+    float                       accel_z;                    /*!< Accelerometer z axis in g */
+    float                       gyro_x;                     /*!< Gyroscope x axis in deg/s */
+    float                       gyro_y;                     /*!< Gyroscope y axis in deg/s */
+    float                       gyro_z;                     /*!< Gyroscope z axis in deg/s */
+    float                       mag_x;                      /*!< Magnetometer x axis in mG */
+    float                       mag_y;                      /*!< Magnetometer y axis in mG */
+    float                       mag_z;                      /*!< Magnetometer z axis in mG */
+    float                       temp;                       /*!< Temperature in degree Celsius */
+} imu_sample_scale_t;
+
 /*
  * @brief   Initialize IMU with default parameters.
  *
@@ -201,6 +395,359 @@ err_code_t imu_get_mag_calib(imu_handle_t handle, float *calib_x, float *calib_y
  */
 err_code_t imu_get_mag_scale(imu_handle_t handle, float *scale_x, float *scale_y, float *scale_z);
 
+/*
+ * @brief   Poll data ready status and read a new sample.
+ *
+ * @note    Only INT_STATUS is read when the sensor has not produced a new sample
+ *          since the last call, so polling faster than the output data rate costs
+ *          one byte per call. When data is ready, accelerometer, temperature and
+ *          gyroscope are read in one burst and the sample gets the next sequence
+ *          number. With a batched transfer callback INT_STATUS and the 14 output
+ *          bytes are always read in one round trip, a poll without new data then
+ *          costs 15 bytes but a new sample takes one transaction instead of two.
+ *
+ * @param   handle Handle structure.
+ * @param   sample Sample structure, only updated when data_ready is true.
+ * @param   data_ready Set to true if a new sample was read, otherwise false.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_poll_sample(imu_handle_t handle, imu_sample_t *sample, bool *data_ready);
+
+/*
+ * @brief   Read selected sensor channels with the fewest transactions.
+ *
+ * @note    Accelerometer, temperature and gyroscope channels are read in one
+ *          transaction spanning the first to the last selected channel, the
+ *          magnetometer needs a second one. Data ready is not checked and only
+ *          the selected channels, seq, timestamps, period and ranges of the
+ *          sample are updated. seq counts imu_read_channels calls and
+ *          timestamp_corrected_us is 0. The sample is not published to
+ *          imu_get_latest_sample.
+ *
+ * @param   handle Handle structure.
+ * @param   channels Bit mask of imu_channel_t.
+ * @param   sample Sample structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_read_channels(imu_handle_t handle, uint8_t channels, imu_sample_t *sample);
+
+/*
+ * @brief   Convert raw sample to scaled data.
+ *
+ * @note    Uses the current biases and scaling factors of the handle, no bus access.
+ *          timestamp_us is taken from timestamp_corrected_us when available.
+ *
+ * @param   handle Handle structure.
+ * @param   sample Raw sample structure.
+ * @param   scale Scaled sample structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_scale_sample(imu_handle_t handle, const imu_sample_t *sample, imu_sample_scale_t *scale);
+
+/*
+ * @brief   Get the latest sample published by the acquisition functions.
+ *
+ * @note    imu_poll_sample and imu_read_fifo publish every new sample,
+ *          scaled with the calibration valid at that time. Any number of
+ *          threads may call this function while one thread acquires, the
+ *          copy is consistent without locks or bus access. Biases and
+ *          scaling factors are published the same way, so the setters may be
+ *          called from any thread too.
+ *
+ * @param   handle Handle structure.
+ * @param   sample Raw sample structure, may be NULL.
+ * @param   scale Scaled sample structure, may be NULL.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           No sample published yet.
+ */
+err_code_t imu_get_latest_sample(imu_handle_t handle, imu_sample_t *sample, imu_sample_scale_t *scale);
+
+/*
+ * @brief   Record data ready interrupt time.
+ *
+ * @note    Call this from the data ready interrupt handler. The next sample read
+ *          by imu_poll_sample, or the newest frame drained by imu_read_fifo, is
+ *          stamped with the interrupt time instead of the read time.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_notify_data_ready(imu_handle_t handle);
+
+/*
+ * @brief   Enable or disable FIFO. Accelerometer, temperature and gyroscope are
+ *          written to FIFO every sample period.
+ *
+ * @param   handle Handle structure.
+ * @param   enable Enable FIFO if true, disable if false.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_config_fifo(imu_handle_t handle, bool enable);
+
+/*
+ * @brief   Drain samples from FIFO.
+ *
+ * @note    Frame timestamps are back computed from the drain time, or the last
+ *          data ready interrupt time, and the sample period. On FIFO overflow
+ *          the FIFO is reset, no sample is returned and the sequence number
+ *          skips the frames that were lost.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Sample array, oldest sample first.
+ * @param   max_samples Size of sample array.
+ * @param   num_samples Number of samples read.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_read_fifo(imu_handle_t handle, imu_sample_t *samples, uint16_t max_samples, uint16_t *num_samples);
+
+/*
+ * @brief   Change sample rate and low-pass filter. Only the registers that
+ *          differ from the values written before are rewritten.
+ *
+ * @note    The sequence number continues without a gap and the clock fit
+ *          starts over at the new period. With FIFO call right after
+ *          imu_read_fifo, frames produced before the change and drained
+ *          after it are dated with the new period. On MPU6500 smplrt_div
+ *          has no effect with dlpf_cfg 0 or 7.
+ *
+ * @param   handle Handle structure.
+ * @param   dlpf_cfg Low-pass filter, DLPF_CFG of the CONFIG register.
+ * @param   smplrt_div Sample rate divider.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_set_rate(imu_handle_t handle, uint8_t dlpf_cfg, uint8_t smplrt_div);
+
+/*
+ * @brief   Set gyroscope DLPF bypass and accelerometer bandwidth apart from
+ *          the shared dlpf_cfg of imu_set_rate. MPU6500 only. Only the
+ *          registers that differ from the values written before are
+ *          rewritten.
+ *
+ * @note    The sample rate is 32 kHz with the gyroscope DLPF bypassed and
+ *          8 kHz with dlpf_cfg 0 or 7, the sample rate divider has no
+ *          effect at either. The 512 byte FIFO then holds 1 ms or 4.5 ms of
+ *          frames, use FIFO mode and call imu_read_fifo at least twice as
+ *          often. Each call drains the FIFO in one burst.
+ *
+ * @param   handle Handle structure.
+ * @param   gyro_fchoice Gyroscope DLPF bypass, mpu6500_gyro_fchoice_t.
+ * @param   accel_dlpf Accelerometer bandwidth, mpu6500_accel_dlpf_t.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_set_bandwidth(imu_handle_t handle, uint8_t gyro_fchoice, uint8_t accel_dlpf);
+
+/*
+ * @brief   Configure auto-range. The full scale of a sensor steps up one range
+ *          as soon as an axis nears saturation, and steps down one range
+ *          after window_samples quiet samples. Disabled by default.
+ *
+ * @note    Every sample is tagged with the range it was taken in and
+ *          imu_scale_sample scales by the tag, so the change is exact at
+ *          the sample it takes effect. A sample produced while the range
+ *          registers are written may be in either range, it is skipped and
+ *          shows as a sequence gap. Biases stay in the range they were
+ *          measured in and are converted.
+ *
+ * @param   handle Handle structure.
+ * @param   config Auto-range configuration.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_config_auto_range(imu_handle_t handle, imu_auto_range_cfg_t config);
+
+/*
+ * @brief   Configure health monitoring. Every sample of imu_poll_sample,
+ *          imu_read_channels and imu_read_fifo is checked in constant time
+ *          and carries the result in its health field. Disabled by default.
+ *          Clears the health status.
+ *
+ * @note    An axis is stuck once it repeats a raw value stuck_samples times,
+ *          until the value changes. A spike is a step larger than the limit
+ *          between two checked samples, steps across a range change are not
+ *          checked. A bus fault sample is not used for the other checks.
+ *          With monitoring enabled a magnetic sensor overflow in
+ *          imu_read_channels sets IMU_HEALTH_MAG_OVERFLOW instead of failing,
+ *          the direct magnetometer reads still fail.
+ *
+ * @param   handle Handle structure.
+ * @param   config Health monitoring configuration.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_config_health(imu_handle_t handle, imu_health_cfg_t config);
+
+/*
+ * @brief   Get health monitoring status.
+ *
+ * @param   handle Handle structure.
+ * @param   status Health status.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_get_health_status(imu_handle_t handle, imu_health_status_t *status);
+
+/*
+ * @brief   Enter low power mode, MPU6500 only. Gyroscope axes are turned off
+ *          and the accelerometer cycles at the lowest rate not below
+ *          wake_rate_hz, until it moves by more than threshold_mg between
+ *          two cycles. FIFO is stopped.
+ *
+ * @note    imu_poll_sample and imu_read_fifo keep being called, they return
+ *          no sample and only check for motion. On motion full rate
+ *          acquisition resumes by itself, FIFO is restarted if it was
+ *          enabled, and samples are held back until the gyroscope has
+ *          started up. Call imu_notify_data_ready from the interrupt handler
+ *          to time the wake-up by the motion interrupt. The sequence number
+ *          continues without a gap and the clock fit starts over.
+ *
+ * @param   handle Handle structure.
+ * @param   threshold_mg Motion threshold in mg, 4 mg resolution, up to 1020 mg.
+ * @param   wake_rate_hz Accelerometer rate while waiting for motion, 0.24 to 500 Hz.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_enter_low_power(imu_handle_t handle, uint16_t threshold_mg, float wake_rate_hz);
+
+/*
+ * @brief   Leave low power mode without waiting for motion. Counts as a
+ *          wake-up.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_exit_low_power(imu_handle_t handle);
+
+/*
+ * @brief   Get power state and wake-up latency.
+ *
+ * @param   handle Handle structure.
+ * @param   status Power status.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_get_power_status(imu_handle_t handle, imu_power_status_t *status);
+
+/*
+ * @brief   Get nominal sample period.
+ *
+ * @param   handle Handle structure.
+ * @param   period_us Sample period in microseconds.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_get_sample_period(imu_handle_t handle, float *period_us);
+
+/*
+ * @brief   Get sample period estimated from the sensor clock.
+ *
+ * @note    Sequence numbers and timestamps of every new sample are fitted
+ *          against each other to measure the sensor oscillator against the
+ *          host clock. Needs a timestamp source.
+ *
+ * @param   handle Handle structure.
+ * @param   period_us True sample period in microseconds, nominal period until enough samples were read.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_get_clock_period(imu_handle_t handle, float *period_us);
+
+/*
+ * @brief   Get drift of the sensor clock relative to the host clock.
+ *
+ * @note    Fails without a timestamp source.
+ *
+ * @param   handle Handle structure.
+ * @param   drift_ppm Drift in parts per million, positive when the sensor runs slow.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_get_clock_drift(imu_handle_t handle, float *drift_ppm);
+
+/*
+ * @brief   Get configuration register values written by imu_config.
+ *
+ * @param   handle Handle structure.
+ * @param   regs Register values.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_get_config_regs(imu_handle_t handle, imu_config_regs_t *regs);
+
+/*
+ * @brief   Get bus and sample statistics.
+ *
+ * @note    Statistics are off by default, define IMU_ENABLE_STATS in imu.c
+ *          to compile them in. The counters are updated by the thread using
+ *          the handle, read them from the same thread or accept a slightly
+ *          inconsistent copy.
+ *
+ * @param   handle Handle structure.
+ * @param   stats Statistics.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail, also when statistics are not compiled in.
+ */
+err_code_t imu_get_stats(imu_handle_t handle, imu_stats_t *stats);
+
+/*
+ * @brief   Clear statistics.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail, also when statistics are not compiled in.
+ */
+err_code_t imu_reset_stats(imu_handle_t handle);
+
 /*
  * @brief   Set accelerometer bias data.
  *
@@ -324,6 +871,43 @@ err_code_t imu_get_mag_soft_iron_bias(imu_handle_t handle, float *bias_x, float
  */
 err_code_t imu_auto_calib(imu_handle_t handle);
 
+/*
+ * @brief   Save the calibration to a blob for flash or a file. The blob is
+ *          little endian, versioned and CRC-32 protected, and records the
+ *          magnetometer settings it belongs to. Biases are stored with the
+ *          scaling factor of their full scale range.
+ *
+ * @param   handle Handle structure.
+ * @param   blob Blob, at least IMU_CALIB_BLOB_SIZE bytes.
+ * @param   blob_size Size of blob.
+ * @param   len Length written.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_calib_save(imu_handle_t handle, uint8_t *blob, uint32_t blob_size, uint32_t *len);
+
+/*
+ * @brief   Load the calibration from a blob of imu_calib_save, in place of
+ *          imu_auto_calib at boot. Call after imu_config.
+ *
+ * @note    The blob is rejected without changing the calibration when its
+ *          CRC or version is wrong, or when it was saved with another
+ *          magnetometer mode or other magnetometer fuse values than
+ *          configured now. A blob saved in another full scale range loads,
+ *          biases are converted by their stored scaling factor.
+ *
+ * @param   handle Handle structure.
+ * @param   blob Blob.
+ * @param   len Length of blob.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_calib_load(imu_handle_t handle, const uint8_t *blob, uint32_t len);
+
 #ifdef __cplusplus
 }
 #endif
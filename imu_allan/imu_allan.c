@@ -0,0 +1,450 @@
+#include "stdlib.h"
+#include "string.h"
+#include "math.h"
+
+#include "imu_allan/imu_allan.h"
+
+#define ALLAN_PI 					3.14159265358979f
+#define ALLAN_DEG_TO_RAD 			(ALLAN_PI / 180.0f)
+#define ALLAN_G 					9.80665f 	/*!< Standard gravity, m/s^2 per g */
+#define ALLAN_BIAS_FACTOR 			0.664f 		/*!< Flicker floor of the Allan deviation over the bias instability */
+#define ALLAN_TERMS 				3 			/*!< Fitted terms, white noise, flicker and random walk */
+
+
+typedef struct {
+	double 						prev[IMU_ALLAN_AXIS_MAX]; 	/*!< Previous cluster average */
+	double 						half[IMU_ALLAN_AXIS_MAX]; 	/*!< First cluster of the pair forming the next level */
+	double 						sum_sq[IMU_ALLAN_AXIS_MAX]; 	/*!< Sum of squared differences of consecutive clusters */
+	uint32_t 					diffs; 						/*!< Differences in sum_sq */
+	uint8_t 					has_prev; 					/*!< prev is valid */
+	uint8_t 					has_half; 					/*!< half is valid */
+} imu_allan_level_t;
+
+typedef struct imu_allan {
+	imu_allan_cfg_t 			cfg; 						/*!< Configuration */
+	imu_allan_level_t 			level[IMU_ALLAN_MAX_LEVELS]; 	/*!< Cluster accumulators, level k averages 2^k samples */
+	uint8_t 					started; 					/*!< A sample has been seen */
+	uint32_t 					last_seq; 					/*!< Sequence number of the last sample */
+	imu_allan_status_t 			status; 					/*!< Status */
+} imu_allan_t;
+
+static void imu_allan_break(imu_allan_handle_t handle)
+{
+	for (uint8_t k = 0; k < IMU_ALLAN_MAX_LEVELS; k++)
+	{
+		handle->level[k].has_prev = 0;
+		handle->level[k].has_half = 0;
+	}
+}
+
+static void imu_allan_input(imu_allan_handle_t handle, uint32_t seq, const double *y)
+{
+	if (handle->started && (seq != handle->last_seq + 1))
+	{
+		imu_allan_break(handle);
+		handle->status.gaps++;
+	}
+	handle->started = 1;
+	handle->last_seq = seq;
+	handle->status.samples++;
+
+	/* Carry the cluster up while it completes a pair */
+	double avg[IMU_ALLAN_AXIS_MAX];
+	memcpy(avg, y, sizeof(avg));
+
+	for (uint8_t k = 0; k < IMU_ALLAN_MAX_LEVELS; k++)
+	{
+		imu_allan_level_t *l = &handle->level[k];
+
+		if (l->has_prev)
+		{
+			for (uint8_t a = 0; a < IMU_ALLAN_AXIS_MAX; a++)
+			{
+				double d = avg[a] - l->prev[a];
+				l->sum_sq[a] += d * d;
+			}
+			if (l->diffs++ == 0)
+			{
+				handle->status.levels = k + 1;
+			}
+		}
+		memcpy(l->prev, avg, sizeof(l->prev));
+		l->has_prev = 1;
+
+		if (!l->has_half)
+		{
+			memcpy(l->half, avg, sizeof(l->half));
+			l->has_half = 1;
+			break;
+		}
+
+		for (uint8_t a = 0; a < IMU_ALLAN_AXIS_MAX; a++)
+		{
+			avg[a] = 0.5 * (l->half[a] + avg[a]);
+		}
+		l->has_half = 0;
+	}
+}
+
+/* Allan variance of each term for a unit parameter, white noise N^2 / tau,
+ * flicker 0.664^2 B^2, random walk K^2 tau / 3.
+ */
+static double imu_allan_basis(uint8_t term, double tau_s)
+{
+	switch (term)
+	{
+	case 0:
+		return 1.0 / tau_s;
+	case 1:
+		return (double)ALLAN_BIAS_FACTOR * ALLAN_BIAS_FACTOR;
+	default:
+		return tau_s / 3.0;
+	}
+}
+
+/* Squared noise terms from a least squares fit of the variance curve.
+ * Residuals are relative and weighted by the differences of the level,
+ * which is about the inverse variance of each point. Every subset of the
+ * terms is solved and the best fit without a negative term wins, a term
+ * the curve does not support stays 0.
+ */
+static void imu_allan_fit(imu_allan_handle_t handle, uint8_t axis, uint32_t min_diffs, double term[ALLAN_TERMS])
+{
+	double ata[ALLAN_TERMS][ALLAN_TERMS] = {{0}};
+	double atb[ALLAN_TERMS] = {0};
+	double btb = 0;
+
+	for (uint8_t k = 0; k < IMU_ALLAN_MAX_LEVELS; k++)
+	{
+		const imu_allan_level_t *l = &handle->level[k];
+		if ((l->diffs < min_diffs) || (l->sum_sq[axis] <= 0))
+		{
+			continue;
+		}
+
+		double tau_s = (double)(1UL << k) / handle->cfg.sample_rate_hz;
+		double avar = l->sum_sq[axis] / (2.0 * l->diffs);
+		double row[ALLAN_TERMS];
+
+		for (uint8_t i = 0; i < ALLAN_TERMS; i++)
+		{
+			row[i] = imu_allan_basis(i, tau_s) / avar;
+		}
+		for (uint8_t i = 0; i < ALLAN_TERMS; i++)
+		{
+			for (uint8_t j = 0; j < ALLAN_TERMS; j++)
+			{
+				ata[i][j] += l->diffs * row[i] * row[j];
+			}
+			atb[i] += l->diffs * row[i];
+		}
+		btb += l->diffs;
+	}
+
+	double best_cost = btb;
+	memset(term, 0, ALLAN_TERMS * sizeof(double));
+
+	for (uint8_t mask = 1; mask < (1 << ALLAN_TERMS); mask++)
+	{
+		double m[ALLAN_TERMS][ALLAN_TERMS + 1];
+		uint8_t idx[ALLAN_TERMS];
+		uint8_t num = 0;
+
+		for (uint8_t i = 0; i < ALLAN_TERMS; i++)
+		{
+			if (mask & (1 << i))
+			{
+				idx[num++] = i;
+			}
+		}
+
+		for (uint8_t i = 0; i < num; i++)
+		{
+			for (uint8_t j = 0; j < num; j++)
+			{
+				m[i][j] = ata[idx[i]][idx[j]];
+			}
+			m[i][num] = atb[idx[i]];
+		}
+
+		/* Gauss-Jordan on the normal equations */
+		uint8_t solved = 1;
+		for (uint8_t c = 0; (c < num) && solved; c++)
+		{
+			uint8_t pivot = c;
+			for (uint8_t r = c + 1; r < num; r++)
+			{
+				if (fabs(m[r][c]) > fabs(m[pivot][c]))
+				{
+					pivot = r;
+				}
+			}
+			if (fabs(m[pivot][c]) < 1e-300)
+			{
+				solved = 0;
+				break;
+			}
+			for (uint8_t j = 0; j <= num; j++)
+			{
+				double t = m[c][j];
+				m[c][j] = m[pivot][j];
+				m[pivot][j] = t;
+			}
+			for (uint8_t r = 0; r < num; r++)
+			{
+				if (r == c)
+				{
+					continue;
+				}
+				double f = m[r][c] / m[c][c];
+				for (uint8_t j = c; j <= num; j++)
+				{
+					m[r][j] -= f * m[c][j];
+				}
+			}
+		}
+
+		double x[ALLAN_TERMS] = {0};
+		for (uint8_t i = 0; (i < num) && solved; i++)
+		{
+			x[idx[i]] = m[i][num] / m[i][i];
+			solved = (x[idx[i]] >= 0);
+		}
+		if (!solved)
+		{
+			continue;
+		}
+
+		/* |A x - b|^2 from the normal equations */
+		double cost = btb;
+		for (uint8_t i = 0; i < ALLAN_TERMS; i++)
+		{
+			cost -= 2.0 * x[i] * atb[i];
+			for (uint8_t j = 0; j < ALLAN_TERMS; j++)
+			{
+				cost += x[i] * ata[i][j] * x[j];
+			}
+		}
+
+		if (cost < best_cost)
+		{
+			best_cost = cost;
+			memcpy(term, x, sizeof(x));
+		}
+	}
+}
+
+imu_allan_handle_t imu_allan_init(void)
+{
+	imu_allan_handle_t handle = calloc(1, sizeof(imu_allan_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_allan_set_config(imu_allan_handle_t handle, imu_allan_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (config.sample_rate_hz <= 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->cfg = config;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_allan_config(imu_allan_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	memset(handle->level, 0, sizeof(handle->level));
+	handle->started = 0;
+	memset(&handle->status, 0, sizeof(imu_allan_status_t));
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_allan_write(imu_allan_handle_t handle, const imu_sample_t *samples, uint16_t num_samples)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	for (uint16_t i = 0; i < num_samples; i++)
+	{
+		const imu_sample_t *s = &samples[i];
+		double accel = (double)(2 << s->accel_range) / 32768.0 * ALLAN_G;
+		double gyro = (double)(250 << s->gyro_range) / 32768.0 * ALLAN_DEG_TO_RAD;
+		double y[IMU_ALLAN_AXIS_MAX] = {
+			s->accel_raw_x * accel, s->accel_raw_y * accel, s->accel_raw_z * accel,
+			s->gyro_raw_x * gyro, s->gyro_raw_y * gyro, s->gyro_raw_z * gyro,
+		};
+
+		imu_allan_input(handle, s->seq, y);
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_allan_write_scale(imu_allan_handle_t handle, const imu_sample_scale_t *samples, uint16_t num_samples)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	for (uint16_t i = 0; i < num_samples; i++)
+	{
+		const imu_sample_scale_t *s = &samples[i];
+		double y[IMU_ALLAN_AXIS_MAX] = {
+			s->accel_x * ALLAN_G, s->accel_y * ALLAN_G, s->accel_z * ALLAN_G,
+			s->gyro_x * ALLAN_DEG_TO_RAD, s->gyro_y * ALLAN_DEG_TO_RAD, s->gyro_z * ALLAN_DEG_TO_RAD,
+		};
+
+		imu_allan_input(handle, s->seq, y);
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_allan_get_curve(imu_allan_handle_t handle, imu_allan_axis_t axis, imu_allan_point_t *points,
+                               uint8_t max_points, uint8_t *num_points)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (points == NULL) || (num_points == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (axis >= IMU_ALLAN_AXIS_MAX)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	*num_points = 0;
+
+	for (uint8_t k = 0; (k < IMU_ALLAN_MAX_LEVELS) && (*num_points < max_points); k++)
+	{
+		const imu_allan_level_t *l = &handle->level[k];
+
+		if (l->diffs == 0)
+		{
+			continue;
+		}
+
+		imu_allan_point_t *p = &points[(*num_points)++];
+		p->tau_s = (float)((double)(1UL << k) / handle->cfg.sample_rate_hz);
+		p->adev = (float)sqrt(l->sum_sq[axis] / (2.0 * l->diffs));
+		p->diffs = l->diffs;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_allan_get_result(imu_allan_handle_t handle, imu_allan_result_t *result)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (result == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	uint32_t min_diffs = (handle->cfg.min_diffs != 0) ? handle->cfg.min_diffs : IMU_ALLAN_MIN_DIFFS_DEFAULT;
+
+	memset(result, 0, sizeof(imu_allan_result_t));
+	result->samples = handle->status.samples;
+
+	for (uint8_t k = 0; k < IMU_ALLAN_MAX_LEVELS; k++)
+	{
+		result->levels += (handle->level[k].diffs >= min_diffs) ? 1 : 0;
+	}
+
+	for (uint8_t a = 0; a < IMU_ALLAN_AXIS_MAX; a++)
+	{
+		imu_allan_noise_t *n = &result->axis[a];
+		double term[ALLAN_TERMS];
+		double adev_min = 0;
+
+		imu_allan_fit(handle, a, min_diffs, term);
+		n->random_walk = (float)sqrt(term[0]);
+		n->bias_instability = (float)sqrt(term[1]);
+		n->rate_random_walk = (float)sqrt(term[2]);
+
+		for (uint8_t k = 0; k < IMU_ALLAN_MAX_LEVELS; k++)
+		{
+			const imu_allan_level_t *l = &handle->level[k];
+			if (l->diffs < min_diffs)
+			{
+				continue;
+			}
+
+			double adev = sqrt(l->sum_sq[a] / (2.0 * l->diffs));
+			if ((n->tau_bias_s == 0) || (adev < adev_min))
+			{
+				adev_min = adev;
+				n->tau_bias_s = (float)((double)(1UL << k) / handle->cfg.sample_rate_hz);
+			}
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_allan_to_preint_noise(const imu_allan_result_t *result, imu_preint_noise_t *noise)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((result == NULL) || (noise == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (result->levels == 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	memset(noise, 0, sizeof(imu_preint_noise_t));
+
+	for (uint8_t a = 0; a < 3; a++)
+	{
+		const imu_allan_noise_t *accel = &result->axis[IMU_ALLAN_ACCEL_X + a];
+		const imu_allan_noise_t *gyro = &result->axis[IMU_ALLAN_GYRO_X + a];
+
+		noise->accel_noise_density = fmaxf(noise->accel_noise_density, accel->random_walk);
+		noise->accel_bias_rw = fmaxf(noise->accel_bias_rw, accel->rate_random_walk);
+		noise->gyro_noise_density = fmaxf(noise->gyro_noise_density, gyro->random_walk);
+		noise->gyro_bias_rw = fmaxf(noise->gyro_bias_rw, gyro->rate_random_walk);
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_allan_get_status(imu_allan_handle_t handle, imu_allan_status_t *status)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (status == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*status = handle->status;
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,227 @@
+#ifndef __IMU_ALLAN_H__
+#define __IMU_ALLAN_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+#include "imu_preint/imu_preint.h"
+
+#define IMU_ALLAN_MAX_LEVELS            32          /*!< Cluster times 1, 2, 4 .. 2^31 sample periods */
+#define IMU_ALLAN_MIN_DIFFS_DEFAULT     8           /*!< Cluster differences a level needs to enter the fit, when min_diffs is 0 */
+
+typedef struct imu_allan* imu_allan_handle_t;
+
+/**
+ * @brief   Analysed axis.
+ */
+typedef enum {
+    IMU_ALLAN_ACCEL_X = 0,                                  /*!< Accelerometer x axis, in m/s^2 */
+    IMU_ALLAN_ACCEL_Y,                                      /*!< Accelerometer y axis, in m/s^2 */
+    IMU_ALLAN_ACCEL_Z,                                      /*!< Accelerometer z axis, in m/s^2 */
+    IMU_ALLAN_GYRO_X,                                       /*!< Gyroscope x axis, in rad/s */
+    IMU_ALLAN_GYRO_Y,                                       /*!< Gyroscope y axis, in rad/s */
+    IMU_ALLAN_GYRO_Z,                                       /*!< Gyroscope z axis, in rad/s */
+    IMU_ALLAN_AXIS_MAX
+} imu_allan_axis_t;
+
+/**
+ * @brief   One point of the Allan deviation curve.
+ */
+typedef struct {
+    float                       tau_s;                      /*!< Cluster time */
+    float                       adev;                       /*!< Allan deviation */
+    uint32_t                    diffs;                      /*!< Cluster differences averaged, the relative error is about 1 / sqrt(2 diffs) */
+} imu_allan_point_t;
+
+/**
+ * @brief   Noise terms of one axis, from a weighted least squares fit of
+ *          the three slopes to the Allan variance. A term the curve does
+ *          not support is 0.
+ */
+typedef struct {
+    float                       random_walk;                /*!< White noise density, slope -1/2 read at 1 s, per sqrt(Hz) */
+    float                       bias_instability;           /*!< Flicker floor over 0.664 */
+    float                       tau_bias_s;                 /*!< Cluster time of the measured curve minimum */
+    float                       rate_random_walk;           /*!< Bias random walk density, slope +1/2 read at 3 s, per s per sqrt(Hz) */
+} imu_allan_noise_t;
+
+/**
+ * @brief   Noise terms of all axes.
+ */
+typedef struct {
+    imu_allan_noise_t           axis[IMU_ALLAN_AXIS_MAX];   /*!< Per axis, in the units of imu_allan_axis_t */
+    uint64_t                    samples;                    /*!< Samples analysed */
+    uint8_t                     levels;                     /*!< Levels with enough differences for the fit */
+} imu_allan_result_t;
+
+/**
+ * @brief   Allan variance configuration structure.
+ */
+typedef struct {
+    float                       sample_rate_hz;             /*!< Sample rate, sets the shortest cluster time */
+    uint32_t                    min_diffs;                  /*!< Cluster differences a level needs to enter the fit, 0 for IMU_ALLAN_MIN_DIFFS_DEFAULT */
+} imu_allan_cfg_t;
+
+/**
+ * @brief   Allan variance status structure.
+ */
+typedef struct {
+    uint64_t                    samples;                    /*!< Samples analysed */
+    uint32_t                    gaps;                       /*!< Sequence gaps, the clusters around a gap are dropped */
+    uint8_t                     levels;                     /*!< Levels with at least one cluster difference */
+} imu_allan_status_t;
+
+/*
+ * @brief   Initialize Allan variance.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_allan_handle_t imu_allan_init(void);
+
+/*
+ * @brief   Set Allan variance configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_allan_set_config(imu_allan_handle_t handle, imu_allan_cfg_t config);
+
+/*
+ * @brief   Configure Allan variance. Clears all clusters and the status.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_allan_config(imu_allan_handle_t handle);
+
+/*
+ * @brief   Add raw samples, as returned by imu_read_fifo or
+ *          imu_log_reader_next. Raw data is scaled with the range tags of
+ *          each sample, constant biases do not change the result.
+ *
+ * @note    Level k averages clusters of 2^k samples. Every level keeps the
+ *          previous cluster, half of the next one and the sum of squared
+ *          differences of consecutive clusters, so memory does not grow with
+ *          the record length. A sample touches two levels on average.
+ *          Clusters do not overlap, long cluster times are less certain
+ *          than with an offline overlapping estimate.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Samples.
+ * @param   num_samples Number of samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_allan_write(imu_allan_handle_t handle, const imu_sample_t *samples, uint16_t num_samples);
+
+/*
+ * @brief   Add scaled samples, as returned by imu_scale_sample.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Samples.
+ * @param   num_samples Number of samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_allan_write_scale(imu_allan_handle_t handle, const imu_sample_scale_t *samples, uint16_t num_samples);
+
+/*
+ * @brief   Get the Allan deviation curve of an axis, shortest cluster time
+ *          first. Levels without cluster differences are left out.
+ *
+ * @param   handle Handle structure.
+ * @param   axis Axis.
+ * @param   points Curve points.
+ * @param   max_points Size of points.
+ * @param   num_points Number of points written.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_allan_get_curve(imu_allan_handle_t handle, imu_allan_axis_t axis, imu_allan_point_t *points,
+                               uint8_t max_points, uint8_t *num_points);
+
+/*
+ * @brief   Get the noise terms of all axes.
+ *
+ * @param   handle Handle structure.
+ * @param   result Noise terms.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_allan_get_result(imu_allan_handle_t handle, imu_allan_result_t *result);
+
+/*
+ * @brief   Convert noise terms to pre-integration noise, the largest term of
+ *          the three axes of each sensor. Pass to imu_preint_set_config.
+ *
+ * @param   result Noise terms.
+ * @param   noise Pre-integration noise.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_allan_to_preint_noise(const imu_allan_result_t *result, imu_preint_noise_t *noise);
+
+/*
+ * @brief   Get Allan variance status.
+ *
+ * @param   handle Handle structure.
+ * @param   status Status.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_allan_get_status(imu_allan_handle_t handle, imu_allan_status_t *status);
+
+/*
+ * @brief   Analyse recorded logs, one handle per log, on a pool of threads.
+ *          Host only, built from imu_allan_logs.c with the log reader and
+ *          pthreads.
+ *
+ * @note    Threads take the next unprocessed log until none is left, a
+ *          failed log does not stop the others. The sample rate of each log
+ *          comes from its header.
+ *
+ * @param   paths Log file paths.
+ * @param   num_logs Number of logs.
+ * @param   num_threads Worker threads, 0 for one per online CPU.
+ * @param   results Noise terms per log.
+ * @param   errors Result per log, may be NULL.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Every log was analysed.
+ *      - Others:           Fail.
+ */
+err_code_t imu_allan_process_logs(const char *const *paths, uint32_t num_logs, uint8_t num_threads,
+                                  imu_allan_result_t *results, err_code_t *errors);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_ALLAN_H__ */
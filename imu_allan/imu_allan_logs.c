@@ -0,0 +1,182 @@
+#include "stdlib.h"
+#include "string.h"
+#include "unistd.h"
+#include "pthread.h"
+#include "stdatomic.h"
+
+#include "imu_allan/imu_allan.h"
+#include "imu_log/imu_log.h"
+
+#define ALLAN_LOGS_MAX_THREADS 		64
+#define ALLAN_LOGS_BATCH 			256 		/*!< Samples per imu_allan_write call */
+
+
+typedef struct {
+	const char *const 			*paths; 					/*!< Log file paths */
+	uint32_t 					num_logs; 					/*!< Number of logs */
+	imu_allan_result_t 			*results; 					/*!< Noise terms per log */
+	err_code_t 					*errors; 					/*!< Result per log */
+	atomic_uint 				next; 						/*!< Next log to take */
+	atomic_uint 				failed; 					/*!< Logs that failed */
+} imu_allan_logs_t;
+
+static err_code_t imu_allan_logs_analyse(imu_log_reader_handle_t reader, imu_allan_handle_t allan,
+                                         imu_allan_result_t *result)
+{
+	imu_log_header_t header;
+
+	if ((imu_log_reader_get_header(reader, &header) != ERR_CODE_SUCCESS) || (header.sample_period_us <= 0))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	imu_allan_cfg_t allan_cfg = {
+		.sample_rate_hz = 1e6f / header.sample_period_us,
+		.min_diffs = 0,
+	};
+
+	err_code_t err = imu_allan_set_config(allan, allan_cfg);
+	if (err == ERR_CODE_SUCCESS)
+	{
+		err = imu_allan_config(allan);
+	}
+
+	imu_sample_t batch[ALLAN_LOGS_BATCH];
+	uint16_t count = 0;
+	uint8_t channels;
+	bool end = false;
+
+	while ((err == ERR_CODE_SUCCESS) && !end)
+	{
+		err = imu_log_reader_next(reader, &batch[count], &channels, &end);
+		if ((err == ERR_CODE_SUCCESS) && !end)
+		{
+			count++;
+		}
+
+		if ((count == ALLAN_LOGS_BATCH) || ((count != 0) && end))
+		{
+			imu_allan_write(allan, batch, count);
+			count = 0;
+		}
+	}
+
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	return imu_allan_get_result(allan, result);
+}
+
+static err_code_t imu_allan_logs_one(const char *path, imu_allan_result_t *result)
+{
+	imu_log_reader_handle_t reader = imu_log_reader_init();
+	imu_allan_handle_t allan = imu_allan_init();
+	imu_log_reader_cfg_t reader_cfg = {.path = path};
+	err_code_t err = ERR_CODE_FAIL;
+
+	if ((reader != NULL) && (allan != NULL))
+	{
+		err = imu_log_reader_set_config(reader, reader_cfg);
+		if (err == ERR_CODE_SUCCESS)
+		{
+			err = imu_log_reader_config(reader);
+		}
+	}
+
+	if (err == ERR_CODE_SUCCESS)
+	{
+		err = imu_allan_logs_analyse(reader, allan, result);
+	}
+
+	if (reader != NULL)
+	{
+		imu_log_reader_deinit(reader);
+	}
+	free(allan);
+
+	return err;
+}
+
+static void *imu_allan_logs_worker(void *arg)
+{
+	imu_allan_logs_t *logs = (imu_allan_logs_t *)arg;
+
+	for (;;)
+	{
+		uint32_t i = atomic_fetch_add(&logs->next, 1);
+		if (i >= logs->num_logs)
+		{
+			break;
+		}
+
+		err_code_t err = imu_allan_logs_one(logs->paths[i], &logs->results[i]);
+		if (err != ERR_CODE_SUCCESS)
+		{
+			memset(&logs->results[i], 0, sizeof(imu_allan_result_t));
+			atomic_fetch_add(&logs->failed, 1);
+		}
+		if (logs->errors != NULL)
+		{
+			logs->errors[i] = err;
+		}
+	}
+
+	return NULL;
+}
+
+err_code_t imu_allan_process_logs(const char *const *paths, uint32_t num_logs, uint8_t num_threads,
+                                  imu_allan_result_t *results, err_code_t *errors)
+{
+	/* Check if pointer data is NULL */
+	if ((paths == NULL) || (results == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	imu_allan_logs_t logs = {
+		.paths = paths,
+		.num_logs = num_logs,
+		.results = results,
+		.errors = errors,
+	};
+	atomic_init(&logs.next, 0);
+	atomic_init(&logs.failed, 0);
+
+	uint32_t threads = num_threads;
+	if (threads == 0)
+	{
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? (uint32_t)cpus : 1;
+	}
+	if (threads > ALLAN_LOGS_MAX_THREADS)
+	{
+		threads = ALLAN_LOGS_MAX_THREADS;
+	}
+	if (threads > num_logs)
+	{
+		threads = num_logs;
+	}
+
+	pthread_t thread[ALLAN_LOGS_MAX_THREADS];
+	uint32_t started = 0;
+
+	/* The calling thread works too, so a failed thread start only slows down */
+	for (uint32_t t = 1; t < threads; t++)
+	{
+		if (pthread_create(&thread[started], NULL, imu_allan_logs_worker, &logs) == 0)
+		{
+			started++;
+		}
+	}
+
+	imu_allan_logs_worker(&logs);
+
+	for (uint32_t t = 0; t < started; t++)
+	{
+		pthread_join(thread[t], NULL);
+	}
+
+	return (atomic_load(&logs.failed) == 0) ? ERR_CODE_SUCCESS : ERR_CODE_FAIL;
+}
@@ -0,0 +1,356 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+#include "math.h"
+
+#include "imu_array/imu_array.h"
+
+
+#define ARRAY_NUM_AXIS 				6 			/*!< Accelerometer x, y, z and gyroscope x, y, z */
+#define ARRAY_OUTLIER_SIGMA_DEFAULT 4.0f
+#define ARRAY_VAR_FORGET_DEFAULT 	0.999f
+#define ARRAY_VAR_MIN 				1e-9f 		/*!< Lower bound of variance estimates */
+#define ARRAY_MAX_SKEW_PERIODS 		2 			/*!< Default maximum sample age in sample periods of the slowest IMU */
+
+
+typedef struct {
+	uint64_t 					timestamp_us; 				/*!< Sample timestamp */
+	float 						axis[ARRAY_NUM_AXIS]; 		/*!< Sample in array frame */
+} array_point_t;
+
+typedef struct imu_array {
+	uint8_t 					num_imu; 					/*!< Number of IMUs */
+	imu_handle_t 				imu[IMU_ARRAY_MAX_IMU]; 	/*!< IMU handles */
+	float 						rotation[IMU_ARRAY_MAX_IMU][9];	/*!< Mounting rotation */
+	float 						init_var[IMU_ARRAY_MAX_IMU][2]; 	/*!< Initial accelerometer and gyroscope variance */
+	float 						outlier_sigma; 				/*!< Outlier threshold */
+	float 						var_forget_factor; 			/*!< Variance forget factor */
+	uint32_t 					cfg_max_skew_us; 			/*!< Configured maximum sample age, 0 for default */
+	uint32_t 					max_skew_us; 				/*!< Maximum sample age */
+	array_point_t 				prev[IMU_ARRAY_MAX_IMU]; 	/*!< Previous sample of every IMU */
+	array_point_t 				curr[IMU_ARRAY_MAX_IMU]; 	/*!< Latest sample of every IMU */
+	uint8_t 					num_valid[IMU_ARRAY_MAX_IMU];	/*!< Number of valid samples in prev and curr, up to 2 */
+	uint64_t 					last_output_us; 			/*!< Time of the last fused sample */
+	uint32_t 					seq; 						/*!< Fused sample counter */
+	imu_array_status_t 			status; 					/*!< Status */
+} imu_array_t;
+
+static void imu_array_rotate(const float *r, float x, float y, float z, float *out)
+{
+	out[0] = r[0] * x + r[1] * y + r[2] * z;
+	out[1] = r[3] * x + r[4] * y + r[5] * z;
+	out[2] = r[6] * x + r[7] * y + r[8] * z;
+}
+
+static float imu_array_median(float *value, uint8_t num)
+{
+	/* Insertion sort, num is at most IMU_ARRAY_MAX_IMU */
+	for (uint8_t i = 1; i < num; i++)
+	{
+		float v = value[i];
+		int8_t j = i - 1;
+		while ((j >= 0) && (value[j] > v))
+		{
+			value[j + 1] = value[j];
+			j--;
+		}
+		value[j + 1] = v;
+	}
+
+	return (num & 1) ? value[num / 2] : 0.5f * (value[num / 2 - 1] + value[num / 2]);
+}
+
+static void imu_array_interpolate(imu_array_handle_t handle, uint8_t idx, uint64_t time_us, float *out)
+{
+	const array_point_t *p0 = &handle->prev[idx];
+	const array_point_t *p1 = &handle->curr[idx];
+	float alpha = 1.0f;
+
+	if ((handle->num_valid[idx] > 1) && (p1->timestamp_us > p0->timestamp_us))
+	{
+		alpha = (float)(int64_t)(time_us - p0->timestamp_us) / (float)(p1->timestamp_us - p0->timestamp_us);
+		alpha = (alpha < 0.0f) ? 0.0f : ((alpha > 1.0f) ? 1.0f : alpha);
+	}
+
+	for (uint8_t a = 0; a < ARRAY_NUM_AXIS; a++)
+	{
+		out[a] = p0->axis[a] + alpha * (p1->axis[a] - p0->axis[a]);
+	}
+}
+
+imu_array_handle_t imu_array_init(void)
+{
+	imu_array_handle_t handle = calloc(1, sizeof(imu_array_t));
+
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_array_set_config(imu_array_handle_t handle, imu_array_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((config.num_imu == 0) || (config.num_imu > IMU_ARRAY_MAX_IMU))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	for (uint8_t i = 0; i < config.num_imu; i++)
+	{
+		if (config.imu[i] == NULL)
+		{
+			return ERR_CODE_NULL_PTR;
+		}
+
+		handle->imu[i] = config.imu[i];
+		memcpy(handle->rotation[i], config.rotation[i], sizeof(handle->rotation[i]));
+		handle->init_var[i][0] = (config.accel_var[i] > ARRAY_VAR_MIN) ? config.accel_var[i] : ARRAY_VAR_MIN;
+		handle->init_var[i][1] = (config.gyro_var[i] > ARRAY_VAR_MIN) ? config.gyro_var[i] : ARRAY_VAR_MIN;
+	}
+
+	handle->num_imu = config.num_imu;
+	handle->outlier_sigma = (config.outlier_sigma > 0) ? config.outlier_sigma : ARRAY_OUTLIER_SIGMA_DEFAULT;
+	handle->var_forget_factor = ((config.var_forget_factor > 0) && (config.var_forget_factor <= 1)) ?
+	                            config.var_forget_factor : ARRAY_VAR_FORGET_DEFAULT;
+	handle->cfg_max_skew_us = config.max_skew_us;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_array_config(imu_array_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	memset(handle->num_valid, 0, sizeof(handle->num_valid));
+	memset(&handle->status, 0, sizeof(handle->status));
+	handle->last_output_us = 0;
+	handle->seq = 0;
+	handle->max_skew_us = handle->cfg_max_skew_us;
+
+	/* Samples are aligned by timestamp, an IMU without a timestamp source
+	 * would stamp everything 0 and stop the output after the first sample.
+	 */
+	for (uint8_t i = 0; i < handle->num_imu; i++)
+	{
+		float drift_ppm;
+
+		if (imu_get_clock_drift(handle->imu[i], &drift_ppm) != ERR_CODE_SUCCESS)
+		{
+			return ERR_CODE_FAIL;
+		}
+	}
+
+	/* Without a limit a stalled IMU would hold the common time back forever */
+	if (handle->max_skew_us == 0)
+	{
+		float max_period_us = 0;
+
+		for (uint8_t i = 0; i < handle->num_imu; i++)
+		{
+			float period_us;
+
+			if (imu_get_sample_period(handle->imu[i], &period_us) != ERR_CODE_SUCCESS)
+			{
+				return ERR_CODE_FAIL;
+			}
+			max_period_us = (period_us > max_period_us) ? period_us : max_period_us;
+		}
+
+		handle->max_skew_us = (uint32_t)(ARRAY_MAX_SKEW_PERIODS * max_period_us);
+	}
+
+	for (uint8_t i = 0; i < handle->num_imu; i++)
+	{
+		handle->status.accel_var[i] = handle->init_var[i][0];
+		handle->status.gyro_var[i] = handle->init_var[i][1];
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_array_update(imu_array_handle_t handle, imu_sample_scale_t *sample, bool *data_ready)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (sample == NULL) || (data_ready == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*data_ready = false;
+
+	/* Acquire: poll every IMU back to back to keep their reads within one period */
+	for (uint8_t i = 0; i < handle->num_imu; i++)
+	{
+		imu_sample_t raw;
+		imu_sample_scale_t scale;
+		bool ready;
+
+		if (imu_poll_sample(handle->imu[i], &raw, &ready) != ERR_CODE_SUCCESS)
+		{
+			handle->status.poll_errors[i]++;
+			continue;
+		}
+
+		if (ready == false)
+		{
+			continue;
+		}
+
+		imu_scale_sample(handle->imu[i], &raw, &scale);
+
+		handle->prev[i] = handle->curr[i];
+		handle->curr[i].timestamp_us = scale.timestamp_us;
+		imu_array_rotate(handle->rotation[i], scale.accel_x, scale.accel_y, scale.accel_z, &handle->curr[i].axis[0]);
+		imu_array_rotate(handle->rotation[i], scale.gyro_x, scale.gyro_y, scale.gyro_z, &handle->curr[i].axis[3]);
+		if (handle->num_valid[i] < 2)
+		{
+			handle->num_valid[i]++;
+		}
+	}
+
+	/* Align: common time is the oldest of the latest samples, so every IMU
+	 * is interpolated and none extrapolated.
+	 */
+	uint64_t fuse_time_us = UINT64_MAX;
+	uint64_t newest_us = 0;
+	for (uint8_t i = 0; i < handle->num_imu; i++)
+	{
+		if (handle->num_valid[i] == 0)
+		{
+			continue;
+		}
+		newest_us = (handle->curr[i].timestamp_us > newest_us) ? handle->curr[i].timestamp_us : newest_us;
+	}
+	for (uint8_t i = 0; i < handle->num_imu; i++)
+	{
+		if ((handle->num_valid[i] == 0) || ((newest_us - handle->curr[i].timestamp_us) > handle->max_skew_us))
+		{
+			continue;
+		}
+		fuse_time_us = (handle->curr[i].timestamp_us < fuse_time_us) ? handle->curr[i].timestamp_us : fuse_time_us;
+	}
+
+	if ((fuse_time_us == UINT64_MAX) || ((handle->seq != 0) && (fuse_time_us <= handle->last_output_us)))
+	{
+		return ERR_CODE_SUCCESS;
+	}
+
+	float value[IMU_ARRAY_MAX_IMU][ARRAY_NUM_AXIS];
+	uint8_t member[IMU_ARRAY_MAX_IMU];
+	uint8_t num = 0;
+
+	for (uint8_t i = 0; i < handle->num_imu; i++)
+	{
+		if ((handle->num_valid[i] == 0) || ((newest_us - handle->curr[i].timestamp_us) > handle->max_skew_us))
+		{
+			handle->status.stale[i]++;
+			continue;
+		}
+
+		imu_array_interpolate(handle, i, fuse_time_us, value[num]);
+		member[num++] = i;
+	}
+
+	/* Fuse: inverse variance weighted mean of the axes close to the median */
+	float fused[ARRAY_NUM_AXIS];
+	uint8_t used_mask[2] = {0, 0};
+
+	for (uint8_t a = 0; a < ARRAY_NUM_AXIS; a++)
+	{
+		uint8_t sensor = (a < 3) ? 0 : 1;
+		float sorted[IMU_ARRAY_MAX_IMU];
+		float sum_w = 0, sum_wv = 0;
+
+		for (uint8_t k = 0; k < num; k++)
+		{
+			sorted[k] = value[k][a];
+		}
+		float median = imu_array_median(sorted, num);
+
+		for (uint8_t k = 0; k < num; k++)
+		{
+			uint8_t i = member[k];
+			float var = sensor ? handle->status.gyro_var[i] : handle->status.accel_var[i];
+			float r = value[k][a] - median;
+
+			if ((num > 2) && ((r * r) > (handle->outlier_sigma * handle->outlier_sigma * var)))
+			{
+				handle->status.rejected[i]++;
+				continue;
+			}
+
+			sum_w += 1.0f / var;
+			sum_wv += value[k][a] / var;
+			used_mask[sensor] |= (uint8_t)(1 << i);
+		}
+
+		fused[a] = (sum_w > 0) ? (sum_wv / sum_w) : median;
+	}
+
+	/* Track each IMU noise from its residual to the fused value */
+	float f = handle->var_forget_factor;
+	for (uint8_t k = 0; (k < num) && (f < 1.0f); k++)
+	{
+		uint8_t i = member[k];
+		float r_accel = 0, r_gyro = 0;
+
+		for (uint8_t a = 0; a < 3; a++)
+		{
+			r_accel += (value[k][a] - fused[a]) * (value[k][a] - fused[a]);
+			r_gyro += (value[k][a + 3] - fused[a + 3]) * (value[k][a + 3] - fused[a + 3]);
+		}
+
+		if (used_mask[0] & (1 << i))
+		{
+			handle->status.accel_var[i] = fmaxf(f * handle->status.accel_var[i] + (1.0f - f) * r_accel / 3.0f, ARRAY_VAR_MIN);
+		}
+		if (used_mask[1] & (1 << i))
+		{
+			handle->status.gyro_var[i] = fmaxf(f * handle->status.gyro_var[i] + (1.0f - f) * r_gyro / 3.0f, ARRAY_VAR_MIN);
+		}
+	}
+
+	handle->status.accel_used_mask = used_mask[0];
+	handle->status.gyro_used_mask = used_mask[1];
+
+	memset(sample, 0, sizeof(imu_sample_scale_t));
+	sample->seq = handle->seq++;
+	sample->timestamp_us = fuse_time_us;
+	sample->accel_x = fused[0];
+	sample->accel_y = fused[1];
+	sample->accel_z = fused[2];
+	sample->gyro_x = fused[3];
+	sample->gyro_y = fused[4];
+	sample->gyro_z = fused[5];
+
+	handle->last_output_us = fuse_time_us;
+	*data_ready = true;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_array_get_status(imu_array_handle_t handle, imu_array_status_t *status)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (status == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*status = handle->status;
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,115 @@
+#ifndef __IMU_ARRAY_H__
+#define __IMU_ARRAY_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+
+#define IMU_ARRAY_MAX_IMU           8           /*!< Maximum number of IMUs in an array */
+
+typedef struct imu_array* imu_array_handle_t;
+
+/**
+ * @brief   IMU array configuration structure.
+ */
+typedef struct {
+    uint8_t                     num_imu;                                /*!< Number of IMUs */
+    imu_handle_t                imu[IMU_ARRAY_MAX_IMU];                 /*!< Configured IMU handles with timestamp source, biases are applied per IMU */
+    float                       rotation[IMU_ARRAY_MAX_IMU][9];         /*!< Row major mounting rotation from IMU frame to array frame */
+    float                       accel_var[IMU_ARRAY_MAX_IMU];           /*!< Initial accelerometer noise variance in g^2 */
+    float                       gyro_var[IMU_ARRAY_MAX_IMU];            /*!< Initial gyroscope noise variance in (deg/s)^2 */
+    float                       outlier_sigma;                          /*!< Reject an axis further than this many standard deviations from the median */
+    float                       var_forget_factor;                      /*!< Weight of past residuals in the variance estimate, 1 keeps the initial variance */
+    uint32_t                    max_skew_us;                            /*!< Samples older than this relative to the newest are not used, 0 for two sample periods of the slowest IMU */
+} imu_array_cfg_t;
+
+/**
+ * @brief   IMU array status structure.
+ */
+typedef struct {
+    uint8_t                     accel_used_mask;                        /*!< Bit i set if IMU i accelerometer was used in the last output */
+    uint8_t                     gyro_used_mask;                         /*!< Bit i set if IMU i gyroscope was used in the last output */
+    float                       accel_var[IMU_ARRAY_MAX_IMU];           /*!< Current accelerometer variance estimate */
+    float                       gyro_var[IMU_ARRAY_MAX_IMU];            /*!< Current gyroscope variance estimate */
+    uint32_t                    rejected[IMU_ARRAY_MAX_IMU];            /*!< Number of rejected axes per IMU */
+    uint32_t                    stale[IMU_ARRAY_MAX_IMU];               /*!< Number of outputs an IMU missed because its data was too old or failed */
+    uint32_t                    poll_errors[IMU_ARRAY_MAX_IMU];         /*!< Number of failed polls per IMU */
+} imu_array_status_t;
+
+/*
+ * @brief   Initialize IMU array with default parameters.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_array_handle_t imu_array_init(void);
+
+/*
+ * @brief   Set IMU array parameters.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_array_set_config(imu_array_handle_t handle, imu_array_cfg_t config);
+
+/*
+ * @brief   Configure IMU array. Clear sample history and variance estimates.
+ *
+ * @note    The IMUs must be configured with a timestamp source, samples are
+ *          aligned by timestamp. The default maximum sample age is taken from
+ *          their sample periods.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_array_config(imu_array_handle_t handle);
+
+/*
+ * @brief   Read all IMUs and output one fused virtual IMU sample.
+ *
+ * @note    Every IMU is polled once. New samples are scaled, rotated into the
+ *          array frame and linearly interpolated to a common time, the oldest
+ *          of the latest IMU timestamps. Each axis is then fused with inverse
+ *          variance weights after rejecting outliers against the median.
+ *          Call at least once per sample period.
+ *
+ * @param   handle Handle structure.
+ * @param   sample Fused sample, timestamp is the common time.
+ * @param   data_ready Set to true if a new fused sample was produced.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_array_update(imu_array_handle_t handle, imu_sample_scale_t *sample, bool *data_ready);
+
+/*
+ * @brief   Get IMU array status.
+ *
+ * @param   handle Handle structure.
+ * @param   status Status structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_array_get_status(imu_array_handle_t handle, imu_array_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_ARRAY_H__ */
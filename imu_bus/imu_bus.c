@@ -0,0 +1,321 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+
+#include "imu_bus/imu_bus.h"
+
+#define REGMAP_SIZE 				256
+#define BUS_SLOT_GROUP 				4 			/*!< Slot functions are generated in groups of four */
+#define BUS_NUM_SLOT_FUNC 			((IMU_BUS_MAX_SLOT + BUS_SLOT_GROUP - 1) / BUS_SLOT_GROUP * BUS_SLOT_GROUP)
+
+#if (IMU_BUS_MAX_SLOT < 1) || (IMU_BUS_MAX_SLOT > 16)
+#error "IMU_BUS_MAX_SLOT must be 1 to 16"
+#endif
+
+
+typedef struct {
+	const imu_bus_ops_t 		*ops; 						/*!< Backend operations, NULL if unbound */
+	void 						*ctx; 						/*!< Backend context */
+} imu_bus_slot_t;
+
+typedef struct imu_bus_regmap {
+	uint8_t 					reg[REGMAP_SIZE]; 			/*!< Registers */
+	uint8_t 					read_flag; 					/*!< Register address bits removed from reads */
+	uint8_t 					clear_on_read_reg; 			/*!< Register cleared after read */
+	uint8_t 					clear_on_read_enable; 		/*!< Enable clear_on_read_reg */
+	imu_bus_regmap_stats_t 		stats; 						/*!< Statistics */
+} imu_bus_regmap_t;
+
+static imu_bus_slot_t imu_bus_slot[BUS_NUM_SLOT_FUNC];
+
+/* Each slot needs its own context free functions. They only look up the slot
+ * and forward, the slot table is the only state.
+ */
+#define IMU_BUS_SLOT_FUNC(n) 																				\
+static err_code_t imu_bus_read_bytes_##n(uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms) 	\
+{ 																											\
+	if (imu_bus_slot[n].ops == NULL) { 																		\
+		return ERR_CODE_FAIL; 																				\
+	} 																										\
+	return imu_bus_slot[n].ops->read_bytes(imu_bus_slot[n].ctx, reg_addr, buf, len, timeout_ms); 			\
+} 																											\
+static err_code_t imu_bus_write_bytes_##n(uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms) 	\
+{ 																											\
+	if (imu_bus_slot[n].ops == NULL) { 																		\
+		return ERR_CODE_FAIL; 																				\
+	} 																										\
+	return imu_bus_slot[n].ops->write_bytes(imu_bus_slot[n].ctx, reg_addr, buf, len, timeout_ms); 			\
+} 																											\
+static err_code_t imu_bus_transfer_##n(imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms) \
+{ 																											\
+	if ((imu_bus_slot[n].ops == NULL) || (imu_bus_slot[n].ops->transfer == NULL)) { 						\
+		return ERR_CODE_FAIL; 																				\
+	} 																										\
+	return imu_bus_slot[n].ops->transfer(imu_bus_slot[n].ctx, transfers, num_transfers, timeout_ms); 		\
+} 																											\
+static void imu_bus_set_bus_clock_##n(uint32_t clock_hz) 													\
+{ 																											\
+	if ((imu_bus_slot[n].ops != NULL) && (imu_bus_slot[n].ops->set_bus_clock != NULL)) { 					\
+		imu_bus_slot[n].ops->set_bus_clock(imu_bus_slot[n].ctx, clock_hz); 									\
+	} 																										\
+} 																											\
+static uint64_t imu_bus_get_time_us_##n(void) 																\
+{ 																											\
+	if ((imu_bus_slot[n].ops == NULL) || (imu_bus_slot[n].ops->get_time_us == NULL)) { 						\
+		return 0; 																							\
+	} 																										\
+	return imu_bus_slot[n].ops->get_time_us(imu_bus_slot[n].ctx); 											\
+}
+
+#define IMU_BUS_SLOT_FUNC_GROUP(a, b, c, d) 																	\
+	IMU_BUS_SLOT_FUNC(a) IMU_BUS_SLOT_FUNC(b) IMU_BUS_SLOT_FUNC(c) IMU_BUS_SLOT_FUNC(d)
+
+#define IMU_BUS_SLOT_ENTRY(n) 																				\
+	{imu_bus_read_bytes_##n, imu_bus_write_bytes_##n, imu_bus_transfer_##n, imu_bus_set_bus_clock_##n, imu_bus_get_time_us_##n}
+
+#define IMU_BUS_SLOT_ENTRY_GROUP(a, b, c, d) 																	\
+	IMU_BUS_SLOT_ENTRY(a), IMU_BUS_SLOT_ENTRY(b), IMU_BUS_SLOT_ENTRY(c), IMU_BUS_SLOT_ENTRY(d),
+
+IMU_BUS_SLOT_FUNC_GROUP(0, 1, 2, 3)
+#if IMU_BUS_MAX_SLOT > 4
+IMU_BUS_SLOT_FUNC_GROUP(4, 5, 6, 7)
+#endif
+#if IMU_BUS_MAX_SLOT > 8
+IMU_BUS_SLOT_FUNC_GROUP(8, 9, 10, 11)
+#endif
+#if IMU_BUS_MAX_SLOT > 12
+IMU_BUS_SLOT_FUNC_GROUP(12, 13, 14, 15)
+#endif
+
+static const imu_bus_func_t imu_bus_slot_func[BUS_NUM_SLOT_FUNC] = {
+	IMU_BUS_SLOT_ENTRY_GROUP(0, 1, 2, 3)
+#if IMU_BUS_MAX_SLOT > 4
+	IMU_BUS_SLOT_ENTRY_GROUP(4, 5, 6, 7)
+#endif
+#if IMU_BUS_MAX_SLOT > 8
+	IMU_BUS_SLOT_ENTRY_GROUP(8, 9, 10, 11)
+#endif
+#if IMU_BUS_MAX_SLOT > 12
+	IMU_BUS_SLOT_ENTRY_GROUP(12, 13, 14, 15)
+#endif
+};
+
+static err_code_t imu_bus_regmap_access(imu_bus_regmap_t *regmap, imu_transfer_t *transfer)
+{
+	uint8_t reg = transfer->reg_addr;
+
+	if (transfer->dir == IMU_TRANSFER_READ)
+	{
+		reg &= (uint8_t)~regmap->read_flag;
+	}
+
+	if ((transfer->buf == NULL) || ((reg + transfer->len) > REGMAP_SIZE))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	regmap->stats.bytes += transfer->len;
+
+	if (transfer->dir == IMU_TRANSFER_WRITE)
+	{
+		regmap->stats.writes++;
+		memcpy(&regmap->reg[reg], transfer->buf, transfer->len);
+		return ERR_CODE_SUCCESS;
+	}
+
+	regmap->stats.reads++;
+	memcpy(transfer->buf, &regmap->reg[reg], transfer->len);
+
+	if (regmap->clear_on_read_enable && (regmap->clear_on_read_reg >= reg) && (regmap->clear_on_read_reg < (reg + transfer->len)))
+	{
+		regmap->reg[regmap->clear_on_read_reg] = 0;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+static err_code_t imu_bus_regmap_read_bytes(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	imu_bus_regmap_t *regmap = (imu_bus_regmap_t *)ctx;
+	imu_transfer_t transfer = {reg_addr, buf, len, IMU_TRANSFER_READ};
+
+	(void)timeout_ms;
+
+	regmap->stats.calls++;
+
+	return imu_bus_regmap_access(regmap, &transfer);
+}
+
+static err_code_t imu_bus_regmap_write_bytes(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	imu_bus_regmap_t *regmap = (imu_bus_regmap_t *)ctx;
+	imu_transfer_t transfer = {reg_addr, buf, len, IMU_TRANSFER_WRITE};
+
+	(void)timeout_ms;
+
+	regmap->stats.calls++;
+
+	return imu_bus_regmap_access(regmap, &transfer);
+}
+
+static err_code_t imu_bus_regmap_transfer(void *ctx, imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms)
+{
+	imu_bus_regmap_t *regmap = (imu_bus_regmap_t *)ctx;
+	err_code_t err;
+
+	(void)timeout_ms;
+
+	/* The whole batch is one backend call */
+	regmap->stats.calls++;
+
+	for (uint8_t i = 0; i < num_transfers; i++)
+	{
+		err = imu_bus_regmap_access(regmap, &transfers[i]);
+		if (err != ERR_CODE_SUCCESS) {
+			return err;
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+static void imu_bus_regmap_set_bus_clock(void *ctx, uint32_t clock_hz)
+{
+	imu_bus_regmap_t *regmap = (imu_bus_regmap_t *)ctx;
+
+	regmap->stats.clock_hz = clock_hz;
+}
+
+static const imu_bus_ops_t imu_bus_regmap_ops = {
+	.read_bytes = imu_bus_regmap_read_bytes,
+	.write_bytes = imu_bus_regmap_write_bytes,
+	.transfer = imu_bus_regmap_transfer,
+	.set_bus_clock = imu_bus_regmap_set_bus_clock,
+	.get_time_us = NULL,
+};
+
+err_code_t imu_bus_bind(uint8_t slot, const imu_bus_ops_t *ops, void *ctx, imu_bus_func_t *func)
+{
+	/* Check if pointer data is NULL */
+	if ((ops == NULL) || (func == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((slot >= IMU_BUS_MAX_SLOT) || (ops->read_bytes == NULL) || (ops->write_bytes == NULL))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	imu_bus_slot[slot].ops = ops;
+	imu_bus_slot[slot].ctx = ctx;
+
+	*func = imu_bus_slot_func[slot];
+	if (ops->transfer == NULL)
+	{
+		func->transfer = NULL;
+	}
+	if (ops->set_bus_clock == NULL)
+	{
+		func->set_bus_clock = NULL;
+	}
+	if (ops->get_time_us == NULL)
+	{
+		func->get_time_us = NULL;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_bus_unbind(uint8_t slot)
+{
+	if (slot >= IMU_BUS_MAX_SLOT)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	imu_bus_slot[slot].ops = NULL;
+	imu_bus_slot[slot].ctx = NULL;
+
+	return ERR_CODE_SUCCESS;
+}
+
+imu_bus_regmap_handle_t imu_bus_regmap_init(void)
+{
+	imu_bus_regmap_handle_t handle = calloc(1, sizeof(imu_bus_regmap_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_bus_regmap_set_config(imu_bus_regmap_handle_t handle, imu_bus_regmap_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->read_flag = config.read_flag;
+	handle->clear_on_read_reg = config.clear_on_read_reg;
+	handle->clear_on_read_enable = config.clear_on_read_enable;
+
+	return ERR_CODE_SUCCESS;
+}
+
+const imu_bus_ops_t *imu_bus_regmap_get_ops(void)
+{
+	return &imu_bus_regmap_ops;
+}
+
+err_code_t imu_bus_regmap_set_reg(imu_bus_regmap_handle_t handle, uint8_t reg_addr, const uint8_t *buf, uint16_t len)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (buf == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((reg_addr + len) > REGMAP_SIZE)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	memcpy(&handle->reg[reg_addr], buf, len);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_bus_regmap_get_reg(imu_bus_regmap_handle_t handle, uint8_t reg_addr, uint8_t *buf, uint16_t len)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (buf == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((reg_addr + len) > REGMAP_SIZE)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	memcpy(buf, &handle->reg[reg_addr], len);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_bus_regmap_get_stats(imu_bus_regmap_handle_t handle, imu_bus_regmap_stats_t *stats)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (stats == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*stats = handle->stats;
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,168 @@
+#ifndef __IMU_BUS_H__
+#define __IMU_BUS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+
+#ifndef IMU_BUS_MAX_SLOT
+#define IMU_BUS_MAX_SLOT                16          /*!< Number of buses that can be bound at the same time, up to 16 */
+#endif
+
+typedef struct imu_bus_regmap* imu_bus_regmap_handle_t;
+
+/**
+ * @brief   Bus backend operations. Unlike the IMU transport functions every
+ *          operation receives the backend context, so one backend
+ *          implementation can serve several buses.
+ */
+typedef struct {
+    err_code_t (*read_bytes)(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms);       /*!< Read registers */
+    err_code_t (*write_bytes)(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms);      /*!< Write registers */
+    err_code_t (*transfer)(void *ctx, imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms);     /*!< Optional batched transfer */
+    void (*set_bus_clock)(void *ctx, uint32_t clock_hz);                                                            /*!< Optional bus clock select */
+    uint64_t (*get_time_us)(void *ctx);                                                                             /*!< Optional timestamp source of the backend */
+} imu_bus_ops_t;
+
+/**
+ * @brief   Transport functions of a bound bus, ready to be copied to imu_cfg_t.
+ */
+typedef struct {
+    imu_func_read_bytes         read_bytes;                 /*!< Read bytes */
+    imu_func_write_bytes        write_bytes;                /*!< Write bytes */
+    imu_func_transfer           transfer;                   /*!< Batched transfer, NULL if the backend has none */
+    imu_func_set_bus_clock      set_bus_clock;              /*!< Bus clock select, NULL if the backend has none */
+    imu_func_get_time_us        get_time_us;                /*!< Timestamp source, NULL if the backend has none */
+} imu_bus_func_t;
+
+/**
+ * @brief   Register map stand-in configuration structure.
+ */
+typedef struct {
+    uint8_t                     read_flag;                  /*!< Register address bits removed from reads, 0x80 to stand in for an SPI device */
+    uint8_t                     clear_on_read_reg;          /*!< Register cleared after it is read, like INT_STATUS */
+    uint8_t                     clear_on_read_enable;       /*!< Enable clear_on_read_reg */
+} imu_bus_regmap_cfg_t;
+
+/**
+ * @brief   Register map stand-in statistics structure.
+ */
+typedef struct {
+    uint32_t                    calls;                      /*!< Number of backend calls */
+    uint32_t                    reads;                      /*!< Number of register reads */
+    uint32_t                    writes;                     /*!< Number of register writes */
+    uint32_t                    bytes;                      /*!< Number of bytes transferred */
+    uint32_t                    clock_hz;                   /*!< Last selected bus clock */
+} imu_bus_regmap_stats_t;
+
+/*
+ * @brief   Bind a bus backend to a slot and get context free transport functions.
+ *
+ * @note    The IMU transport functions have no context pointer, each slot
+ *          owns a fixed set of functions that forward to ops with ctx.
+ *
+ * @param   slot Slot, less than IMU_BUS_MAX_SLOT.
+ * @param   ops Backend operations, must stay valid while bound.
+ * @param   ctx Backend context.
+ * @param   func Transport functions.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_bus_bind(uint8_t slot, const imu_bus_ops_t *ops, void *ctx, imu_bus_func_t *func);
+
+/*
+ * @brief   Unbind slot. Its transport functions fail afterwards.
+ *
+ * @param   slot Slot.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_bus_unbind(uint8_t slot);
+
+/*
+ * @brief   Initialize register map stand-in. An in-process bus of 256
+ *          registers for testing without hardware.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_bus_regmap_handle_t imu_bus_regmap_init(void);
+
+/*
+ * @brief   Set register map stand-in configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_bus_regmap_set_config(imu_bus_regmap_handle_t handle, imu_bus_regmap_cfg_t config);
+
+/*
+ * @brief   Get register map stand-in backend operations, ctx is the handle.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Backend operations.
+ */
+const imu_bus_ops_t *imu_bus_regmap_get_ops(void);
+
+/*
+ * @brief   Set registers directly, without counting a bus access.
+ *
+ * @param   handle Handle structure.
+ * @param   reg_addr First register address.
+ * @param   buf Data.
+ * @param   len Number of bytes, reg_addr + len must not exceed 256.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_bus_regmap_set_reg(imu_bus_regmap_handle_t handle, uint8_t reg_addr, const uint8_t *buf, uint16_t len);
+
+/*
+ * @brief   Get registers directly, without counting a bus access.
+ *
+ * @param   handle Handle structure.
+ * @param   reg_addr First register address.
+ * @param   buf Data.
+ * @param   len Number of bytes, reg_addr + len must not exceed 256.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_bus_regmap_get_reg(imu_bus_regmap_handle_t handle, uint8_t reg_addr, uint8_t *buf, uint16_t len);
+
+/*
+ * @brief   Get register map stand-in statistics.
+ *
+ * @param   handle Handle structure.
+ * @param   stats Statistics.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_bus_regmap_get_stats(imu_bus_regmap_handle_t handle, imu_bus_regmap_stats_t *stats);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_BUS_H__ */
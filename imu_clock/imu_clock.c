@@ -0,0 +1,173 @@
+#include "stdlib.h"
+#include "stddef.h"
+
+#include "imu_clock/imu_clock.h"
+
+
+#define CLOCK_FORGET_FACTOR_DEFAULT 	0.999f
+#define CLOCK_MIN_OBSERVATIONS_DEFAULT 	16
+
+
+typedef struct imu_clock {
+	float 						nominal_period_us; 			/*!< Nominal sample period */
+	float 						forget_factor; 				/*!< Forget factor */
+	uint32_t 					min_observations; 			/*!< Observations needed before using the fit */
+	uint32_t 					num_observations; 			/*!< Number of observations */
+	uint32_t 					origin_index; 				/*!< Frame index of the first observation */
+	uint64_t 					origin_time_us; 			/*!< Host time of the first observation */
+	double 						weight; 					/*!< Sum of weights */
+	double 						mean_x; 					/*!< Weighted mean of frame index */
+	double 						mean_y; 					/*!< Weighted mean of host time */
+	double 						sxx; 						/*!< Weighted co-moment of frame index */
+	double 						sxy; 						/*!< Weighted co-moment of frame index and host time */
+} imu_clock_t;
+
+static double imu_clock_slope(imu_clock_handle_t handle)
+{
+	if ((handle->num_observations < handle->min_observations) || (handle->sxx <= 0))
+	{
+		return handle->nominal_period_us;
+	}
+
+	return handle->sxy / handle->sxx;
+}
+
+imu_clock_handle_t imu_clock_init(void)
+{
+	imu_clock_handle_t handle = calloc(1, sizeof(imu_clock_t));
+
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	handle->forget_factor = CLOCK_FORGET_FACTOR_DEFAULT;
+	handle->min_observations = CLOCK_MIN_OBSERVATIONS_DEFAULT;
+
+	return handle;
+}
+
+err_code_t imu_clock_set_config(imu_clock_handle_t handle, imu_clock_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((config.forget_factor <= 0) || (config.forget_factor > 1))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->nominal_period_us = config.nominal_period_us;
+	handle->forget_factor = config.forget_factor;
+	handle->min_observations = (config.min_observations < 2) ? 2 : config.min_observations;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_clock_config(imu_clock_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->num_observations = 0;
+	handle->weight = 0;
+	handle->mean_x = 0;
+	handle->mean_y = 0;
+	handle->sxx = 0;
+	handle->sxy = 0;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_clock_update(imu_clock_handle_t handle, uint32_t frame_index, uint64_t time_us)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->num_observations == 0)
+	{
+		handle->origin_index = frame_index;
+		handle->origin_time_us = time_us;
+	}
+
+	/* Work relative to the first observation to keep full double precision */
+	double x = (double)(uint32_t)(frame_index - handle->origin_index);
+	double y = (double)(int64_t)(time_us - handle->origin_time_us);
+
+	/* Exponentially weighted Welford update of means and co-moments */
+	handle->weight = handle->forget_factor * handle->weight + 1.0;
+
+	double dx = x - handle->mean_x;
+	handle->mean_x += dx / handle->weight;
+	handle->mean_y += (y - handle->mean_y) / handle->weight;
+	handle->sxx = handle->forget_factor * handle->sxx + dx * (x - handle->mean_x);
+	handle->sxy = handle->forget_factor * handle->sxy + dx * (y - handle->mean_y);
+
+	handle->num_observations++;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_clock_get_period(imu_clock_handle_t handle, float *period_us)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (period_us == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*period_us = (float)imu_clock_slope(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_clock_get_drift(imu_clock_handle_t handle, float *drift_ppm)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (drift_ppm == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->nominal_period_us <= 0)
+	{
+		*drift_ppm = 0;
+		return ERR_CODE_SUCCESS;
+	}
+
+	*drift_ppm = (float)((imu_clock_slope(handle) / handle->nominal_period_us - 1.0) * 1e6);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_clock_get_time(imu_clock_handle_t handle, uint32_t frame_index, uint64_t *time_us)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (time_us == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->num_observations == 0)
+	{
+		*time_us = 0;
+		return ERR_CODE_SUCCESS;
+	}
+
+	double x = (double)(int32_t)(frame_index - handle->origin_index);
+	double y = handle->mean_y + imu_clock_slope(handle) * (x - handle->mean_x);
+
+	*time_us = handle->origin_time_us + (int64_t)(y + ((y >= 0) ? 0.5 : -0.5));
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#ifndef __IMU_CLOCK_H__
+#define __IMU_CLOCK_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+
+typedef struct imu_clock* imu_clock_handle_t;
+
+/**
+ * @brief   Sensor clock estimator configuration structure.
+ */
+typedef struct {
+    float                       nominal_period_us;          /*!< Sample period derived from the sensor configuration */
+    float                       forget_factor;              /*!< Weight of past observations, 0 < forget_factor <= 1, 1 never forgets */
+    uint32_t                    min_observations;           /*!< Observations needed before the fit replaces the nominal period */
+} imu_clock_cfg_t;
+
+/*
+ * @brief   Initialize sensor clock estimator with default parameters.
+ *
+ * @note    The estimator fits host time = offset + period * frame index with a
+ *          streaming, exponentially weighted least-squares regression. Every
+ *          update costs O(1) time and memory.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_clock_handle_t imu_clock_init(void);
+
+/*
+ * @brief   Set sensor clock estimator parameters.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_clock_set_config(imu_clock_handle_t handle, imu_clock_cfg_t config);
+
+/*
+ * @brief   Configure sensor clock estimator. Clear all observations.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_clock_config(imu_clock_handle_t handle);
+
+/*
+ * @brief   Add an observation of frame index and host time.
+ *
+ * @note    Frame index is the FIFO frame count or the data ready interrupt
+ *          count. It must not wrap between two observations.
+ *
+ * @param   handle Handle structure.
+ * @param   frame_index Frame index.
+ * @param   time_us Host time of the frame in microseconds.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_clock_update(imu_clock_handle_t handle, uint32_t frame_index, uint64_t time_us);
+
+/*
+ * @brief   Get estimated true sample period.
+ *
+ * @param   handle Handle structure.
+ * @param   period_us Sample period in microseconds. Nominal period until enough observations were added.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_clock_get_period(imu_clock_handle_t handle, float *period_us);
+
+/*
+ * @brief   Get drift of the sensor clock relative to host clock.
+ *
+ * @param   handle Handle structure.
+ * @param   drift_ppm Drift in parts per million, positive when the sensor runs slow.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_clock_get_drift(imu_clock_handle_t handle, float *drift_ppm);
+
+/*
+ * @brief   Get corrected host time of a frame from the fitted line.
+ *
+ * @param   handle Handle structure.
+ * @param   frame_index Frame index.
+ * @param   time_us Corrected time in microseconds, 0 if no observation was added.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_clock_get_time(imu_clock_handle_t handle, uint32_t frame_index, uint64_t *time_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_CLOCK_H__ */
@@ -0,0 +1,398 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+
+#include "imu_codec/imu_codec.h"
+
+#define CODEC_CHANNEL_ALL 			(IMU_CHANNEL_ACCEL | IMU_CHANNEL_TEMP | IMU_CHANNEL_GYRO | IMU_CHANNEL_MAG)
+#define CODEC_AXIS_HEADER_SIZE 		3
+#define CODEC_AXIS_MAX_PACKED 		(((IMU_CODEC_BLOCK_MAX_SAMPLES - 1) * 16 + 7) / 8)
+
+
+typedef struct {
+	uint8_t 					channel; 					/*!< Channel of the axis */
+	uint8_t 					offset; 					/*!< Offset of the raw value in imu_sample_t */
+} imu_codec_axis_t;
+
+typedef struct imu_codec_encoder {
+	imu_codec_encoder_cfg_t 	cfg; 						/*!< Configuration */
+	uint8_t 					num_axes; 					/*!< Axes per sample */
+	uint8_t 					axis_idx[IMU_CODEC_MAX_AXES]; 	/*!< Axis table index of the coded axes */
+	uint16_t 					pending; 					/*!< Samples waiting for a full block */
+	int16_t 					axes[IMU_CODEC_MAX_AXES][IMU_CODEC_BLOCK_MAX_SAMPLES]; 	/*!< Pending samples, planar */
+	uint8_t 					block[IMU_CODEC_BLOCK_MAX_SIZE]; 	/*!< Coded block */
+	imu_codec_encoder_stats_t 	stats; 						/*!< Statistics */
+} imu_codec_encoder_t;
+
+static const imu_codec_axis_t imu_codec_axis[IMU_CODEC_MAX_AXES] = {
+	{IMU_CHANNEL_ACCEL, offsetof(imu_sample_t, accel_raw_x)},
+	{IMU_CHANNEL_ACCEL, offsetof(imu_sample_t, accel_raw_y)},
+	{IMU_CHANNEL_ACCEL, offsetof(imu_sample_t, accel_raw_z)},
+	{IMU_CHANNEL_TEMP, offsetof(imu_sample_t, temp_raw)},
+	{IMU_CHANNEL_GYRO, offsetof(imu_sample_t, gyro_raw_x)},
+	{IMU_CHANNEL_GYRO, offsetof(imu_sample_t, gyro_raw_y)},
+	{IMU_CHANNEL_GYRO, offsetof(imu_sample_t, gyro_raw_z)},
+	{IMU_CHANNEL_MAG, offsetof(imu_sample_t, mag_raw_x)},
+	{IMU_CHANNEL_MAG, offsetof(imu_sample_t, mag_raw_y)},
+	{IMU_CHANNEL_MAG, offsetof(imu_sample_t, mag_raw_z)},
+};
+
+static uint8_t imu_codec_get_axes(uint8_t channels, uint8_t *axis_idx)
+{
+	uint8_t num_axes = 0;
+
+	for (uint8_t i = 0; i < IMU_CODEC_MAX_AXES; i++)
+	{
+		if (channels & imu_codec_axis[i].channel)
+		{
+			axis_idx[num_axes++] = i;
+		}
+	}
+
+	return num_axes;
+}
+
+static int16_t imu_codec_get_raw(const imu_sample_t *sample, uint8_t axis)
+{
+	int16_t value;
+	memcpy(&value, (const uint8_t *)sample + imu_codec_axis[axis].offset, sizeof(value));
+
+	return value;
+}
+
+static uint32_t imu_codec_packed_size(uint16_t num_samples, uint8_t width)
+{
+	return ((uint32_t)(num_samples - 1) * width + 7) / 8;
+}
+
+/* Code one axis, returns the end of the coded axis */
+static uint8_t *imu_codec_encode_axis(const int16_t *x, uint16_t num_samples, uint8_t *p)
+{
+	uint16_t zigzag[IMU_CODEC_BLOCK_MAX_SAMPLES];
+	uint16_t all = 0;
+
+	/* Deltas modulo 2^16, zigzag maps small magnitudes to small codes */
+	for (uint16_t i = 1; i < num_samples; i++)
+	{
+		uint16_t delta = (uint16_t)x[i] - (uint16_t)x[i - 1];
+		zigzag[i - 1] = (uint16_t)((delta << 1) ^ (0u - (delta >> 15)));
+		all |= zigzag[i - 1];
+	}
+
+	uint8_t width = 0;
+	while (all >> width)
+	{
+		width++;
+	}
+
+	*p++ = (uint8_t)x[0];
+	*p++ = (uint8_t)((uint16_t)x[0] >> 8);
+	*p++ = width;
+
+	uint32_t acc = 0;
+	uint8_t bits = 0;
+
+	for (uint16_t i = 0; (width != 0) && (i < num_samples - 1); i++)
+	{
+		acc |= (uint32_t)zigzag[i] << bits;
+		bits += width;
+		while (bits >= 8)
+		{
+			*p++ = (uint8_t)acc;
+			acc >>= 8;
+			bits -= 8;
+		}
+	}
+
+	if (bits != 0)
+	{
+		*p++ = (uint8_t)acc;
+	}
+
+	return p;
+}
+
+static void imu_codec_decode_axis(const uint8_t *packed, uint16_t num_samples, uint8_t width, int16_t first, int16_t *out)
+{
+	uint8_t buf[CODEC_AXIS_MAX_PACKED + 3];
+	uint16_t code[IMU_CODEC_BLOCK_MAX_SAMPLES];
+	int16_t delta[IMU_CODEC_BLOCK_MAX_SAMPLES];
+	uint32_t size = imu_codec_packed_size(num_samples, width);
+	uint32_t mask = (1u << width) - 1;
+	uint16_t n = num_samples - 1;
+
+	/* Padding lets every code be read with a fixed three byte load */
+	memcpy(buf, packed, size);
+	memset(buf + size, 0, 3);
+
+	for (uint16_t i = 0; i < n; i++)
+	{
+		uint32_t bit = (uint32_t)i * width;
+		const uint8_t *b = &buf[bit >> 3];
+		uint32_t word = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16);
+		code[i] = (uint16_t)((word >> (bit & 7)) & mask);
+	}
+
+	for (uint16_t i = 0; i < n; i++)
+	{
+		delta[i] = (int16_t)((code[i] >> 1) ^ (0u - (code[i] & 1u)));
+	}
+
+	out[0] = first;
+	for (uint16_t i = 0; i < n; i++)
+	{
+		out[i + 1] = (int16_t)((uint16_t)out[i] + (uint16_t)delta[i]);
+	}
+}
+
+static err_code_t imu_codec_encoder_emit(imu_codec_encoder_t *encoder)
+{
+	uint16_t num_samples = encoder->pending;
+	uint32_t start = 0;
+
+	if (encoder->cfg.func_get_cycles != NULL)
+	{
+		start = encoder->cfg.func_get_cycles();
+	}
+
+	uint8_t *p = encoder->block;
+	*p++ = (uint8_t)num_samples;
+	*p++ = encoder->cfg.channels;
+
+	for (uint8_t k = 0; k < encoder->num_axes; k++)
+	{
+		p = imu_codec_encode_axis(encoder->axes[k], num_samples, p);
+	}
+
+	if (encoder->cfg.func_get_cycles != NULL)
+	{
+		encoder->stats.encode_cycles += encoder->cfg.func_get_cycles() - start;
+	}
+
+	uint32_t len = (uint32_t)(p - encoder->block);
+
+	encoder->pending = 0;
+	encoder->stats.samples += num_samples;
+	encoder->stats.raw_bytes += (uint64_t)num_samples * encoder->num_axes * sizeof(int16_t);
+
+	if (encoder->cfg.func_output(encoder->block, len) != ERR_CODE_SUCCESS)
+	{
+		encoder->stats.dropped_blocks++;
+		return ERR_CODE_FAIL;
+	}
+
+	encoder->stats.blocks++;
+	encoder->stats.coded_bytes += len;
+
+	return ERR_CODE_SUCCESS;
+}
+
+imu_codec_encoder_handle_t imu_codec_encoder_init(void)
+{
+	imu_codec_encoder_handle_t handle = calloc(1, sizeof(imu_codec_encoder_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_codec_encoder_set_config(imu_codec_encoder_handle_t handle, imu_codec_encoder_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if ((handle == NULL) || (config.func_output == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((config.channels == 0) || (config.channels & ~CODEC_CHANNEL_ALL) ||
+	        (config.block_samples == 0) || (config.block_samples > IMU_CODEC_BLOCK_MAX_SAMPLES))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->cfg = config;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_codec_encoder_config(imu_codec_encoder_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->num_axes = imu_codec_get_axes(handle->cfg.channels, handle->axis_idx);
+	handle->pending = 0;
+	memset(&handle->stats, 0, sizeof(imu_codec_encoder_stats_t));
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_codec_encoder_write(imu_codec_encoder_handle_t handle, const imu_sample_t *samples, uint16_t num_samples)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err = ERR_CODE_SUCCESS;
+
+	for (uint16_t i = 0; i < num_samples; i++)
+	{
+		for (uint8_t k = 0; k < handle->num_axes; k++)
+		{
+			handle->axes[k][handle->pending] = imu_codec_get_raw(&samples[i], handle->axis_idx[k]);
+		}
+
+		if (++handle->pending == handle->cfg.block_samples)
+		{
+			if (imu_codec_encoder_emit(handle) != ERR_CODE_SUCCESS)
+			{
+				err = ERR_CODE_FAIL;
+			}
+		}
+	}
+
+	return err;
+}
+
+err_code_t imu_codec_encoder_flush(imu_codec_encoder_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->pending == 0)
+	{
+		return ERR_CODE_SUCCESS;
+	}
+
+	return imu_codec_encoder_emit(handle);
+}
+
+err_code_t imu_codec_encoder_get_stats(imu_codec_encoder_handle_t handle, imu_codec_encoder_stats_t *stats)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (stats == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*stats = handle->stats;
+	stats->ratio = (stats->coded_bytes != 0) ? (float)stats->raw_bytes / (float)stats->coded_bytes : 0.0f;
+	stats->cycles_per_sample = (stats->samples != 0) ? (float)stats->encode_cycles / (float)stats->samples : 0.0f;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_codec_encode_block(const imu_sample_t *samples, uint16_t num_samples, uint8_t channels,
+                                  uint8_t *block, uint32_t block_size, uint32_t *len)
+{
+	/* Check if pointer data is NULL */
+	if ((samples == NULL) || (block == NULL) || (len == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((channels == 0) || (channels & ~CODEC_CHANNEL_ALL) ||
+	        (num_samples == 0) || (num_samples > IMU_CODEC_BLOCK_MAX_SAMPLES))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	uint8_t axis_idx[IMU_CODEC_MAX_AXES];
+	uint8_t num_axes = imu_codec_get_axes(channels, axis_idx);
+
+	/* Worst case, every delta 16 bits */
+	if (block_size < 2 + num_axes * (CODEC_AXIS_HEADER_SIZE + imu_codec_packed_size(num_samples, 16)))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	uint8_t *p = block;
+	*p++ = (uint8_t)num_samples;
+	*p++ = channels;
+
+	for (uint8_t k = 0; k < num_axes; k++)
+	{
+		int16_t x[IMU_CODEC_BLOCK_MAX_SAMPLES];
+
+		for (uint16_t i = 0; i < num_samples; i++)
+		{
+			x[i] = imu_codec_get_raw(&samples[i], axis_idx[k]);
+		}
+
+		p = imu_codec_encode_axis(x, num_samples, p);
+	}
+
+	*len = (uint32_t)(p - block);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_codec_decode_block(const uint8_t *data, uint32_t len, int16_t *axes, uint16_t stride,
+                                  uint8_t *channels, uint16_t *num_samples, uint32_t *used)
+{
+	/* Check if pointer data is NULL */
+	if ((data == NULL) || (axes == NULL) || (channels == NULL) || (num_samples == NULL) || (used == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (len < 2)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	uint16_t n = data[0];
+	uint8_t mask = data[1];
+
+	if ((n == 0) || (n > IMU_CODEC_BLOCK_MAX_SAMPLES) || (n > stride) ||
+	        (mask == 0) || (mask & ~CODEC_CHANNEL_ALL))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	uint8_t axis_idx[IMU_CODEC_MAX_AXES];
+	uint8_t num_axes = imu_codec_get_axes(mask, axis_idx);
+	uint32_t pos = 2;
+
+	for (uint8_t k = 0; k < num_axes; k++)
+	{
+		if (pos + CODEC_AXIS_HEADER_SIZE > len)
+		{
+			return ERR_CODE_FAIL;
+		}
+
+		int16_t first = (int16_t)(data[pos] | (data[pos + 1] << 8));
+		uint8_t width = data[pos + 2];
+		pos += CODEC_AXIS_HEADER_SIZE;
+
+		if (width > 16)
+		{
+			return ERR_CODE_FAIL;
+		}
+
+		uint32_t size = imu_codec_packed_size(n, width);
+		if (pos + size > len)
+		{
+			return ERR_CODE_FAIL;
+		}
+
+		imu_codec_decode_axis(&data[pos], n, width, first, &axes[(uint32_t)k * stride]);
+		pos += size;
+	}
+
+	*channels = mask;
+	*num_samples = n;
+	*used = pos;
+
+	return ERR_CODE_SUCCESS;
+}
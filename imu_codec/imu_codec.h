@@ -0,0 +1,177 @@
+#ifndef __IMU_CODEC_H__
+#define __IMU_CODEC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+
+/*
+ * Block layout, all fields little endian:
+ *
+ *      u8  number of samples n, 1..IMU_CODEC_BLOCK_MAX_SAMPLES
+ *      u8  channels, bit mask of imu_channel_t
+ *      per axis    i16 first value, u8 delta bit width w, 0..16
+ *      per axis    n - 1 zigzag coded deltas of w bits, least significant
+ *                  bit first, padded to a whole byte
+ *
+ * Axes are ordered accel x, y, z, temp, gyro x, y, z, mag x, y, z, only the
+ * channels in the mask are present. Deltas are taken modulo 2^16 so every
+ * delta fits in 16 bits. Blocks are independent, a lost block loses only its
+ * own samples. Sequence numbers and timestamps are not coded, the container
+ * carries them.
+ */
+#define IMU_CODEC_BLOCK_MAX_SAMPLES     64          /*!< Largest block */
+#define IMU_CODEC_MAX_AXES              10          /*!< Accelerometer, temperature, gyroscope and magnetometer axes */
+#define IMU_CODEC_BLOCK_MAX_SIZE        (2 + IMU_CODEC_MAX_AXES * (3 + ((IMU_CODEC_BLOCK_MAX_SAMPLES - 1) * 16 + 7) / 8))   /*!< Largest coded block */
+
+typedef struct imu_codec_encoder* imu_codec_encoder_handle_t;
+
+typedef err_code_t (*imu_codec_func_output)(const uint8_t *block, uint32_t len);
+
+/**
+ * @brief   Encoder configuration structure.
+ */
+typedef struct {
+    uint8_t                     channels;                   /*!< Bit mask of imu_channel_t to code */
+    uint8_t                     block_samples;              /*!< Samples per block, 1..IMU_CODEC_BLOCK_MAX_SAMPLES */
+    imu_codec_func_output       func_output;                /*!< Receives every coded block */
+    imu_func_get_cycles         func_get_cycles;            /*!< Optional cycle counter, NULL disables the encode cost */
+} imu_codec_encoder_cfg_t;
+
+/**
+ * @brief   Encoder statistics structure.
+ */
+typedef struct {
+    uint32_t                    samples;                    /*!< Samples coded */
+    uint32_t                    blocks;                     /*!< Blocks output */
+    uint32_t                    dropped_blocks;             /*!< Blocks the output function failed to take */
+    uint64_t                    raw_bytes;                  /*!< Size of the coded samples as int16 frames */
+    uint64_t                    coded_bytes;                /*!< Size of the coded blocks */
+    uint64_t                    encode_cycles;              /*!< Cycles spent in block coding */
+    float                       ratio;                      /*!< raw_bytes / coded_bytes */
+    float                       cycles_per_sample;          /*!< encode_cycles / samples */
+} imu_codec_encoder_stats_t;
+
+/*
+ * @brief   Initialize encoder.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_codec_encoder_handle_t imu_codec_encoder_init(void);
+
+/*
+ * @brief   Set encoder configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_codec_encoder_set_config(imu_codec_encoder_handle_t handle, imu_codec_encoder_cfg_t config);
+
+/*
+ * @brief   Configure encoder. Discards pending samples and clears statistics.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_codec_encoder_config(imu_codec_encoder_handle_t handle);
+
+/*
+ * @brief   Add samples, as returned by imu_read_fifo or imu_poll_sample.
+ *          Every full block is coded and passed to func_output.
+ *
+ * @note    Memory is bounded by the handle, one block of samples and one
+ *          coded block.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Samples.
+ * @param   num_samples Number of samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail, a block was dropped.
+ */
+err_code_t imu_codec_encoder_write(imu_codec_encoder_handle_t handle, const imu_sample_t *samples, uint16_t num_samples);
+
+/*
+ * @brief   Code and output pending samples as a short block.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_codec_encoder_flush(imu_codec_encoder_handle_t handle);
+
+/*
+ * @brief   Get encoder statistics.
+ *
+ * @param   handle Handle structure.
+ * @param   stats Statistics.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_codec_encoder_get_stats(imu_codec_encoder_handle_t handle, imu_codec_encoder_stats_t *stats);
+
+/*
+ * @brief   Code one block without an encoder handle.
+ *
+ * @param   samples Samples.
+ * @param   num_samples Number of samples, 1..IMU_CODEC_BLOCK_MAX_SAMPLES.
+ * @param   channels Bit mask of imu_channel_t to code.
+ * @param   block Coded block, IMU_CODEC_BLOCK_MAX_SIZE bytes are always enough.
+ * @param   block_size Size of block.
+ * @param   len Length of the coded block.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_codec_encode_block(const imu_sample_t *samples, uint16_t num_samples, uint8_t channels,
+                                  uint8_t *block, uint32_t block_size, uint32_t *len);
+
+/*
+ * @brief   Decode one block into planar axis arrays. Axis k of the block,
+ *          in layout order, is written to axes[k * stride .. k * stride + n - 1].
+ *
+ * @note    Meant for the host. Every axis is unpacked a word at a time and
+ *          the zigzag and delta passes run over contiguous arrays that the
+ *          compiler vectorizes.
+ *
+ * @param   data Coded data, may hold further blocks after this one.
+ * @param   len Length of data.
+ * @param   axes Axis arrays, IMU_CODEC_MAX_AXES * stride values are always enough.
+ * @param   stride Distance between axis arrays, at least the block samples.
+ * @param   channels Bit mask of imu_channel_t of the block.
+ * @param   num_samples Number of samples of the block.
+ * @param   used Length of the block in data.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail, block is truncated or invalid.
+ */
+err_code_t imu_codec_decode_block(const uint8_t *data, uint32_t len, int16_t *axes, uint16_t stride,
+                                  uint8_t *channels, uint16_t *num_samples, uint32_t *used);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_CODEC_H__ */
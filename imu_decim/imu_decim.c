@@ -0,0 +1,329 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+#include "math.h"
+
+#include "imu_decim/imu_decim.h"
+
+#define DECIM_PI 					3.14159265358979f
+
+
+typedef struct imu_decim {
+	imu_decim_cfg_t 			cfg; 						/*!< Configuration */
+	float 						coeffs[2 * IMU_DECIM_MAX_TAPS]; 	/*!< Reversed coefficients, twice so every window is contiguous */
+	float 						hist[IMU_DECIM_MAX_TAPS][IMU_DECIM_LANES]; 	/*!< Input ring, lanes of one sample together */
+	uint64_t 					hist_time_us[IMU_DECIM_MAX_TAPS]; 	/*!< Timestamps of the input ring */
+	uint16_t 					pos; 						/*!< Ring index of the oldest sample, next to be written */
+	uint16_t 					fill; 						/*!< Samples since the restart, up to the group delay */
+	uint8_t 					phase; 						/*!< Samples since the last output */
+	uint8_t 					started; 					/*!< Ring holds samples */
+	uint32_t 					last_seq; 					/*!< Sequence number of the last input */
+	uint8_t 					last_accel_range; 			/*!< Accelerometer range of the last raw input */
+	uint8_t 					last_gyro_range; 			/*!< Gyroscope range of the last raw input */
+	imu_decim_status_t 			status; 					/*!< Status */
+} imu_decim_t;
+
+/* Zeroth order modified Bessel function of the first kind */
+static float imu_decim_bessel_i0(float x)
+{
+	float sum = 1.0f;
+	float term = 1.0f;
+
+	for (uint8_t k = 1; k < 32; k++)
+	{
+		term *= (x / (2.0f * k)) * (x / (2.0f * k));
+		sum += term;
+		if (term < sum * 1e-9f)
+		{
+			break;
+		}
+	}
+
+	return sum;
+}
+
+static void imu_decim_design(imu_decim_handle_t handle, float *h)
+{
+	uint16_t taps = handle->cfg.taps;
+	float att = handle->cfg.attenuation_db;
+	float center = (taps - 1) / 2.0f;
+	float fc = 0.5f / handle->cfg.ratio;
+	float beta = 0;
+
+	/* Kaiser window parameter for the stopband attenuation */
+	if (att > 50.0f)
+	{
+		beta = 0.1102f * (att - 8.7f);
+	}
+	else if (att > 21.0f)
+	{
+		beta = 0.5842f * powf(att - 21.0f, 0.4f) + 0.07886f * (att - 21.0f);
+	}
+
+	float i0_beta = imu_decim_bessel_i0(beta);
+	float sum = 0;
+
+	for (uint16_t n = 0; n < taps; n++)
+	{
+		float t = n - center;
+		float sinc = (t == 0) ? 2.0f * fc : sinf(2.0f * DECIM_PI * fc * t) / (DECIM_PI * t);
+		float r = (center > 0) ? t / center : 0;
+
+		h[n] = sinc * imu_decim_bessel_i0(beta * sqrtf(1.0f - r * r)) / i0_beta;
+		sum += h[n];
+	}
+
+	/* Unity gain at DC, a constant input comes out unchanged */
+	for (uint16_t n = 0; n < taps; n++)
+	{
+		h[n] /= sum;
+	}
+}
+
+static void imu_decim_restart(imu_decim_handle_t handle, const float *lanes)
+{
+	/* Hold the first sample into the past, a step into the filter would
+	 * ring for the whole filter length.
+	 */
+	for (uint16_t i = 0; i < handle->cfg.taps; i++)
+	{
+		memcpy(handle->hist[i], lanes, sizeof(handle->hist[i]));
+	}
+
+	handle->pos = 0;
+	handle->fill = 0;
+	handle->phase = 0;
+
+	if (handle->started)
+	{
+		handle->status.restarts++;
+	}
+	handle->started = 1;
+}
+
+static uint8_t imu_decim_input(imu_decim_handle_t handle, const float *lanes, uint32_t seq, uint64_t timestamp_us,
+                               bool restart, imu_decim_sample_t *out)
+{
+	uint16_t taps = handle->cfg.taps;
+	uint16_t delay = handle->status.delay_samples;
+
+	if (!handle->started || restart || (seq != handle->last_seq + 1))
+	{
+		imu_decim_restart(handle, lanes);
+	}
+	else
+	{
+		memcpy(handle->hist[handle->pos], lanes, sizeof(handle->hist[handle->pos]));
+	}
+
+	handle->hist_time_us[handle->pos] = timestamp_us;
+	handle->pos = (handle->pos + 1 == taps) ? 0 : handle->pos + 1;
+	handle->last_seq = seq;
+	handle->status.inputs++;
+
+	/* Output only once the filter center is at a real sample */
+	if (handle->fill < delay)
+	{
+		handle->fill++;
+		return 0;
+	}
+
+	if (handle->phase != 0)
+	{
+		handle->phase = (handle->phase + 1 == handle->cfg.ratio) ? 0 : handle->phase + 1;
+		return 0;
+	}
+	handle->phase = 1;
+
+	/* Sample at ring index i is weighted by coeffs[taps - pos + i]. Lanes
+	 * are the inner loop, independent accumulators the compiler vectorizes
+	 * without reordering any sum.
+	 */
+	const float *c = &handle->coeffs[taps - handle->pos];
+	float acc[IMU_DECIM_LANES] = {0};
+
+	for (uint16_t i = 0; i < taps; i++)
+	{
+		const float *x = handle->hist[i];
+		float ci = c[i];
+
+		for (uint8_t l = 0; l < IMU_DECIM_LANES; l++)
+		{
+			acc[l] += ci * x[l];
+		}
+	}
+
+	uint16_t center = (handle->pos + taps - 1 - delay) % taps;
+
+	out->seq = seq - delay;
+	out->timestamp_us = handle->hist_time_us[center];
+	out->accel_x = acc[0];
+	out->accel_y = acc[1];
+	out->accel_z = acc[2];
+	out->gyro_x = acc[3];
+	out->gyro_y = acc[4];
+	out->gyro_z = acc[5];
+	out->temp = acc[6];
+
+	return 1;
+}
+
+static void imu_decim_emit(imu_decim_handle_t handle, const imu_decim_sample_t *sample,
+                           imu_decim_sample_t *out, uint16_t max_out, uint16_t *num_out)
+{
+	if (*num_out < max_out)
+	{
+		out[(*num_out)++] = *sample;
+		handle->status.outputs++;
+	}
+	else
+	{
+		handle->status.dropped++;
+	}
+}
+
+imu_decim_handle_t imu_decim_init(void)
+{
+	imu_decim_handle_t handle = calloc(1, sizeof(imu_decim_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_decim_set_config(imu_decim_handle_t handle, imu_decim_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	/* Odd length keeps the group delay a whole number of samples */
+	if ((config.ratio < 2) || (config.ratio > IMU_DECIM_MAX_RATIO) ||
+	        (config.taps == 0) || (config.taps > IMU_DECIM_MAX_TAPS) || ((config.taps & 1) == 0) ||
+	        ((config.coeffs == NULL) && (config.attenuation_db <= 0)))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->cfg = config;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_decim_config(imu_decim_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	uint16_t taps = handle->cfg.taps;
+	float h[IMU_DECIM_MAX_TAPS];
+
+	if (handle->cfg.coeffs != NULL)
+	{
+		memcpy(h, handle->cfg.coeffs, taps * sizeof(float));
+	}
+	else
+	{
+		imu_decim_design(handle, h);
+	}
+
+	for (uint16_t n = 0; n < taps; n++)
+	{
+		handle->coeffs[n] = h[taps - 1 - n];
+		handle->coeffs[taps + n] = h[taps - 1 - n];
+	}
+
+	handle->pos = 0;
+	handle->fill = 0;
+	handle->phase = 0;
+	handle->started = 0;
+	memset(&handle->status, 0, sizeof(imu_decim_status_t));
+	handle->status.delay_samples = (taps - 1) / 2;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_decim_write(imu_decim_handle_t handle, const imu_sample_t *samples, uint16_t num_samples,
+                           imu_decim_sample_t *out, uint16_t max_out, uint16_t *num_out)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL) || (out == NULL) || (num_out == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*num_out = 0;
+
+	for (uint16_t i = 0; i < num_samples; i++)
+	{
+		const imu_sample_t *s = &samples[i];
+		float lanes[IMU_DECIM_LANES] = {
+			s->accel_raw_x, s->accel_raw_y, s->accel_raw_z,
+			s->gyro_raw_x, s->gyro_raw_y, s->gyro_raw_z,
+			s->temp_raw, 0
+		};
+
+		/* Raw data of different ranges does not mix */
+		bool restart = (s->accel_range != handle->last_accel_range) || (s->gyro_range != handle->last_gyro_range);
+		handle->last_accel_range = s->accel_range;
+		handle->last_gyro_range = s->gyro_range;
+
+		imu_decim_sample_t sample;
+		if (imu_decim_input(handle, lanes, s->seq, s->timestamp_us, restart, &sample))
+		{
+			imu_decim_emit(handle, &sample, out, max_out, num_out);
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_decim_write_scale(imu_decim_handle_t handle, const imu_sample_scale_t *samples, uint16_t num_samples,
+                                 imu_decim_sample_t *out, uint16_t max_out, uint16_t *num_out)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL) || (out == NULL) || (num_out == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*num_out = 0;
+
+	for (uint16_t i = 0; i < num_samples; i++)
+	{
+		const imu_sample_scale_t *s = &samples[i];
+		float lanes[IMU_DECIM_LANES] = {
+			s->accel_x, s->accel_y, s->accel_z,
+			s->gyro_x, s->gyro_y, s->gyro_z,
+			s->temp, 0
+		};
+
+		imu_decim_sample_t sample;
+		if (imu_decim_input(handle, lanes, s->seq, s->timestamp_us, false, &sample))
+		{
+			imu_decim_emit(handle, &sample, out, max_out, num_out);
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_decim_get_status(imu_decim_handle_t handle, imu_decim_status_t *status)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (status == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*status = handle->status;
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,150 @@
+#ifndef __IMU_DECIM_H__
+#define __IMU_DECIM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+
+#define IMU_DECIM_MAX_RATIO             32          /*!< Largest decimation ratio */
+#define IMU_DECIM_MAX_TAPS              255         /*!< Longest filter */
+#define IMU_DECIM_LANES                 8           /*!< Accelerometer x, y, z, gyroscope x, y, z, temperature, padding */
+
+typedef struct imu_decim* imu_decim_handle_t;
+
+/**
+ * @brief   Decimator configuration structure.
+ */
+typedef struct {
+    uint8_t                     ratio;                      /*!< Decimation ratio, 2..IMU_DECIM_MAX_RATIO */
+    uint16_t                    taps;                       /*!< Filter length, odd, up to IMU_DECIM_MAX_TAPS */
+    float                       attenuation_db;             /*!< Stopband attenuation of the designed filter */
+    const float                 *coeffs;                    /*!< Optional taps coefficients, NULL designs the filter */
+} imu_decim_cfg_t;
+
+/**
+ * @brief   Decimated sample structure. Units are those of the input, raw
+ *          data for imu_decim_write and scaled data for imu_decim_write_scale.
+ */
+typedef struct {
+    uint32_t                    seq;                        /*!< Sequence number of the input sample at the filter center */
+    uint64_t                    timestamp_us;               /*!< Timestamp of that input sample */
+    float                       accel_x;                    /*!< Accelerometer x axis */
+    float                       accel_y;                    /*!< Accelerometer y axis */
+    float                       accel_z;                    /*!< Accelerometer z axis */
+    float                       gyro_x;                     /*!< Gyroscope x axis */
+    float                       gyro_y;                     /*!< Gyroscope y axis */
+    float                       gyro_z;                     /*!< Gyroscope z axis */
+    float                       temp;                       /*!< Temperature */
+} imu_decim_sample_t;
+
+/**
+ * @brief   Decimator status structure.
+ */
+typedef struct {
+    uint32_t                    inputs;                     /*!< Input samples */
+    uint32_t                    outputs;                    /*!< Output samples */
+    uint32_t                    restarts;                   /*!< Restarts on a sequence gap or range change */
+    uint32_t                    dropped;                    /*!< Output samples that did not fit the output buffer */
+    uint16_t                    delay_samples;              /*!< Group delay in input samples */
+} imu_decim_status_t;
+
+/*
+ * @brief   Initialize decimator.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_decim_handle_t imu_decim_init(void);
+
+/*
+ * @brief   Set decimator configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_decim_set_config(imu_decim_handle_t handle, imu_decim_cfg_t config);
+
+/*
+ * @brief   Configure decimator. Without coefficients a linear phase
+ *          low-pass is designed, a Kaiser windowed sinc with its cutoff at
+ *          the output Nyquist frequency and unity gain at DC. The transition
+ *          band is about (attenuation_db - 8) / (14.4 * taps) of the input
+ *          rate wide. Clears the filter state and status.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_decim_config(imu_decim_handle_t handle);
+
+/*
+ * @brief   Filter raw samples, as returned by imu_read_fifo or
+ *          imu_poll_sample, and output every ratio-th filtered sample.
+ *
+ * @note    Only the output samples are computed, at taps multiply-adds per
+ *          lane. The filter restarts on a sequence gap or a range change,
+ *          holding the first sample into the past, and outputs again once
+ *          the filter center reaches it.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Samples.
+ * @param   num_samples Number of samples.
+ * @param   out Output samples, num_samples / ratio + 1 are always enough.
+ * @param   max_out Size of out.
+ * @param   num_out Number of output samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_decim_write(imu_decim_handle_t handle, const imu_sample_t *samples, uint16_t num_samples,
+                           imu_decim_sample_t *out, uint16_t max_out, uint16_t *num_out);
+
+/*
+ * @brief   Same as imu_decim_write for scaled samples, as returned by
+ *          imu_scale_sample. Range changes are already scaled out.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Samples.
+ * @param   num_samples Number of samples.
+ * @param   out Output samples, num_samples / ratio + 1 are always enough.
+ * @param   max_out Size of out.
+ * @param   num_out Number of output samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_decim_write_scale(imu_decim_handle_t handle, const imu_sample_scale_t *samples, uint16_t num_samples,
+                                 imu_decim_sample_t *out, uint16_t max_out, uint16_t *num_out);
+
+/*
+ * @brief   Get decimator status.
+ *
+ * @param   handle Handle structure.
+ * @param   status Status.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_decim_get_status(imu_decim_handle_t handle, imu_decim_status_t *status);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_DECIM_H__ */
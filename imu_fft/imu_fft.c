@@ -0,0 +1,607 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+#include "math.h"
+
+#include "imu_fft/imu_fft.h"
+
+#define FFT_PI 						3.14159265358979f
+#define FFT_Q15_ONE 				32767
+
+
+typedef struct imu_fft {
+	imu_fft_cfg_t 				cfg; 						/*!< Configuration */
+	uint8_t 					num_axes; 					/*!< Axes per frame */
+	uint8_t 					axis_offset[IMU_FFT_MAX_AXES]; 	/*!< Offset of the raw value of each axis in imu_sample_t */
+	uint8_t 					axis_gyro[IMU_FFT_MAX_AXES]; 	/*!< Axis is a gyroscope axis */
+	uint16_t 					count; 						/*!< Samples in the current frame */
+	uint32_t 					next_seq; 					/*!< Expected sequence number of the next sample */
+	uint8_t 					accel_range; 				/*!< Accelerometer range of the current frame */
+	uint8_t 					gyro_range; 				/*!< Gyroscope range of the current frame */
+	imu_fft_features_t 			features; 					/*!< Features of the current frame */
+	imu_fft_status_t 			status; 					/*!< Status */
+} imu_fft_t;
+
+static const uint8_t imu_fft_axis_offset[IMU_FFT_MAX_AXES] = {
+	offsetof(imu_sample_t, accel_raw_x),
+	offsetof(imu_sample_t, accel_raw_y),
+	offsetof(imu_sample_t, accel_raw_z),
+	offsetof(imu_sample_t, gyro_raw_x),
+	offsetof(imu_sample_t, gyro_raw_y),
+	offsetof(imu_sample_t, gyro_raw_z),
+};
+
+static uint8_t imu_fft_sample_size(imu_fft_format_t format)
+{
+	return (format == IMU_FFT_FORMAT_Q15) ? sizeof(int16_t) : sizeof(float);
+}
+
+static void *imu_fft_frame(imu_fft_handle_t handle, uint8_t axis)
+{
+	return (uint8_t *)handle->cfg.buf + (uint32_t)axis * handle->cfg.points * imu_fft_sample_size(handle->cfg.format);
+}
+
+/* Twiddle table after the frames, cos(2 pi k / n) then sin(2 pi k / n) for k < n / 2 */
+static void *imu_fft_twiddle(imu_fft_handle_t handle)
+{
+	return imu_fft_frame(handle, handle->num_axes);
+}
+
+static int16_t imu_fft_sat_q15(int32_t value)
+{
+	if (value > 32767)
+	{
+		return 32767;
+	}
+	if (value < -32768)
+	{
+		return -32768;
+	}
+
+	return (int16_t)value;
+}
+
+static void imu_fft_bitrev(void *data, uint16_t m, uint8_t sample_size)
+{
+	/* Swap complex points, a complex point is two samples */
+	for (uint16_t i = 1, j = 0; i < m; i++)
+	{
+		uint16_t bit = m >> 1;
+		for (; j & bit; bit >>= 1)
+		{
+			j ^= bit;
+		}
+		j ^= bit;
+
+		if (i < j)
+		{
+			uint8_t tmp[2 * sizeof(float)];
+			uint8_t *a = (uint8_t *)data + (uint32_t)i * 2 * sample_size;
+			uint8_t *b = (uint8_t *)data + (uint32_t)j * 2 * sample_size;
+
+			memcpy(tmp, a, 2 * sample_size);
+			memcpy(a, b, 2 * sample_size);
+			memcpy(b, tmp, 2 * sample_size);
+		}
+	}
+}
+
+static void imu_fft_cfft_f32(float *z, uint16_t m, const float *tw, uint16_t n)
+{
+	const float *tw_sin = tw + n / 2;
+
+	for (uint16_t len = 2; len <= m; len <<= 1)
+	{
+		uint16_t half = len / 2;
+		uint16_t step = n / len;
+
+		for (uint16_t i = 0; i < m; i += len)
+		{
+			for (uint16_t j = 0; j < half; j++)
+			{
+				float wr = tw[j * step];
+				float wi = -tw_sin[j * step];
+				float *a = &z[2 * (i + j)];
+				float *b = &z[2 * (i + j + half)];
+				float tr = b[0] * wr - b[1] * wi;
+				float ti = b[0] * wi + b[1] * wr;
+
+				b[0] = a[0] - tr;
+				b[1] = a[1] - ti;
+				a[0] += tr;
+				a[1] += ti;
+			}
+		}
+	}
+}
+
+static void imu_fft_cfft_q15(int16_t *z, uint16_t m, const int16_t *tw, uint16_t n)
+{
+	const int16_t *tw_sin = tw + n / 2;
+
+	/* Every stage halves, the result is the transform divided by m */
+	for (uint16_t len = 2; len <= m; len <<= 1)
+	{
+		uint16_t half = len / 2;
+		uint16_t step = n / len;
+
+		for (uint16_t i = 0; i < m; i += len)
+		{
+			for (uint16_t j = 0; j < half; j++)
+			{
+				int32_t wr = tw[j * step];
+				int32_t wi = -tw_sin[j * step];
+				int16_t *a = &z[2 * (i + j)];
+				int16_t *b = &z[2 * (i + j + half)];
+				int32_t tr = (b[0] * wr - b[1] * wi + 0x4000) >> 15;
+				int32_t ti = (b[0] * wi + b[1] * wr + 0x4000) >> 15;
+
+				b[0] = (int16_t)((a[0] - tr) >> 1);
+				b[1] = (int16_t)((a[1] - ti) >> 1);
+				a[0] = (int16_t)((a[0] + tr) >> 1);
+				a[1] = (int16_t)((a[1] + ti) >> 1);
+			}
+		}
+	}
+}
+
+/* Spectrum of n real samples from the m = n / 2 point transform Z of the
+ * even samples as real and odd samples as imaginary part:
+ *      X[k] = Fe + W^k Fo, X[m - k] = conj(Fe - W^k Fo)
+ *      Fe = (Z[k] + conj(Z[m - k])) / 2, Fo = (Z[k] - conj(Z[m - k])) / 2j
+ * X[0] and X[m] are real and share the first point.
+ */
+static void imu_fft_split_f32(float *z, uint16_t m, const float *tw, uint16_t n)
+{
+	const float *tw_sin = tw + n / 2;
+	float zr = z[0], zi = z[1];
+
+	z[0] = zr + zi;
+	z[1] = zr - zi;
+
+	for (uint16_t k = 1; k <= m / 2; k++)
+	{
+		float *p = &z[2 * k];
+		float *q = &z[2 * (m - k)];
+		float fer = 0.5f * (p[0] + q[0]);
+		float fei = 0.5f * (p[1] - q[1]);
+		float for_ = 0.5f * (p[1] + q[1]);
+		float foi = -0.5f * (p[0] - q[0]);
+		float wr = tw[k];
+		float wi = -tw_sin[k];
+		float tr = for_ * wr - foi * wi;
+		float ti = for_ * wi + foi * wr;
+
+		p[0] = fer + tr;
+		p[1] = fei + ti;
+		q[0] = fer - tr;
+		q[1] = -(fei - ti);
+	}
+}
+
+static void imu_fft_split_q15(int16_t *z, uint16_t m, const int16_t *tw, uint16_t n)
+{
+	const int16_t *tw_sin = tw + n / 2;
+	int32_t zr = z[0], zi = z[1];
+
+	z[0] = imu_fft_sat_q15(zr + zi);
+	z[1] = imu_fft_sat_q15(zr - zi);
+
+	for (uint16_t k = 1; k <= m / 2; k++)
+	{
+		int16_t *p = &z[2 * k];
+		int16_t *q = &z[2 * (m - k)];
+		int32_t fer = (p[0] + q[0]) >> 1;
+		int32_t fei = (p[1] - q[1]) >> 1;
+		int32_t for_ = (p[1] + q[1]) >> 1;
+		int32_t foi = -((p[0] - q[0]) >> 1);
+		int32_t wr = tw[k];
+		int32_t wi = -tw_sin[k];
+		int32_t tr = (for_ * wr - foi * wi + 0x4000) >> 15;
+		int32_t ti = (for_ * wi + foi * wr + 0x4000) >> 15;
+
+		p[0] = imu_fft_sat_q15(fer + tr);
+		p[1] = imu_fft_sat_q15(fei + ti);
+		q[0] = imu_fft_sat_q15(fer - tr);
+		q[1] = imu_fft_sat_q15(-(fei - ti));
+	}
+}
+
+/* Hann window value of sample i, from the cosine table */
+static float imu_fft_hann_f32(const float *tw, uint16_t i, uint16_t n)
+{
+	uint16_t k = (i <= n / 2) ? i : n - i;
+	float c = (k == n / 2) ? -1.0f : tw[k];
+
+	return 0.5f - 0.5f * c;
+}
+
+static int32_t imu_fft_hann_q15(const int16_t *tw, uint16_t i, uint16_t n)
+{
+	uint16_t k = (i <= n / 2) ? i : n - i;
+	int32_t c = (k == n / 2) ? -FFT_Q15_ONE : tw[k];
+
+	return (FFT_Q15_ONE - c + 1) >> 1;
+}
+
+static float imu_fft_power(imu_fft_handle_t handle, const void *frame, uint16_t k)
+{
+	uint16_t m = handle->cfg.points / 2;
+	float re, im;
+
+	if (handle->cfg.format == IMU_FFT_FORMAT_Q15)
+	{
+		const int16_t *z = (const int16_t *)frame;
+		re = (k == 0) ? z[0] : (k == m) ? z[1] : z[2 * k];
+		im = ((k == 0) || (k == m)) ? 0 : z[2 * k + 1];
+	}
+	else
+	{
+		const float *z = (const float *)frame;
+		re = (k == 0) ? z[0] : (k == m) ? z[1] : z[2 * k];
+		im = ((k == 0) || (k == m)) ? 0 : z[2 * k + 1];
+	}
+
+	return re * re + im * im;
+}
+
+/* Mean and RMS, then the mean removed and the window applied in place */
+static void imu_fft_prepare(imu_fft_handle_t handle, void *frame, float *mean, float *rms)
+{
+	uint16_t n = handle->cfg.points;
+	bool hann = (handle->cfg.window == IMU_FFT_WINDOW_HANN);
+
+	if (handle->cfg.format == IMU_FFT_FORMAT_Q15)
+	{
+		int16_t *x = (int16_t *)frame;
+		const int16_t *tw = (const int16_t *)imu_fft_twiddle(handle);
+		int64_t sum = 0, sum_sq = 0;
+
+		for (uint16_t i = 0; i < n; i++)
+		{
+			sum += x[i];
+		}
+		int32_t avg = (int32_t)(sum / n);
+
+		/* Input halved so the first stage cannot overflow */
+		for (uint16_t i = 0; i < n; i++)
+		{
+			int32_t d = x[i] - avg;
+			int32_t w = hann ? imu_fft_hann_q15(tw, i, n) : FFT_Q15_ONE;
+
+			sum_sq += (int64_t)d * d;
+			x[i] = (int16_t)((d * w) >> 16);
+		}
+
+		*mean = (float)sum / n;
+		*rms = sqrtf((float)((double)sum_sq / n - ((double)sum / n - avg) * ((double)sum / n - avg)));
+	}
+	else
+	{
+		float *x = (float *)frame;
+		const float *tw = (const float *)imu_fft_twiddle(handle);
+		float sum = 0, sum_sq = 0;
+
+		for (uint16_t i = 0; i < n; i++)
+		{
+			sum += x[i];
+		}
+		float avg = sum / n;
+
+		for (uint16_t i = 0; i < n; i++)
+		{
+			float d = x[i] - avg;
+			sum_sq += d * d;
+			x[i] = hann ? d * imu_fft_hann_f32(tw, i, n) : d;
+		}
+
+		*mean = avg;
+		*rms = sqrtf(sum_sq / n);
+	}
+}
+
+static void imu_fft_transform(imu_fft_handle_t handle, void *frame)
+{
+	uint16_t n = handle->cfg.points;
+	uint16_t m = n / 2;
+
+	if (handle->cfg.format == IMU_FFT_FORMAT_Q15)
+	{
+		const int16_t *tw = (const int16_t *)imu_fft_twiddle(handle);
+
+		imu_fft_bitrev(frame, m, sizeof(int16_t));
+		imu_fft_cfft_q15((int16_t *)frame, m, tw, n);
+		imu_fft_split_q15((int16_t *)frame, m, tw, n);
+	}
+	else
+	{
+		const float *tw = (const float *)imu_fft_twiddle(handle);
+
+		imu_fft_bitrev(frame, m, sizeof(float));
+		imu_fft_cfft_f32((float *)frame, m, tw, n);
+		imu_fft_split_f32((float *)frame, m, tw, n);
+	}
+}
+
+static void imu_fft_extract(imu_fft_handle_t handle, const void *frame, float unit, imu_fft_axis_features_t *f)
+{
+	uint16_t n = handle->cfg.points;
+	uint16_t m = n / 2;
+	float resolution_hz = handle->cfg.sample_rate_hz / n;
+
+	/* Q15 holds the spectrum divided by n */
+	float x_scale = (handle->cfg.format == IMU_FFT_FORMAT_Q15) ? (float)n : 1.0f;
+
+	/* Coherent gain for amplitudes, power gain for energies */
+	bool hann = (handle->cfg.window == IMU_FFT_WINDOW_HANN);
+	float cg = hann ? 0.5f : 1.0f;
+	float pg = hann ? 0.375f : 1.0f;
+	float amp_scale = 2.0f * x_scale * unit / (n * cg);
+	float ms_scale = 2.0f * x_scale * x_scale * unit * unit / ((float)n * n * pg);
+
+	float band_ms[IMU_FFT_MAX_BANDS] = {0};
+	float peak_power[IMU_FFT_MAX_PEAKS] = {0};
+	uint16_t peak_bin[IMU_FFT_MAX_PEAKS] = {0};
+	uint8_t band = 0;
+
+	float p0 = imu_fft_power(handle, frame, 0);
+	float p1 = imu_fft_power(handle, frame, 1);
+
+	for (uint16_t k = 1; k < m; k++)
+	{
+		float p2 = imu_fft_power(handle, frame, k + 1);
+		float freq_hz = k * resolution_hz;
+
+		while ((band < handle->cfg.num_bands) && (freq_hz >= handle->cfg.band_edges_hz[band + 1]))
+		{
+			band++;
+		}
+		if ((band < handle->cfg.num_bands) && (freq_hz >= handle->cfg.band_edges_hz[band]))
+		{
+			band_ms[band] += p1;
+		}
+
+		/* Keep the strongest local maxima, strongest first */
+		if ((p1 > p0) && (p1 >= p2) && (p1 > peak_power[IMU_FFT_MAX_PEAKS - 1]))
+		{
+			uint8_t i = IMU_FFT_MAX_PEAKS - 1;
+			for (; (i > 0) && (p1 > peak_power[i - 1]); i--)
+			{
+				peak_power[i] = peak_power[i - 1];
+				peak_bin[i] = peak_bin[i - 1];
+			}
+			peak_power[i] = p1;
+			peak_bin[i] = k;
+		}
+
+		p0 = p1;
+		p1 = p2;
+	}
+
+	for (uint8_t b = 0; b < IMU_FFT_MAX_BANDS; b++)
+	{
+		f->band_rms[b] = (b < handle->cfg.num_bands) ? sqrtf(band_ms[b] * ms_scale) : 0;
+	}
+
+	for (uint8_t i = 0; i < IMU_FFT_MAX_PEAKS; i++)
+	{
+		uint16_t k = peak_bin[i];
+
+		if (k == 0)
+		{
+			f->peak_hz[i] = 0;
+			f->peak_amp[i] = 0;
+			continue;
+		}
+
+		/* Parabola through the magnitudes around the peak */
+		float m0 = sqrtf(imu_fft_power(handle, frame, k - 1));
+		float m1 = sqrtf(peak_power[i]);
+		float m2 = sqrtf(imu_fft_power(handle, frame, k + 1));
+		float den = m0 - 2.0f * m1 + m2;
+		float delta = (den < 0) ? 0.5f * (m0 - m2) / den : 0;
+
+		f->peak_hz[i] = (k + delta) * resolution_hz;
+		f->peak_amp[i] = (m1 - 0.25f * (m0 - m2) * delta) * amp_scale;
+	}
+}
+
+static void imu_fft_analyse(imu_fft_handle_t handle)
+{
+	uint32_t start = 0;
+
+	if (handle->cfg.func_get_cycles != NULL)
+	{
+		start = handle->cfg.func_get_cycles();
+	}
+
+	for (uint8_t a = 0; a < handle->num_axes; a++)
+	{
+		void *frame = imu_fft_frame(handle, a);
+		imu_fft_axis_features_t *f = &handle->features.axis[a];
+
+		/* Raw data to g or deg/s in the range of the frame */
+		float unit = handle->axis_gyro[a] ? (float)(250 << handle->gyro_range) / 32768.0f :
+		             (float)(2 << handle->accel_range) / 32768.0f;
+
+		imu_fft_prepare(handle, frame, &f->mean, &f->rms);
+		f->mean *= unit;
+		f->rms *= unit;
+
+		imu_fft_transform(handle, frame);
+		imu_fft_extract(handle, frame, unit, f);
+	}
+
+	if (handle->cfg.func_get_cycles != NULL)
+	{
+		handle->status.analysis_cycles = handle->cfg.func_get_cycles() - start;
+	}
+
+	handle->status.frames++;
+
+	if (handle->cfg.func_features != NULL)
+	{
+		handle->cfg.func_features(&handle->features);
+	}
+}
+
+imu_fft_handle_t imu_fft_init(void)
+{
+	imu_fft_handle_t handle = calloc(1, sizeof(imu_fft_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_fft_set_config(imu_fft_handle_t handle, imu_fft_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if ((handle == NULL) || (config.buf == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	uint8_t num_axes = ((config.channels & IMU_CHANNEL_ACCEL) ? 3 : 0) + ((config.channels & IMU_CHANNEL_GYRO) ? 3 : 0);
+
+	if ((config.points < IMU_FFT_MIN_POINTS) || (config.points > IMU_FFT_MAX_POINTS) ||
+	        ((config.points & (config.points - 1)) != 0) ||
+	        (config.format >= IMU_FFT_FORMAT_MAX) || (config.window >= IMU_FFT_WINDOW_MAX) ||
+	        (num_axes == 0) || (config.sample_rate_hz <= 0) || (config.num_bands > IMU_FFT_MAX_BANDS) ||
+	        (config.buf_size < (uint32_t)IMU_FFT_BUF_SIZE(config.points, num_axes, imu_fft_sample_size(config.format))) ||
+	        (((uintptr_t)config.buf & (sizeof(float) - 1)) != 0))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	for (uint8_t b = 0; b < config.num_bands; b++)
+	{
+		if (config.band_edges_hz[b + 1] <= config.band_edges_hz[b])
+		{
+			return ERR_CODE_FAIL;
+		}
+	}
+
+	handle->cfg = config;
+	handle->num_axes = 0;
+
+	for (uint8_t a = 0; a < IMU_FFT_MAX_AXES; a++)
+	{
+		uint8_t gyro = (a >= 3);
+		if (config.channels & (gyro ? IMU_CHANNEL_GYRO : IMU_CHANNEL_ACCEL))
+		{
+			handle->axis_offset[handle->num_axes] = imu_fft_axis_offset[a];
+			handle->axis_gyro[handle->num_axes] = gyro;
+			handle->num_axes++;
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_fft_config(imu_fft_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	uint16_t n = handle->cfg.points;
+
+	for (uint16_t k = 0; k < n / 2; k++)
+	{
+		float c = cosf(2.0f * FFT_PI * k / n);
+		float s = sinf(2.0f * FFT_PI * k / n);
+
+		if (handle->cfg.format == IMU_FFT_FORMAT_Q15)
+		{
+			int16_t *tw = (int16_t *)imu_fft_twiddle(handle);
+			tw[k] = (int16_t)lrintf(c * FFT_Q15_ONE);
+			tw[n / 2 + k] = (int16_t)lrintf(s * FFT_Q15_ONE);
+		}
+		else
+		{
+			float *tw = (float *)imu_fft_twiddle(handle);
+			tw[k] = c;
+			tw[n / 2 + k] = s;
+		}
+	}
+
+	handle->count = 0;
+	memset(&handle->features, 0, sizeof(imu_fft_features_t));
+	handle->features.resolution_hz = handle->cfg.sample_rate_hz / n;
+	handle->features.num_axes = handle->num_axes;
+	memset(&handle->status, 0, sizeof(imu_fft_status_t));
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_fft_write(imu_fft_handle_t handle, const imu_sample_t *samples, uint16_t num_samples)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	for (uint16_t i = 0; i < num_samples; i++)
+	{
+		const imu_sample_t *s = &samples[i];
+
+		if ((handle->count != 0) &&
+		        ((s->seq != handle->next_seq) || (s->accel_range != handle->accel_range) || (s->gyro_range != handle->gyro_range)))
+		{
+			handle->count = 0;
+			handle->status.restarts++;
+		}
+
+		if (handle->count == 0)
+		{
+			handle->features.first_seq = s->seq;
+			handle->features.timestamp_us = s->timestamp_us;
+			handle->accel_range = s->accel_range;
+			handle->gyro_range = s->gyro_range;
+		}
+
+		for (uint8_t a = 0; a < handle->num_axes; a++)
+		{
+			int16_t raw;
+			memcpy(&raw, (const uint8_t *)s + handle->axis_offset[a], sizeof(raw));
+
+			if (handle->cfg.format == IMU_FFT_FORMAT_Q15)
+			{
+				((int16_t *)imu_fft_frame(handle, a))[handle->count] = raw;
+			}
+			else
+			{
+				((float *)imu_fft_frame(handle, a))[handle->count] = raw;
+			}
+		}
+
+		handle->next_seq = s->seq + 1;
+
+		if (++handle->count == handle->cfg.points)
+		{
+			imu_fft_analyse(handle);
+			handle->count = 0;
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_fft_get_status(imu_fft_handle_t handle, imu_fft_status_t *status)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (status == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*status = handle->status;
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,166 @@
+#ifndef __IMU_FFT_H__
+#define __IMU_FFT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+
+#define IMU_FFT_MIN_POINTS              256         /*!< Shortest frame */
+#define IMU_FFT_MAX_POINTS              4096        /*!< Longest frame */
+#define IMU_FFT_MAX_AXES                6           /*!< Accelerometer x, y, z, gyroscope x, y, z */
+#define IMU_FFT_MAX_BANDS               8           /*!< Energy bands per axis */
+#define IMU_FFT_MAX_PEAKS               3           /*!< Spectral peaks per axis */
+
+/* Work buffer size, one frame per axis and the twiddle table. sample_size
+ * is sizeof(float) for IMU_FFT_FORMAT_FLOAT and sizeof(int16_t) for
+ * IMU_FFT_FORMAT_Q15.
+ */
+#define IMU_FFT_BUF_SIZE(points, num_axes, sample_size)     (((num_axes) + 1) * (points) * (sample_size))
+
+typedef struct imu_fft* imu_fft_handle_t;
+
+/**
+ * @brief   Arithmetic format.
+ */
+typedef enum {
+    IMU_FFT_FORMAT_FLOAT = 0,                               /*!< Single precision float */
+    IMU_FFT_FORMAT_Q15,                                     /*!< 16 bit fixed point, raw data is used as is */
+    IMU_FFT_FORMAT_MAX
+} imu_fft_format_t;
+
+/**
+ * @brief   Window.
+ */
+typedef enum {
+    IMU_FFT_WINDOW_HANN = 0,                                /*!< Hann */
+    IMU_FFT_WINDOW_RECT,                                    /*!< Rectangular, for signals periodic in the frame */
+    IMU_FFT_WINDOW_MAX
+} imu_fft_window_t;
+
+/**
+ * @brief   Features of one axis.
+ */
+typedef struct {
+    float                       mean;                       /*!< Mean of the frame */
+    float                       rms;                        /*!< RMS of the frame with the mean removed */
+    float                       band_rms[IMU_FFT_MAX_BANDS];    /*!< RMS of each band */
+    float                       peak_hz[IMU_FFT_MAX_PEAKS];     /*!< Strongest spectral peaks, strongest first, 0 when missing */
+    float                       peak_amp[IMU_FFT_MAX_PEAKS];    /*!< Sine amplitude of each peak, low by up to the window scalloping loss */
+} imu_fft_axis_features_t;
+
+/**
+ * @brief   Features of one frame. Accelerometer axes are in g, gyroscope
+ *          axes in deg/s.
+ */
+typedef struct {
+    uint32_t                    first_seq;                  /*!< Sequence number of the first sample of the frame */
+    uint64_t                    timestamp_us;               /*!< Timestamp of the first sample of the frame */
+    float                       resolution_hz;              /*!< Bin spacing */
+    uint8_t                     num_axes;                   /*!< Axes in axis, accelerometer first */
+    imu_fft_axis_features_t     axis[IMU_FFT_MAX_AXES];     /*!< Features per axis */
+} imu_fft_features_t;
+
+typedef void (*imu_fft_func_features)(const imu_fft_features_t *features);
+
+/**
+ * @brief   Spectral analysis configuration structure.
+ */
+typedef struct {
+    uint16_t                    points;                     /*!< Frame length, power of two, IMU_FFT_MIN_POINTS..IMU_FFT_MAX_POINTS */
+    imu_fft_format_t            format;                     /*!< Arithmetic format */
+    imu_fft_window_t            window;                     /*!< Window */
+    uint8_t                     channels;                   /*!< IMU_CHANNEL_ACCEL, IMU_CHANNEL_GYRO or both */
+    float                       sample_rate_hz;             /*!< Input sample rate */
+    float                       band_edges_hz[IMU_FFT_MAX_BANDS + 1];   /*!< Band edges, ascending, band i is edge i to edge i + 1 */
+    uint8_t                     num_bands;                  /*!< Number of bands */
+    void                        *buf;                       /*!< Work buffer of IMU_FFT_BUF_SIZE bytes, aligned for float */
+    uint32_t                    buf_size;                   /*!< Work buffer size */
+    imu_fft_func_features       func_features;              /*!< Receives the features of every frame */
+    imu_func_get_cycles         func_get_cycles;            /*!< Optional cycle counter, NULL disables the analysis cost */
+} imu_fft_cfg_t;
+
+/**
+ * @brief   Spectral analysis status structure.
+ */
+typedef struct {
+    uint32_t                    frames;                     /*!< Frames analysed */
+    uint32_t                    restarts;                   /*!< Partial frames dropped on a sequence gap or range change */
+    uint32_t                    analysis_cycles;            /*!< Cycles of the last frame analysis */
+} imu_fft_status_t;
+
+/*
+ * @brief   Initialize spectral analysis.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_fft_handle_t imu_fft_init(void);
+
+/*
+ * @brief   Set spectral analysis configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_fft_set_config(imu_fft_handle_t handle, imu_fft_cfg_t config);
+
+/*
+ * @brief   Configure spectral analysis. Builds the twiddle table in the
+ *          work buffer and clears the frame and status.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_fft_config(imu_fft_handle_t handle);
+
+/*
+ * @brief   Add raw samples, as returned by imu_read_fifo. Every full frame
+ *          is windowed, transformed in place and its features are passed
+ *          to func_features.
+ *
+ * @note    The real FFT runs as a complex FFT of half the points. Q15
+ *          halves every stage so nothing overflows, its noise floor is
+ *          about 70 dB below full scale. A sequence gap or a range change
+ *          drops the partial frame.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Samples.
+ * @param   num_samples Number of samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_fft_write(imu_fft_handle_t handle, const imu_sample_t *samples, uint16_t num_samples);
+
+/*
+ * @brief   Get spectral analysis status.
+ *
+ * @param   handle Handle structure.
+ * @param   status Status.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_fft_get_status(imu_fft_handle_t handle, imu_fft_status_t *status);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_FFT_H__ */
@@ -0,0 +1,438 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+#include "math.h"
+
+#include "imu_filter/imu_filter.h"
+
+#define FILTER_PI 					3.14159265358979f
+#define FILTER_ACCEL_LANE 			0 			/*!< First accelerometer lane */
+#define FILTER_GYRO_LANE 			3 			/*!< First gyroscope lane */
+#define FILTER_DYN_AXES 			3 			/*!< Gyroscope axes feeding the spectral estimate */
+#define FILTER_DYN_MIN_RATIO 		4.0f 		/*!< Peak over mean bin power needed to retune */
+#define FILTER_DYN_SMOOTH 			0.5f 		/*!< Weight of a new peak in the notch centre */
+#define FILTER_DYN_MIN_BLOCK 		32 			/*!< Shortest spectral estimate block */
+
+
+/* Coefficients of one stage, per lane so one loop filters every sensor */
+typedef struct {
+	float 						b0[IMU_FILTER_LANES];
+	float 						b1[IMU_FILTER_LANES];
+	float 						b2[IMU_FILTER_LANES];
+	float 						a1[IMU_FILTER_LANES];
+	float 						a2[IMU_FILTER_LANES];
+} imu_filter_coef_t;
+
+/* Direct form 1 state, input and output history stay valid across a
+ * coefficient change.
+ */
+typedef struct {
+	float 						x1[IMU_FILTER_LANES];
+	float 						x2[IMU_FILTER_LANES];
+	float 						y1[IMU_FILTER_LANES];
+	float 						y2[IMU_FILTER_LANES];
+} imu_filter_state_t;
+
+typedef struct imu_filter {
+	imu_filter_cfg_t 			cfg; 						/*!< Configuration */
+	uint8_t 					num_stages; 				/*!< Static stages in use */
+	imu_filter_coef_t 			coef[IMU_FILTER_MAX_STAGES]; 	/*!< Static stage coefficients */
+	imu_filter_state_t 			state[IMU_FILTER_MAX_STAGES]; 	/*!< Static stage state */
+	imu_filter_coef_t 			dyn_coef; 					/*!< Dynamic notch coefficients */
+	imu_filter_coef_t 			dyn_step; 					/*!< Dynamic notch coefficient change per sample */
+	imu_filter_state_t 			dyn_state; 					/*!< Dynamic notch state */
+	uint16_t 					dyn_ramp; 					/*!< Samples left in the coefficient ramp */
+	float 						bin_hz[IMU_FILTER_DYN_BINS]; 	/*!< Bin frequencies */
+	float 						bin_coef[IMU_FILTER_DYN_BINS]; 	/*!< Goertzel coefficients, 2 cos(w) */
+	float 						bin_s1[FILTER_DYN_AXES][IMU_FILTER_DYN_BINS]; 	/*!< Goertzel state */
+	float 						bin_s2[FILTER_DYN_AXES][IMU_FILTER_DYN_BINS]; 	/*!< Goertzel state */
+	uint16_t 					bin_count; 					/*!< Samples in the current block */
+	uint8_t 					primed; 					/*!< State holds the first sample */
+	imu_filter_status_t 		status; 					/*!< Status */
+} imu_filter_t;
+
+static void imu_filter_set_identity(imu_filter_coef_t *coef, uint8_t lane, uint8_t num_lanes)
+{
+	for (uint8_t l = lane; l < lane + num_lanes; l++)
+	{
+		coef->b0[l] = 1.0f;
+		coef->b1[l] = 0;
+		coef->b2[l] = 0;
+		coef->a1[l] = 0;
+		coef->a2[l] = 0;
+	}
+}
+
+static void imu_filter_design(imu_filter_coef_t *coef, uint8_t lane, uint8_t num_lanes,
+                              imu_filter_type_t type, float freq_hz, float q, float sample_rate_hz)
+{
+	if (type == IMU_FILTER_NONE)
+	{
+		imu_filter_set_identity(coef, lane, num_lanes);
+		return;
+	}
+
+	/* Audio EQ cookbook biquads, normalized by a0 */
+	float w0 = 2.0f * FILTER_PI * freq_hz / sample_rate_hz;
+	float cos_w0 = cosf(w0);
+	float alpha = sinf(w0) / (2.0f * q);
+	float a0 = 1.0f + alpha;
+	float b0, b1, b2;
+
+	switch (type)
+	{
+	case IMU_FILTER_LOWPASS:
+		b0 = (1.0f - cos_w0) / 2.0f;
+		b1 = 1.0f - cos_w0;
+		b2 = b0;
+		break;
+	case IMU_FILTER_HIGHPASS:
+		b0 = (1.0f + cos_w0) / 2.0f;
+		b1 = -(1.0f + cos_w0);
+		b2 = b0;
+		break;
+	default:
+		b0 = 1.0f;
+		b1 = -2.0f * cos_w0;
+		b2 = 1.0f;
+		break;
+	}
+
+	for (uint8_t l = lane; l < lane + num_lanes; l++)
+	{
+		coef->b0[l] = b0 / a0;
+		coef->b1[l] = b1 / a0;
+		coef->b2[l] = b2 / a0;
+		coef->a1[l] = -2.0f * cos_w0 / a0;
+		coef->a2[l] = (1.0f - alpha) / a0;
+	}
+}
+
+static void imu_filter_prime(const imu_filter_coef_t *coef, imu_filter_state_t *state, const float *x)
+{
+	/* Steady state of a constant input, the first sample does not step */
+	for (uint8_t l = 0; l < IMU_FILTER_LANES; l++)
+	{
+		float den = 1.0f + coef->a1[l] + coef->a2[l];
+		float gain = (den != 0) ? (coef->b0[l] + coef->b1[l] + coef->b2[l]) / den : 0;
+
+		state->x1[l] = x[l];
+		state->x2[l] = x[l];
+		state->y1[l] = gain * x[l];
+		state->y2[l] = gain * x[l];
+	}
+}
+
+static void imu_filter_biquad(const imu_filter_coef_t *coef, imu_filter_state_t *state, float *x)
+{
+	for (uint8_t l = 0; l < IMU_FILTER_LANES; l++)
+	{
+		float y = coef->b0[l] * x[l] + coef->b1[l] * state->x1[l] + coef->b2[l] * state->x2[l]
+		          - coef->a1[l] * state->y1[l] - coef->a2[l] * state->y2[l];
+
+		state->x2[l] = state->x1[l];
+		state->x1[l] = x[l];
+		state->y2[l] = state->y1[l];
+		state->y1[l] = y;
+		x[l] = y;
+	}
+}
+
+static void imu_filter_ramp(imu_filter_handle_t handle)
+{
+	float *c = (float *)&handle->dyn_coef;
+	const float *d = (const float *)&handle->dyn_step;
+
+	for (uint8_t i = 0; i < sizeof(imu_filter_coef_t) / sizeof(float); i++)
+	{
+		c[i] += d[i];
+	}
+
+	handle->dyn_ramp--;
+}
+
+static void imu_filter_retune(imu_filter_handle_t handle, float freq_hz)
+{
+	imu_filter_coef_t target = handle->dyn_coef;
+	uint8_t num_lanes = handle->cfg.dyn_notch_accel ? 6 : 3;
+	uint8_t lane = handle->cfg.dyn_notch_accel ? FILTER_ACCEL_LANE : FILTER_GYRO_LANE;
+
+	/* Any remaining ramp ends here, the new one starts from where it is */
+	imu_filter_design(&target, lane, num_lanes, IMU_FILTER_NOTCH, freq_hz, handle->cfg.dyn_notch_q, handle->cfg.sample_rate_hz);
+
+	/* Biquads with coefficients on the line between two stable ones are
+	 * stable, the stability triangle of a1, a2 is convex.
+	 */
+	float *c = (float *)&handle->dyn_coef;
+	float *t = (float *)&target;
+	float *d = (float *)&handle->dyn_step;
+	uint16_t ramp = handle->cfg.dyn_notch_block;
+
+	for (uint8_t i = 0; i < sizeof(imu_filter_coef_t) / sizeof(float); i++)
+	{
+		d[i] = (t[i] - c[i]) / ramp;
+	}
+
+	handle->dyn_ramp = ramp;
+	handle->status.dyn_notch_hz = freq_hz;
+	handle->status.retunes++;
+}
+
+static void imu_filter_estimate(imu_filter_handle_t handle)
+{
+	float power[IMU_FILTER_DYN_BINS];
+	float total = 0;
+	uint8_t peak = 0;
+
+	for (uint8_t k = 0; k < IMU_FILTER_DYN_BINS; k++)
+	{
+		power[k] = 0;
+		for (uint8_t a = 0; a < FILTER_DYN_AXES; a++)
+		{
+			float s1 = handle->bin_s1[a][k];
+			float s2 = handle->bin_s2[a][k];
+
+			power[k] += s1 * s1 + s2 * s2 - handle->bin_coef[k] * s1 * s2;
+		}
+
+		/* Rounding may leave an empty bin just below zero */
+		if (power[k] < 0)
+		{
+			power[k] = 0;
+		}
+
+		total += power[k];
+		if (power[k] > power[peak])
+		{
+			peak = k;
+		}
+	}
+
+	memset(handle->bin_s1, 0, sizeof(handle->bin_s1));
+	memset(handle->bin_s2, 0, sizeof(handle->bin_s2));
+	handle->bin_count = 0;
+	handle->status.estimates++;
+
+	/* Parabola through the peak and its neighbours magnitudes */
+	float freq_hz = handle->bin_hz[peak];
+	if ((peak > 0) && (peak < IMU_FILTER_DYN_BINS - 1))
+	{
+		float m0 = sqrtf(power[peak - 1]);
+		float m1 = sqrtf(power[peak]);
+		float m2 = sqrtf(power[peak + 1]);
+		float den = m0 - 2.0f * m1 + m2;
+		if (den < 0)
+		{
+			float delta = 0.5f * (m0 - m2) / den;
+			freq_hz += delta * (handle->bin_hz[1] - handle->bin_hz[0]);
+		}
+	}
+
+	float mean = total / IMU_FILTER_DYN_BINS;
+	handle->status.peak_hz = freq_hz;
+	handle->status.peak_ratio = (mean > 0) ? power[peak] / mean : 0;
+
+	/* Hold the notch when no peak stands out */
+	if (handle->status.peak_ratio < FILTER_DYN_MIN_RATIO)
+	{
+		return;
+	}
+
+	if (handle->status.dyn_notch_hz > 0)
+	{
+		freq_hz = handle->status.dyn_notch_hz + FILTER_DYN_SMOOTH * (freq_hz - handle->status.dyn_notch_hz);
+	}
+
+	imu_filter_retune(handle, freq_hz);
+}
+
+static void imu_filter_goertzel(imu_filter_handle_t handle, const float *x)
+{
+	for (uint8_t a = 0; a < FILTER_DYN_AXES; a++)
+	{
+		float in = x[FILTER_GYRO_LANE + a];
+		float *s1 = handle->bin_s1[a];
+		float *s2 = handle->bin_s2[a];
+
+		for (uint8_t k = 0; k < IMU_FILTER_DYN_BINS; k++)
+		{
+			float s = in + handle->bin_coef[k] * s1[k] - s2[k];
+			s2[k] = s1[k];
+			s1[k] = s;
+		}
+	}
+
+	if (++handle->bin_count == handle->cfg.dyn_notch_block)
+	{
+		imu_filter_estimate(handle);
+	}
+}
+
+imu_filter_handle_t imu_filter_init(void)
+{
+	imu_filter_handle_t handle = calloc(1, sizeof(imu_filter_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_filter_set_config(imu_filter_handle_t handle, imu_filter_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	float nyquist_hz = config.sample_rate_hz / 2.0f;
+
+	if (config.sample_rate_hz <= 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	for (uint8_t i = 0; i < IMU_FILTER_MAX_STAGES; i++)
+	{
+		const imu_filter_stage_t *stage[2] = {&config.accel_stages[i], &config.gyro_stages[i]};
+
+		for (uint8_t j = 0; j < 2; j++)
+		{
+			if ((stage[j]->type >= IMU_FILTER_TYPE_MAX) ||
+			        ((stage[j]->type != IMU_FILTER_NONE) &&
+			         ((stage[j]->freq_hz <= 0) || (stage[j]->freq_hz >= nyquist_hz) || (stage[j]->q <= 0))))
+			{
+				return ERR_CODE_FAIL;
+			}
+		}
+	}
+
+	/* A block must resolve the bin spacing */
+	if (config.dyn_notch_enable &&
+	        ((config.dyn_notch_min_hz <= 0) || (config.dyn_notch_max_hz <= config.dyn_notch_min_hz) ||
+	         (config.dyn_notch_max_hz >= nyquist_hz) || (config.dyn_notch_q <= 0) ||
+	         (config.dyn_notch_block < FILTER_DYN_MIN_BLOCK)))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->cfg = config;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_filter_config(imu_filter_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->num_stages = 0;
+	for (uint8_t i = 0; i < IMU_FILTER_MAX_STAGES; i++)
+	{
+		const imu_filter_stage_t *accel = &handle->cfg.accel_stages[i];
+		const imu_filter_stage_t *gyro = &handle->cfg.gyro_stages[i];
+
+		imu_filter_set_identity(&handle->coef[i], 0, IMU_FILTER_LANES);
+		imu_filter_design(&handle->coef[i], FILTER_ACCEL_LANE, 3, accel->type, accel->freq_hz, accel->q, handle->cfg.sample_rate_hz);
+		imu_filter_design(&handle->coef[i], FILTER_GYRO_LANE, 3, gyro->type, gyro->freq_hz, gyro->q, handle->cfg.sample_rate_hz);
+
+		if ((accel->type != IMU_FILTER_NONE) || (gyro->type != IMU_FILTER_NONE))
+		{
+			handle->num_stages = i + 1;
+		}
+	}
+
+	/* The dynamic notch passes data until the first peak */
+	imu_filter_set_identity(&handle->dyn_coef, 0, IMU_FILTER_LANES);
+	handle->dyn_ramp = 0;
+
+	float spacing_hz = (handle->cfg.dyn_notch_max_hz - handle->cfg.dyn_notch_min_hz) / (IMU_FILTER_DYN_BINS - 1);
+	for (uint8_t k = 0; k < IMU_FILTER_DYN_BINS; k++)
+	{
+		handle->bin_hz[k] = handle->cfg.dyn_notch_min_hz + k * spacing_hz;
+		handle->bin_coef[k] = 2.0f * cosf(2.0f * FILTER_PI * handle->bin_hz[k] / handle->cfg.sample_rate_hz);
+	}
+	memset(handle->bin_s1, 0, sizeof(handle->bin_s1));
+	memset(handle->bin_s2, 0, sizeof(handle->bin_s2));
+	handle->bin_count = 0;
+
+	handle->primed = 0;
+	memset(&handle->status, 0, sizeof(imu_filter_status_t));
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_filter_apply(imu_filter_handle_t handle, imu_sample_scale_t *samples, uint16_t num_samples)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	for (uint16_t i = 0; i < num_samples; i++)
+	{
+		imu_sample_scale_t *s = &samples[i];
+		float x[IMU_FILTER_LANES] = {
+			s->accel_x, s->accel_y, s->accel_z,
+			s->gyro_x, s->gyro_y, s->gyro_z,
+			0, 0
+		};
+
+		if (!handle->primed)
+		{
+			for (uint8_t k = 0; k < handle->num_stages; k++)
+			{
+				imu_filter_prime(&handle->coef[k], &handle->state[k], x);
+			}
+			handle->primed = 1;
+		}
+
+		for (uint8_t k = 0; k < handle->num_stages; k++)
+		{
+			imu_filter_biquad(&handle->coef[k], &handle->state[k], x);
+		}
+
+		if (handle->cfg.dyn_notch_enable)
+		{
+			/* Estimate before the notch, after it the peak is gone */
+			imu_filter_goertzel(handle, x);
+
+			if (handle->dyn_ramp != 0)
+			{
+				imu_filter_ramp(handle);
+			}
+
+			imu_filter_biquad(&handle->dyn_coef, &handle->dyn_state, x);
+		}
+
+		s->accel_x = x[0];
+		s->accel_y = x[1];
+		s->accel_z = x[2];
+		s->gyro_x = x[3];
+		s->gyro_y = x[4];
+		s->gyro_z = x[5];
+	}
+
+	handle->status.samples += num_samples;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_filter_get_status(imu_filter_handle_t handle, imu_filter_status_t *status)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (status == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*status = handle->status;
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,140 @@
+#ifndef __IMU_FILTER_H__
+#define __IMU_FILTER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+
+#define IMU_FILTER_MAX_STAGES           4           /*!< Static biquad stages per sensor */
+#define IMU_FILTER_LANES                8           /*!< Accelerometer x, y, z, gyroscope x, y, z, padding */
+#define IMU_FILTER_DYN_BINS             16          /*!< Spectral estimate bins of the dynamic notch */
+
+typedef struct imu_filter* imu_filter_handle_t;
+
+/**
+ * @brief   Biquad type.
+ */
+typedef enum {
+    IMU_FILTER_NONE = 0,                                    /*!< Stage passes data unchanged */
+    IMU_FILTER_LOWPASS,                                     /*!< Second order low-pass */
+    IMU_FILTER_HIGHPASS,                                    /*!< Second order high-pass */
+    IMU_FILTER_NOTCH,                                       /*!< Notch */
+    IMU_FILTER_TYPE_MAX
+} imu_filter_type_t;
+
+/**
+ * @brief   Biquad stage structure.
+ */
+typedef struct {
+    imu_filter_type_t           type;                       /*!< Type */
+    float                       freq_hz;                    /*!< Cutoff or centre frequency, below half the sample rate */
+    float                       q;                          /*!< Quality factor, 0.7071 for a Butterworth low-pass or high-pass */
+} imu_filter_stage_t;
+
+/**
+ * @brief   Filter configuration structure.
+ */
+typedef struct {
+    float                       sample_rate_hz;             /*!< Input sample rate */
+    imu_filter_stage_t          accel_stages[IMU_FILTER_MAX_STAGES];    /*!< Accelerometer stages, applied in order */
+    imu_filter_stage_t          gyro_stages[IMU_FILTER_MAX_STAGES];     /*!< Gyroscope stages, applied in order */
+    bool                        dyn_notch_enable;           /*!< Enable the dynamic notch on the gyroscope */
+    bool                        dyn_notch_accel;            /*!< Apply the dynamic notch to the accelerometer too */
+    float                       dyn_notch_min_hz;           /*!< Lowest tracked frequency */
+    float                       dyn_notch_max_hz;           /*!< Highest tracked frequency */
+    float                       dyn_notch_q;                /*!< Quality factor of the dynamic notch */
+    uint16_t                    dyn_notch_block;            /*!< Samples per spectral estimate, also the coefficient ramp length */
+} imu_filter_cfg_t;
+
+/**
+ * @brief   Filter status structure.
+ */
+typedef struct {
+    float                       dyn_notch_hz;               /*!< Current dynamic notch centre frequency, 0 before the first peak */
+    float                       peak_hz;                    /*!< Peak of the last spectral estimate */
+    float                       peak_ratio;                 /*!< Peak bin power over the mean bin power of the last estimate */
+    uint32_t                    estimates;                  /*!< Spectral estimates */
+    uint32_t                    retunes;                    /*!< Dynamic notch coefficient changes */
+    uint32_t                    samples;                    /*!< Filtered samples */
+} imu_filter_status_t;
+
+/*
+ * @brief   Initialize filter.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_filter_handle_t imu_filter_init(void);
+
+/*
+ * @brief   Set filter configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_filter_set_config(imu_filter_handle_t handle, imu_filter_cfg_t config);
+
+/*
+ * @brief   Configure filter. Computes the stage coefficients and clears the
+ *          filter state and status. Call again after a sample rate change.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_filter_config(imu_filter_handle_t handle);
+
+/*
+ * @brief   Filter scaled samples in place, as returned by imu_scale_sample.
+ *          Accelerometer and gyroscope axes are filtered, other fields are
+ *          left unchanged.
+ *
+ * @note    The dynamic notch tracks the strongest peak between
+ *          dyn_notch_min_hz and dyn_notch_max_hz. Goertzel bins over the
+ *          gyroscope axes give one spectral estimate every dyn_notch_block
+ *          samples. The notch coefficients then move linearly to the new
+ *          centre over the next block, every intermediate filter is
+ *          stable so the output does not glitch. Per sample cost is the
+ *          stages times 8 lanes, plus 3 times IMU_FILTER_DYN_BINS Goertzel
+ *          updates.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Samples.
+ * @param   num_samples Number of samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_filter_apply(imu_filter_handle_t handle, imu_sample_scale_t *samples, uint16_t num_samples);
+
+/*
+ * @brief   Get filter status.
+ *
+ * @param   handle Handle structure.
+ * @param   status Status.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_filter_get_status(imu_filter_handle_t handle, imu_filter_status_t *status);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_FILTER_H__ */
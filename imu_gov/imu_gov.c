@@ -0,0 +1,177 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+#include "math.h"
+
+#include "imu_gov/imu_gov.h"
+
+
+typedef struct imu_gov {
+	imu_gov_cfg_t 				cfg; 						/*!< Configuration */
+	float 						accel_ms; 					/*!< Mean square accelerometer activity in g^2 */
+	float 						gyro_ms; 					/*!< Mean square gyroscope activity in (deg/s)^2 */
+	uint64_t 					profile_time_us; 			/*!< Time since the last profile change */
+	uint32_t 					last_seq; 					/*!< Sequence number of the last sample */
+	imu_gov_status_t 			status; 					/*!< Status */
+} imu_gov_t;
+
+static err_code_t imu_gov_set_profile(imu_gov_handle_t handle, uint8_t profile)
+{
+	const imu_gov_profile_t *p = &handle->cfg.profiles[profile];
+
+	err_code_t err = imu_set_rate(handle->cfg.imu, p->dlpf_cfg, p->smplrt_div);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	imu_gov_event_t event = {
+		.from_profile = handle->status.profile,
+		.to_profile = profile,
+		.last_seq = handle->last_seq,
+		.accel_activity_g = sqrtf(handle->accel_ms),
+		.gyro_activity_dps = sqrtf(handle->gyro_ms),
+	};
+	imu_get_sample_period(handle->cfg.imu, &event.period_us);
+
+	handle->status.profile = profile;
+	handle->status.changes++;
+	handle->profile_time_us = 0;
+
+	if (handle->cfg.func_rate_change != NULL)
+	{
+		handle->cfg.func_rate_change(&event);
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+imu_gov_handle_t imu_gov_init(void)
+{
+	imu_gov_handle_t handle = calloc(1, sizeof(imu_gov_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_gov_set_config(imu_gov_handle_t handle, imu_gov_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if ((handle == NULL) || (config.imu == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((config.num_profiles == 0) || (config.num_profiles > IMU_GOV_MAX_PROFILES) ||
+	        (config.initial_profile >= config.num_profiles) || (config.window_ms <= 0))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->cfg = config;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_gov_config(imu_gov_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	const imu_gov_profile_t *p = &handle->cfg.profiles[handle->cfg.initial_profile];
+
+	err_code_t err = imu_set_rate(handle->cfg.imu, p->dlpf_cfg, p->smplrt_div);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	handle->accel_ms = 0;
+	handle->gyro_ms = 0;
+	handle->profile_time_us = 0;
+	handle->last_seq = 0;
+	memset(&handle->status, 0, sizeof(imu_gov_status_t));
+	handle->status.profile = handle->cfg.initial_profile;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_gov_update(imu_gov_handle_t handle, const imu_sample_t *samples, uint16_t num_samples)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (num_samples == 0)
+	{
+		return ERR_CODE_SUCCESS;
+	}
+
+	float window_us = handle->cfg.window_ms * 1000.0f;
+	uint8_t profile = handle->status.profile;
+
+	for (uint16_t i = 0; i < num_samples; i++)
+	{
+		imu_sample_scale_t scale;
+		imu_scale_sample(handle->cfg.imu, &samples[i], &scale);
+
+		/* Deviation of the acceleration magnitude from gravity does not
+		 * depend on orientation.
+		 */
+		float accel = sqrtf(scale.accel_x * scale.accel_x + scale.accel_y * scale.accel_y + scale.accel_z * scale.accel_z) - 1.0f;
+		float gyro_sq = scale.gyro_x * scale.gyro_x + scale.gyro_y * scale.gyro_y + scale.gyro_z * scale.gyro_z;
+
+		/* Exponential average over window_ms whatever the current rate */
+		float alpha = samples[i].period_us / window_us;
+		if (alpha > 1.0f)
+		{
+			alpha = 1.0f;
+		}
+
+		handle->accel_ms += alpha * (accel * accel - handle->accel_ms);
+		handle->gyro_ms += alpha * (gyro_sq - handle->gyro_ms);
+		handle->profile_time_us += (uint64_t)samples[i].period_us;
+		handle->status.time_in_profile_us[profile] += (uint64_t)samples[i].period_us;
+	}
+
+	handle->last_seq = samples[num_samples - 1].seq;
+	handle->status.accel_activity_g = sqrtf(handle->accel_ms);
+	handle->status.gyro_activity_dps = sqrtf(handle->gyro_ms);
+
+	const imu_gov_profile_t *p = &handle->cfg.profiles[profile];
+
+	if ((profile + 1 < handle->cfg.num_profiles) &&
+	        ((handle->status.accel_activity_g > p->accel_up_g) || (handle->status.gyro_activity_dps > p->gyro_up_dps)))
+	{
+		return imu_gov_set_profile(handle, profile + 1);
+	}
+
+	if ((profile > 0) && (handle->profile_time_us >= (uint64_t)handle->cfg.hold_ms * 1000) &&
+	        (handle->status.accel_activity_g < p->accel_down_g) && (handle->status.gyro_activity_dps < p->gyro_down_dps))
+	{
+		return imu_gov_set_profile(handle, profile - 1);
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_gov_get_status(imu_gov_handle_t handle, imu_gov_status_t *status)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (status == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*status = handle->status;
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,139 @@
+#ifndef __IMU_GOV_H__
+#define __IMU_GOV_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+
+#define IMU_GOV_MAX_PROFILES            8           /*!< Maximum number of rate profiles */
+
+typedef struct imu_gov* imu_gov_handle_t;
+
+/**
+ * @brief   Rate profile structure. Profiles are ordered from the lowest to
+ *          the highest rate. For hysteresis the down thresholds of a profile
+ *          must be below the up thresholds of the profile before it.
+ */
+typedef struct {
+    uint8_t                     dlpf_cfg;                   /*!< Low-pass filter, DLPF_CFG of the CONFIG register */
+    uint8_t                     smplrt_div;                 /*!< Sample rate divider */
+    float                       accel_up_g;                 /*!< Step to the next profile when accelerometer activity exceeds this, in g */
+    float                       gyro_up_dps;                /*!< Step to the next profile when gyroscope activity exceeds this, in deg/s */
+    float                       accel_down_g;               /*!< Step to the previous profile when accelerometer activity is below this, in g */
+    float                       gyro_down_dps;              /*!< Step to the previous profile when gyroscope activity is below this, in deg/s */
+} imu_gov_profile_t;
+
+/**
+ * @brief   Rate change event structure.
+ */
+typedef struct {
+    uint8_t                     from_profile;               /*!< Profile before the change */
+    uint8_t                     to_profile;                 /*!< Profile after the change */
+    float                       period_us;                  /*!< Nominal sample period of the new profile */
+    uint32_t                    last_seq;                   /*!< Sequence number of the last sample evaluated at the old rate */
+    float                       accel_activity_g;           /*!< Accelerometer activity that caused the change */
+    float                       gyro_activity_dps;          /*!< Gyroscope activity that caused the change */
+} imu_gov_event_t;
+
+typedef void (*imu_gov_func_rate_change)(const imu_gov_event_t *event);
+
+/**
+ * @brief   Governor configuration structure.
+ */
+typedef struct {
+    imu_handle_t                imu;                        /*!< Configured IMU handle */
+    imu_gov_profile_t           profiles[IMU_GOV_MAX_PROFILES];     /*!< Rate profiles, lowest rate first */
+    uint8_t                     num_profiles;               /*!< Number of profiles */
+    uint8_t                     initial_profile;            /*!< Profile set by imu_gov_config */
+    float                       window_ms;                  /*!< Activity averaging time constant */
+    uint32_t                    hold_ms;                    /*!< Time a profile is kept at least before stepping down */
+    imu_gov_func_rate_change    func_rate_change;           /*!< Optional rate change event */
+} imu_gov_cfg_t;
+
+/**
+ * @brief   Governor status structure.
+ */
+typedef struct {
+    uint8_t                     profile;                    /*!< Current profile */
+    float                       accel_activity_g;           /*!< RMS deviation of the acceleration magnitude from 1 g */
+    float                       gyro_activity_dps;          /*!< RMS angular rate magnitude */
+    uint32_t                    changes;                    /*!< Profile changes */
+    uint64_t                    time_in_profile_us[IMU_GOV_MAX_PROFILES];   /*!< Time spent in each profile, counted from sample periods */
+} imu_gov_status_t;
+
+/*
+ * @brief   Initialize governor.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_gov_handle_t imu_gov_init(void);
+
+/*
+ * @brief   Set governor configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_gov_set_config(imu_gov_handle_t handle, imu_gov_cfg_t config);
+
+/*
+ * @brief   Configure governor. Sets the initial profile on the IMU and clears
+ *          activity and status.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_gov_config(imu_gov_handle_t handle);
+
+/*
+ * @brief   Update activity with new samples, as returned by imu_read_fifo or
+ *          imu_poll_sample, and step the profile up or down by one if the
+ *          thresholds are crossed. The change is written with imu_set_rate
+ *          and reported to func_rate_change.
+ *
+ * @note    Stepping up happens at once, stepping down only after hold_ms in
+ *          the current profile. Time is counted from the sample periods, so
+ *          no timestamp source is needed.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Samples.
+ * @param   num_samples Number of samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_gov_update(imu_gov_handle_t handle, const imu_sample_t *samples, uint16_t num_samples);
+
+/*
+ * @brief   Get governor status.
+ *
+ * @param   handle Handle structure.
+ * @param   status Status.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_gov_get_status(imu_gov_handle_t handle, imu_gov_status_t *status);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_GOV_H__ */
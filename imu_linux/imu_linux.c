@@ -0,0 +1,348 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/ioctl.h"
+#include "linux/i2c.h"
+#include "linux/i2c-dev.h"
+#include "linux/spi/spidev.h"
+
+#include "imu_linux/imu_linux.h"
+
+#define LINUX_MAX_FD 				8 			/*!< Number of device paths open at the same time */
+#define LINUX_PATH_LEN 				32
+#define LINUX_MAX_MSG 				(2 * IMU_LINUX_MAX_BATCH) 	/*!< A read is a register and a data message */
+
+
+typedef struct {
+	char 						path[LINUX_PATH_LEN]; 		/*!< Device path */
+	int 						fd; 						/*!< File descriptor */
+	uint32_t 					users; 						/*!< Number of handles using fd, 0 if free */
+} imu_linux_fd_t;
+
+typedef struct imu_linux {
+	imu_linux_bus_t 			bus; 						/*!< Bus type */
+	char 						path[LINUX_PATH_LEN]; 		/*!< Device path */
+	uint8_t 					i2c_addr; 					/*!< I2C slave address */
+	uint8_t 					spi_mode; 					/*!< SPI mode */
+	uint32_t 					spi_speed_hz; 				/*!< SPI clock of the next transfer */
+	int 						fd; 						/*!< Shared file descriptor, -1 if closed */
+	uint32_t 					i2c_timeout_ms; 			/*!< Timeout last set with I2C_TIMEOUT */
+	uint8_t 					reg[IMU_LINUX_MAX_BATCH]; 	/*!< Register address bytes of a batch */
+	uint8_t 					tx_buf[IMU_LINUX_MAX_XFER_LEN + 1];	/*!< I2C write buffer, register address and data */
+	struct i2c_msg 				i2c_msg[LINUX_MAX_MSG]; 	/*!< I2C_RDWR messages */
+	struct spi_ioc_transfer 	spi_xfer[LINUX_MAX_MSG]; 	/*!< SPI_IOC_MESSAGE segments */
+} imu_linux_t;
+
+static imu_linux_fd_t imu_linux_fd[LINUX_MAX_FD];
+
+static int imu_linux_open(const char *path)
+{
+	int free_idx = -1;
+
+	for (int i = 0; i < LINUX_MAX_FD; i++)
+	{
+		if (imu_linux_fd[i].users == 0)
+		{
+			if (free_idx < 0) {
+				free_idx = i;
+			}
+			continue;
+		}
+
+		if (strcmp(imu_linux_fd[i].path, path) == 0)
+		{
+			imu_linux_fd[i].users++;
+			return imu_linux_fd[i].fd;
+		}
+	}
+
+	if (free_idx < 0)
+	{
+		return -1;
+	}
+
+	int fd = open(path, O_RDWR);
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	/* Path length was checked by imu_linux_set_config */
+	strcpy(imu_linux_fd[free_idx].path, path);
+	imu_linux_fd[free_idx].fd = fd;
+	imu_linux_fd[free_idx].users = 1;
+
+	return fd;
+}
+
+static void imu_linux_close(int fd)
+{
+	for (int i = 0; i < LINUX_MAX_FD; i++)
+	{
+		if ((imu_linux_fd[i].users != 0) && (imu_linux_fd[i].fd == fd))
+		{
+			imu_linux_fd[i].users--;
+			if (imu_linux_fd[i].users == 0)
+			{
+				close(fd);
+			}
+			return;
+		}
+	}
+}
+
+static void imu_linux_set_i2c_timeout(imu_linux_t *linux_bus, uint32_t timeout_ms)
+{
+	/* I2C_TIMEOUT is per adapter and in units of 10 ms, only issue it on change */
+	if (timeout_ms != linux_bus->i2c_timeout_ms)
+	{
+		ioctl(linux_bus->fd, I2C_TIMEOUT, (unsigned long)((timeout_ms + 9) / 10));
+		linux_bus->i2c_timeout_ms = timeout_ms;
+	}
+}
+
+static err_code_t imu_linux_i2c_transfer(imu_linux_t *linux_bus, imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms)
+{
+	struct i2c_rdwr_ioctl_data data;
+	uint32_t num_msg = 0;
+	uint32_t tx_used = 0;
+
+	for (uint8_t i = 0; i < num_transfers; i++)
+	{
+		imu_transfer_t *transfer = &transfers[i];
+
+		if (transfer->dir == IMU_TRANSFER_READ)
+		{
+			/* Register address then repeated start and read */
+			linux_bus->reg[i] = transfer->reg_addr;
+			linux_bus->i2c_msg[num_msg++] = (struct i2c_msg) {linux_bus->i2c_addr, 0, 1, &linux_bus->reg[i]};
+			linux_bus->i2c_msg[num_msg++] = (struct i2c_msg) {linux_bus->i2c_addr, I2C_M_RD, transfer->len, transfer->buf};
+		}
+		else
+		{
+			/* Register address and data must be one message without restart */
+			if ((tx_used + transfer->len + 1) > (uint32_t)sizeof(linux_bus->tx_buf))
+			{
+				return ERR_CODE_FAIL;
+			}
+
+			uint8_t *tx = &linux_bus->tx_buf[tx_used];
+			tx[0] = transfer->reg_addr;
+			memcpy(&tx[1], transfer->buf, transfer->len);
+			tx_used += transfer->len + 1;
+
+			linux_bus->i2c_msg[num_msg++] = (struct i2c_msg) {linux_bus->i2c_addr, 0, (uint16_t)(transfer->len + 1), tx};
+		}
+	}
+
+	imu_linux_set_i2c_timeout(linux_bus, timeout_ms);
+
+	data.msgs = linux_bus->i2c_msg;
+	data.nmsgs = num_msg;
+	if (ioctl(linux_bus->fd, I2C_RDWR, &data) < 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+static err_code_t imu_linux_spi_transfer(imu_linux_t *linux_bus, imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms)
+{
+	uint32_t num_msg = 0;
+
+	/* spidev ioctls have no timeout */
+	(void)timeout_ms;
+
+	memset(linux_bus->spi_xfer, 0, sizeof(struct spi_ioc_transfer) * 2 * num_transfers);
+
+	for (uint8_t i = 0; i < num_transfers; i++)
+	{
+		imu_transfer_t *transfer = &transfers[i];
+		struct spi_ioc_transfer *addr = &linux_bus->spi_xfer[num_msg++];
+		struct spi_ioc_transfer *payload = &linux_bus->spi_xfer[num_msg++];
+
+		/* Address and data share one chip select assertion */
+		linux_bus->reg[i] = transfer->reg_addr;
+		addr->tx_buf = (unsigned long)&linux_bus->reg[i];
+		addr->len = 1;
+		addr->speed_hz = linux_bus->spi_speed_hz;
+
+		if (transfer->dir == IMU_TRANSFER_READ) {
+			payload->rx_buf = (unsigned long)transfer->buf;
+		} else {
+			payload->tx_buf = (unsigned long)transfer->buf;
+		}
+		payload->len = transfer->len;
+		payload->speed_hz = linux_bus->spi_speed_hz;
+
+		/* Release chip select between transfers of a batch */
+		payload->cs_change = (i + 1 < num_transfers) ? 1 : 0;
+	}
+
+	if (ioctl(linux_bus->fd, SPI_IOC_MESSAGE(num_msg), linux_bus->spi_xfer) < 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+static err_code_t imu_linux_transfer(void *ctx, imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms)
+{
+	imu_linux_t *linux_bus = (imu_linux_t *)ctx;
+
+	if ((linux_bus == NULL) || (transfers == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((linux_bus->fd < 0) || (num_transfers == 0) || (num_transfers > IMU_LINUX_MAX_BATCH))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	for (uint8_t i = 0; i < num_transfers; i++)
+	{
+		if ((transfers[i].buf == NULL) || (transfers[i].len == 0) || (transfers[i].len > IMU_LINUX_MAX_XFER_LEN))
+		{
+			return ERR_CODE_FAIL;
+		}
+	}
+
+	if (linux_bus->bus == IMU_LINUX_BUS_SPI)
+	{
+		return imu_linux_spi_transfer(linux_bus, transfers, num_transfers, timeout_ms);
+	}
+
+	return imu_linux_i2c_transfer(linux_bus, transfers, num_transfers, timeout_ms);
+}
+
+static err_code_t imu_linux_read_bytes(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	imu_transfer_t transfer = {reg_addr, buf, len, IMU_TRANSFER_READ};
+
+	return imu_linux_transfer(ctx, &transfer, 1, timeout_ms);
+}
+
+static err_code_t imu_linux_write_bytes(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	imu_transfer_t transfer = {reg_addr, buf, len, IMU_TRANSFER_WRITE};
+
+	return imu_linux_transfer(ctx, &transfer, 1, timeout_ms);
+}
+
+static void imu_linux_set_bus_clock(void *ctx, uint32_t clock_hz)
+{
+	imu_linux_t *linux_bus = (imu_linux_t *)ctx;
+
+	/* spidev takes the clock per segment, no ioctl needed */
+	if ((linux_bus != NULL) && (linux_bus->bus == IMU_LINUX_BUS_SPI))
+	{
+		linux_bus->spi_speed_hz = clock_hz;
+	}
+}
+
+static const imu_bus_ops_t imu_linux_ops = {
+	.read_bytes = imu_linux_read_bytes,
+	.write_bytes = imu_linux_write_bytes,
+	.transfer = imu_linux_transfer,
+	.set_bus_clock = imu_linux_set_bus_clock,
+	.get_time_us = NULL,
+};
+
+imu_linux_handle_t imu_linux_init(void)
+{
+	imu_linux_handle_t handle = calloc(1, sizeof(imu_linux_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	handle->fd = -1;
+
+	return handle;
+}
+
+err_code_t imu_linux_set_config(imu_linux_handle_t handle, imu_linux_cfg_t config)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (config.dev_path == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((config.bus >= IMU_LINUX_BUS_MAX) || (strlen(config.dev_path) >= LINUX_PATH_LEN))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->bus = config.bus;
+	strcpy(handle->path, config.dev_path);
+	handle->i2c_addr = config.i2c_addr;
+	handle->spi_mode = config.spi_mode;
+	handle->spi_speed_hz = config.spi_speed_hz;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_linux_config(imu_linux_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->fd < 0)
+	{
+		handle->fd = imu_linux_open(handle->path);
+		if (handle->fd < 0)
+		{
+			return ERR_CODE_FAIL;
+		}
+	}
+
+	handle->i2c_timeout_ms = 0;
+
+	if (handle->bus == IMU_LINUX_BUS_SPI)
+	{
+		uint8_t mode = handle->spi_mode & 0x03;
+		uint8_t bits = 8;
+
+		if ((ioctl(handle->fd, SPI_IOC_WR_MODE, &mode) < 0) ||
+		        (ioctl(handle->fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) ||
+		        (ioctl(handle->fd, SPI_IOC_WR_MAX_SPEED_HZ, &handle->spi_speed_hz) < 0))
+		{
+			return ERR_CODE_FAIL;
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_linux_deinit(imu_linux_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->fd >= 0)
+	{
+		imu_linux_close(handle->fd);
+		handle->fd = -1;
+	}
+
+	free(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+const imu_bus_ops_t *imu_linux_get_ops(void)
+{
+	return &imu_linux_ops;
+}
@@ -0,0 +1,104 @@
+#ifndef __IMU_LINUX_H__
+#define __IMU_LINUX_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu_bus/imu_bus.h"
+
+#define IMU_LINUX_MAX_XFER_LEN          1024        /*!< Largest single register transfer, covers a full FIFO drain */
+#define IMU_LINUX_MAX_BATCH             8           /*!< Largest number of transfers in one batch */
+
+typedef struct imu_linux* imu_linux_handle_t;
+
+/**
+ * @brief   Linux bus type.
+ */
+typedef enum {
+    IMU_LINUX_BUS_I2C = 0,                                  /*!< i2c-dev, /dev/i2c-N */
+    IMU_LINUX_BUS_SPI,                                      /*!< spidev, /dev/spidevB.C */
+    IMU_LINUX_BUS_MAX
+} imu_linux_bus_t;
+
+/**
+ * @brief   Linux backend configuration structure.
+ */
+typedef struct {
+    imu_linux_bus_t             bus;                        /*!< Bus type */
+    const char                  *dev_path;                  /*!< Device path, e.g. "/dev/i2c-1" or "/dev/spidev0.0" */
+    uint8_t                     i2c_addr;                   /*!< I2C 7 bit slave address */
+    uint8_t                     spi_mode;                   /*!< SPI mode, 0..3 */
+    uint32_t                    spi_speed_hz;               /*!< SPI clock until set_bus_clock selects another */
+} imu_linux_cfg_t;
+
+/*
+ * @brief   Initialize Linux bus backend.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_linux_handle_t imu_linux_init(void);
+
+/*
+ * @brief   Set Linux bus backend configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_linux_set_config(imu_linux_handle_t handle, imu_linux_cfg_t config);
+
+/*
+ * @brief   Open the device and configure it. Backends on the same device path
+ *          share one file descriptor.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_linux_config(imu_linux_handle_t handle);
+
+/*
+ * @brief   Close the device, the file descriptor is closed with its last user.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_linux_deinit(imu_linux_handle_t handle);
+
+/*
+ * @brief   Get Linux backend operations, ctx is the handle. Bind them with
+ *          imu_bus_bind to get the IMU transport functions.
+ *
+ * @note    Reads are one combined I2C_RDWR ioctl with a repeated start, or one
+ *          SPI_IOC_MESSAGE with chip select held. Batches run as a single
+ *          ioctl. Register addresses are sent as given, the MPU6500 driver
+ *          already sets the SPI read flag. Message buffers live in the
+ *          handle, there is no allocation per transfer.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Backend operations.
+ */
+const imu_bus_ops_t *imu_linux_get_ops(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_LINUX_H__ */
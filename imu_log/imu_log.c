@@ -0,0 +1,306 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+
+#include "imu_log/imu_log.h"
+
+#define LOG_SEQ_DELTA_MAX 			0xFF
+#define LOG_TIME_DELTA_MAX 			0xFFFF
+#define LOG_SAMPLE_MAX_SIZE 		(5 + 9 + 3 + IMU_LOG_RECORD_MAX_SIZE + 7) 	/*!< SEQ, TIME, RANGE, MOTION and MAG records of one sample */
+
+
+typedef struct imu_log_writer {
+	imu_log_writer_cfg_t 		cfg; 						/*!< Configuration */
+	uint32_t 					used; 						/*!< Buffered bytes */
+	uint32_t 					last_seq; 					/*!< Sequence number of the last MOTION record */
+	uint64_t 					last_time_us; 				/*!< Timestamp of the last MOTION record */
+	uint8_t 					last_accel_range; 			/*!< Accelerometer range of the last MOTION record */
+	uint8_t 					last_gyro_range; 			/*!< Gyroscope range of the last MOTION record */
+	uint8_t 					resync; 					/*!< Next MOTION record needs absolute SEQ and TIME */
+	imu_log_writer_stats_t 		stats; 						/*!< Statistics */
+} imu_log_writer_t;
+
+static uint8_t *imu_log_put_u16(uint8_t *p, uint16_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+
+	return p + 2;
+}
+
+static uint8_t *imu_log_put_u32(uint8_t *p, uint32_t value)
+{
+	p = imu_log_put_u16(p, (uint16_t)value);
+
+	return imu_log_put_u16(p, (uint16_t)(value >> 16));
+}
+
+static uint8_t *imu_log_put_u64(uint8_t *p, uint64_t value)
+{
+	p = imu_log_put_u32(p, (uint32_t)value);
+
+	return imu_log_put_u32(p, (uint32_t)(value >> 32));
+}
+
+static uint8_t *imu_log_put_f32(uint8_t *p, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	return imu_log_put_u32(p, bits);
+}
+
+static err_code_t imu_log_writer_drain(imu_log_writer_t *writer)
+{
+	if (writer->used == 0)
+	{
+		return ERR_CODE_SUCCESS;
+	}
+
+	err_code_t err = writer->cfg.func_flush(writer->cfg.buf, writer->used);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	writer->stats.bytes += writer->used;
+	writer->stats.flushes++;
+	writer->used = 0;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_log_header_from_imu(imu_handle_t imu, imu_log_header_t *header)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((imu == NULL) || (header == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	memset(header, 0, sizeof(imu_log_header_t));
+
+	imu_get_config_regs(imu, &header->regs);
+	imu_get_sample_period(imu, &header->sample_period_us);
+	imu_get_accel_bias(imu, &header->accel_bias_x, &header->accel_bias_y, &header->accel_bias_z);
+	imu_get_gyro_bias(imu, &header->gyro_bias_x, &header->gyro_bias_y, &header->gyro_bias_z);
+	imu_get_mag_hard_iron_bias(imu, &header->mag_hard_iron_bias_x, &header->mag_hard_iron_bias_y, &header->mag_hard_iron_bias_z);
+	imu_get_mag_soft_iron_bias(imu, &header->mag_soft_iron_bias_x, &header->mag_soft_iron_bias_y, &header->mag_soft_iron_bias_z);
+
+	return ERR_CODE_SUCCESS;
+}
+
+imu_log_writer_handle_t imu_log_writer_init(void)
+{
+	imu_log_writer_handle_t handle = calloc(1, sizeof(imu_log_writer_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_log_writer_set_config(imu_log_writer_handle_t handle, imu_log_writer_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if ((handle == NULL) || (config.buf == NULL) || (config.func_flush == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	/* The header and one complete sample must fit */
+	if ((config.buf_size < IMU_LOG_HEADER_SIZE) || (config.buf_size < LOG_SAMPLE_MAX_SIZE))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->cfg = config;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_log_writer_config(imu_log_writer_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->used = 0;
+	handle->resync = 1;
+	memset(&handle->stats, 0, sizeof(imu_log_writer_stats_t));
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_log_writer_start(imu_log_writer_handle_t handle, const imu_log_header_t *header)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (header == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	uint8_t *p = handle->cfg.buf;
+
+	memcpy(p, IMU_LOG_MAGIC, 4);
+	p = imu_log_put_u16(p + 4, IMU_LOG_VERSION);
+	p = imu_log_put_u16(p, IMU_LOG_HEADER_SIZE);
+
+	*p++ = header->regs.who_am_i;
+	*p++ = header->regs.mag_present;
+	*p++ = header->regs.smplrt_div;
+	*p++ = header->regs.config;
+	*p++ = header->regs.gyro_config;
+	*p++ = header->regs.accel_config;
+	*p++ = header->regs.accel_config2;
+	*p++ = header->regs.mag_cntl;
+	*p++ = header->regs.mag_asa[0];
+	*p++ = header->regs.mag_asa[1];
+	*p++ = header->regs.mag_asa[2];
+	*p++ = 0;
+
+	p = imu_log_put_f32(p, header->sample_period_us);
+	p = imu_log_put_u16(p, (uint16_t)header->accel_bias_x);
+	p = imu_log_put_u16(p, (uint16_t)header->accel_bias_y);
+	p = imu_log_put_u16(p, (uint16_t)header->accel_bias_z);
+	p = imu_log_put_u16(p, (uint16_t)header->gyro_bias_x);
+	p = imu_log_put_u16(p, (uint16_t)header->gyro_bias_y);
+	p = imu_log_put_u16(p, (uint16_t)header->gyro_bias_z);
+	p = imu_log_put_f32(p, header->mag_hard_iron_bias_x);
+	p = imu_log_put_f32(p, header->mag_hard_iron_bias_y);
+	p = imu_log_put_f32(p, header->mag_hard_iron_bias_z);
+	p = imu_log_put_f32(p, header->mag_soft_iron_bias_x);
+	p = imu_log_put_f32(p, header->mag_soft_iron_bias_y);
+	p = imu_log_put_f32(p, header->mag_soft_iron_bias_z);
+
+	handle->used = (uint32_t)(p - handle->cfg.buf);
+	handle->resync = 1;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_log_writer_write(imu_log_writer_handle_t handle, const imu_sample_t *sample, uint8_t channels)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (sample == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	uint8_t motion = channels & (IMU_CHANNEL_ACCEL | IMU_CHANNEL_TEMP | IMU_CHANNEL_GYRO);
+	uint8_t mag = channels & IMU_CHANNEL_MAG;
+
+	if ((motion == 0) && (mag == 0))
+	{
+		return ERR_CODE_SUCCESS;
+	}
+
+	/* Flush only when the whole sample may not fit, so records of one sample
+	 * are never split by a failed flush.
+	 */
+	if (handle->used + LOG_SAMPLE_MAX_SIZE > handle->cfg.buf_size)
+	{
+		if (imu_log_writer_drain(handle) != ERR_CODE_SUCCESS)
+		{
+			handle->stats.dropped++;
+			handle->resync = 1;
+			return ERR_CODE_FAIL;
+		}
+	}
+
+	uint8_t *p = handle->cfg.buf + handle->used;
+	uint8_t records = 0;
+
+	if (motion)
+	{
+		uint32_t seq_delta = sample->seq - handle->last_seq;
+		uint64_t time_delta = sample->timestamp_us - handle->last_time_us;
+
+		if (handle->resync || (seq_delta > LOG_SEQ_DELTA_MAX))
+		{
+			*p++ = IMU_LOG_RECORD_SEQ;
+			p = imu_log_put_u32(p, sample->seq);
+			seq_delta = 0;
+			records++;
+		}
+
+		if (handle->resync || (sample->timestamp_us < handle->last_time_us) || (time_delta > LOG_TIME_DELTA_MAX))
+		{
+			*p++ = IMU_LOG_RECORD_TIME;
+			p = imu_log_put_u64(p, sample->timestamp_us);
+			time_delta = 0;
+			records++;
+		}
+
+		if (handle->resync || (sample->accel_range != handle->last_accel_range) ||
+		        (sample->gyro_range != handle->last_gyro_range))
+		{
+			*p++ = IMU_LOG_RECORD_RANGE;
+			*p++ = sample->accel_range;
+			*p++ = sample->gyro_range;
+			records++;
+		}
+
+		*p++ = IMU_LOG_RECORD_MOTION;
+		*p++ = (uint8_t)seq_delta;
+		p = imu_log_put_u16(p, (uint16_t)time_delta);
+		p = imu_log_put_u16(p, (uint16_t)sample->accel_raw_x);
+		p = imu_log_put_u16(p, (uint16_t)sample->accel_raw_y);
+		p = imu_log_put_u16(p, (uint16_t)sample->accel_raw_z);
+		p = imu_log_put_u16(p, (uint16_t)sample->temp_raw);
+		p = imu_log_put_u16(p, (uint16_t)sample->gyro_raw_x);
+		p = imu_log_put_u16(p, (uint16_t)sample->gyro_raw_y);
+		p = imu_log_put_u16(p, (uint16_t)sample->gyro_raw_z);
+		records++;
+
+		handle->last_seq = sample->seq;
+		handle->last_time_us = sample->timestamp_us;
+		handle->last_accel_range = sample->accel_range;
+		handle->last_gyro_range = sample->gyro_range;
+		handle->resync = 0;
+	}
+
+	/* A magnetometer record without a preceding motion record of the log has
+	 * no sample to belong to.
+	 */
+	if (mag && !handle->resync)
+	{
+		*p++ = IMU_LOG_RECORD_MAG;
+		p = imu_log_put_u16(p, (uint16_t)sample->mag_raw_x);
+		p = imu_log_put_u16(p, (uint16_t)sample->mag_raw_y);
+		p = imu_log_put_u16(p, (uint16_t)sample->mag_raw_z);
+		records++;
+	}
+
+	handle->used = (uint32_t)(p - handle->cfg.buf);
+	handle->stats.records += records;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_log_writer_flush(imu_log_writer_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	return imu_log_writer_drain(handle);
+}
+
+err_code_t imu_log_writer_get_stats(imu_log_writer_handle_t handle, imu_log_writer_stats_t *stats)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (stats == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*stats = handle->stats;
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,346 @@
+#ifndef __IMU_LOG_H__
+#define __IMU_LOG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+#include "imu_bus/imu_bus.h"
+
+/*
+ * Log layout, all fields little endian:
+ *
+ *  Header, IMU_LOG_HEADER_SIZE bytes
+ *      0   magic "IMUL"
+ *      4   u16 version
+ *      6   u16 header size, readers skip bytes they do not know
+ *      8   who_am_i, mag_present, smplrt_div, config, gyro_config,
+ *          accel_config, accel_config2, mag_cntl, mag_asa[3], reserved
+ *      20  f32 sample period in us
+ *      24  i16 accel bias x, y, z, gyro bias x, y, z
+ *      36  f32 mag hard iron bias x, y, z, mag soft iron bias x, y, z
+ *
+ *  Records, first byte is the record type
+ *      MOTION  u8 seq delta, u16 time delta in us, i16 accel x, y, z,
+ *              temp, gyro x, y, z
+ *      MAG     i16 mag x, y, z, belongs to the preceding MOTION record
+ *      SEQ     u32 sequence number of the next MOTION record
+ *      TIME    u64 timestamp in us of the next MOTION record
+ *      RANGE   u8 accelerometer range, u8 gyroscope range of the next
+ *              MOTION records, 0..3 as imu_sample_t tags them
+ *
+ *  SEQ and TIME are written when a delta does not fit in its MOTION field,
+ *  the MOTION record that follows then carries a delta of 0. RANGE is
+ *  written at the start and whenever auto-range changed a range, before
+ *  the first RANGE record the ranges of the header registers apply.
+ */
+#define IMU_LOG_MAGIC                   "IMUL"      /*!< File magic */
+#define IMU_LOG_VERSION                 2           /*!< Format version */
+#define IMU_LOG_HEADER_SIZE             60          /*!< Header size of this version */
+#define IMU_LOG_FRAME_SIZE              14          /*!< Accelerometer, temperature and gyroscope raw data */
+#define IMU_LOG_RECORD_MAX_SIZE         18          /*!< Largest record, MOTION */
+
+typedef struct imu_log_writer* imu_log_writer_handle_t;
+typedef struct imu_log_reader* imu_log_reader_handle_t;
+
+typedef err_code_t (*imu_log_func_flush)(const uint8_t *buf, uint32_t len);
+
+/**
+ * @brief   Record type.
+ */
+typedef enum {
+    IMU_LOG_RECORD_MOTION = 1,                              /*!< Accelerometer, temperature and gyroscope frame */
+    IMU_LOG_RECORD_MAG,                                     /*!< Magnetometer frame */
+    IMU_LOG_RECORD_SEQ,                                     /*!< Absolute sequence number */
+    IMU_LOG_RECORD_TIME,                                    /*!< Absolute timestamp */
+    IMU_LOG_RECORD_RANGE,                                   /*!< Full scale ranges */
+} imu_log_record_t;
+
+/**
+ * @brief   Replay port, one register map per device.
+ */
+typedef enum {
+    IMU_LOG_PORT_MPU = 0,                                   /*!< MPU6050 or MPU6500 */
+    IMU_LOG_PORT_AK8963,                                    /*!< AK8963 */
+    IMU_LOG_PORT_MAX
+} imu_log_port_t;
+
+/**
+ * @brief   Log header structure.
+ */
+typedef struct {
+    imu_config_regs_t           regs;                       /*!< Configuration registers */
+    float                       sample_period_us;           /*!< Sample period in microseconds */
+    int16_t                     accel_bias_x;               /*!< Accelerometer bias of x axis */
+    int16_t                     accel_bias_y;               /*!< Accelerometer bias of y axis */
+    int16_t                     accel_bias_z;               /*!< Accelerometer bias of z axis */
+    int16_t                     gyro_bias_x;                /*!< Gyroscope bias of x axis */
+    int16_t                     gyro_bias_y;                /*!< Gyroscope bias of y axis */
+    int16_t                     gyro_bias_z;                /*!< Gyroscope bias of z axis */
+    float                       mag_hard_iron_bias_x;       /*!< Magnetometer hard iron bias of x axis */
+    float                       mag_hard_iron_bias_y;       /*!< Magnetometer hard iron bias of y axis */
+    float                       mag_hard_iron_bias_z;       /*!< Magnetometer hard iron bias of z axis */
+    float                       mag_soft_iron_bias_x;       /*!< Magnetometer soft iron bias of x axis */
+    float                       mag_soft_iron_bias_y;       /*!< Magnetometer soft iron bias of y axis */
+    float                       mag_soft_iron_bias_z;       /*!< Magnetometer soft iron bias of z axis */
+} imu_log_header_t;
+
+/**
+ * @brief   Log writer configuration structure.
+ */
+typedef struct {
+    uint8_t                     *buf;                       /*!< Record buffer, at least IMU_LOG_HEADER_SIZE bytes */
+    uint32_t                    buf_size;                   /*!< Record buffer size */
+    imu_log_func_flush          func_flush;                 /*!< Store buffered bytes, called when the buffer is full */
+} imu_log_writer_cfg_t;
+
+/**
+ * @brief   Log writer statistics structure.
+ */
+typedef struct {
+    uint64_t                    bytes;                      /*!< Bytes flushed */
+    uint32_t                    records;                    /*!< Records written to the buffer */
+    uint32_t                    flushes;                    /*!< Successful flushes */
+    uint32_t                    dropped;                    /*!< Samples dropped because a flush failed */
+} imu_log_writer_stats_t;
+
+/**
+ * @brief   Log reader configuration structure.
+ */
+typedef struct {
+    const char                  *path;                      /*!< Log file path */
+} imu_log_reader_cfg_t;
+
+/*
+ * @brief   Fill log header from a configured IMU.
+ *
+ * @param   imu IMU handle structure.
+ * @param   header Log header.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_header_from_imu(imu_handle_t imu, imu_log_header_t *header);
+
+/*
+ * @brief   Initialize log writer.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_log_writer_handle_t imu_log_writer_init(void);
+
+/*
+ * @brief   Set log writer configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_writer_set_config(imu_log_writer_handle_t handle, imu_log_writer_cfg_t config);
+
+/*
+ * @brief   Configure log writer.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_writer_config(imu_log_writer_handle_t handle);
+
+/*
+ * @brief   Start a log. Discards buffered records and buffers the header.
+ *
+ * @param   handle Handle structure.
+ * @param   header Log header.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_writer_start(imu_log_writer_handle_t handle, const imu_log_header_t *header);
+
+/*
+ * @brief   Write a sample. Flushes when the buffer is full, a sample that
+ *          does not fit after a failed flush is dropped and counted.
+ *
+ * @note    Safe to call from the sampling loop, never allocates and flushes
+ *          at most once.
+ *
+ * @param   handle Handle structure.
+ * @param   sample Sample.
+ * @param   channels Bit mask of imu_channel_t with valid data in sample.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_writer_write(imu_log_writer_handle_t handle, const imu_sample_t *sample, uint8_t channels);
+
+/*
+ * @brief   Flush buffered records.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_writer_flush(imu_log_writer_handle_t handle);
+
+/*
+ * @brief   Get log writer statistics.
+ *
+ * @param   handle Handle structure.
+ * @param   stats Statistics.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_writer_get_stats(imu_log_writer_handle_t handle, imu_log_writer_stats_t *stats);
+
+/*
+ * @brief   Initialize log reader. The reader is host only and maps the log
+ *          file into memory.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_log_reader_handle_t imu_log_reader_init(void);
+
+/*
+ * @brief   Set log reader configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_reader_set_config(imu_log_reader_handle_t handle, imu_log_reader_cfg_t config);
+
+/*
+ * @brief   Map the log file and check its header.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_reader_config(imu_log_reader_handle_t handle);
+
+/*
+ * @brief   Unmap the log file and free the reader.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_reader_deinit(imu_log_reader_handle_t handle);
+
+/*
+ * @brief   Get log header.
+ *
+ * @param   handle Handle structure.
+ * @param   header Log header.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_reader_get_header(imu_log_reader_handle_t handle, imu_log_header_t *header);
+
+/*
+ * @brief   Read the next sample directly, without going through the IMU.
+ *
+ * @param   handle Handle structure.
+ * @param   sample Sample, timestamp_corrected_us is 0.
+ * @param   channels Bit mask of imu_channel_t with valid data in sample.
+ * @param   end End of log reached, sample is not written.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_reader_next(imu_log_reader_handle_t handle, imu_sample_t *sample, uint8_t *channels, bool *end);
+
+/*
+ * @brief   Restart direct reads and replay from the first record.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_log_reader_rewind(imu_log_reader_handle_t handle);
+
+/*
+ * @brief   Get replay backend operations. The replay serves the recorded
+ *          samples through the sensor registers, so imu_config and
+ *          imu_get_* run unchanged against the log at host speed. Writes
+ *          are accepted and ignored.
+ *
+ * @note    The get_time_us function of the bound bus is the replay time
+ *          source of that reader, the recorded time of the sample the
+ *          replay currently serves. Use it as func_get_time_us.
+ *
+ * @note    The range registers follow the RANGE records. The IMU does not
+ *          read them back, a recording spanning a range change replays
+ *          in the recorded ranges only with the same auto-range
+ *          configuration. imu_log_reader_next always tags the recorded
+ *          ranges.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Backend operations.
+ */
+const imu_bus_ops_t *imu_log_reader_get_ops(void);
+
+/*
+ * @brief   Get replay backend context of a port, to bind with imu_bus_bind.
+ *
+ * @param   handle Handle structure.
+ * @param   port Port.
+ *
+ * @return
+ *      - Context: Success.
+ *      - NULL:    Fail.
+ */
+void *imu_log_reader_get_ctx(imu_log_reader_handle_t handle, imu_log_port_t port);
+
+/*
+ * @brief   Replay delay, returns at once. Use as func_delay.
+ *
+ * @param   ms Delay in milliseconds.
+ *
+ * @return  None.
+ */
+void imu_log_reader_delay(uint32_t ms);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_LOG_H__ */
@@ -0,0 +1,734 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+
+#include "imu_log/imu_log.h"
+#include "mpu6500/mpu6500.h"
+#include "ak8963/ak8963.h"
+#include "mpu6050/mpu6050_register.h"
+#include "mpu6500/mpu6500_register.h"
+#include "ak8963/ak8963_register.h"
+
+/* MPU6050 and MPU6500 share the register addresses used here, the MPU6050
+ * names are used for both.
+ */
+#define LOG_PATH_LEN 				256
+#define LOG_MPU_REG_SIZE 			128
+#define LOG_AK8963_REG_SIZE 		32
+#define LOG_READ_FLAG 				0x80
+#define LOG_MPU6050_FIFO_SIZE 		1024
+#define LOG_MPU6500_FIFO_SIZE 		512
+#define LOG_FRAME_ALL 				0x3FFF 		/*!< Consumed mask of a whole output register frame */
+
+#define LOG_INT_DATA_RDY 			0x01
+#define LOG_AK8963_ST1_DRDY 		0x01
+#define LOG_AK8963_ST2_BITM 		0x10
+
+
+/**
+ * @brief   Position in the record stream and the state it implies.
+ */
+typedef struct {
+	uint32_t 					pos; 						/*!< Offset of the next record */
+	uint32_t 					index; 						/*!< MOTION records passed */
+	uint32_t 					seq; 						/*!< Sequence number of the last MOTION record */
+	uint64_t 					time_us; 					/*!< Timestamp of the last MOTION record */
+	uint8_t 					accel_range; 				/*!< Accelerometer range of the last MOTION record */
+	uint8_t 					gyro_range; 				/*!< Gyroscope range of the last MOTION record */
+	const uint8_t 				*frame; 					/*!< Raw data of the last MOTION record */
+	const uint8_t 				*mag; 						/*!< Raw data of its MAG record, NULL if none */
+} imu_log_cursor_t;
+
+typedef struct {
+	struct imu_log_reader 		*reader; 					/*!< Owner */
+	imu_log_port_t 				port; 						/*!< Port */
+} imu_log_port_ctx_t;
+
+typedef struct imu_log_reader {
+	char 						path[LOG_PATH_LEN]; 		/*!< Log file path */
+	const uint8_t 				*data; 						/*!< Mapped log file */
+	size_t 						size; 						/*!< Log file size */
+	uint16_t 					header_size; 				/*!< Header size of the log */
+	imu_log_header_t 			header; 					/*!< Log header */
+	uint32_t 					total_frames; 				/*!< Number of MOTION records */
+	imu_log_cursor_t 			direct; 					/*!< Cursor of imu_log_reader_next */
+	imu_log_cursor_t 			replay; 					/*!< Cursor of the sample the replay serves */
+	uint8_t 					replay_valid; 				/*!< Replay serves a sample */
+	uint16_t 					consumed; 					/*!< Output register bytes read since the sample was served */
+	uint8_t 					fifo_offset; 				/*!< Next byte of the frame read from FIFO_R_W */
+	uint16_t 					fifo_frames; 				/*!< FIFO capacity in frames */
+	uint8_t 					mag_ready; 					/*!< Magnetometer data of the sample not read yet */
+	uint64_t 					fifo_time_us; 				/*!< Replay time of the last FIFO count read */
+	uint8_t 					fifo_time_valid; 			/*!< Replay time is fifo_time_us */
+	uint8_t 					mpu_reg[LOG_MPU_REG_SIZE]; 	/*!< MPU register map */
+	uint8_t 					ak8963_reg[LOG_AK8963_REG_SIZE]; 	/*!< AK8963 register map */
+	imu_log_port_ctx_t 			port[IMU_LOG_PORT_MAX]; 	/*!< Backend contexts */
+} imu_log_reader_t;
+
+static uint16_t imu_log_get_u16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t imu_log_get_u32(const uint8_t *p)
+{
+	return (uint32_t)imu_log_get_u16(p) | ((uint32_t)imu_log_get_u16(p + 2) << 16);
+}
+
+static uint64_t imu_log_get_u64(const uint8_t *p)
+{
+	return (uint64_t)imu_log_get_u32(p) | ((uint64_t)imu_log_get_u32(p + 4) << 32);
+}
+
+static float imu_log_get_f32(const uint8_t *p)
+{
+	uint32_t bits = imu_log_get_u32(p);
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+static uint8_t imu_log_record_size(uint8_t type)
+{
+	switch (type)
+	{
+	case IMU_LOG_RECORD_MOTION:
+		return 1 + 1 + 2 + IMU_LOG_FRAME_SIZE;
+	case IMU_LOG_RECORD_MAG:
+		return 1 + 6;
+	case IMU_LOG_RECORD_SEQ:
+		return 1 + 4;
+	case IMU_LOG_RECORD_TIME:
+		return 1 + 8;
+	case IMU_LOG_RECORD_RANGE:
+		return 1 + 2;
+	default:
+		return 0;
+	}
+}
+
+/* Move cursor to the next MOTION record and the MAG record belonging to it.
+ * Returns 0 at the end of the log, an unknown or truncated record ends the
+ * log as well.
+ */
+static uint8_t imu_log_cursor_next(const imu_log_reader_t *reader, imu_log_cursor_t *cursor)
+{
+	while (cursor->pos < reader->size)
+	{
+		const uint8_t *p = reader->data + cursor->pos;
+		uint8_t size = imu_log_record_size(p[0]);
+
+		if ((size == 0) || (cursor->pos + size > reader->size))
+		{
+			return 0;
+		}
+
+		cursor->pos += size;
+
+		if (p[0] == IMU_LOG_RECORD_SEQ)
+		{
+			cursor->seq = imu_log_get_u32(p + 1);
+		}
+		else if (p[0] == IMU_LOG_RECORD_TIME)
+		{
+			cursor->time_us = imu_log_get_u64(p + 1);
+		}
+		else if (p[0] == IMU_LOG_RECORD_RANGE)
+		{
+			cursor->accel_range = p[1] & 0x03;
+			cursor->gyro_range = p[2] & 0x03;
+		}
+		else if (p[0] == IMU_LOG_RECORD_MOTION)
+		{
+			cursor->seq += p[1];
+			cursor->time_us += imu_log_get_u16(p + 2);
+			cursor->frame = p + 4;
+			cursor->mag = NULL;
+			cursor->index++;
+
+			const uint8_t *next = reader->data + cursor->pos;
+			if ((cursor->pos + imu_log_record_size(IMU_LOG_RECORD_MAG) <= reader->size) && (next[0] == IMU_LOG_RECORD_MAG))
+			{
+				cursor->mag = next + 1;
+				cursor->pos += imu_log_record_size(IMU_LOG_RECORD_MAG);
+			}
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void imu_log_cursor_reset(const imu_log_reader_t *reader, imu_log_cursor_t *cursor)
+{
+	memset(cursor, 0, sizeof(imu_log_cursor_t));
+	cursor->pos = reader->header_size;
+	cursor->accel_range = (reader->header.regs.accel_config >> 3) & 0x03;
+	cursor->gyro_range = (reader->header.regs.gyro_config >> 3) & 0x03;
+}
+
+/* Serve the next sample through the register maps, the last one stays at the end */
+static uint8_t imu_log_replay_advance(imu_log_reader_t *reader)
+{
+	if (!imu_log_cursor_next(reader, &reader->replay))
+	{
+		return 0;
+	}
+
+	const uint8_t *frame = reader->replay.frame;
+
+	/* Little endian in the log, big endian in the registers */
+	for (uint8_t i = 0; i < IMU_LOG_FRAME_SIZE; i += 2)
+	{
+		reader->mpu_reg[MPU6050_ACCEL_XOUT_H + i] = frame[i + 1];
+		reader->mpu_reg[MPU6050_ACCEL_XOUT_H + i + 1] = frame[i];
+	}
+
+	reader->mpu_reg[MPU6050_ACCEL_CONFIG] = (reader->mpu_reg[MPU6050_ACCEL_CONFIG] & ~0x18) | (reader->replay.accel_range << 3);
+	reader->mpu_reg[MPU6050_GYRO_CONFIG] = (reader->mpu_reg[MPU6050_GYRO_CONFIG] & ~0x18) | (reader->replay.gyro_range << 3);
+
+	if (reader->replay.mag != NULL)
+	{
+		memcpy(&reader->ak8963_reg[AK8963_XOUT_L], reader->replay.mag, 6);
+		reader->mag_ready = 1;
+	}
+
+	reader->replay_valid = 1;
+	reader->consumed = 0;
+
+	return 1;
+}
+
+static uint16_t imu_log_replay_pending(const imu_log_reader_t *reader)
+{
+	uint32_t pending = reader->total_frames - reader->replay.index;
+
+	if (reader->replay_valid && (reader->consumed == 0))
+	{
+		pending++;
+	}
+
+	return (pending < reader->fifo_frames) ? (uint16_t)pending : reader->fifo_frames;
+}
+
+static void imu_log_replay_fifo_count(imu_log_reader_t *reader)
+{
+	uint16_t frames = imu_log_replay_pending(reader);
+	uint16_t count = frames * IMU_LOG_FRAME_SIZE;
+
+	reader->mpu_reg[MPU6050_FIFO_COUNTH] = (uint8_t)(count >> 8);
+	reader->mpu_reg[MPU6050_FIFO_COUNTH + 1] = (uint8_t)count;
+
+	if (frames == 0)
+	{
+		return;
+	}
+
+	/* Time of the newest frame counted. The IMU places the newest frame half
+	 * a sample period before the drain, report the drain that far later.
+	 */
+	imu_log_cursor_t ahead = reader->replay;
+	uint16_t steps = (reader->replay_valid && (reader->consumed == 0)) ? frames - 1 : frames;
+
+	for (uint16_t i = 0; i < steps; i++)
+	{
+		imu_log_cursor_next(reader, &ahead);
+	}
+
+	reader->fifo_time_us = ahead.time_us + (uint64_t)(reader->header.sample_period_us / 2.0f);
+	reader->fifo_time_valid = 1;
+}
+
+static void imu_log_replay_read_fifo(imu_log_reader_t *reader, uint8_t *buf, uint16_t len)
+{
+	for (uint16_t i = 0; i < len; i++)
+	{
+		if (reader->fifo_offset == 0)
+		{
+			if (!(reader->replay_valid && (reader->consumed == 0)) && !imu_log_replay_advance(reader))
+			{
+				/* Underflow */
+				memset(&buf[i], 0, len - i);
+				return;
+			}
+		}
+
+		buf[i] = reader->mpu_reg[MPU6050_ACCEL_XOUT_H + reader->fifo_offset];
+
+		if (++reader->fifo_offset == IMU_LOG_FRAME_SIZE)
+		{
+			reader->fifo_offset = 0;
+			reader->consumed = LOG_FRAME_ALL;
+		}
+	}
+}
+
+static void imu_log_replay_read_mpu(imu_log_reader_t *reader, uint8_t reg_addr, uint8_t *buf, uint16_t len)
+{
+	/* FIFO_R_W does not auto increment */
+	if (reg_addr == MPU6050_FIRO_R_W)
+	{
+		imu_log_replay_read_fifo(reader, buf, len);
+		return;
+	}
+
+	uint16_t first = reg_addr;
+	uint16_t last = reg_addr + len - 1;
+
+	reader->fifo_time_valid = 0;
+
+	/* Status read after the sample was read serves the next one */
+	if ((first <= MPU6050_INT_STATUS) && (last >= MPU6050_INT_STATUS))
+	{
+		if (!reader->replay_valid || (reader->consumed != 0))
+		{
+			imu_log_replay_advance(reader);
+		}
+
+		reader->mpu_reg[MPU6050_INT_STATUS] = (reader->replay_valid && (reader->consumed == 0)) ? LOG_INT_DATA_RDY : 0;
+	}
+
+	/* Direct reads of output registers already read serve the next sample */
+	if ((first <= MPU6050_GYRO_ZOUT_L) && (last >= MPU6050_ACCEL_XOUT_H))
+	{
+		uint16_t lo = (first > MPU6050_ACCEL_XOUT_H) ? first : MPU6050_ACCEL_XOUT_H;
+		uint16_t hi = (last < MPU6050_GYRO_ZOUT_L) ? last : MPU6050_GYRO_ZOUT_L;
+		uint16_t mask = (uint16_t)(((1u << (hi - lo + 1)) - 1) << (lo - MPU6050_ACCEL_XOUT_H));
+
+		if (!reader->replay_valid || (reader->consumed & mask))
+		{
+			imu_log_replay_advance(reader);
+		}
+
+		reader->consumed |= mask;
+	}
+
+	if ((first <= MPU6050_FIFO_COUNTH + 1) && (last >= MPU6050_FIFO_COUNTH))
+	{
+		imu_log_replay_fifo_count(reader);
+	}
+
+	for (uint16_t i = 0; i < len; i++)
+	{
+		uint16_t addr = reg_addr + i;
+		buf[i] = (addr < LOG_MPU_REG_SIZE) ? reader->mpu_reg[addr] : 0;
+	}
+}
+
+static void imu_log_replay_read_ak8963(imu_log_reader_t *reader, uint8_t reg_addr, uint8_t *buf, uint16_t len)
+{
+	uint8_t data_read = 0;
+
+	reader->ak8963_reg[AK8963_ST1] = reader->mag_ready ? LOG_AK8963_ST1_DRDY : 0;
+
+	for (uint16_t i = 0; i < len; i++)
+	{
+		uint16_t addr = reg_addr + i;
+		buf[i] = (addr < LOG_AK8963_REG_SIZE) ? reader->ak8963_reg[addr] : 0;
+		if ((addr >= AK8963_XOUT_L) && (addr <= AK8963_ST2))
+		{
+			data_read = 1;
+		}
+	}
+
+	if (data_read)
+	{
+		reader->mag_ready = 0;
+	}
+}
+
+static err_code_t imu_log_replay_transfer(void *ctx, imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms)
+{
+	imu_log_port_ctx_t *port = (imu_log_port_ctx_t *)ctx;
+
+	/* Replay runs at host speed */
+	(void)timeout_ms;
+
+	if ((port == NULL) || (transfers == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	imu_log_reader_t *reader = port->reader;
+	if (reader->data == NULL)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	for (uint8_t i = 0; i < num_transfers; i++)
+	{
+		if (transfers[i].buf == NULL)
+		{
+			return ERR_CODE_NULL_PTR;
+		}
+
+		/* Configuration comes from the log header */
+		if (transfers[i].dir == IMU_TRANSFER_WRITE)
+		{
+			continue;
+		}
+
+		uint8_t reg_addr = transfers[i].reg_addr & (uint8_t)~LOG_READ_FLAG;
+
+		if (port->port == IMU_LOG_PORT_MPU) {
+			imu_log_replay_read_mpu(reader, reg_addr, transfers[i].buf, transfers[i].len);
+		} else {
+			imu_log_replay_read_ak8963(reader, reg_addr, transfers[i].buf, transfers[i].len);
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+static err_code_t imu_log_replay_read_bytes(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	imu_transfer_t transfer = {reg_addr, buf, len, IMU_TRANSFER_READ};
+
+	return imu_log_replay_transfer(ctx, &transfer, 1, timeout_ms);
+}
+
+static err_code_t imu_log_replay_write_bytes(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	imu_transfer_t transfer = {reg_addr, buf, len, IMU_TRANSFER_WRITE};
+
+	return imu_log_replay_transfer(ctx, &transfer, 1, timeout_ms);
+}
+
+static uint64_t imu_log_replay_get_time_us(void *ctx)
+{
+	imu_log_port_ctx_t *port = (imu_log_port_ctx_t *)ctx;
+
+	if (port == NULL)
+	{
+		return 0;
+	}
+
+	imu_log_reader_t *reader = port->reader;
+	if (reader->data == NULL)
+	{
+		return 0;
+	}
+
+	if (reader->fifo_time_valid)
+	{
+		return reader->fifo_time_us;
+	}
+
+	/* Once the served sample was read the clock is at the next one, the IMU
+	 * takes the timestamp before it reads the status.
+	 */
+	imu_log_cursor_t next = reader->replay;
+	if ((!reader->replay_valid || (reader->consumed != 0)) && imu_log_cursor_next(reader, &next))
+	{
+		return next.time_us;
+	}
+
+	return reader->replay.time_us;
+}
+
+static const imu_bus_ops_t imu_log_replay_ops = {
+	.read_bytes = imu_log_replay_read_bytes,
+	.write_bytes = imu_log_replay_write_bytes,
+	.transfer = imu_log_replay_transfer,
+	.set_bus_clock = NULL,
+	.get_time_us = imu_log_replay_get_time_us,
+};
+
+static void imu_log_replay_reset(imu_log_reader_t *reader)
+{
+	const imu_config_regs_t *regs = &reader->header.regs;
+
+	imu_log_cursor_reset(reader, &reader->direct);
+	imu_log_cursor_reset(reader, &reader->replay);
+	reader->replay_valid = 0;
+	reader->consumed = 0;
+	reader->fifo_offset = 0;
+	reader->mag_ready = 0;
+	reader->fifo_time_valid = 0;
+
+	memset(reader->mpu_reg, 0, sizeof(reader->mpu_reg));
+	reader->mpu_reg[MPU6050_SMPLRT_DIV] = regs->smplrt_div;
+	reader->mpu_reg[MPU6050_CONFIG] = regs->config;
+	reader->mpu_reg[MPU6050_GYRO_CONFIG] = regs->gyro_config;
+	reader->mpu_reg[MPU6050_ACCEL_CONFIG] = regs->accel_config;
+	reader->mpu_reg[MPU6500_ACCEL_CONFIG2] = regs->accel_config2;
+	reader->mpu_reg[MPU6050_WHO_AM_I] = regs->who_am_i;
+
+	memset(reader->ak8963_reg, 0, sizeof(reader->ak8963_reg));
+	if (regs->mag_present)
+	{
+		reader->ak8963_reg[AK8963_WHO_AM_I] = AK8963_WHO_AM_I_DEFAULT;
+		reader->ak8963_reg[AK8963_CNTL] = regs->mag_cntl;
+		reader->ak8963_reg[AK8963_ST2] = regs->mag_cntl & LOG_AK8963_ST2_BITM;
+		memcpy(&reader->ak8963_reg[AK8963_ASAX], regs->mag_asa, 3);
+	}
+}
+
+static err_code_t imu_log_parse_header(imu_log_reader_t *reader)
+{
+	const uint8_t *p = reader->data;
+	imu_log_header_t *header = &reader->header;
+
+	if ((reader->size < IMU_LOG_HEADER_SIZE) || (memcmp(p, IMU_LOG_MAGIC, 4) != 0))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	/* Newer headers may only grow, newer record types are not understood */
+	uint16_t version = imu_log_get_u16(p + 4);
+	reader->header_size = imu_log_get_u16(p + 6);
+	if ((version != IMU_LOG_VERSION) || (reader->header_size < IMU_LOG_HEADER_SIZE) || (reader->header_size > reader->size))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	header->regs.who_am_i = p[8];
+	header->regs.mag_present = p[9];
+	header->regs.smplrt_div = p[10];
+	header->regs.config = p[11];
+	header->regs.gyro_config = p[12];
+	header->regs.accel_config = p[13];
+	header->regs.accel_config2 = p[14];
+	header->regs.mag_cntl = p[15];
+	memcpy(header->regs.mag_asa, p + 16, 3);
+
+	header->sample_period_us = imu_log_get_f32(p + 20);
+	header->accel_bias_x = (int16_t)imu_log_get_u16(p + 24);
+	header->accel_bias_y = (int16_t)imu_log_get_u16(p + 26);
+	header->accel_bias_z = (int16_t)imu_log_get_u16(p + 28);
+	header->gyro_bias_x = (int16_t)imu_log_get_u16(p + 30);
+	header->gyro_bias_y = (int16_t)imu_log_get_u16(p + 32);
+	header->gyro_bias_z = (int16_t)imu_log_get_u16(p + 34);
+	header->mag_hard_iron_bias_x = imu_log_get_f32(p + 36);
+	header->mag_hard_iron_bias_y = imu_log_get_f32(p + 40);
+	header->mag_hard_iron_bias_z = imu_log_get_f32(p + 44);
+	header->mag_soft_iron_bias_x = imu_log_get_f32(p + 48);
+	header->mag_soft_iron_bias_y = imu_log_get_f32(p + 52);
+	header->mag_soft_iron_bias_z = imu_log_get_f32(p + 56);
+
+	return ERR_CODE_SUCCESS;
+}
+
+static void imu_log_reader_unmap(imu_log_reader_t *reader)
+{
+	if (reader->data != NULL)
+	{
+		munmap((void *)reader->data, reader->size);
+		reader->data = NULL;
+		reader->size = 0;
+	}
+}
+
+imu_log_reader_handle_t imu_log_reader_init(void)
+{
+	imu_log_reader_handle_t handle = calloc(1, sizeof(imu_log_reader_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	for (uint8_t i = 0; i < IMU_LOG_PORT_MAX; i++)
+	{
+		handle->port[i].reader = handle;
+		handle->port[i].port = (imu_log_port_t)i;
+	}
+
+	return handle;
+}
+
+err_code_t imu_log_reader_set_config(imu_log_reader_handle_t handle, imu_log_reader_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if ((handle == NULL) || (config.path == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (strlen(config.path) >= LOG_PATH_LEN)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	strcpy(handle->path, config.path);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_log_reader_config(imu_log_reader_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	imu_log_reader_unmap(handle);
+
+	int fd = open(handle->path, O_RDONLY);
+	if (fd < 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size <= 0))
+	{
+		close(fd);
+		return ERR_CODE_FAIL;
+	}
+
+	void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	/* Records are read once front to back */
+	madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	handle->data = (const uint8_t *)data;
+	handle->size = (size_t)st.st_size;
+
+	if (imu_log_parse_header(handle) != ERR_CODE_SUCCESS)
+	{
+		imu_log_reader_unmap(handle);
+		return ERR_CODE_FAIL;
+	}
+
+	imu_log_cursor_t cursor;
+	imu_log_cursor_reset(handle, &cursor);
+	while (imu_log_cursor_next(handle, &cursor));
+	handle->total_frames = cursor.index;
+
+	uint16_t fifo_size = (handle->header.regs.who_am_i == MPU6500_WHO_AM_I_DEFAULT) ? LOG_MPU6500_FIFO_SIZE : LOG_MPU6050_FIFO_SIZE;
+	handle->fifo_frames = fifo_size / IMU_LOG_FRAME_SIZE;
+
+	imu_log_replay_reset(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_log_reader_deinit(imu_log_reader_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	imu_log_reader_unmap(handle);
+	free(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_log_reader_get_header(imu_log_reader_handle_t handle, imu_log_header_t *header)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (header == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->data == NULL)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	*header = handle->header;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_log_reader_next(imu_log_reader_handle_t handle, imu_sample_t *sample, uint8_t *channels, bool *end)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (sample == NULL) || (channels == NULL) || (end == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->data == NULL)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	*end = !imu_log_cursor_next(handle, &handle->direct);
+	if (*end)
+	{
+		return ERR_CODE_SUCCESS;
+	}
+
+	const uint8_t *frame = handle->direct.frame;
+
+	sample->seq = handle->direct.seq;
+	sample->timestamp_us = handle->direct.time_us;
+	sample->timestamp_corrected_us = 0;
+	sample->period_us = handle->header.sample_period_us;
+	sample->accel_range = handle->direct.accel_range;
+	sample->gyro_range = handle->direct.gyro_range;
+	sample->health = 0;
+	sample->accel_raw_x = (int16_t)imu_log_get_u16(frame + 0);
+	sample->accel_raw_y = (int16_t)imu_log_get_u16(frame + 2);
+	sample->accel_raw_z = (int16_t)imu_log_get_u16(frame + 4);
+	sample->temp_raw = (int16_t)imu_log_get_u16(frame + 6);
+	sample->gyro_raw_x = (int16_t)imu_log_get_u16(frame + 8);
+	sample->gyro_raw_y = (int16_t)imu_log_get_u16(frame + 10);
+	sample->gyro_raw_z = (int16_t)imu_log_get_u16(frame + 12);
+	*channels = IMU_CHANNEL_ACCEL | IMU_CHANNEL_TEMP | IMU_CHANNEL_GYRO;
+
+	if (handle->direct.mag != NULL)
+	{
+		sample->mag_raw_x = (int16_t)imu_log_get_u16(handle->direct.mag + 0);
+		sample->mag_raw_y = (int16_t)imu_log_get_u16(handle->direct.mag + 2);
+		sample->mag_raw_z = (int16_t)imu_log_get_u16(handle->direct.mag + 4);
+		*channels |= IMU_CHANNEL_MAG;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_log_reader_rewind(imu_log_reader_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->data == NULL)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	imu_log_replay_reset(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+const imu_bus_ops_t *imu_log_reader_get_ops(void)
+{
+	return &imu_log_replay_ops;
+}
+
+void *imu_log_reader_get_ctx(imu_log_reader_handle_t handle, imu_log_port_t port)
+{
+	if ((handle == NULL) || (port >= IMU_LOG_PORT_MAX))
+	{
+		return NULL;
+	}
+
+	return &handle->port[port];
+}
+
+void imu_log_reader_delay(uint32_t ms)
+{
+	(void)ms;
+}
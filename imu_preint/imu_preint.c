@@ -0,0 +1,472 @@
+#include "stdlib.h"
+#include "string.h"
+#include "math.h"
+
+#include "imu_preint/imu_preint.h"
+
+#define PREINT_PI 					3.14159265358979f
+#define PREINT_DEG_TO_RAD 			(PREINT_PI / 180.0f)
+#define PREINT_G 					9.80665f 	/*!< Standard gravity, m/s^2 per g */
+#define PREINT_MAX_DT_PERIODS 		16 			/*!< Longest accepted timestamp step, in nominal periods */
+#define PREINT_SMALL_ANGLE 			1e-4f 		/*!< Below this series expansions replace sin and cos */
+
+
+typedef struct imu_preint {
+	imu_preint_cfg_t 			cfg; 						/*!< Configuration */
+	float 						period_s; 					/*!< Nominal sample period */
+	float 						next_gyro_bias[3]; 			/*!< Gyroscope bias for the next interval */
+	float 						next_accel_bias[3]; 		/*!< Accelerometer bias for the next interval */
+	float 						prev_dtheta[3]; 			/*!< Angle increment of the previous sample */
+	float 						prev_dv[3]; 				/*!< Velocity increment of the previous sample */
+	uint8_t 					prev_valid; 				/*!< Previous increments are contiguous */
+	uint8_t 					started; 					/*!< A sample has been seen */
+	uint32_t 					last_seq; 					/*!< Sequence number of the last sample */
+	uint64_t 					last_timestamp_us; 			/*!< Timestamp of the last sample */
+	imu_preint_result_t 		result; 					/*!< Current interval, delta_q, delta_angle and bias variances filled on read */
+	imu_preint_status_t 		status; 					/*!< Status */
+} imu_preint_t;
+
+static void imu_preint_skew(const float v[3], float m[3][3])
+{
+	m[0][0] = 0;		m[0][1] = -v[2];	m[0][2] = v[1];
+	m[1][0] = v[2];		m[1][1] = 0;		m[1][2] = -v[0];
+	m[2][0] = -v[1];	m[2][1] = v[0];		m[2][2] = 0;
+}
+
+static void imu_preint_cross(const float a[3], const float b[3], float c[3])
+{
+	c[0] = a[1] * b[2] - a[2] * b[1];
+	c[1] = a[2] * b[0] - a[0] * b[2];
+	c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static void imu_preint_mul33(float a[3][3], float b[3][3], float c[3][3])
+{
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			c[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+		}
+	}
+}
+
+static void imu_preint_mul33_vec(float a[3][3], const float v[3], float c[3])
+{
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		c[i] = a[i][0] * v[0] + a[i][1] * v[1] + a[i][2] * v[2];
+	}
+}
+
+static void imu_preint_quat_to_rot(const float q[4], float r[3][3])
+{
+	float w = q[0], x = q[1], y = q[2], z = q[3];
+
+	r[0][0] = 1 - 2 * (y * y + z * z);
+	r[0][1] = 2 * (x * y - w * z);
+	r[0][2] = 2 * (x * z + w * y);
+	r[1][0] = 2 * (x * y + w * z);
+	r[1][1] = 1 - 2 * (x * x + z * z);
+	r[1][2] = 2 * (y * z - w * x);
+	r[2][0] = 2 * (x * z - w * y);
+	r[2][1] = 2 * (y * z + w * x);
+	r[2][2] = 1 - 2 * (x * x + y * y);
+}
+
+/* Rotation of the rotation vector phi, as quaternion and matrix, and the
+ * right Jacobian of SO(3) at phi.
+ */
+static void imu_preint_exp(const float phi[3], float q[4], float r[3][3], float jr[3][3])
+{
+	float angle = sqrtf(phi[0] * phi[0] + phi[1] * phi[1] + phi[2] * phi[2]);
+	float k1, k2, half_sinc;
+	float s[3][3], s2[3][3];
+
+	if (angle < PREINT_SMALL_ANGLE)
+	{
+		half_sinc = 0.5f;
+		k1 = 0.5f;
+		k2 = 1.0f / 6.0f;
+		q[0] = 1.0f;
+	}
+	else
+	{
+		half_sinc = sinf(0.5f * angle) / angle;
+		k1 = (1.0f - cosf(angle)) / (angle * angle);
+		k2 = (angle - sinf(angle)) / (angle * angle * angle);
+		q[0] = cosf(0.5f * angle);
+	}
+
+	q[1] = phi[0] * half_sinc;
+	q[2] = phi[1] * half_sinc;
+	q[3] = phi[2] * half_sinc;
+	imu_preint_quat_to_rot(q, r);
+
+	imu_preint_skew(phi, s);
+	imu_preint_mul33(s, s, s2);
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			jr[i][j] = ((i == j) ? 1.0f : 0.0f) - k1 * s[i][j] + k2 * s2[i][j];
+		}
+	}
+}
+
+static void imu_preint_log(const float q[4], float phi[3])
+{
+	float w = q[0], sign = 1.0f;
+	float n = sqrtf(q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+	/* Shortest rotation */
+	if (w < 0)
+	{
+		w = -w;
+		sign = -1.0f;
+	}
+
+	float scale = (n < PREINT_SMALL_ANGLE) ? 2.0f / w : 2.0f * atan2f(n, w) / n;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		phi[i] = sign * scale * q[i + 1];
+	}
+}
+
+static void imu_preint_restart(imu_preint_handle_t handle)
+{
+	imu_preint_result_t *r = &handle->result;
+
+	memset(r, 0, sizeof(imu_preint_result_t));
+	r->delta_q[0] = 1.0f;
+	r->start_us = handle->last_timestamp_us;
+	r->end_us = handle->last_timestamp_us;
+	memcpy(r->gyro_bias, handle->next_gyro_bias, sizeof(r->gyro_bias));
+	memcpy(r->accel_bias, handle->next_accel_bias, sizeof(r->accel_bias));
+}
+
+/* out = A in, with the error transition
+ *      A = | dR^T               0       0 |
+ *          | -Rk [a]x dt        I       0 |
+ *          | -1/2 Rk [a]x dt^2  I dt    I |
+ * a rotation error moves to the end frame and tilts the specific force into
+ * velocity and position. in is read transposed when transpose is set.
+ */
+static void imu_preint_transition(float in[IMU_PREINT_STATES][IMU_PREINT_STATES], uint8_t transpose,
+                                  float dr[3][3], float rk_ax[3][3], float dt,
+                                  float out[IMU_PREINT_STATES][IMU_PREINT_STATES])
+{
+	for (uint8_t j = 0; j < IMU_PREINT_STATES; j++)
+	{
+		float x[IMU_PREINT_STATES];
+		for (uint8_t k = 0; k < IMU_PREINT_STATES; k++)
+		{
+			x[k] = transpose ? in[j][k] : in[k][j];
+		}
+
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			float tilt = rk_ax[i][0] * x[0] + rk_ax[i][1] * x[1] + rk_ax[i][2] * x[2];
+
+			out[i][j] = dr[0][i] * x[0] + dr[1][i] * x[1] + dr[2][i] * x[2];
+			out[3 + i][j] = x[3 + i] - tilt * dt;
+			out[6 + i][j] = x[6 + i] + x[3 + i] * dt - 0.5f * tilt * dt * dt;
+		}
+	}
+}
+
+static void imu_preint_update_cov(imu_preint_handle_t handle, float dr[3][3], float jr[3][3],
+                                  float rk_ax[3][3], float dt)
+{
+	float t[IMU_PREINT_STATES][IMU_PREINT_STATES];
+	float (*cov)[IMU_PREINT_STATES] = handle->result.cov;
+
+	/* A cov A^T as A (A cov)^T, the result is symmetric */
+	imu_preint_transition(cov, 0, dr, rk_ax, dt, t);
+	imu_preint_transition(t, 1, dr, rk_ax, dt, cov);
+
+	/* White noise, variance of an angle or velocity increment is density^2 * dt */
+	float gyro_var = handle->cfg.noise.gyro_noise_density * handle->cfg.noise.gyro_noise_density * dt;
+	float accel_var = handle->cfg.noise.accel_noise_density * handle->cfg.noise.accel_noise_density * dt;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			cov[i][j] += gyro_var * (jr[i][0] * jr[j][0] + jr[i][1] * jr[j][1] + jr[i][2] * jr[j][2]);
+		}
+		cov[3 + i][3 + i] += accel_var;
+		cov[3 + i][6 + i] += accel_var * 0.5f * dt;
+		cov[6 + i][3 + i] += accel_var * 0.5f * dt;
+		cov[6 + i][6 + i] += accel_var * 0.25f * dt * dt;
+	}
+}
+
+static void imu_preint_sample(imu_preint_handle_t handle, const imu_sample_scale_t *s)
+{
+	imu_preint_result_t *r = &handle->result;
+	float dt = handle->period_s;
+	uint8_t contiguous = handle->started && (s->seq == handle->last_seq + 1);
+
+	/* Without timestamps contiguous samples are one nominal period apart */
+	if (handle->started)
+	{
+		int64_t step_us = (int64_t)(s->timestamp_us - handle->last_timestamp_us);
+		uint8_t timed = (s->timestamp_us != 0) && (handle->last_timestamp_us != 0);
+
+		if (contiguous && timed && (step_us > 0) && (step_us <= PREINT_MAX_DT_PERIODS * handle->period_s * 1e6f))
+		{
+			dt = step_us * 1e-6f;
+		}
+		else if (!contiguous || timed)
+		{
+			r->gaps++;
+			handle->status.gaps++;
+		}
+	}
+
+	if (r->num_samples == 0)
+	{
+		r->first_seq = s->seq;
+		if (!handle->started)
+		{
+			r->start_us = s->timestamp_us - (uint64_t)(dt * 1e6f);
+		}
+	}
+
+	float omega[3] = {
+		s->gyro_x * PREINT_DEG_TO_RAD - r->gyro_bias[0],
+		s->gyro_y * PREINT_DEG_TO_RAD - r->gyro_bias[1],
+		s->gyro_z * PREINT_DEG_TO_RAD - r->gyro_bias[2],
+	};
+	float acc[3] = {
+		s->accel_x * PREINT_G - r->accel_bias[0],
+		s->accel_y * PREINT_G - r->accel_bias[1],
+		s->accel_z * PREINT_G - r->accel_bias[2],
+	};
+	float dtheta[3], dv[3], phi[3], dv_rot[3], c0[3], c1[3];
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		dtheta[i] = omega[i] * dt;
+		dv[i] = acc[i] * dt;
+	}
+
+	/* Coning and sculling from this and the previous increment:
+	 *      phi = dtheta + 1/12 prev_dtheta x dtheta
+	 *      dv_rot = dv + 1/2 dtheta x dv + 1/12 (prev_dtheta x dv + prev_dv x dtheta)
+	 */
+	memcpy(phi, dtheta, sizeof(phi));
+	imu_preint_cross(dtheta, dv, c0);
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		dv_rot[i] = dv[i] + 0.5f * c0[i];
+	}
+
+	if (handle->prev_valid && contiguous)
+	{
+		imu_preint_cross(handle->prev_dtheta, dtheta, c0);
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			phi[i] += c0[i] / 12.0f;
+		}
+
+		imu_preint_cross(handle->prev_dtheta, dv, c0);
+		imu_preint_cross(handle->prev_dv, dtheta, c1);
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			dv_rot[i] += (c0[i] + c1[i]) / 12.0f;
+		}
+	}
+
+	memcpy(handle->prev_dtheta, dtheta, sizeof(dtheta));
+	memcpy(handle->prev_dv, dv, sizeof(dv));
+	handle->prev_valid = 1;
+
+	float rk[3][3], dq[4], dr[3][3], jr[3][3], ax[3][3], rk_ax[3][3], m[3][3], rdv[3];
+
+	imu_preint_quat_to_rot(r->delta_q, rk);
+	imu_preint_exp(phi, dq, dr, jr);
+	imu_preint_skew(acc, ax);
+	imu_preint_mul33(rk, ax, rk_ax);
+
+	imu_preint_update_cov(handle, dr, jr, rk_ax, dt);
+
+	/* Bias Jacobians, position and velocity first, they use the rotation
+	 * Jacobian at the start of the step.
+	 */
+	imu_preint_mul33(rk_ax, r->dr_dbg, m);
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			r->dp_dba[i][j] += r->dv_dba[i][j] * dt - 0.5f * rk[i][j] * dt * dt;
+			r->dp_dbg[i][j] += r->dv_dbg[i][j] * dt - 0.5f * m[i][j] * dt * dt;
+			r->dv_dba[i][j] -= rk[i][j] * dt;
+			r->dv_dbg[i][j] -= m[i][j] * dt;
+		}
+	}
+
+	float drt_dr[3][3];
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			drt_dr[i][j] = dr[0][i] * r->dr_dbg[0][j] + dr[1][i] * r->dr_dbg[1][j] + dr[2][i] * r->dr_dbg[2][j];
+		}
+	}
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			r->dr_dbg[i][j] = drt_dr[i][j] - jr[i][j] * dt;
+		}
+	}
+
+	/* Position with the velocity before the step, then velocity, then rotation */
+	imu_preint_mul33_vec(rk, dv_rot, rdv);
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		r->delta_p[i] += r->delta_v[i] * dt + 0.5f * rdv[i] * dt;
+		r->delta_v[i] += rdv[i];
+	}
+
+	float q0 = r->delta_q[0], q1 = r->delta_q[1], q2 = r->delta_q[2], q3 = r->delta_q[3];
+	float q[4] = {
+		q0 * dq[0] - q1 * dq[1] - q2 * dq[2] - q3 * dq[3],
+		q0 * dq[1] + q1 * dq[0] + q2 * dq[3] - q3 * dq[2],
+		q0 * dq[2] - q1 * dq[3] + q2 * dq[0] + q3 * dq[1],
+		q0 * dq[3] + q1 * dq[2] - q2 * dq[1] + q3 * dq[0],
+	};
+	float norm = 1.0f / sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		r->delta_q[i] = q[i] * norm;
+	}
+
+	r->dt_s += dt;
+	r->end_us = s->timestamp_us;
+	r->num_samples++;
+
+	handle->started = 1;
+	handle->last_seq = s->seq;
+	handle->last_timestamp_us = s->timestamp_us;
+	handle->status.samples++;
+}
+
+imu_preint_handle_t imu_preint_init(void)
+{
+	imu_preint_handle_t handle = calloc(1, sizeof(imu_preint_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_preint_set_config(imu_preint_handle_t handle, imu_preint_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((config.sample_rate_hz <= 0) ||
+	        (config.noise.gyro_noise_density < 0) || (config.noise.accel_noise_density < 0) ||
+	        (config.noise.gyro_bias_rw < 0) || (config.noise.accel_bias_rw < 0))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->cfg = config;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_preint_config(imu_preint_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->period_s = 1.0f / handle->cfg.sample_rate_hz;
+	memset(handle->next_gyro_bias, 0, sizeof(handle->next_gyro_bias));
+	memset(handle->next_accel_bias, 0, sizeof(handle->next_accel_bias));
+	handle->prev_valid = 0;
+	handle->started = 0;
+	handle->last_timestamp_us = 0;
+	imu_preint_restart(handle);
+	memset(&handle->status, 0, sizeof(imu_preint_status_t));
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_preint_set_bias(imu_preint_handle_t handle, const float gyro_bias[3], const float accel_bias[3])
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (gyro_bias == NULL) || (accel_bias == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	memcpy(handle->next_gyro_bias, gyro_bias, sizeof(handle->next_gyro_bias));
+	memcpy(handle->next_accel_bias, accel_bias, sizeof(handle->next_accel_bias));
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_preint_write(imu_preint_handle_t handle, const imu_sample_scale_t *samples, uint16_t num_samples)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	for (uint16_t i = 0; i < num_samples; i++)
+	{
+		imu_preint_sample(handle, &samples[i]);
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_preint_read(imu_preint_handle_t handle, imu_preint_result_t *result)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (result == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	imu_preint_result_t *r = &handle->result;
+
+	imu_preint_log(r->delta_q, r->delta_angle);
+	r->gyro_bias_var = handle->cfg.noise.gyro_bias_rw * handle->cfg.noise.gyro_bias_rw * r->dt_s;
+	r->accel_bias_var = handle->cfg.noise.accel_bias_rw * handle->cfg.noise.accel_bias_rw * r->dt_s;
+	*result = *r;
+
+	imu_preint_restart(handle);
+	handle->status.intervals++;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_preint_get_status(imu_preint_handle_t handle, imu_preint_status_t *status)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (status == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*status = handle->status;
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,174 @@
+#ifndef __IMU_PREINT_H__
+#define __IMU_PREINT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+
+#define IMU_PREINT_STATES               9           /*!< Error state, rotation, velocity, position */
+
+typedef struct imu_preint* imu_preint_handle_t;
+
+/**
+ * @brief   Continuous time sensor noise, per axis.
+ */
+typedef struct {
+    float                       gyro_noise_density;         /*!< Angle random walk, in rad/s/sqrt(Hz) */
+    float                       accel_noise_density;        /*!< Velocity random walk, in m/s^2/sqrt(Hz) */
+    float                       gyro_bias_rw;               /*!< Gyroscope bias random walk, in rad/s^2/sqrt(Hz) */
+    float                       accel_bias_rw;              /*!< Accelerometer bias random walk, in m/s^3/sqrt(Hz) */
+} imu_preint_noise_t;
+
+/**
+ * @brief   Pre-integrated interval. Deltas are in the body frame at the
+ *          start of the interval, gravity is not removed.
+ */
+typedef struct {
+    uint32_t                    first_seq;                  /*!< Sequence number of the first sample of the interval */
+    uint32_t                    num_samples;                /*!< Samples integrated */
+    uint32_t                    gaps;                       /*!< Sequence gaps and bad timestamps bridged with the nominal period */
+    uint64_t                    start_us;                   /*!< Timestamp of the sample before the interval */
+    uint64_t                    end_us;                     /*!< Timestamp of the last sample of the interval */
+    float                       dt_s;                       /*!< Integrated time */
+    float                       delta_q[4];                 /*!< Rotation from the end to the start body frame, quaternion w, x, y, z */
+    float                       delta_angle[3];             /*!< Same rotation as rotation vector, in rad */
+    float                       delta_v[3];                 /*!< Velocity change from specific force, in m/s */
+    float                       delta_p[3];                 /*!< Position change from specific force, in m */
+    float                       cov[IMU_PREINT_STATES][IMU_PREINT_STATES];  /*!< Covariance of rotation, velocity and position errors */
+    float                       dr_dbg[3][3];               /*!< Jacobian of delta_angle over the gyroscope bias */
+    float                       dv_dbg[3][3];               /*!< Jacobian of delta_v over the gyroscope bias */
+    float                       dv_dba[3][3];               /*!< Jacobian of delta_v over the accelerometer bias */
+    float                       dp_dbg[3][3];               /*!< Jacobian of delta_p over the gyroscope bias */
+    float                       dp_dba[3][3];               /*!< Jacobian of delta_p over the accelerometer bias */
+    float                       gyro_bias[3];               /*!< Gyroscope bias removed, the Jacobians linearize around it, in rad/s */
+    float                       accel_bias[3];              /*!< Accelerometer bias removed, in m/s^2 */
+    float                       gyro_bias_var;              /*!< Gyroscope bias variance added over the interval, per axis */
+    float                       accel_bias_var;             /*!< Accelerometer bias variance added over the interval, per axis */
+} imu_preint_result_t;
+
+/**
+ * @brief   Pre-integration configuration structure.
+ */
+typedef struct {
+    float                       sample_rate_hz;             /*!< Nominal sample rate, used when timestamps cannot be */
+    imu_preint_noise_t          noise;                      /*!< Sensor noise */
+} imu_preint_cfg_t;
+
+/**
+ * @brief   Pre-integration status structure.
+ */
+typedef struct {
+    uint32_t                    samples;                    /*!< Samples integrated */
+    uint32_t                    intervals;                  /*!< Intervals read */
+    uint32_t                    gaps;                       /*!< Sequence gaps and bad timestamps */
+} imu_preint_status_t;
+
+/*
+ * @brief   Initialize pre-integration.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_preint_handle_t imu_preint_init(void);
+
+/*
+ * @brief   Set pre-integration configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_preint_set_config(imu_preint_handle_t handle, imu_preint_cfg_t config);
+
+/*
+ * @brief   Configure pre-integration. Clears the biases, the interval and
+ *          the status.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_preint_config(imu_preint_handle_t handle);
+
+/*
+ * @brief   Set the biases removed from the samples, on top of the biases of
+ *          the IMU handle. Used from the next interval, the current one keeps
+ *          its linearization point.
+ *
+ * @param   handle Handle structure.
+ * @param   gyro_bias Gyroscope bias in rad/s.
+ * @param   accel_bias Accelerometer bias in m/s^2.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_preint_set_bias(imu_preint_handle_t handle, const float gyro_bias[3], const float accel_bias[3]);
+
+/*
+ * @brief   Integrate scaled samples, as returned by imu_scale_sample.
+ *
+ * @note    Every sample is a rate held since the previous sample. Rotation
+ *          and velocity use the increment of the sample and of the one
+ *          before it, a coning term corrects the rotation vector and a
+ *          sculling term the velocity increment, so vibration does not
+ *          turn into drift. The covariance and the bias Jacobians follow
+ *          to first order. A sequence gap restarts the coning history.
+ *          Samples without timestamps are one nominal period apart.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Samples.
+ * @param   num_samples Number of samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_preint_write(imu_preint_handle_t handle, const imu_sample_scale_t *samples, uint16_t num_samples);
+
+/*
+ * @brief   Read the interval integrated since the last read and start the
+ *          next one at the last sample.
+ *
+ * @note    For a new gyroscope bias estimate bg + d the rotation is about
+ *          delta_angle + dr_dbg * d, velocity and position follow the same
+ *          way, without integrating again.
+ *
+ * @param   handle Handle structure.
+ * @param   result Interval.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_preint_read(imu_preint_handle_t handle, imu_preint_result_t *result);
+
+/*
+ * @brief   Get pre-integration status.
+ *
+ * @param   handle Handle structure.
+ * @param   status Status.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_preint_get_status(imu_preint_handle_t handle, imu_preint_status_t *status);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_PREINT_H__ */
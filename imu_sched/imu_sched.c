@@ -0,0 +1,240 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+
+#include "imu_sched/imu_sched.h"
+
+
+#define SCHED_NUM_CHANNEL 			4
+#define SCHED_MAG_READ_LEN 			7 			/*!< Magnetometer data and ST2 */
+
+/* I2C register read: START, address + W, register, repeated START,
+ * address + R, data bytes and STOP, 9 clocks per byte.
+ */
+#define I2C_READ_OVERHEAD_CLK 		(3 * 9 + 3)
+#define I2C_CLK_PER_BYTE 			9
+
+
+static const uint8_t sched_channel[SCHED_NUM_CHANNEL] = {
+	IMU_CHANNEL_ACCEL,
+	IMU_CHANNEL_GYRO,
+	IMU_CHANNEL_TEMP,
+	IMU_CHANNEL_MAG,
+};
+
+typedef struct imu_sched {
+	float 						tick_rate_hz; 				/*!< Tick rate */
+	float 						channel_rate_hz[SCHED_NUM_CHANNEL];	/*!< Requested channel rates */
+	uint32_t 					bus_clock_hz; 				/*!< Bus clock */
+	imu_sched_func_publish 		func_publish; 				/*!< Publish function */
+	uint32_t 					divider[SCHED_NUM_CHANNEL];	/*!< Ticks between two reads of a channel, 0 disabled */
+	uint32_t 					phase[SCHED_NUM_CHANNEL]; 	/*!< Tick offset of a channel */
+	imu_handle_t 				imu[IMU_SCHED_MAX_IMU]; 	/*!< IMU handles */
+	imu_sample_t 				sample[IMU_SCHED_MAX_IMU]; 	/*!< Latest data of every IMU */
+	uint8_t 					mag_present[IMU_SCHED_MAX_IMU];	/*!< IMU has a magnetometer */
+	uint8_t 					num_imu; 					/*!< Number of IMU handles */
+	uint32_t 					tick; 						/*!< Tick counter */
+	uint64_t 					bus_clocks; 				/*!< Estimated bus busy time in bus clocks */
+	imu_sched_stats_t 			stats; 						/*!< Statistics */
+} imu_sched_t;
+
+static uint32_t imu_sched_read_len(uint8_t channels)
+{
+	uint8_t first = 14, last = 0;
+
+	/* Same span imu_read_channels reads */
+	if (channels & IMU_CHANNEL_ACCEL)
+	{
+		first = 0;
+		last = 6;
+	}
+	if (channels & IMU_CHANNEL_TEMP)
+	{
+		first = (first < 6) ? first : 6;
+		last = 8;
+	}
+	if (channels & IMU_CHANNEL_GYRO)
+	{
+		first = (first < 8) ? first : 8;
+		last = 14;
+	}
+
+	return (first < last) ? (last - first) : 0;
+}
+
+imu_sched_handle_t imu_sched_init(void)
+{
+	imu_sched_handle_t handle = calloc(1, sizeof(imu_sched_t));
+
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t imu_sched_set_config(imu_sched_handle_t handle, imu_sched_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (config.tick_rate_hz <= 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->tick_rate_hz = config.tick_rate_hz;
+	handle->channel_rate_hz[0] = config.accel_rate_hz;
+	handle->channel_rate_hz[1] = config.gyro_rate_hz;
+	handle->channel_rate_hz[2] = config.temp_rate_hz;
+	handle->channel_rate_hz[3] = config.mag_rate_hz;
+	handle->bus_clock_hz = config.bus_clock_hz;
+	handle->func_publish = config.func_publish;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_sched_config(imu_sched_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	for (uint8_t ch = 0; ch < SCHED_NUM_CHANNEL; ch++)
+	{
+		float rate = handle->channel_rate_hz[ch];
+
+		if (rate <= 0)
+		{
+			handle->divider[ch] = 0;
+			continue;
+		}
+
+		/* Never read slower than requested */
+		uint32_t divider = (uint32_t)(handle->tick_rate_hz / rate);
+		handle->divider[ch] = (divider < 1) ? 1 : divider;
+	}
+
+	/* The magnetometer is a separate transaction, shift it away from the
+	 * ticks where the slow motion channels are read to flatten bus load.
+	 */
+	handle->phase[0] = 0;
+	handle->phase[1] = 0;
+	handle->phase[2] = 0;
+	handle->phase[3] = (handle->divider[3] > 1) ? (handle->divider[3] / 2) : 0;
+
+	handle->tick = 0;
+	handle->bus_clocks = 0;
+	memset(&handle->stats, 0, sizeof(handle->stats));
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_sched_add_imu(imu_sched_handle_t handle, imu_handle_t imu)
+{
+	/* Check if handle structure is NULL */
+	if ((handle == NULL) || (imu == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->num_imu >= IMU_SCHED_MAX_IMU)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	imu_config_regs_t regs;
+	if (imu_get_config_regs(imu, &regs) != ERR_CODE_SUCCESS)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->imu[handle->num_imu] = imu;
+	handle->mag_present[handle->num_imu] = regs.mag_present;
+	memset(&handle->sample[handle->num_imu], 0, sizeof(imu_sample_t));
+	handle->num_imu++;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_sched_tick(imu_sched_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t ret = ERR_CODE_SUCCESS;
+	uint8_t channels = 0;
+
+	/* Plan: channels due in this tick */
+	for (uint8_t ch = 0; ch < SCHED_NUM_CHANNEL; ch++)
+	{
+		if ((handle->divider[ch] != 0) && (((handle->tick + handle->phase[ch]) % handle->divider[ch]) == 0))
+		{
+			channels |= sched_channel[ch];
+		}
+	}
+
+	uint32_t motion_len = imu_sched_read_len(channels);
+
+	for (uint8_t i = 0; (i < handle->num_imu) && (channels != 0); i++)
+	{
+		/* The magnetometer read is skipped on IMUs without one */
+		uint8_t mag = (channels & IMU_CHANNEL_MAG) && handle->mag_present[i];
+		uint32_t transactions = ((motion_len != 0) ? 1 : 0) + (mag ? 1 : 0);
+		uint32_t bytes = motion_len + (mag ? SCHED_MAG_READ_LEN : 0);
+
+		err_code_t err = imu_read_channels(handle->imu[i], channels, &handle->sample[i]);
+
+		handle->stats.transactions += transactions;
+		handle->stats.bytes += bytes;
+		handle->bus_clocks += transactions * I2C_READ_OVERHEAD_CLK + bytes * I2C_CLK_PER_BYTE;
+
+		if (err != ERR_CODE_SUCCESS)
+		{
+			handle->stats.errors++;
+			ret = ERR_CODE_FAIL;
+			continue;
+		}
+
+		if (handle->func_publish != NULL)
+		{
+			handle->func_publish(i, channels, &handle->sample[i]);
+		}
+	}
+
+	handle->tick++;
+	handle->stats.ticks = handle->tick;
+
+	return ret;
+}
+
+err_code_t imu_sched_get_stats(imu_sched_handle_t handle, imu_sched_stats_t *stats)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (stats == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*stats = handle->stats;
+
+	/* Bus time is kept in clocks, a float sum stops growing on long runs */
+	if ((handle->bus_clock_hz != 0) && (handle->tick != 0))
+	{
+		double bus_time_us = (double)handle->bus_clocks * 1000000.0 / handle->bus_clock_hz;
+		stats->bus_time_us = (float)bus_time_us;
+		stats->bus_utilisation = (float)(bus_time_us * handle->tick_rate_hz / (handle->tick * 1000000.0));
+	}
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,126 @@
+#ifndef __IMU_SCHED_H__
+#define __IMU_SCHED_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu.h"
+
+#define IMU_SCHED_MAX_IMU           8           /*!< Maximum number of IMU handles per scheduler */
+
+typedef struct imu_sched* imu_sched_handle_t;
+
+/*
+ * @brief   Publish function, called once per IMU for every tick that read data.
+ *
+ * @param   imu_index Index of the IMU in the order it was added.
+ * @param   channels Bit mask of imu_channel_t updated in this tick.
+ * @param   sample Sample holding the latest data of every channel. seq counts reads of this IMU.
+ */
+typedef void (*imu_sched_func_publish)(uint8_t imu_index, uint8_t channels, const imu_sample_t *sample);
+
+/**
+ * @brief   Scheduler configuration structure. A channel rate of 0 disables the channel.
+ */
+typedef struct {
+    float                       tick_rate_hz;               /*!< Rate imu_sched_tick is called at */
+    float                       accel_rate_hz;              /*!< Accelerometer rate */
+    float                       gyro_rate_hz;               /*!< Gyroscope rate */
+    float                       temp_rate_hz;               /*!< Temperature rate */
+    float                       mag_rate_hz;                /*!< Magnetometer rate */
+    uint32_t                    bus_clock_hz;               /*!< I2C bus clock used to estimate bus utilisation */
+    imu_sched_func_publish      func_publish;               /*!< Publish function */
+} imu_sched_cfg_t;
+
+/**
+ * @brief   Scheduler statistics structure.
+ */
+typedef struct {
+    uint32_t                    ticks;                      /*!< Number of ticks */
+    uint32_t                    transactions;               /*!< Number of bus transactions */
+    uint32_t                    bytes;                      /*!< Number of data bytes read */
+    uint32_t                    errors;                     /*!< Number of failed reads */
+    float                       bus_time_us;                /*!< Estimated bus busy time, 0 without bus clock */
+    float                       bus_utilisation;            /*!< Bus busy time over elapsed time, 0 to 1 */
+} imu_sched_stats_t;
+
+/*
+ * @brief   Initialize scheduler with default parameters.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_sched_handle_t imu_sched_init(void);
+
+/*
+ * @brief   Set scheduler parameters.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_sched_set_config(imu_sched_handle_t handle, imu_sched_cfg_t config);
+
+/*
+ * @brief   Configure scheduler. Compute channel dividers and clear statistics.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_sched_config(imu_sched_handle_t handle);
+
+/*
+ * @brief   Add an IMU handle to the scheduler. The IMU must be configured.
+ *
+ * @param   handle Handle structure.
+ * @param   imu IMU handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_sched_add_imu(imu_sched_handle_t handle, imu_handle_t imu);
+
+/*
+ * @brief   Run one scheduler tick. Call from a timer or data ready interrupt at
+ *          the configured tick rate.
+ *
+ * @note    Every channel due in this tick is read for every IMU, accelerometer,
+ *          temperature and gyroscope in a single burst, and published.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           At least one read failed.
+ */
+err_code_t imu_sched_tick(imu_sched_handle_t handle);
+
+/*
+ * @brief   Get scheduler statistics.
+ *
+ * @param   handle Handle structure.
+ * @param   stats Statistics structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_sched_get_stats(imu_sched_handle_t handle, imu_sched_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_SCHED_H__ */
@@ -0,0 +1,788 @@
+#include "stdlib.h"
+#include "stddef.h"
+#include "string.h"
+#include "math.h"
+
+#include "imu_sim/imu_sim.h"
+#include "mpu6050/mpu6050_register.h"
+#include "mpu6500/mpu6500_register.h"
+#include "ak8963/ak8963_register.h"
+
+/* MPU6050 and MPU6500 share the register addresses used here, the MPU6050
+ * names are used for both.
+ */
+#define SIM_REG_SIZE 				128
+#define SIM_FIFO_SIZE_MAX 			1024
+#define SIM_MPU6050_FIFO_SIZE 		1024
+#define SIM_MPU6500_FIFO_SIZE 		512
+#define SIM_MPU6050_WHO_AM_I 		0x68
+#define SIM_MPU6500_WHO_AM_I 		0x70
+#define SIM_AK8963_WHO_AM_I 		0x48
+#define SIM_AK8963_SINGLE_NS 		7200000 	/*!< Single measurement time */
+#define SIM_AK8963_HOFL_UT 			4912.0f 	/*!< |X| + |Y| + |Z| limit of the sensor */
+#define SIM_READ_FLAG 				0x80
+#define SIM_STOPPED 				UINT64_MAX
+#define SIM_PI 						3.14159265358979f
+
+#define SIM_INT_DATA_RDY 			0x01
+#define SIM_INT_FIFO_OFLOW 			0x10
+#define SIM_USER_CTRL_FIFO_EN 		0x40
+#define SIM_USER_CTRL_FIFO_RESET 	0x04
+#define SIM_PWR_MGMT_1_RESET 		0x80
+#define SIM_PWR_MGMT_1_SLEEP 		0x40
+#define SIM_PWR_MGMT_1_CYCLE 		0x20
+#define SIM_PWR_MGMT_2_GYRO 		0x07 		/*!< Gyroscope axes standby */
+#define SIM_INT_WOM 				0x40
+#define SIM_MOT_DETECT_EN 			0x80
+#define SIM_GYRO_STARTUP_NS 		35000000 	/*!< Gyroscope output is zero this long after leaving standby */
+#define SIM_AK8963_ST1_DRDY 		0x01
+#define SIM_AK8963_ST1_DOR 			0x02
+#define SIM_AK8963_ST2_HOFL 		0x08
+#define SIM_AK8963_CNTL_BIT 		0x10
+
+
+typedef struct imu_sim {
+	imu_sim_cfg_t 				cfg; 						/*!< Configuration */
+	uint8_t 					reg[SIM_REG_SIZE]; 			/*!< Register map */
+	uint8_t 					fifo[SIM_FIFO_SIZE_MAX]; 	/*!< FIFO ring buffer */
+	uint16_t 					fifo_head; 					/*!< Index of the oldest FIFO byte */
+	uint16_t 					fifo_count; 				/*!< Number of FIFO bytes */
+	uint16_t 					fifo_size; 					/*!< FIFO capacity */
+	uint64_t 					origin_ns; 					/*!< Virtual time of power on, signal time zero */
+	uint64_t 					start_ns; 					/*!< Virtual time the current output rate started */
+	double 						period_ns; 					/*!< Sample period on the virtual clock */
+	uint64_t 					sample_idx; 				/*!< Index of the next sample since start_ns */
+	uint64_t 					next_ns; 					/*!< Virtual time of the next sample, SIM_STOPPED if none */
+	uint64_t 					bus_time_ns; 				/*!< Virtual bus time spent */
+	uint32_t 					rng; 						/*!< Random state */
+	uint64_t 					gyro_ready_ns; 				/*!< Virtual time the gyroscope output becomes valid */
+	int16_t 					wom_ref[3]; 				/*!< Previous accelerometer sample of wake-on-motion */
+	uint8_t 					wom_ref_valid; 				/*!< wom_ref holds a sample */
+	imu_sim_stats_t 			stats; 						/*!< Statistics */
+} imu_sim_t;
+
+static imu_sim_t *imu_sim_dev[IMU_SIM_MAX_DEV];
+static uint64_t imu_sim_now_ns;
+
+/* MPU6500 LP_ACCEL_ODR rates of accelerometer cycle mode */
+static const float imu_sim_lp_accel_odr_hz[12] = {
+	0.24f, 0.49f, 0.98f, 1.95f, 3.91f, 7.81f, 15.63f, 31.25f, 62.5f, 125.0f, 250.0f, 500.0f
+};
+
+static float imu_sim_uniform(imu_sim_t *sim)
+{
+	/* xorshift32, reproducible for a given seed */
+	sim->rng ^= sim->rng << 13;
+	sim->rng ^= sim->rng >> 17;
+	sim->rng ^= sim->rng << 5;
+
+	return (float)((sim->rng >> 8) + 1) / 16777217.0f;
+}
+
+static float imu_sim_gauss(imu_sim_t *sim)
+{
+	float u1 = imu_sim_uniform(sim);
+	float u2 = imu_sim_uniform(sim);
+
+	return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * SIM_PI * u2);
+}
+
+static int16_t imu_sim_to_raw(float value, float lsb)
+{
+	float raw = value * lsb;
+
+	if (raw > 32767.0f) {
+		return 32767;
+	}
+	if (raw < -32768.0f) {
+		return -32768;
+	}
+
+	return (int16_t)lroundf(raw);
+}
+
+static void imu_sim_schedule(imu_sim_t *sim)
+{
+	float rate_hz = 0;
+
+	if (sim->cfg.chip == IMU_SIM_CHIP_AK8963)
+	{
+		switch (sim->reg[AK8963_CNTL] & 0x0F) {
+		case 0x01:
+			/* Single measurement, one sample after the conversion time */
+			rate_hz = 1e9f / SIM_AK8963_SINGLE_NS;
+			break;
+		case 0x02:
+			rate_hz = 8.0f;
+			break;
+		case 0x06:
+			rate_hz = 100.0f;
+			break;
+		default:
+			break;
+		}
+	}
+	else if ((sim->reg[MPU6050_PWR_MGMT_1] & SIM_PWR_MGMT_1_SLEEP) == 0)
+	{
+		uint8_t dlpf_cfg = sim->reg[MPU6050_CONFIG] & 0x07;
+		uint8_t fchoice_b = sim->reg[MPU6050_GYRO_CONFIG] & 0x03;
+
+		uint8_t lp_accel_odr = sim->reg[MPU6500_LP_ACCEL_ODR] & 0x0F;
+
+		if ((sim->cfg.chip == IMU_SIM_CHIP_MPU6500) && (sim->reg[MPU6050_PWR_MGMT_1] & SIM_PWR_MGMT_1_CYCLE))
+		{
+			/* Accelerometer cycle mode, wakes at the low power rate */
+			rate_hz = (lp_accel_odr < 12) ? imu_sim_lp_accel_odr_hz[lp_accel_odr] : 0;
+		}
+		else if ((sim->cfg.chip == IMU_SIM_CHIP_MPU6500) && (fchoice_b != 0))
+		{
+			/* DLPF bypassed, sample rate divider has no effect */
+			rate_hz = 32000.0f;
+		}
+		else if ((sim->cfg.chip == IMU_SIM_CHIP_MPU6500) && ((dlpf_cfg == 0) || (dlpf_cfg == 7)))
+		{
+			/* Sample rate divider only applies with the DLPF on */
+			rate_hz = 8000.0f;
+		}
+		else
+		{
+			rate_hz = ((dlpf_cfg == 0) || (dlpf_cfg == 7)) ? 8000.0f : 1000.0f;
+			rate_hz /= (1.0f + sim->reg[MPU6050_SMPLRT_DIV]);
+		}
+	}
+
+	sim->start_ns = imu_sim_now_ns;
+	sim->sample_idx = 1;
+
+	if (rate_hz <= 0)
+	{
+		sim->next_ns = SIM_STOPPED;
+		return;
+	}
+
+	sim->period_ns = 1e9 / (rate_hz * (1.0 + sim->cfg.clock_ppm * 1e-6));
+	sim->next_ns = sim->start_ns + (uint64_t)sim->period_ns;
+}
+
+static void imu_sim_reset(imu_sim_t *sim)
+{
+	memset(sim->reg, 0, sizeof(sim->reg));
+	sim->gyro_ready_ns = 0;
+	sim->wom_ref_valid = 0;
+	sim->fifo_head = 0;
+	sim->fifo_count = 0;
+
+	if (sim->cfg.chip == IMU_SIM_CHIP_AK8963)
+	{
+		sim->reg[AK8963_WHO_AM_I] = SIM_AK8963_WHO_AM_I;
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			sim->reg[AK8963_ASAX + i] = (sim->cfg.mag_asa[i] != 0) ? sim->cfg.mag_asa[i] : 128;
+		}
+	}
+	else
+	{
+		sim->reg[MPU6050_PWR_MGMT_1] = SIM_PWR_MGMT_1_SLEEP;
+		sim->reg[MPU6050_WHO_AM_I] = (sim->cfg.chip == IMU_SIM_CHIP_MPU6500) ? SIM_MPU6500_WHO_AM_I : SIM_MPU6050_WHO_AM_I;
+	}
+
+	imu_sim_schedule(sim);
+}
+
+static void imu_sim_fifo_push(imu_sim_t *sim, const uint8_t *data, uint8_t len)
+{
+	uint8_t overflow = 0;
+
+	for (uint8_t i = 0; i < len; i++)
+	{
+		/* Oldest byte is overwritten, frames lose alignment like on the chip */
+		if (sim->fifo_count == sim->fifo_size)
+		{
+			sim->fifo_head = (sim->fifo_head + 1) % sim->fifo_size;
+			sim->fifo_count--;
+			overflow = 1;
+		}
+
+		sim->fifo[(sim->fifo_head + sim->fifo_count) % sim->fifo_size] = data[i];
+		sim->fifo_count++;
+	}
+
+	if (overflow)
+	{
+		sim->reg[MPU6050_INT_STATUS] |= SIM_INT_FIFO_OFLOW;
+		sim->stats.fifo_overflows++;
+	}
+}
+
+static float imu_sim_wave(imu_sim_t *sim, float offset, float amplitude, float freq_hz, float noise, float t)
+{
+	float value = offset;
+
+	if (amplitude != 0)
+	{
+		value += amplitude * sinf(2.0f * SIM_PI * freq_hz * t);
+	}
+	if (noise != 0)
+	{
+		value += noise * imu_sim_gauss(sim);
+	}
+
+	return value;
+}
+
+/* Returns the interrupt status bits raised by the sample */
+static uint8_t imu_sim_sample_mpu(imu_sim_t *sim, float t)
+{
+	const imu_sim_signal_t *signal = &sim->cfg.signal;
+	float accel_lsb = (float)(16384 >> ((sim->reg[MPU6050_ACCEL_CONFIG] >> 3) & 0x03));
+	float gyro_lsb = 131.0f / (float)(1 << ((sim->reg[MPU6050_GYRO_CONFIG] >> 3) & 0x03));
+	int16_t raw[7];
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		raw[i] = imu_sim_to_raw(imu_sim_wave(sim, signal->accel_offset_g[i], signal->accel_amplitude_g[i],
+		                                     signal->accel_freq_hz, signal->accel_noise_g, t), accel_lsb);
+		raw[4 + i] = imu_sim_to_raw(imu_sim_wave(sim, signal->gyro_offset_dps[i], signal->gyro_amplitude_dps[i],
+		                                         signal->gyro_freq_hz, signal->gyro_noise_dps, t), gyro_lsb);
+	}
+
+	/* Gyroscope axes in standby or still starting up read zero */
+	uint8_t gyro_standby = sim->reg[MPU6050_PWR_MGMT_2] & SIM_PWR_MGMT_2_GYRO;
+	if ((sim->reg[MPU6050_PWR_MGMT_1] & SIM_PWR_MGMT_1_CYCLE) || (imu_sim_now_ns < sim->gyro_ready_ns)) {
+		gyro_standby = SIM_PWR_MGMT_2_GYRO;
+	}
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		if (gyro_standby & (0x04 >> i)) {
+			raw[4 + i] = 0;
+		}
+	}
+
+	if (sim->cfg.chip == IMU_SIM_CHIP_MPU6500) {
+		raw[3] = imu_sim_to_raw(signal->temp_c - 21.0f, 333.87f);
+	} else {
+		raw[3] = imu_sim_to_raw(signal->temp_c - 36.53f, 340.0f);
+	}
+
+	/* Output registers are big endian */
+	uint8_t *out = &sim->reg[MPU6050_ACCEL_XOUT_H];
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		out[2 * i] = (uint8_t)((uint16_t)raw[i] >> 8);
+		out[2 * i + 1] = (uint8_t)raw[i];
+	}
+
+	if (sim->reg[MPU6050_INT_STATUS] & SIM_INT_DATA_RDY)
+	{
+		sim->stats.overruns++;
+	}
+	sim->reg[MPU6050_INT_STATUS] |= SIM_INT_DATA_RDY;
+	uint8_t events = SIM_INT_DATA_RDY;
+
+	/* Wake-on-motion compares every sample with the previous one, the
+	 * threshold is in 4 mg steps.
+	 */
+	if ((sim->cfg.chip == IMU_SIM_CHIP_MPU6500) && (sim->reg[MPU6500_MOT_DETECT_CTRL] & SIM_MOT_DETECT_EN))
+	{
+		float threshold = sim->reg[MPU6500_WOM_THR] * 0.004f * accel_lsb;
+		uint8_t motion = 0;
+
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			if (sim->wom_ref_valid && (fabsf((float)raw[i] - (float)sim->wom_ref[i]) > threshold)) {
+				motion = 1;
+			}
+			sim->wom_ref[i] = raw[i];
+		}
+		sim->wom_ref_valid = 1;
+
+		if (motion)
+		{
+			sim->reg[MPU6050_INT_STATUS] |= SIM_INT_WOM;
+			events |= SIM_INT_WOM;
+			sim->stats.wake_events++;
+		}
+	}
+
+	/* FIFO frames follow register order: accelerometer, temperature, gyroscope */
+	if (sim->reg[MPU6050_USER_CTRL] & SIM_USER_CTRL_FIFO_EN)
+	{
+		uint8_t fifo_en = sim->reg[MPU6050_FIFO_EN];
+
+		if (fifo_en & 0x08) {
+			imu_sim_fifo_push(sim, &out[0], 6);
+		}
+		if (fifo_en & 0x80) {
+			imu_sim_fifo_push(sim, &out[6], 2);
+		}
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			if (fifo_en & (0x40 >> i)) {
+				imu_sim_fifo_push(sim, &out[8 + 2 * i], 2);
+			}
+		}
+	}
+
+	return events;
+}
+
+static void imu_sim_sample_ak8963(imu_sim_t *sim)
+{
+	const imu_sim_signal_t *signal = &sim->cfg.signal;
+	uint8_t bit16 = sim->reg[AK8963_CNTL] & SIM_AK8963_CNTL_BIT;
+	float lsb = bit16 ? (1.0f / 0.15f) : (1.0f / 0.6f);
+	float field[3];
+	float sum = 0;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		field[i] = imu_sim_wave(sim, signal->mag_offset_ut[i], 0, 0, signal->mag_noise_ut, 0);
+		sum += fabsf(field[i]);
+	}
+
+	if (sim->reg[AK8963_ST1] & SIM_AK8963_ST1_DRDY)
+	{
+		sim->reg[AK8963_ST1] |= SIM_AK8963_ST1_DOR;
+		sim->stats.overruns++;
+	}
+	sim->reg[AK8963_ST1] |= SIM_AK8963_ST1_DRDY;
+
+	/* Output registers are little endian */
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		int16_t raw = imu_sim_to_raw(field[i], lsb);
+		sim->reg[AK8963_XOUT_L + 2 * i] = (uint8_t)raw;
+		sim->reg[AK8963_XOUT_H + 2 * i] = (uint8_t)((uint16_t)raw >> 8);
+	}
+	sim->reg[AK8963_ST2] = bit16 | ((sum >= SIM_AK8963_HOFL_UT) ? SIM_AK8963_ST2_HOFL : 0);
+
+	/* Single measurement returns to power down */
+	if ((sim->reg[AK8963_CNTL] & 0x0F) == 0x01)
+	{
+		sim->reg[AK8963_CNTL] &= SIM_AK8963_CNTL_BIT;
+		sim->next_ns = SIM_STOPPED;
+	}
+}
+
+static void imu_sim_run_until(uint64_t time_ns)
+{
+	/* Produce samples of all devices in time order */
+	while (1)
+	{
+		imu_sim_t *sim = NULL;
+
+		for (uint8_t i = 0; i < IMU_SIM_MAX_DEV; i++)
+		{
+			if ((imu_sim_dev[i] != NULL) && (imu_sim_dev[i]->next_ns <= time_ns) &&
+			        ((sim == NULL) || (imu_sim_dev[i]->next_ns < sim->next_ns)))
+			{
+				sim = imu_sim_dev[i];
+			}
+		}
+
+		if (sim == NULL)
+		{
+			break;
+		}
+
+		imu_sim_now_ns = sim->next_ns;
+		sim->sample_idx++;
+		sim->next_ns = sim->start_ns + (uint64_t)(sim->sample_idx * sim->period_ns);
+		sim->stats.samples++;
+
+		uint8_t events;
+		if (sim->cfg.chip == IMU_SIM_CHIP_AK8963) {
+			imu_sim_sample_ak8963(sim);
+			events = 1;
+		} else {
+			events = imu_sim_sample_mpu(sim, (float)((imu_sim_now_ns - sim->origin_ns) * 1e-9)) & sim->reg[MPU6050_INT_ENABLE];
+		}
+
+		if ((sim->cfg.func_data_ready != NULL) && events)
+		{
+			sim->cfg.func_data_ready();
+		}
+	}
+
+	imu_sim_now_ns = time_ns;
+}
+
+static void imu_sim_bus_time(imu_sim_t *sim, float time_us)
+{
+	uint64_t time_ns = (uint64_t)(time_us * 1000.0f + 0.5f);
+
+	sim->bus_time_ns += time_ns;
+	imu_sim_run_until(imu_sim_now_ns + time_ns);
+}
+
+static void imu_sim_read_mpu(imu_sim_t *sim, uint8_t reg_addr, uint8_t *buf, uint16_t len)
+{
+	uint8_t clear_int_status = 0;
+
+	sim->reg[MPU6050_FIFO_COUNTH] = (uint8_t)(sim->fifo_count >> 8);
+	sim->reg[MPU6050_FIRO_COUNTL] = (uint8_t)sim->fifo_count;
+
+	for (uint16_t i = 0; i < len; i++)
+	{
+		/* FIFO_R_W does not auto increment */
+		if (reg_addr == MPU6050_FIRO_R_W)
+		{
+			buf[i] = 0;
+			if (sim->fifo_count != 0)
+			{
+				buf[i] = sim->fifo[sim->fifo_head];
+				sim->fifo_head = (sim->fifo_head + 1) % sim->fifo_size;
+				sim->fifo_count--;
+			}
+			continue;
+		}
+
+		buf[i] = (reg_addr < SIM_REG_SIZE) ? sim->reg[reg_addr] : 0;
+		if (reg_addr == MPU6050_INT_STATUS)
+		{
+			clear_int_status = 1;
+		}
+		reg_addr++;
+	}
+
+	if (clear_int_status)
+	{
+		sim->reg[MPU6050_INT_STATUS] = 0;
+	}
+}
+
+static void imu_sim_write_mpu(imu_sim_t *sim, uint8_t reg_addr, const uint8_t *buf, uint16_t len)
+{
+	uint8_t reschedule = 0;
+
+	for (uint16_t i = 0; i < len; i++, reg_addr++)
+	{
+		if (reg_addr >= SIM_REG_SIZE)
+		{
+			break;
+		}
+
+		switch (reg_addr) {
+		case MPU6050_PWR_MGMT_1:
+			if (buf[i] & SIM_PWR_MGMT_1_RESET)
+			{
+				imu_sim_reset(sim);
+				return;
+			}
+			sim->reg[reg_addr] = buf[i];
+			reschedule = 1;
+			break;
+		case MPU6050_USER_CTRL:
+			if (buf[i] & SIM_USER_CTRL_FIFO_RESET)
+			{
+				sim->fifo_head = 0;
+				sim->fifo_count = 0;
+			}
+			/* Reset bits clear themselves */
+			sim->reg[reg_addr] = buf[i] & 0xF8;
+			break;
+		case MPU6050_PWR_MGMT_2:
+			/* Gyroscope axes leaving standby need the start-up time */
+			if ((sim->reg[reg_addr] & ~buf[i]) & SIM_PWR_MGMT_2_GYRO)
+			{
+				sim->gyro_ready_ns = imu_sim_now_ns + SIM_GYRO_STARTUP_NS;
+			}
+			sim->reg[reg_addr] = buf[i];
+			break;
+		case MPU6500_MOT_DETECT_CTRL:
+			sim->wom_ref_valid = 0;
+			sim->reg[reg_addr] = buf[i];
+			break;
+		case MPU6050_SMPLRT_DIV:
+		case MPU6050_CONFIG:
+		case MPU6050_GYRO_CONFIG:
+		case MPU6500_LP_ACCEL_ODR:
+			sim->reg[reg_addr] = buf[i];
+			reschedule = 1;
+			break;
+		case MPU6050_INT_STATUS:
+		case MPU6050_FIFO_COUNTH:
+		case MPU6050_FIRO_COUNTL:
+		case MPU6050_FIRO_R_W:
+		case MPU6050_WHO_AM_I:
+			break;
+		default:
+			/* Output registers are read only */
+			if ((reg_addr < MPU6050_ACCEL_XOUT_H) || (reg_addr > MPU6050_EXT_SENS_DATA_23))
+			{
+				sim->reg[reg_addr] = buf[i];
+			}
+			break;
+		}
+	}
+
+	if (reschedule)
+	{
+		imu_sim_schedule(sim);
+	}
+}
+
+static void imu_sim_read_ak8963(imu_sim_t *sim, uint8_t reg_addr, uint8_t *buf, uint16_t len)
+{
+	uint8_t data_read = 0;
+
+	for (uint16_t i = 0; i < len; i++, reg_addr++)
+	{
+		buf[i] = (reg_addr <= AK8963_ASAZ) ? sim->reg[reg_addr] : 0;
+		if ((reg_addr >= AK8963_XOUT_L) && (reg_addr <= AK8963_ST2))
+		{
+			data_read = 1;
+		}
+	}
+
+	/* Reading measurement data or ST2 releases DRDY and DOR */
+	if (data_read)
+	{
+		sim->reg[AK8963_ST1] &= (uint8_t)~(SIM_AK8963_ST1_DRDY | SIM_AK8963_ST1_DOR);
+	}
+}
+
+static void imu_sim_write_ak8963(imu_sim_t *sim, uint8_t reg_addr, const uint8_t *buf, uint16_t len)
+{
+	for (uint16_t i = 0; i < len; i++, reg_addr++)
+	{
+		if (reg_addr == AK8963_CNTL)
+		{
+			sim->reg[reg_addr] = buf[i] & 0x1F;
+			imu_sim_schedule(sim);
+		}
+		else if ((reg_addr == AK8963_RSV) && (buf[i] & 0x01))
+		{
+			/* Soft reset */
+			imu_sim_reset(sim);
+			return;
+		}
+		else if ((reg_addr == AK8963_ASTC) || (reg_addr == AK8963_I2CDIS))
+		{
+			sim->reg[reg_addr] = buf[i];
+		}
+	}
+}
+
+static err_code_t imu_sim_access(imu_sim_t *sim, imu_transfer_t *transfer)
+{
+	uint8_t reg_addr = transfer->reg_addr;
+
+	if (transfer->buf == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (transfer->dir == IMU_TRANSFER_READ)
+	{
+		if (sim->cfg.spi)
+		{
+			reg_addr &= (uint8_t)~SIM_READ_FLAG;
+		}
+
+		if (sim->cfg.chip == IMU_SIM_CHIP_AK8963) {
+			imu_sim_read_ak8963(sim, reg_addr, transfer->buf, transfer->len);
+		} else {
+			imu_sim_read_mpu(sim, reg_addr, transfer->buf, transfer->len);
+		}
+	}
+	else
+	{
+		if (sim->cfg.chip == IMU_SIM_CHIP_AK8963) {
+			imu_sim_write_ak8963(sim, reg_addr, transfer->buf, transfer->len);
+		} else {
+			imu_sim_write_mpu(sim, reg_addr, transfer->buf, transfer->len);
+		}
+	}
+
+	sim->stats.bytes += transfer->len;
+
+	/* Data phase */
+	imu_sim_bus_time(sim, transfer->len * sim->cfg.byte_time_us);
+
+	return ERR_CODE_SUCCESS;
+}
+
+static err_code_t imu_sim_transfer(void *ctx, imu_transfer_t *transfers, uint8_t num_transfers, uint32_t timeout_ms)
+{
+	imu_sim_t *sim = (imu_sim_t *)ctx;
+	err_code_t err;
+
+	/* The virtual bus never stalls */
+	(void)timeout_ms;
+
+	if ((sim == NULL) || (transfers == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	/* Address phase and bus setup, once per transaction */
+	sim->stats.transactions++;
+	imu_sim_bus_time(sim, sim->cfg.latency_us + sim->cfg.jitter_us * imu_sim_uniform(sim));
+
+	for (uint8_t i = 0; i < num_transfers; i++)
+	{
+		err = imu_sim_access(sim, &transfers[i]);
+		if (err != ERR_CODE_SUCCESS) {
+			return err;
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+static err_code_t imu_sim_read_bytes(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	imu_transfer_t transfer = {reg_addr, buf, len, IMU_TRANSFER_READ};
+
+	return imu_sim_transfer(ctx, &transfer, 1, timeout_ms);
+}
+
+static err_code_t imu_sim_write_bytes(void *ctx, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	imu_transfer_t transfer = {reg_addr, buf, len, IMU_TRANSFER_WRITE};
+
+	return imu_sim_transfer(ctx, &transfer, 1, timeout_ms);
+}
+
+static const imu_bus_ops_t imu_sim_ops = {
+	.read_bytes = imu_sim_read_bytes,
+	.write_bytes = imu_sim_write_bytes,
+	.transfer = imu_sim_transfer,
+	.set_bus_clock = NULL,
+	.get_time_us = NULL,
+};
+
+imu_sim_handle_t imu_sim_init(void)
+{
+	imu_sim_handle_t handle = calloc(1, sizeof(imu_sim_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	handle->next_ns = SIM_STOPPED;
+
+	return handle;
+}
+
+err_code_t imu_sim_set_config(imu_sim_handle_t handle, imu_sim_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((config.chip >= IMU_SIM_CHIP_MAX) || (config.latency_us < 0) || (config.jitter_us < 0) || (config.byte_time_us < 0))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->cfg = config;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_sim_config(imu_sim_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	int8_t slot = -1;
+	for (uint8_t i = 0; i < IMU_SIM_MAX_DEV; i++)
+	{
+		if (imu_sim_dev[i] == handle)
+		{
+			slot = i;
+			break;
+		}
+		if ((slot < 0) && (imu_sim_dev[i] == NULL))
+		{
+			slot = i;
+		}
+	}
+
+	if (slot < 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	handle->fifo_size = (handle->cfg.chip == IMU_SIM_CHIP_MPU6500) ? SIM_MPU6500_FIFO_SIZE : SIM_MPU6050_FIFO_SIZE;
+	handle->rng = (handle->cfg.seed != 0) ? handle->cfg.seed : 1;
+	handle->origin_ns = imu_sim_now_ns;
+	handle->bus_time_ns = 0;
+	memset(&handle->stats, 0, sizeof(imu_sim_stats_t));
+	imu_sim_reset(handle);
+
+	imu_sim_dev[slot] = handle;
+
+	return ERR_CODE_SUCCESS;
+}
+
+const imu_bus_ops_t *imu_sim_get_ops(void)
+{
+	return &imu_sim_ops;
+}
+
+err_code_t imu_sim_set_signal(imu_sim_handle_t handle, imu_sim_signal_t signal)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->cfg.signal = signal;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_sim_get_stats(imu_sim_handle_t handle, imu_sim_stats_t *stats)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (stats == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*stats = handle->stats;
+	stats->bus_time_us = handle->bus_time_ns / 1000;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t imu_sim_reset_stats(imu_sim_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	memset(&handle->stats, 0, sizeof(imu_sim_stats_t));
+	handle->bus_time_ns = 0;
+
+	return ERR_CODE_SUCCESS;
+}
+
+void imu_sim_advance_us(float time_us)
+{
+	if (time_us > 0)
+	{
+		imu_sim_run_until(imu_sim_now_ns + (uint64_t)(time_us * 1000.0f + 0.5f));
+	}
+}
+
+void imu_sim_delay(uint32_t ms)
+{
+	imu_sim_run_until(imu_sim_now_ns + (uint64_t)ms * 1000000);
+}
+
+uint64_t imu_sim_get_time_us(void)
+{
+	return imu_sim_now_ns / 1000;
+}
@@ -0,0 +1,187 @@
+#ifndef __IMU_SIM_H__
+#define __IMU_SIM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "imu_bus/imu_bus.h"
+
+#ifndef IMU_SIM_MAX_DEV
+#define IMU_SIM_MAX_DEV                 16          /*!< Number of simulated devices sharing the virtual clock */
+#endif
+
+typedef struct imu_sim* imu_sim_handle_t;
+
+/**
+ * @brief   Simulated chip.
+ */
+typedef enum {
+    IMU_SIM_CHIP_MPU6050 = 0,                               /*!< MPU6050, 1024 byte FIFO */
+    IMU_SIM_CHIP_MPU6500,                                   /*!< MPU6500, 512 byte FIFO */
+    IMU_SIM_CHIP_AK8963,                                    /*!< AK8963 magnetometer */
+    IMU_SIM_CHIP_MAX
+} imu_sim_chip_t;
+
+/**
+ * @brief   Simulated motion. Every axis is offset + amplitude * sin(2 * pi * freq * t) + gaussian noise.
+ */
+typedef struct {
+    float                       accel_offset_g[3];          /*!< Accelerometer offset in g */
+    float                       accel_amplitude_g[3];       /*!< Accelerometer sine amplitude in g */
+    float                       accel_freq_hz;              /*!< Accelerometer sine frequency */
+    float                       accel_noise_g;              /*!< Accelerometer noise standard deviation in g */
+    float                       gyro_offset_dps[3];         /*!< Gyroscope offset in deg/s */
+    float                       gyro_amplitude_dps[3];      /*!< Gyroscope sine amplitude in deg/s */
+    float                       gyro_freq_hz;               /*!< Gyroscope sine frequency */
+    float                       gyro_noise_dps;             /*!< Gyroscope noise standard deviation in deg/s */
+    float                       mag_offset_ut[3];           /*!< Magnetic field in uT */
+    float                       mag_noise_ut;               /*!< Magnetometer noise standard deviation in uT */
+    float                       temp_c;                     /*!< Temperature in degree Celsius */
+} imu_sim_signal_t;
+
+/**
+ * @brief   Simulated device configuration structure.
+ */
+typedef struct {
+    imu_sim_chip_t              chip;                       /*!< Simulated chip */
+    uint8_t                     spi;                        /*!< SPI bus, register address bit 7 selects read */
+    uint32_t                    seed;                       /*!< Random seed of noise and jitter, same seed gives the same run */
+    float                       latency_us;                 /*!< Bus time of each transaction before the first byte */
+    float                       jitter_us;                  /*!< Uniform random extra latency, 0 to jitter_us */
+    float                       byte_time_us;               /*!< Bus time per data byte */
+    float                       clock_ppm;                  /*!< Sensor clock error, positive runs fast */
+    uint8_t                     mag_asa[3];                 /*!< AK8963 sensitivity adjustment fuse values, 0 reads as 128 */
+    imu_sim_signal_t            signal;                     /*!< Simulated motion */
+    void                        (*func_data_ready)(void);   /*!< Optional data ready interrupt, called at the virtual sample time */
+} imu_sim_cfg_t;
+
+/**
+ * @brief   Simulated device statistics structure.
+ */
+typedef struct {
+    uint32_t                    transactions;               /*!< Bus transactions, a batch counts once */
+    uint32_t                    bytes;                      /*!< Data bytes transferred */
+    uint64_t                    bus_time_us;                /*!< Virtual bus time spent */
+    uint32_t                    samples;                    /*!< Samples produced */
+    uint32_t                    fifo_overflows;             /*!< FIFO overflow events */
+    uint32_t                    overruns;                   /*!< Samples overwritten before read, data ready still set or AK8963 DOR */
+    uint32_t                    wake_events;                /*!< MPU6500 wake-on-motion events */
+} imu_sim_stats_t;
+
+/*
+ * @brief   Initialize simulated device.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - NULL:             Fail.
+ */
+imu_sim_handle_t imu_sim_init(void);
+
+/*
+ * @brief   Set simulated device configuration.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_sim_set_config(imu_sim_handle_t handle, imu_sim_cfg_t config);
+
+/*
+ * @brief   Power on simulated device. Registers take their reset values and
+ *          the device joins the virtual clock.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_sim_config(imu_sim_handle_t handle);
+
+/*
+ * @brief   Get simulated device backend operations, ctx is the handle. Bind
+ *          them with imu_bus_bind to get the IMU transport functions.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Backend operations.
+ */
+const imu_bus_ops_t *imu_sim_get_ops(void);
+
+/*
+ * @brief   Get simulated device statistics.
+ *
+ * @param   handle Handle structure.
+ * @param   stats Statistics.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_sim_get_stats(imu_sim_handle_t handle, imu_sim_stats_t *stats);
+
+/*
+ * @brief   Change simulated motion, takes effect from the next sample.
+ *
+ * @param   handle Handle structure.
+ * @param   signal Simulated motion.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_sim_set_signal(imu_sim_handle_t handle, imu_sim_signal_t signal);
+
+/*
+ * @brief   Clear simulated device statistics.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t imu_sim_reset_stats(imu_sim_handle_t handle);
+
+/*
+ * @brief   Advance virtual clock. Devices produce their samples in time order
+ *          on the way. Bus transactions and imu_sim_delay advance it too.
+ *
+ * @param   time_us Time in microseconds.
+ *
+ * @return  None.
+ */
+void imu_sim_advance_us(float time_us);
+
+/*
+ * @brief   Delay on the virtual clock, matches imu_func_delay.
+ *
+ * @param   ms Time in milliseconds.
+ *
+ * @return  None.
+ */
+void imu_sim_delay(uint32_t ms);
+
+/*
+ * @brief   Get virtual time, matches imu_func_get_time_us.
+ *
+ * @param   None.
+ *
+ * @return  Virtual time in microseconds.
+ */
+uint64_t imu_sim_get_time_us(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_SIM_H__ */
@@ -74,7 +74,7 @@ err_code_t mpu6050_init(imu_func_read_bytes read_bytes,
 
 	/* Configure sample rate divider */
 	buffer = 0;
-	buffer = 0x04;
+	buffer = MPU6050_SMPLRT_DIV_DEFAULT;
 	err_ret = write_bytes(MPU6050_SMPLRT_DIV, &buffer, 1, MPU6050_INIT_TIMEOUT);
 	if (err_ret != ERR_CODE_SUCCESS)
 	{
@@ -153,3 +153,222 @@ err_code_t mpu6050_get_gyro_raw(imu_func_read_bytes read_bytes,
 	return ERR_CODE_SUCCESS;
 }
 
+err_code_t mpu6050_get_int_status(imu_func_read_bytes read_bytes, uint8_t *int_status)
+{
+	if (int_status == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+
+	err = read_bytes(MPU6050_INT_STATUS, int_status, 1, MPU6050_READ_TIMEOUT);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_get_motion_raw(imu_func_read_bytes read_bytes,
+                                  int16_t *accel_raw_x,
+                                  int16_t *accel_raw_y,
+                                  int16_t *accel_raw_z,
+                                  int16_t *temp_raw,
+                                  int16_t *gyro_raw_x,
+                                  int16_t *gyro_raw_y,
+                                  int16_t *gyro_raw_z)
+{
+	if ((accel_raw_x == NULL) || (accel_raw_y == NULL) || (accel_raw_z == NULL) || (temp_raw == NULL) ||
+	    (gyro_raw_x == NULL) || (gyro_raw_y == NULL) || (gyro_raw_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+	uint8_t motion_raw_data[14];
+
+	/* ACCEL_XOUT_H..GYRO_ZOUT_L are contiguous, one transaction covers all of them */
+	err = read_bytes(MPU6050_ACCEL_XOUT_H, motion_raw_data, 14, MPU6050_READ_TIMEOUT);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	*accel_raw_x = (int16_t)((motion_raw_data[0] << 8) + motion_raw_data[1]);
+	*accel_raw_y = (int16_t)((motion_raw_data[2] << 8) + motion_raw_data[3]);
+	*accel_raw_z = (int16_t)((motion_raw_data[4] << 8) + motion_raw_data[5]);
+	*temp_raw = (int16_t)((motion_raw_data[6] << 8) + motion_raw_data[7]);
+	*gyro_raw_x = (int16_t)((motion_raw_data[8] << 8) + motion_raw_data[9]);
+	*gyro_raw_y = (int16_t)((motion_raw_data[10] << 8) + motion_raw_data[11]);
+	*gyro_raw_z = (int16_t)((motion_raw_data[12] << 8) + motion_raw_data[13]);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_config_fifo(imu_func_write_bytes write_bytes, uint8_t fifo_en)
+{
+	err_code_t err_ret;
+	uint8_t buffer;
+
+	/* Stop FIFO and clear its content */
+	buffer = 0x04;
+	err_ret = write_bytes(MPU6050_USER_CTRL, &buffer, 1, MPU6050_WRITE_TIMEOUT);
+	if (err_ret != ERR_CODE_SUCCESS)
+	{
+		return err_ret;
+	}
+
+	buffer = fifo_en;
+	err_ret = write_bytes(MPU6050_FIFO_EN, &buffer, 1, MPU6050_WRITE_TIMEOUT);
+	if (err_ret != ERR_CODE_SUCCESS)
+	{
+		return err_ret;
+	}
+
+	if (fifo_en == 0)
+	{
+		return ERR_CODE_SUCCESS;
+	}
+
+	/* Enable FIFO operation */
+	buffer = 0x40;
+	err_ret = write_bytes(MPU6050_USER_CTRL, &buffer, 1, MPU6050_WRITE_TIMEOUT);
+	if (err_ret != ERR_CODE_SUCCESS)
+	{
+		return err_ret;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_get_fifo_count(imu_func_read_bytes read_bytes, uint16_t *count)
+{
+	if (count == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+	uint8_t fifo_count_data[2];
+
+	err = read_bytes(MPU6050_FIFO_COUNTH, fifo_count_data, 2, MPU6050_READ_TIMEOUT);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	*count = (uint16_t)(((fifo_count_data[0] & 0x1F) << 8) | fifo_count_data[1]);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_read_fifo(imu_func_read_bytes read_bytes, uint8_t *buf, uint16_t len)
+{
+	if (buf == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+
+	err = read_bytes(MPU6050_FIRO_R_W, buf, len, MPU6050_READ_TIMEOUT);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_read_motion_block(imu_func_read_bytes read_bytes, uint8_t offset, uint8_t *buf, uint8_t len)
+{
+	if (buf == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((len == 0) || ((offset + len) > 14))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	err_code_t err;
+
+	err = read_bytes(MPU6050_ACCEL_XOUT_H + offset, buf, len, MPU6050_READ_TIMEOUT);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_get_status_motion_block(imu_func_transfer transfer, uint8_t *int_status, uint8_t *buf)
+{
+	if ((transfer == NULL) || (int_status == NULL) || (buf == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+	imu_transfer_t xfer[2] = {
+		{MPU6050_INT_STATUS, int_status, 1, IMU_TRANSFER_READ},
+		{MPU6050_ACCEL_XOUT_H, buf, 14, IMU_TRANSFER_READ},
+	};
+
+	err = transfer(xfer, 2, MPU6050_READ_TIMEOUT);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_get_status_fifo_count(imu_func_transfer transfer, uint8_t *int_status, uint16_t *count)
+{
+	if ((transfer == NULL) || (int_status == NULL) || (count == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+	uint8_t fifo_count_data[2];
+	imu_transfer_t xfer[2] = {
+		{MPU6050_INT_STATUS, int_status, 1, IMU_TRANSFER_READ},
+		{MPU6050_FIFO_COUNTH, fifo_count_data, 2, IMU_TRANSFER_READ},
+	};
+
+	err = transfer(xfer, 2, MPU6050_READ_TIMEOUT);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	*count = (uint16_t)(((fifo_count_data[0] & 0x1F) << 8) | fifo_count_data[1]);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_set_dlpf(imu_func_write_bytes write_bytes, mpu6050_dlpf_cfg_t dlpf_cfg)
+{
+	uint8_t buffer = dlpf_cfg & 0x07;
+
+	return write_bytes(MPU6050_CONFIG, &buffer, 1, MPU6050_WRITE_TIMEOUT);
+}
+
+err_code_t mpu6050_set_smplrt_div(imu_func_write_bytes write_bytes, uint8_t smplrt_div)
+{
+	uint8_t buffer = smplrt_div;
+
+	return write_bytes(MPU6050_SMPLRT_DIV, &buffer, 1, MPU6050_WRITE_TIMEOUT);
+}
+
+err_code_t mpu6050_set_gyro_range(imu_func_write_bytes write_bytes, mpu6050_gfs_sel_t gfs_sel)
+{
+	uint8_t buffer = (gfs_sel << 3) & 0x18;
+
+	return write_bytes(MPU6050_GYRO_CONFIG, &buffer, 1, MPU6050_WRITE_TIMEOUT);
+}
+
+err_code_t mpu6050_set_accel_range(imu_func_write_bytes write_bytes, mpu6050_afs_sel_t afs_sel)
+{
+	uint8_t buffer = (afs_sel << 3) & 0x18;
+
+	return write_bytes(MPU6050_ACCEL_CONFIG, &buffer, 1, MPU6050_WRITE_TIMEOUT);
+}
@@ -8,6 +8,16 @@ extern "C" {
 #include "err_code.h"
 #include "imu.h"
 
+#define MPU6050_INT_STATUS_DATA_RDY     0x01        /*!< INT_STATUS data ready flag */
+#define MPU6050_INT_STATUS_FIFO_OFLOW   0x10        /*!< INT_STATUS FIFO overflow flag */
+
+#define MPU6050_SMPLRT_DIV_DEFAULT      0x04        /*!< Sample rate divider written by mpu6050_init */
+#define MPU6050_WHO_AM_I_DEFAULT        0x68        /*!< WHO_AM_I register value */
+
+#define MPU6050_FIFO_EN_TEMP            0x80        /*!< Write temperature to FIFO */
+#define MPU6050_FIFO_EN_GYRO            0x70        /*!< Write gyroscope x, y, z axis to FIFO */
+#define MPU6050_FIFO_EN_ACCEL           0x08        /*!< Write accelerometer x, y, z axis to FIFO */
+
 
 /**
  * @brief   Clock selection.
@@ -127,6 +137,175 @@ err_code_t mpu6050_get_gyro_raw(imu_func_read_bytes read_bytes,
                                 int16_t *raw_y,
                                 int16_t *raw_z);
 
+/*
+ * @brief   Get interrupt status. Reading INT_STATUS clears the data ready flag.
+ *
+ * @param   read_bytes Function read bytes.
+ * @param   int_status Interrupt status.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_get_int_status(imu_func_read_bytes read_bytes, uint8_t *int_status);
+
+/*
+ * @brief   Get accelerometer, temperature and gyroscope raw value in one burst read.
+ *
+ * @param   read_bytes Function read bytes.
+ * @param   accel_raw_x Accelerometer raw data x axis.
+ * @param   accel_raw_y Accelerometer raw data y axis.
+ * @param   accel_raw_z Accelerometer raw data z axis.
+ * @param   temp_raw Temperature raw data.
+ * @param   gyro_raw_x Gyroscope raw data x axis.
+ * @param   gyro_raw_y Gyroscope raw data y axis.
+ * @param   gyro_raw_z Gyroscope raw data z axis.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_get_motion_raw(imu_func_read_bytes read_bytes,
+                                  int16_t *accel_raw_x,
+                                  int16_t *accel_raw_y,
+                                  int16_t *accel_raw_z,
+                                  int16_t *temp_raw,
+                                  int16_t *gyro_raw_x,
+                                  int16_t *gyro_raw_y,
+                                  int16_t *gyro_raw_z);
+
+/*
+ * @brief   Reset FIFO and select which sensor data is written to it.
+ *
+ * @param   write_bytes Function write bytes.
+ * @param   fifo_en FIFO enable mask, combination of MPU6050_FIFO_EN_*. 0 disables the FIFO.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_config_fifo(imu_func_write_bytes write_bytes, uint8_t fifo_en);
+
+/*
+ * @brief   Get number of bytes stored in FIFO.
+ *
+ * @param   read_bytes Function read bytes.
+ * @param   count FIFO count in bytes.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_get_fifo_count(imu_func_read_bytes read_bytes, uint16_t *count);
+
+/*
+ * @brief   Read data from FIFO.
+ *
+ * @param   read_bytes Function read bytes.
+ * @param   buf Buffer.
+ * @param   len Number of bytes to read.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_read_fifo(imu_func_read_bytes read_bytes, uint8_t *buf, uint16_t len);
+
+/*
+ * @brief   Read part of the accelerometer, temperature and gyroscope output
+ *          registers in one transaction.
+ *
+ * @param   read_bytes Function read bytes.
+ * @param   offset First register to read, as offset from ACCEL_XOUT_H.
+ * @param   buf Buffer.
+ * @param   len Number of bytes to read, offset + len must not exceed 14.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_read_motion_block(imu_func_read_bytes read_bytes, uint8_t offset, uint8_t *buf, uint8_t len);
+
+/*
+ * @brief   Get interrupt status and accelerometer, temperature and gyroscope
+ *          output registers in one batched transfer.
+ *
+ * @note    The output registers are read even if no new data is ready, one
+ *          call costs less than a second round trip on batched transports.
+ *
+ * @param   transfer Function batched transfer.
+ * @param   int_status Interrupt status.
+ * @param   buf Buffer of 14 bytes, same layout as mpu6050_read_motion_block.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_get_status_motion_block(imu_func_transfer transfer, uint8_t *int_status, uint8_t *buf);
+
+/*
+ * @brief   Get interrupt status and FIFO count in one batched transfer.
+ *
+ * @param   transfer Function batched transfer.
+ * @param   int_status Interrupt status.
+ * @param   count FIFO count in bytes.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_get_status_fifo_count(imu_func_transfer transfer, uint8_t *int_status, uint16_t *count);
+
+
+/*
+ * @brief   Set digital low pass filter, CONFIG register.
+ *
+ * @param   write_bytes Function write bytes.
+ * @param   dlpf_cfg Low-pass filter.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_set_dlpf(imu_func_write_bytes write_bytes, mpu6050_dlpf_cfg_t dlpf_cfg);
+
+/*
+ * @brief   Set sample rate divider, SMPLRT_DIV register.
+ *
+ * @param   write_bytes Function write bytes.
+ * @param   smplrt_div Sample rate is the gyroscope output rate / (1 + smplrt_div).
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_set_smplrt_div(imu_func_write_bytes write_bytes, uint8_t smplrt_div);
+
+/*
+ * @brief   Set gyroscope full scale, GYRO_CONFIG register. Takes effect
+ *          from the next sample.
+ *
+ * @param   write_bytes Function write bytes.
+ * @param   gfs_sel Gyroscope full scale.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_set_gyro_range(imu_func_write_bytes write_bytes, mpu6050_gfs_sel_t gfs_sel);
+
+/*
+ * @brief   Set accelerometer full scale, ACCEL_CONFIG register. Takes effect
+ *          from the next sample.
+ *
+ * @param   write_bytes Function write bytes.
+ * @param   afs_sel Accelerometer full scale.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_set_accel_range(imu_func_write_bytes write_bytes, mpu6050_afs_sel_t afs_sel);
 
 #ifdef __cplusplus
 }
@@ -9,22 +9,76 @@
 #define MPU6500_READ_TIMEOUT 			100
 #define MPU6500_WRITE_TIMEOUT 			100
 
+#define MPU6500_SPI_READ_FLAG 			0x80 		/*!< Register address bit 7 selects read in SPI mode */
+#define MPU6500_USER_CTRL_I2C_IF_DIS 	0x10 		/*!< Disable I2C slave interface, SPI only */
+#define MPU6500_ACCEL_FCHOICE_B 		0x08 		/*!< ACCEL_CONFIG2 accelerometer DLPF bypass */
 
-err_code_t mpu6500_init(imu_func_read_bytes read_bytes,
+
+static void mpu6500_select_clock(mpu6500_dev_t *dev, uint32_t clock_hz)
+{
+	/* SPI runs at 1 MHz for register writes and up to 20 MHz for reading
+	 * sensor, interrupt and FIFO registers. Only switch when needed.
+	 */
+	if ((dev->set_bus_clock != NULL) && (dev->bus_clock_hz != clock_hz))
+	{
+		dev->set_bus_clock(clock_hz);
+		dev->bus_clock_hz = clock_hz;
+	}
+}
+
+static err_code_t mpu6500_read_reg(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes, uint8_t reg_addr, uint8_t *buf, uint16_t len)
+{
+	mpu6500_select_clock(dev, MPU6500_SPI_DATA_CLOCK_HZ);
+
+	return read_bytes(reg_addr | dev->read_flag, buf, len, MPU6500_READ_TIMEOUT);
+}
+
+static err_code_t mpu6500_write_reg(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	mpu6500_select_clock(dev, MPU6500_SPI_CONFIG_CLOCK_HZ);
+
+	return write_bytes(reg_addr, buf, len, timeout_ms);
+}
+
+
+
+err_code_t mpu6500_init(mpu6500_dev_t *dev,
+                        imu_func_read_bytes read_bytes,
                         imu_func_write_bytes write_bytes,
                         imu_func_delay delay,
                         mpu6500_clksel_t clksel,
                         mpu6500_dlpf_cfg_t dlpf_cfg,
                         mpu6500_sleep_mode_t sleep_mode,
                         mpu6500_afs_sel_t afs_sel,
-                        mpu6500_gfs_sel_t gfs_sel)
+                        mpu6500_gfs_sel_t gfs_sel,
+                        mpu6500_transport_t transport,
+                        imu_func_set_bus_clock set_bus_clock)
 {
+	if (dev == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
 	err_code_t err_ret = ERR_CODE_FAIL;
 
+	if (transport == MPU6500_TRANSPORT_SPI)
+	{
+		dev->read_flag = MPU6500_SPI_READ_FLAG;
+		dev->user_ctrl = MPU6500_USER_CTRL_I2C_IF_DIS;
+		dev->set_bus_clock = set_bus_clock;
+	}
+	else
+	{
+		dev->read_flag = 0;
+		dev->user_ctrl = 0;
+		dev->set_bus_clock = NULL;
+	}
+	dev->bus_clock_hz = 0;
+
 	/* Reset mpu6500 */
 	uint8_t buffer = 0;
 	buffer = 0x80;
-	err_ret = write_bytes(MPU6500_PWR_MGMT_1, &buffer, 1, MPU6500_INIT_TIMEOUT);
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_PWR_MGMT_1, &buffer, 1, MPU6500_INIT_TIMEOUT);
 	if (err_ret != ERR_CODE_SUCCESS)
 	{
 		return err_ret;
@@ -33,10 +87,23 @@ err_code_t mpu6500_init(imu_func_read_bytes read_bytes,
 	/* Delay 100ms here if necessary */
 	delay(100);
 
+	/* Reset enables the I2C interface again, disable it before it can
+	 * misinterpret SPI traffic.
+	 */
+	if (transport == MPU6500_TRANSPORT_SPI)
+	{
+		buffer = dev->user_ctrl;
+		err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_USER_CTRL, &buffer, 1, MPU6500_INIT_TIMEOUT);
+		if (err_ret != ERR_CODE_SUCCESS)
+		{
+			return err_ret;
+		}
+	}
+
 	/* Configure clock source and sleep mode */
 	buffer = clksel & 0x07;
 	buffer |= (sleep_mode << 6) & 0x40;
-	err_ret = write_bytes(MPU6500_PWR_MGMT_1, &buffer, 1, MPU6500_INIT_TIMEOUT);
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_PWR_MGMT_1, &buffer, 1, MPU6500_INIT_TIMEOUT);
 	if (err_ret != ERR_CODE_SUCCESS)
 	{
 		return err_ret;
@@ -48,7 +115,7 @@ err_code_t mpu6500_init(imu_func_read_bytes read_bytes,
 	/* Configure digital low pass filter */
 	buffer = 0;
 	buffer = dlpf_cfg & 0x07;
-	err_ret = write_bytes(MPU6500_CONFIG, &buffer, 1, MPU6500_INIT_TIMEOUT);
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_CONFIG, &buffer, 1, MPU6500_INIT_TIMEOUT);
 	if (err_ret != ERR_CODE_SUCCESS)
 	{
 		return err_ret;
@@ -57,7 +124,7 @@ err_code_t mpu6500_init(imu_func_read_bytes read_bytes,
 	/* Configure gyroscope range */
 	buffer = 0;
 	buffer = (gfs_sel << 3) & 0x18;
-	err_ret = write_bytes(MPU6500_GYRO_CONFIG, &buffer, 1, MPU6500_INIT_TIMEOUT);
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_GYRO_CONFIG, &buffer, 1, MPU6500_INIT_TIMEOUT);
 	if (err_ret != ERR_CODE_SUCCESS)
 	{
 		return err_ret;
@@ -66,7 +133,7 @@ err_code_t mpu6500_init(imu_func_read_bytes read_bytes,
 	/* Configure accelerometer range */
 	buffer = 0;
 	buffer = (afs_sel << 3) & 0x18;
-	err_ret = write_bytes(MPU6500_ACCEL_CONFIG, &buffer, 1, MPU6500_INIT_TIMEOUT);
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_ACCEL_CONFIG, &buffer, 1, MPU6500_INIT_TIMEOUT);
 	if (err_ret != ERR_CODE_SUCCESS)
 	{
 		return err_ret;
@@ -74,8 +141,8 @@ err_code_t mpu6500_init(imu_func_read_bytes read_bytes,
 
 	/* Configure sample rate divider */
 	buffer = 0;
-	buffer = 0x04;
-	err_ret = write_bytes(MPU6500_SMPLRT_DIV, &buffer, 1, MPU6500_INIT_TIMEOUT);
+	buffer = MPU6500_SMPLRT_DIV_DEFAULT;
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_SMPLRT_DIV, &buffer, 1, MPU6500_INIT_TIMEOUT);
 	if (err_ret != ERR_CODE_SUCCESS)
 	{
 		return err_ret;
@@ -84,17 +151,18 @@ err_code_t mpu6500_init(imu_func_read_bytes read_bytes,
 	/* Configure interrupt and enable bypass.
 	 * Set Interrupt pin active high, push-pull, Clear and read of INT_STATUS,
 	 * enable I2C_BYPASS_EN in INT_PIN_CFG register so additional chips can
-	 * join the I2C bus and can be controlled by master.
+	 * join the I2C bus and can be controlled by master. Bypass has no use in
+	 * SPI mode.
 	 */
-	buffer = 0x22;
-	err_ret = write_bytes(MPU6500_INT_PIN_CFG, &buffer, 1, MPU6500_INIT_TIMEOUT);
+	buffer = (transport == MPU6500_TRANSPORT_SPI) ? 0x20 : 0x22;
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_INT_PIN_CFG, &buffer, 1, MPU6500_INIT_TIMEOUT);
 	if (err_ret != ERR_CODE_SUCCESS)
 	{
 		return err_ret;
 	}
 
 	buffer = 0x01;
-	err_ret = write_bytes(MPU6500_INT_ENABLE, &buffer, 1, MPU6500_INIT_TIMEOUT);
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_INT_ENABLE, &buffer, 1, MPU6500_INIT_TIMEOUT);
 	if (err_ret != ERR_CODE_SUCCESS)
 	{
 		return err_ret;
@@ -103,7 +171,7 @@ err_code_t mpu6500_init(imu_func_read_bytes read_bytes,
 	return ERR_CODE_SUCCESS;
 }
 
-err_code_t mpu6500_get_accel_raw(imu_func_read_bytes read_bytes,
+err_code_t mpu6500_get_accel_raw(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes,
                                  int16_t *raw_x,
                                  int16_t *raw_y,
                                  int16_t *raw_z)
@@ -116,7 +184,7 @@ err_code_t mpu6500_get_accel_raw(imu_func_read_bytes read_bytes,
 	err_code_t err;
 	uint8_t accel_raw_data[6];
 
-	err = read_bytes(MPU6500_ACCEL_XOUT_H, accel_raw_data, 6, MPU6500_READ_TIMEOUT);
+	err = mpu6500_read_reg(dev, read_bytes, MPU6500_ACCEL_XOUT_H, accel_raw_data, 6);
 	if (err != ERR_CODE_SUCCESS) {
 		return err;
 	}
@@ -128,7 +196,7 @@ err_code_t mpu6500_get_accel_raw(imu_func_read_bytes read_bytes,
 	return ERR_CODE_SUCCESS;
 }
 
-err_code_t mpu6500_get_gyro_raw(imu_func_read_bytes read_bytes,
+err_code_t mpu6500_get_gyro_raw(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes,
                                 int16_t *raw_x,
                                 int16_t *raw_y,
                                 int16_t *raw_z)
@@ -141,7 +209,7 @@ err_code_t mpu6500_get_gyro_raw(imu_func_read_bytes read_bytes,
 	err_code_t err;
 	uint8_t gyro_raw_data[6];
 
-	err = read_bytes(MPU6500_GYRO_XOUT_H, gyro_raw_data, 6, MPU6500_READ_TIMEOUT);
+	err = mpu6500_read_reg(dev, read_bytes, MPU6500_GYRO_XOUT_H, gyro_raw_data, 6);
 	if (err != ERR_CODE_SUCCESS) {
 		return err;
 	}
@@ -152,3 +220,289 @@ err_code_t mpu6500_get_gyro_raw(imu_func_read_bytes read_bytes,
 
 	return ERR_CODE_SUCCESS;
 }
+
+err_code_t mpu6500_get_int_status(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes, uint8_t *int_status)
+{
+	if (int_status == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+
+	err = mpu6500_read_reg(dev, read_bytes, MPU6500_INT_STATUS, int_status, 1);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6500_get_motion_raw(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes,
+                                  int16_t *accel_raw_x,
+                                  int16_t *accel_raw_y,
+                                  int16_t *accel_raw_z,
+                                  int16_t *temp_raw,
+                                  int16_t *gyro_raw_x,
+                                  int16_t *gyro_raw_y,
+                                  int16_t *gyro_raw_z)
+{
+	if ((accel_raw_x == NULL) || (accel_raw_y == NULL) || (accel_raw_z == NULL) || (temp_raw == NULL) ||
+	    (gyro_raw_x == NULL) || (gyro_raw_y == NULL) || (gyro_raw_z == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+	uint8_t motion_raw_data[14];
+
+	/* ACCEL_XOUT_H..GYRO_ZOUT_L are contiguous, one transaction covers all of them */
+	err = mpu6500_read_reg(dev, read_bytes, MPU6500_ACCEL_XOUT_H, motion_raw_data, 14);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	*accel_raw_x = (int16_t)((motion_raw_data[0] << 8) + motion_raw_data[1]);
+	*accel_raw_y = (int16_t)((motion_raw_data[2] << 8) + motion_raw_data[3]);
+	*accel_raw_z = (int16_t)((motion_raw_data[4] << 8) + motion_raw_data[5]);
+	*temp_raw = (int16_t)((motion_raw_data[6] << 8) + motion_raw_data[7]);
+	*gyro_raw_x = (int16_t)((motion_raw_data[8] << 8) + motion_raw_data[9]);
+	*gyro_raw_y = (int16_t)((motion_raw_data[10] << 8) + motion_raw_data[11]);
+	*gyro_raw_z = (int16_t)((motion_raw_data[12] << 8) + motion_raw_data[13]);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6500_config_fifo(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, uint8_t fifo_en)
+{
+	err_code_t err_ret;
+	uint8_t buffer;
+
+	/* Stop FIFO and clear its content */
+	buffer = dev->user_ctrl | 0x04;
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_USER_CTRL, &buffer, 1, MPU6500_WRITE_TIMEOUT);
+	if (err_ret != ERR_CODE_SUCCESS)
+	{
+		return err_ret;
+	}
+
+	buffer = fifo_en;
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_FIFO_EN, &buffer, 1, MPU6500_WRITE_TIMEOUT);
+	if (err_ret != ERR_CODE_SUCCESS)
+	{
+		return err_ret;
+	}
+
+	if (fifo_en == 0)
+	{
+		return ERR_CODE_SUCCESS;
+	}
+
+	/* Enable FIFO operation */
+	buffer = dev->user_ctrl | 0x40;
+	err_ret = mpu6500_write_reg(dev, write_bytes, MPU6500_USER_CTRL, &buffer, 1, MPU6500_WRITE_TIMEOUT);
+	if (err_ret != ERR_CODE_SUCCESS)
+	{
+		return err_ret;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6500_get_fifo_count(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes, uint16_t *count)
+{
+	if (count == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+	uint8_t fifo_count_data[2];
+
+	err = mpu6500_read_reg(dev, read_bytes, MPU6500_FIFO_COUNTH, fifo_count_data, 2);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	*count = (uint16_t)(((fifo_count_data[0] & 0x1F) << 8) | fifo_count_data[1]);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6500_read_fifo(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes, uint8_t *buf, uint16_t len)
+{
+	if (buf == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+
+	err = mpu6500_read_reg(dev, read_bytes, MPU6500_FIFP_R_W, buf, len);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6500_read_motion_block(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes, uint8_t offset, uint8_t *buf, uint8_t len)
+{
+	if (buf == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((len == 0) || ((offset + len) > 14))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	err_code_t err;
+
+	err = mpu6500_read_reg(dev, read_bytes, MPU6500_ACCEL_XOUT_H + offset, buf, len);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6500_get_status_motion_block(mpu6500_dev_t *dev, imu_func_transfer transfer, uint8_t *int_status, uint8_t *buf)
+{
+	if ((transfer == NULL) || (int_status == NULL) || (buf == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+	imu_transfer_t xfer[2] = {
+		{MPU6500_INT_STATUS | dev->read_flag, int_status, 1, IMU_TRANSFER_READ},
+		{MPU6500_ACCEL_XOUT_H | dev->read_flag, buf, 14, IMU_TRANSFER_READ},
+	};
+
+	mpu6500_select_clock(dev, MPU6500_SPI_DATA_CLOCK_HZ);
+
+	err = transfer(xfer, 2, MPU6500_READ_TIMEOUT);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6500_get_status_fifo_count(mpu6500_dev_t *dev, imu_func_transfer transfer, uint8_t *int_status, uint16_t *count)
+{
+	if ((transfer == NULL) || (int_status == NULL) || (count == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+	uint8_t fifo_count_data[2];
+	imu_transfer_t xfer[2] = {
+		{MPU6500_INT_STATUS | dev->read_flag, int_status, 1, IMU_TRANSFER_READ},
+		{MPU6500_FIFO_COUNTH | dev->read_flag, fifo_count_data, 2, IMU_TRANSFER_READ},
+	};
+
+	mpu6500_select_clock(dev, MPU6500_SPI_DATA_CLOCK_HZ);
+
+	err = transfer(xfer, 2, MPU6500_READ_TIMEOUT);
+	if (err != ERR_CODE_SUCCESS) {
+		return err;
+	}
+
+	*count = (uint16_t)(((fifo_count_data[0] & 0x1F) << 8) | fifo_count_data[1]);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6500_enter_wake_on_motion(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes,
+                                        mpu6500_clksel_t clksel,
+                                        mpu6500_lp_accel_odr_t lp_odr,
+                                        uint8_t threshold)
+{
+	/* Register sequence of the wake-on-motion setup, the accelerometer must
+	 * be running before cycle mode is set last.
+	 */
+	const uint8_t sequence[][2] = {
+		{MPU6500_PWR_MGMT_1, clksel & 0x07}, 			/* Awake, cycle off */
+		{MPU6500_PWR_MGMT_2, 0x07}, 					/* Gyroscope x, y, z axis standby */
+		{MPU6500_ACCEL_CONFIG2, 0x09}, 					/* Accelerometer 184 Hz bandwidth, 1 kHz rate */
+		{MPU6500_INT_ENABLE, MPU6500_INT_STATUS_WOM}, 	/* Wake-on-motion interrupt only */
+		{MPU6500_MOT_DETECT_CTRL, 0xC0}, 				/* Compare with previous sample */
+		{MPU6500_WOM_THR, threshold},
+		{MPU6500_LP_ACCEL_ODR, lp_odr & 0x0F},
+		{MPU6500_PWR_MGMT_1, (clksel & 0x07) | 0x20}, 	/* Cycle mode */
+	};
+
+	for (uint8_t i = 0; i < sizeof(sequence) / sizeof(sequence[0]); i++)
+	{
+		uint8_t buffer = sequence[i][1];
+		err_code_t err_ret = mpu6500_write_reg(dev, write_bytes, sequence[i][0], &buffer, 1, MPU6500_WRITE_TIMEOUT);
+		if (err_ret != ERR_CODE_SUCCESS)
+		{
+			return err_ret;
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6500_exit_wake_on_motion(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, mpu6500_clksel_t clksel, uint8_t accel_config2)
+{
+	const uint8_t sequence[][2] = {
+		{MPU6500_PWR_MGMT_1, clksel & 0x07}, 			/* Cycle off */
+		{MPU6500_PWR_MGMT_2, 0x00}, 					/* All axes on */
+		{MPU6500_ACCEL_CONFIG2, accel_config2},
+		{MPU6500_MOT_DETECT_CTRL, 0x00},
+		{MPU6500_INT_ENABLE, MPU6500_INT_STATUS_DATA_RDY},
+	};
+
+	for (uint8_t i = 0; i < sizeof(sequence) / sizeof(sequence[0]); i++)
+	{
+		uint8_t buffer = sequence[i][1];
+		err_code_t err_ret = mpu6500_write_reg(dev, write_bytes, sequence[i][0], &buffer, 1, MPU6500_WRITE_TIMEOUT);
+		if (err_ret != ERR_CODE_SUCCESS)
+		{
+			return err_ret;
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6500_set_dlpf(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, mpu6500_dlpf_cfg_t dlpf_cfg)
+{
+	uint8_t buffer = dlpf_cfg & 0x07;
+
+	return mpu6500_write_reg(dev, write_bytes, MPU6500_CONFIG, &buffer, 1, MPU6500_WRITE_TIMEOUT);
+}
+
+err_code_t mpu6500_set_smplrt_div(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, uint8_t smplrt_div)
+{
+	uint8_t buffer = smplrt_div;
+
+	return mpu6500_write_reg(dev, write_bytes, MPU6500_SMPLRT_DIV, &buffer, 1, MPU6500_WRITE_TIMEOUT);
+}
+
+err_code_t mpu6500_set_gyro_range(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, mpu6500_gfs_sel_t gfs_sel, mpu6500_gyro_fchoice_t fchoice)
+{
+	uint8_t buffer = ((gfs_sel << 3) & 0x18) | (fchoice & 0x03);
+
+	return mpu6500_write_reg(dev, write_bytes, MPU6500_GYRO_CONFIG, &buffer, 1, MPU6500_WRITE_TIMEOUT);
+}
+
+err_code_t mpu6500_set_accel_dlpf(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, mpu6500_accel_dlpf_t accel_dlpf)
+{
+	uint8_t buffer = (accel_dlpf == MPU6500_ACCEL_DLPF_1130_HZ) ? MPU6500_ACCEL_FCHOICE_B : (accel_dlpf & 0x07);
+
+	return mpu6500_write_reg(dev, write_bytes, MPU6500_ACCEL_CONFIG2, &buffer, 1, MPU6500_WRITE_TIMEOUT);
+}
+
+err_code_t mpu6500_set_accel_range(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, mpu6500_afs_sel_t afs_sel)
+{
+	uint8_t buffer = (afs_sel << 3) & 0x18;
+
+	return mpu6500_write_reg(dev, write_bytes, MPU6500_ACCEL_CONFIG, &buffer, 1, MPU6500_WRITE_TIMEOUT);
+}
@@ -8,6 +8,26 @@ extern "C" {
 #include "err_code.h"
 #include "imu.h"
 
+#define MPU6500_INT_STATUS_DATA_RDY     0x01        /*!< INT_STATUS data ready flag */
+#define MPU6500_INT_STATUS_FIFO_OFLOW   0x10        /*!< INT_STATUS FIFO overflow flag */
+#define MPU6500_INT_STATUS_WOM          0x40        /*!< INT_STATUS wake-on-motion flag */
+
+#define MPU6500_SMPLRT_DIV_DEFAULT      0x04        /*!< Sample rate divider written by mpu6500_init */
+#define MPU6500_WHO_AM_I_DEFAULT        0x70        /*!< WHO_AM_I register value */
+
+#define MPU6500_FIFO_EN_TEMP            0x80        /*!< Write temperature to FIFO */
+#define MPU6500_FIFO_EN_GYRO            0x70        /*!< Write gyroscope x, y, z axis to FIFO */
+#define MPU6500_FIFO_EN_ACCEL           0x08        /*!< Write accelerometer x, y, z axis to FIFO */
+
+#define MPU6500_SPI_CONFIG_CLOCK_HZ     1000000     /*!< SPI clock for register writes */
+#define MPU6500_SPI_DATA_CLOCK_HZ       20000000    /*!< SPI clock for sensor, interrupt and FIFO reads */
+
+#define MPU6500_WOM_THR_MG_PER_LSB      4           /*!< Wake-on-motion threshold resolution */
+#define MPU6500_GYRO_STARTUP_MS         35          /*!< Gyroscope start-up time from standby */
+
+#define MPU6500_GYRO_FCHOICE_RATE_HZ    32000       /*!< Sample rate with the gyroscope DLPF bypassed */
+#define MPU6500_GYRO_DLPF_OFF_RATE_HZ   8000        /*!< Sample rate with dlpf_cfg 0 or 7, SMPLRT_DIV has no effect */
+
 
 /**
  * @brief   Clock source select.
@@ -32,6 +52,31 @@ typedef enum {
     MPU6500_DLPF_CFG_MAX
 } mpu6500_dlpf_cfg_t;
 
+/**
+ * @brief   Gyroscope DLPF bypass, FCHOICE_B bits of GYRO_CONFIG.
+ */
+typedef enum {
+    MPU6500_GYRO_FCHOICE_DLPF = 0,          /*!< Gyroscope filtered by dlpf_cfg */
+    MPU6500_GYRO_FCHOICE_8800_HZ,           /*!< DLPF bypassed, 8800 Hz bandwidth, 32 kHz rate */
+    MPU6500_GYRO_FCHOICE_3600_HZ,           /*!< DLPF bypassed, 3600 Hz bandwidth, 32 kHz rate */
+    MPU6500_GYRO_FCHOICE_MAX
+} mpu6500_gyro_fchoice_t;
+
+/**
+ * @brief   Accelerometer bandwidth select, ACCEL_CONFIG2 register.
+ */
+typedef enum {
+    MPU6500_ACCEL_DLPF_460_HZ = 0,          /*!< 460 Hz bandwidth, 1 kHz rate */
+    MPU6500_ACCEL_DLPF_184_HZ,              /*!< 184 Hz bandwidth, 1 kHz rate */
+    MPU6500_ACCEL_DLPF_92_HZ,               /*!< 92 Hz bandwidth, 1 kHz rate */
+    MPU6500_ACCEL_DLPF_41_HZ,               /*!< 41 Hz bandwidth, 1 kHz rate */
+    MPU6500_ACCEL_DLPF_20_HZ,               /*!< 20 Hz bandwidth, 1 kHz rate */
+    MPU6500_ACCEL_DLPF_10_HZ,               /*!< 10 Hz bandwidth, 1 kHz rate */
+    MPU6500_ACCEL_DLPF_5_HZ,                /*!< 5 Hz bandwidth, 1 kHz rate */
+    MPU6500_ACCEL_DLPF_1130_HZ,             /*!< DLPF bypassed, 1130 Hz bandwidth, 4 kHz rate */
+    MPU6500_ACCEL_DLPF_MAX
+} mpu6500_accel_dlpf_t;
+
 /**
  * @brief   Sleep mode.
  */
@@ -41,6 +86,25 @@ typedef enum {
     MPU6500_SLEEP_MODE_MAX
 } mpu6500_sleep_mode_t;
 
+/**
+ * @brief   Low power accelerometer output data rate.
+ */
+typedef enum {
+    MPU6500_LP_ACCEL_ODR_0_24_HZ = 0,       /*!< 0.24 Hz */
+    MPU6500_LP_ACCEL_ODR_0_49_HZ,           /*!< 0.49 Hz */
+    MPU6500_LP_ACCEL_ODR_0_98_HZ,           /*!< 0.98 Hz */
+    MPU6500_LP_ACCEL_ODR_1_95_HZ,           /*!< 1.95 Hz */
+    MPU6500_LP_ACCEL_ODR_3_91_HZ,           /*!< 3.91 Hz */
+    MPU6500_LP_ACCEL_ODR_7_81_HZ,           /*!< 7.81 Hz */
+    MPU6500_LP_ACCEL_ODR_15_63_HZ,          /*!< 15.63 Hz */
+    MPU6500_LP_ACCEL_ODR_31_25_HZ,          /*!< 31.25 Hz */
+    MPU6500_LP_ACCEL_ODR_62_5_HZ,           /*!< 62.5 Hz */
+    MPU6500_LP_ACCEL_ODR_125_HZ,            /*!< 125 Hz */
+    MPU6500_LP_ACCEL_ODR_250_HZ,            /*!< 250 Hz */
+    MPU6500_LP_ACCEL_ODR_500_HZ,            /*!< 500 Hz */
+    MPU6500_LP_ACCEL_ODR_MAX
+} mpu6500_lp_accel_odr_t;
+
 /**
  * @brief   FS scale.
  */
@@ -63,9 +127,36 @@ typedef enum {
     MPU6500_AFS_SEL_MAX
 } mpu6500_afs_sel_t;
 
+/**
+ * @brief   Transport.
+ */
+typedef enum {
+    MPU6500_TRANSPORT_I2C = 0,              /*!< I2C */
+    MPU6500_TRANSPORT_SPI,                  /*!< SPI, read_bytes receives the register address with bit 7 set */
+    MPU6500_TRANSPORT_MAX
+} mpu6500_transport_t;
+
+/**
+ * @brief   Transport state of one device. Owned by the caller, filled in by
+ *          mpu6500_init and passed to every other function.
+ */
+typedef struct {
+    uint8_t                     read_flag;                  /*!< Added to register address of reads */
+    uint8_t                     user_ctrl;                  /*!< USER_CTRL bits kept by every USER_CTRL write */
+    imu_func_set_bus_clock      set_bus_clock;              /*!< SPI clock select, NULL in I2C mode */
+    uint32_t                    bus_clock_hz;               /*!< Current SPI clock, 0 until first selected */
+} mpu6500_dev_t;
+
 /*
  * @brief   Send control commands to target with configuration parameters.
  *
+ * @note    Transport and SPI clock select are kept in dev, so devices on
+ *          different buses do not share them. In SPI mode the I2C interface
+ *          is disabled and set_bus_clock is called with
+ *          MPU6500_SPI_CONFIG_CLOCK_HZ before register writes and with
+ *          MPU6500_SPI_DATA_CLOCK_HZ before sensor, interrupt and FIFO reads.
+ *
+ * @param   dev Device state, filled in here and passed to every other function.
  * @param   read_bytes Function read bytes.
  * @param   write_bytes Function write bytes.
  * @param   delay Function delay.
@@ -74,23 +165,29 @@ typedef enum {
  * @param   sleep_mode Sleep mode.
  * @param   afs_sel Accelerometer full scale.
  * @param   gfs_sel Gyroscope full scale.
+ * @param   transport Transport.
+ * @param   set_bus_clock Function set SPI clock, may be NULL in SPI mode if the clock is fixed.
  *
  * @return
  *      - ERR_CODE_SUCCESS: Success.
  *      - Others:           Fail.
  */
-err_code_t mpu6500_init(imu_func_read_bytes read_bytes,
+err_code_t mpu6500_init(mpu6500_dev_t *dev,
+                        imu_func_read_bytes read_bytes,
                         imu_func_write_bytes write_bytes,
                         imu_func_delay delay,
                         mpu6500_clksel_t clksel,
                         mpu6500_dlpf_cfg_t dlpf_cfg,
                         mpu6500_sleep_mode_t sleep_mode,
                         mpu6500_afs_sel_t afs_sel,
-                        mpu6500_gfs_sel_t gfs_sel);
+                        mpu6500_gfs_sel_t gfs_sel,
+                        mpu6500_transport_t transport,
+                        imu_func_set_bus_clock set_bus_clock);
 
 /*
  * @brief   Get accelerometer raw value.
  *
+ * @param   dev Device state, from mpu6500_init.
  * @param   read_bytes Function read bytes.
  * @param   raw_x Raw data x axis.
  * @param   raw_y Raw data y axis.
@@ -100,7 +197,7 @@ err_code_t mpu6500_init(imu_func_read_bytes read_bytes,
  *      - ERR_CODE_SUCCESS: Success.
  *      - Others:           Fail.
  */
-err_code_t mpu6500_get_accel_raw(imu_func_read_bytes read_bytes,
+err_code_t mpu6500_get_accel_raw(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes,
                                  int16_t *raw_x,
                                  int16_t *raw_y,
                                  int16_t *raw_z);
@@ -108,6 +205,7 @@ err_code_t mpu6500_get_accel_raw(imu_func_read_bytes read_bytes,
 /*
  * @brief   Get gyroscope raw value.
  *
+ * @param   dev Device state, from mpu6500_init.
  * @param   read_bytes Function read bytes.
  * @param   raw_x Raw data x axis.
  * @param   raw_y Raw data y axis.
@@ -117,11 +215,250 @@ err_code_t mpu6500_get_accel_raw(imu_func_read_bytes read_bytes,
  *      - ERR_CODE_SUCCESS: Success.
  *      - Others:           Fail.
  */
-err_code_t mpu6500_get_gyro_raw(imu_func_read_bytes read_bytes,
+err_code_t mpu6500_get_gyro_raw(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes,
                                 int16_t *raw_x,
                                 int16_t *raw_y,
                                 int16_t *raw_z);
 
+/*
+ * @brief   Get interrupt status. Reading INT_STATUS clears the data ready flag.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   read_bytes Function read bytes.
+ * @param   int_status Interrupt status.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_get_int_status(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes, uint8_t *int_status);
+
+/*
+ * @brief   Get accelerometer, temperature and gyroscope raw value in one burst read.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   read_bytes Function read bytes.
+ * @param   accel_raw_x Accelerometer raw data x axis.
+ * @param   accel_raw_y Accelerometer raw data y axis.
+ * @param   accel_raw_z Accelerometer raw data z axis.
+ * @param   temp_raw Temperature raw data.
+ * @param   gyro_raw_x Gyroscope raw data x axis.
+ * @param   gyro_raw_y Gyroscope raw data y axis.
+ * @param   gyro_raw_z Gyroscope raw data z axis.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_get_motion_raw(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes,
+                                  int16_t *accel_raw_x,
+                                  int16_t *accel_raw_y,
+                                  int16_t *accel_raw_z,
+                                  int16_t *temp_raw,
+                                  int16_t *gyro_raw_x,
+                                  int16_t *gyro_raw_y,
+                                  int16_t *gyro_raw_z);
+
+/*
+ * @brief   Reset FIFO and select which sensor data is written to it.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   write_bytes Function write bytes.
+ * @param   fifo_en FIFO enable mask, combination of MPU6500_FIFO_EN_*. 0 disables the FIFO.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_config_fifo(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, uint8_t fifo_en);
+
+/*
+ * @brief   Get number of bytes stored in FIFO.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   read_bytes Function read bytes.
+ * @param   count FIFO count in bytes.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_get_fifo_count(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes, uint16_t *count);
+
+/*
+ * @brief   Read data from FIFO.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   read_bytes Function read bytes.
+ * @param   buf Buffer.
+ * @param   len Number of bytes to read.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_read_fifo(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes, uint8_t *buf, uint16_t len);
+
+/*
+ * @brief   Read part of the accelerometer, temperature and gyroscope output
+ *          registers in one transaction.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   read_bytes Function read bytes.
+ * @param   offset First register to read, as offset from ACCEL_XOUT_H.
+ * @param   buf Buffer.
+ * @param   len Number of bytes to read, offset + len must not exceed 14.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_read_motion_block(mpu6500_dev_t *dev, imu_func_read_bytes read_bytes, uint8_t offset, uint8_t *buf, uint8_t len);
+
+/*
+ * @brief   Get interrupt status and accelerometer, temperature and gyroscope
+ *          output registers in one batched transfer.
+ *
+ * @note    The output registers are read even if no new data is ready, one
+ *          call costs less than a second round trip on batched transports.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   transfer Function batched transfer.
+ * @param   int_status Interrupt status.
+ * @param   buf Buffer of 14 bytes, same layout as mpu6500_read_motion_block.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_get_status_motion_block(mpu6500_dev_t *dev, imu_func_transfer transfer, uint8_t *int_status, uint8_t *buf);
+
+/*
+ * @brief   Get interrupt status and FIFO count in one batched transfer.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   transfer Function batched transfer.
+ * @param   int_status Interrupt status.
+ * @param   count FIFO count in bytes.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_get_status_fifo_count(mpu6500_dev_t *dev, imu_func_transfer transfer, uint8_t *int_status, uint16_t *count);
+
+/*
+ * @brief   Enter accelerometer cycle mode with wake-on-motion interrupt.
+ *          Gyroscope axes go to standby, the accelerometer wakes at lp_odr
+ *          and raises MPU6500_INT_STATUS_WOM when an axis changes by more
+ *          than the threshold from the previous sample. Data ready interrupt
+ *          is disabled.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   write_bytes Function write bytes.
+ * @param   clksel Clock source.
+ * @param   lp_odr Accelerometer wake-up rate.
+ * @param   threshold Threshold in MPU6500_WOM_THR_MG_PER_LSB steps.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_enter_wake_on_motion(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes,
+                                        mpu6500_clksel_t clksel,
+                                        mpu6500_lp_accel_odr_t lp_odr,
+                                        uint8_t threshold);
+
+/*
+ * @brief   Leave accelerometer cycle mode. Gyroscope axes are enabled again
+ *          and give valid data after MPU6500_GYRO_STARTUP_MS, data ready
+ *          interrupt and the accelerometer bandwidth are restored.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   write_bytes Function write bytes.
+ * @param   clksel Clock source.
+ * @param   accel_config2 ACCEL_CONFIG2 to restore, as written by mpu6500_set_accel_dlpf, 0 after mpu6500_init.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_exit_wake_on_motion(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, mpu6500_clksel_t clksel, uint8_t accel_config2);
+
+
+/*
+ * @brief   Set digital low pass filter, CONFIG register.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   write_bytes Function write bytes.
+ * @param   dlpf_cfg Low-pass filter.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_set_dlpf(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, mpu6500_dlpf_cfg_t dlpf_cfg);
+
+/*
+ * @brief   Set sample rate divider, SMPLRT_DIV register.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   write_bytes Function write bytes.
+ * @param   smplrt_div Sample rate is the gyroscope output rate / (1 + smplrt_div).
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_set_smplrt_div(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, uint8_t smplrt_div);
+
+/*
+ * @brief   Set gyroscope full scale and DLPF bypass, GYRO_CONFIG register.
+ *          Takes effect from the next sample.
+ *
+ * @note    With the DLPF bypassed the sample rate is
+ *          MPU6500_GYRO_FCHOICE_RATE_HZ whatever dlpf_cfg and SMPLRT_DIV
+ *          are. Accelerometer samples repeat in between its own updates.
+ *          Pass the current bypass to change only the full scale.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   write_bytes Function write bytes.
+ * @param   gfs_sel Gyroscope full scale.
+ * @param   fchoice DLPF bypass, FCHOICE_B bits.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_set_gyro_range(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, mpu6500_gfs_sel_t gfs_sel, mpu6500_gyro_fchoice_t fchoice);
+
+/*
+ * @brief   Set accelerometer bandwidth, ACCEL_CONFIG2 register, apart from
+ *          the gyroscope dlpf_cfg.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   write_bytes Function write bytes.
+ * @param   accel_dlpf Accelerometer bandwidth.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_set_accel_dlpf(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, mpu6500_accel_dlpf_t accel_dlpf);
+
+/*
+ * @brief   Set accelerometer full scale, ACCEL_CONFIG register. Takes effect
+ *          from the next sample.
+ *
+ * @param   dev Device state, from mpu6500_init.
+ * @param   write_bytes Function write bytes.
+ * @param   afs_sel Accelerometer full scale.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6500_set_accel_range(mpu6500_dev_t *dev, imu_func_write_bytes write_bytes, mpu6500_afs_sel_t afs_sel);
 
 #ifdef __cplusplus
 }
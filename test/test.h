@@ -0,0 +1,97 @@
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include "stdio.h"
+#include "string.h"
+
+#include "imu.h"
+#include "imu_bus/imu_bus.h"
+#include "imu_sim/imu_sim.h"
+
+/* Host tests against the device simulator. Every test file is one program,
+ * a failed check prints its location and the program exits non-zero.
+ */
+
+static int test_failures;
+
+#define TEST_ASSERT(cond) 																				\
+	do { 																								\
+		if (!(cond)) { 																					\
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); 							\
+			test_failures++; 																			\
+		} 																								\
+	} while (0)
+
+#define TEST_RUN(func) 																					\
+	do { 																								\
+		int failures = test_failures; 																	\
+		func(); 																						\
+		printf("%s %s\n", (test_failures == failures) ? "pass" : "FAIL", #func); 						\
+	} while (0)
+
+#define TEST_RESULT() 		((test_failures == 0) ? 0 : 1)
+
+/* Quiet device lying flat: 1 g on z, small noise, room temperature */
+static inline imu_sim_signal_t test_signal_still(void)
+{
+	imu_sim_signal_t signal;
+
+	memset(&signal, 0, sizeof(signal));
+	signal.accel_offset_g[2] = 1.0f;
+	signal.accel_noise_g = 0.002f;
+	signal.gyro_noise_dps = 0.05f;
+	signal.temp_c = 25.0f;
+
+	return signal;
+}
+
+/* Simulated chip on a bus slot and a configured IMU on top of it */
+static inline imu_handle_t test_setup(uint8_t slot, imu_sim_chip_t chip, imu_sim_signal_t signal, imu_sim_handle_t *sim)
+{
+	imu_sim_cfg_t sim_cfg;
+	imu_bus_func_t func;
+
+	*sim = imu_sim_init();
+	if (*sim == NULL)
+	{
+		return NULL;
+	}
+
+	memset(&sim_cfg, 0, sizeof(sim_cfg));
+	sim_cfg.chip = chip;
+	sim_cfg.seed = 1 + slot;
+	sim_cfg.signal = signal;
+
+	if ((imu_sim_set_config(*sim, sim_cfg) != ERR_CODE_SUCCESS) || (imu_sim_config(*sim) != ERR_CODE_SUCCESS) ||
+	        (imu_bus_bind(slot, imu_sim_get_ops(), *sim, &func) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	imu_handle_t handle = imu_init();
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	imu_cfg_t cfg;
+	memset(&cfg, 0, sizeof(cfg));
+	if (chip == IMU_SIM_CHIP_MPU6500) {
+		cfg.mpu6500_read_bytes = func.read_bytes;
+		cfg.mpu6500_write_bytes = func.write_bytes;
+	} else {
+		cfg.mpu6050_read_bytes = func.read_bytes;
+		cfg.mpu6050_write_bytes = func.write_bytes;
+	}
+	cfg.func_delay = imu_sim_delay;
+	cfg.func_get_time_us = imu_sim_get_time_us;
+
+	if ((imu_set_config(handle, cfg) != ERR_CODE_SUCCESS) || (imu_config(handle) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+#endif /* __TEST_H__ */
@@ -0,0 +1,162 @@
+#include "stdlib.h"
+#include "math.h"
+
+#include "test.h"
+#include "imu_allan/imu_allan.h"
+
+#define TEST_RATE_HZ 				100.0f
+#define TEST_NUM_SAMPLES 			(1u << 17) 		/*!< 22 minutes */
+#define TEST_CHUNK 					1024
+#define TEST_GYRO_NOISE_DPS 		0.1f
+#define TEST_ACCEL_NOISE_G 			0.002f
+#define TEST_GYRO_STEP_DPS 			1e-4f 			/*!< Bias random walk step per sample */
+#define TEST_PI 					3.14159265f
+#define TEST_DEG_TO_RAD 			(TEST_PI / 180.0f)
+#define TEST_G 						9.80665f
+
+static imu_allan_handle_t allan;
+static imu_sample_scale_t chunk[TEST_CHUNK];
+static uint64_t rng = 88172645463325252ull;
+
+/* Standard normal, xorshift and Box-Muller, the same sequence every run */
+static float test_gauss(void)
+{
+	float u[2];
+
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		rng ^= rng << 13;
+		rng ^= rng >> 7;
+		rng ^= rng << 17;
+		u[i] = ((rng >> 40) + 1.0f) / 16777217.0f;
+	}
+
+	return sqrtf(-2.0f * logf(u[0])) * cosf(2 * TEST_PI * u[1]);
+}
+
+static void test_allan_start(void)
+{
+	imu_allan_cfg_t cfg = {
+		.sample_rate_hz = TEST_RATE_HZ,
+	};
+
+	if (allan == NULL)
+	{
+		allan = imu_allan_init();
+	}
+	TEST_ASSERT(allan != NULL);
+	TEST_ASSERT(imu_allan_set_config(allan, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_allan_config(allan) == ERR_CODE_SUCCESS);
+}
+
+/* White noise on gyroscope x and accelerometer z, a random walk bias on
+ * gyroscope y, constant offsets everywhere
+ */
+static void test_feed(uint32_t skip_seq)
+{
+	float walk = 0;
+
+	for (uint32_t n = 0; n < TEST_NUM_SAMPLES; n += TEST_CHUNK)
+	{
+		memset(chunk, 0, sizeof(chunk));
+		for (uint16_t i = 0; i < TEST_CHUNK; i++)
+		{
+			walk += TEST_GYRO_STEP_DPS * test_gauss();
+			chunk[i].seq = n + i + ((n + i >= skip_seq) ? 1 : 0);
+			chunk[i].accel_z = 1.0f + TEST_ACCEL_NOISE_G * test_gauss();
+			chunk[i].gyro_x = 0.5f + TEST_GYRO_NOISE_DPS * test_gauss();
+			chunk[i].gyro_y = -0.3f + walk;
+		}
+		TEST_ASSERT(imu_allan_write_scale(allan, chunk, TEST_CHUNK) == ERR_CODE_SUCCESS);
+	}
+}
+
+static void test_allan_white(void)
+{
+	imu_allan_point_t points[IMU_ALLAN_MAX_LEVELS];
+	imu_allan_result_t result;
+	imu_allan_status_t status;
+	uint8_t num;
+
+	test_allan_start();
+	test_feed(TEST_NUM_SAMPLES);
+
+	TEST_ASSERT(imu_allan_get_status(allan, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.samples == TEST_NUM_SAMPLES);
+	TEST_ASSERT(status.gaps == 0);
+	/* Clusters of up to half the record have a difference */
+	TEST_ASSERT(status.levels == 17);
+
+	/* Slope -1/2 wherever the estimate is certain */
+	TEST_ASSERT(imu_allan_get_curve(allan, IMU_ALLAN_GYRO_X, points, IMU_ALLAN_MAX_LEVELS, &num) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(num == 17);
+	TEST_ASSERT(fabsf(points[0].tau_s - 1.0f / TEST_RATE_HZ) < 1e-6f);
+	for (uint8_t k = 0; (k + 1 < num) && (points[k + 1].diffs >= 256); k++)
+	{
+		float slope = log2f(points[k + 1].adev / points[k].adev);
+		TEST_ASSERT(fabsf(slope + 0.5f) < 0.1f);
+	}
+
+	/* Density is the deviation of one sample over the square root of the rate */
+	float gyro_density = TEST_GYRO_NOISE_DPS * TEST_DEG_TO_RAD / sqrtf(TEST_RATE_HZ);
+	float accel_density = TEST_ACCEL_NOISE_G * TEST_G / sqrtf(TEST_RATE_HZ);
+	TEST_ASSERT(fabsf(points[0].adev - TEST_GYRO_NOISE_DPS * TEST_DEG_TO_RAD) < 0.02f * TEST_GYRO_NOISE_DPS * TEST_DEG_TO_RAD);
+
+	TEST_ASSERT(imu_allan_get_result(allan, &result) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(result.samples == TEST_NUM_SAMPLES);
+	TEST_ASSERT(fabsf(result.axis[IMU_ALLAN_GYRO_X].random_walk - gyro_density) < 0.05f * gyro_density);
+	TEST_ASSERT(fabsf(result.axis[IMU_ALLAN_ACCEL_Z].random_walk - accel_density) < 0.05f * accel_density);
+	TEST_ASSERT(result.axis[IMU_ALLAN_GYRO_X].rate_random_walk < 0.1f * gyro_density);
+
+	/* The largest term of each sensor feeds pre-integration */
+	imu_preint_noise_t noise;
+	TEST_ASSERT(imu_allan_to_preint_noise(&result, &noise) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(noise.gyro_noise_density >= result.axis[IMU_ALLAN_GYRO_X].random_walk);
+	TEST_ASSERT(noise.accel_noise_density == result.axis[IMU_ALLAN_ACCEL_Z].random_walk);
+}
+
+static void test_allan_bias_walk(void)
+{
+	imu_allan_point_t points[IMU_ALLAN_MAX_LEVELS];
+	imu_allan_result_t result;
+	uint8_t num;
+
+	test_allan_start();
+	test_feed(TEST_NUM_SAMPLES);
+
+	/* A bias random walk rises at slope +1/2, K^2 tau / 3 */
+	TEST_ASSERT(imu_allan_get_curve(allan, IMU_ALLAN_GYRO_Y, points, IMU_ALLAN_MAX_LEVELS, &num) == ERR_CODE_SUCCESS);
+	for (uint8_t k = 4; (k + 1 < num) && (points[k + 1].diffs >= 256); k++)
+	{
+		float slope = log2f(points[k + 1].adev / points[k].adev);
+		TEST_ASSERT(fabsf(slope - 0.5f) < 0.15f);
+	}
+
+	float rrw = TEST_GYRO_STEP_DPS * TEST_DEG_TO_RAD * sqrtf(TEST_RATE_HZ);
+	TEST_ASSERT(imu_allan_get_result(allan, &result) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(fabsf(result.axis[IMU_ALLAN_GYRO_Y].rate_random_walk - rrw) < 0.3f * rrw);
+}
+
+static void test_allan_gap(void)
+{
+	imu_allan_status_t status;
+
+	/* A lost sample drops the clusters around it and nothing else */
+	test_allan_start();
+	test_feed(TEST_NUM_SAMPLES / 2);
+
+	TEST_ASSERT(imu_allan_get_status(allan, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.gaps == 1);
+	TEST_ASSERT(status.samples == TEST_NUM_SAMPLES);
+}
+
+int main(void)
+{
+	TEST_RUN(test_allan_white);
+	TEST_RUN(test_allan_bias_walk);
+	TEST_RUN(test_allan_gap);
+
+	free(allan);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,205 @@
+#include "test.h"
+#include "imu_array/imu_array.h"
+
+#define TEST_NUM_IMU 				3
+#define TEST_PERIOD_US 				5000.0f 	/*!< 200 Hz output data rate of the default configuration */
+#define TEST_PWR_MGMT_1 			0x6B
+#define TEST_PWR_MGMT_1_SLEEP 		0x40
+
+static imu_handle_t imu[TEST_NUM_IMU];
+static imu_sim_handle_t sim[TEST_NUM_IMU];
+static imu_array_handle_t array;
+
+/* Update once per millisecond, return the number of fused samples */
+static uint32_t test_run(uint32_t time_ms, uint64_t *last_time_us)
+{
+	imu_sample_scale_t sample;
+	bool data_ready;
+	uint32_t outputs = 0;
+
+	for (uint32_t i = 0; i < time_ms; i++)
+	{
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_array_update(array, &sample, &data_ready) == ERR_CODE_SUCCESS);
+		if (data_ready)
+		{
+			*last_time_us = sample.timestamp_us;
+			outputs++;
+		}
+	}
+
+	return outputs;
+}
+
+static void test_array_all_healthy(void)
+{
+	imu_array_status_t status;
+	uint64_t last_time_us = 0;
+
+	uint32_t outputs = test_run(100, &last_time_us);
+	TEST_ASSERT(outputs >= 18);
+	TEST_ASSERT(imu_sim_get_time_us() - last_time_us <= 2 * (uint64_t)TEST_PERIOD_US);
+
+	TEST_ASSERT(imu_array_get_status(array, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.accel_used_mask == 0x07);
+	TEST_ASSERT(status.gyro_used_mask == 0x07);
+}
+
+static void test_array_stalled_imu(void)
+{
+	imu_array_status_t before, after;
+	imu_bus_func_t func;
+	uint8_t sleep = TEST_PWR_MGMT_1_SLEEP;
+	uint64_t last_time_us = 0;
+
+	/* Put the last device to sleep behind the driver's back, it stops producing data */
+	TEST_ASSERT(imu_bus_bind(2, imu_sim_get_ops(), sim[2], &func) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(func.write_bytes(TEST_PWR_MGMT_1, &sleep, 1, 10) == ERR_CODE_SUCCESS);
+
+	imu_array_get_status(array, &before);
+
+	/* Output continues from the others, the stalled one does not hold the common time back */
+	uint32_t outputs = test_run(200, &last_time_us);
+	TEST_ASSERT(outputs >= 36);
+	TEST_ASSERT(imu_sim_get_time_us() - last_time_us <= 2 * (uint64_t)TEST_PERIOD_US);
+
+	imu_array_get_status(array, &after);
+	TEST_ASSERT(after.stale[2] > before.stale[2]);
+	TEST_ASSERT(after.gyro_used_mask == 0x03);
+	TEST_ASSERT(after.accel_used_mask == 0x03);
+}
+
+static void test_array_failed_poll(void)
+{
+	imu_array_status_t before, after;
+	imu_bus_func_t func;
+	uint64_t last_time_us = 0;
+
+	imu_array_get_status(array, &before);
+
+	/* An unbound slot fails every transfer */
+	TEST_ASSERT(imu_bus_unbind(1) == ERR_CODE_SUCCESS);
+	uint32_t outputs = test_run(100, &last_time_us);
+	TEST_ASSERT(outputs >= 18);
+
+	imu_array_get_status(array, &after);
+	TEST_ASSERT(after.poll_errors[1] >= before.poll_errors[1] + 100);
+	TEST_ASSERT(after.poll_errors[0] == before.poll_errors[0]);
+	TEST_ASSERT(after.gyro_used_mask == 0x01);
+
+	TEST_ASSERT(imu_bus_bind(1, imu_sim_get_ops(), sim[1], &func) == ERR_CODE_SUCCESS);
+}
+
+static void test_array_no_time_source(void)
+{
+	imu_array_handle_t untimed = imu_array_init();
+	imu_array_cfg_t cfg;
+	imu_sim_cfg_t sim_cfg;
+	imu_bus_func_t func;
+	imu_cfg_t imu_cfg;
+
+	memset(&sim_cfg, 0, sizeof(sim_cfg));
+	sim_cfg.chip = IMU_SIM_CHIP_MPU6050;
+	sim_cfg.signal = test_signal_still();
+
+	imu_sim_handle_t untimed_sim = imu_sim_init();
+	TEST_ASSERT(imu_sim_set_config(untimed_sim, sim_cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_sim_config(untimed_sim) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_bus_bind(TEST_NUM_IMU, imu_sim_get_ops(), untimed_sim, &func) == ERR_CODE_SUCCESS);
+
+	memset(&imu_cfg, 0, sizeof(imu_cfg));
+	imu_cfg.mpu6050_read_bytes = func.read_bytes;
+	imu_cfg.mpu6050_write_bytes = func.write_bytes;
+	imu_cfg.func_delay = imu_sim_delay;
+
+	imu_handle_t imu_untimed = imu_init();
+	TEST_ASSERT(imu_set_config(imu_untimed, imu_cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_config(imu_untimed) == ERR_CODE_SUCCESS);
+
+	/* Samples could not be aligned, the setup is rejected */
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.num_imu = 2;
+	cfg.imu[0] = imu[0];
+	cfg.imu[1] = imu_untimed;
+	TEST_ASSERT(imu_array_set_config(untimed, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_array_config(untimed) != ERR_CODE_SUCCESS);
+}
+
+static void test_array_full(void)
+{
+	imu_array_handle_t full = imu_array_init();
+	imu_array_cfg_t cfg;
+	imu_array_status_t status;
+	imu_sample_scale_t sample;
+	imu_sim_handle_t full_sim;
+	bool data_ready;
+	uint32_t outputs = 0;
+	const float identity[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+	/* A full array on the upper bus slots, with room left for magnetometers */
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.num_imu = IMU_ARRAY_MAX_IMU;
+	for (uint8_t i = 0; i < IMU_ARRAY_MAX_IMU; i++)
+	{
+		cfg.imu[i] = test_setup(IMU_BUS_MAX_SLOT - IMU_ARRAY_MAX_IMU + i, IMU_SIM_CHIP_MPU6050, test_signal_still(), &full_sim);
+		TEST_ASSERT(cfg.imu[i] != NULL);
+		memcpy(cfg.rotation[i], identity, sizeof(identity));
+		cfg.accel_var[i] = 1e-4f;
+		cfg.gyro_var[i] = 1e-2f;
+	}
+
+	TEST_ASSERT(imu_array_set_config(full, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_array_config(full) == ERR_CODE_SUCCESS);
+
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_array_update(full, &sample, &data_ready) == ERR_CODE_SUCCESS);
+		outputs += data_ready ? 1 : 0;
+	}
+
+	TEST_ASSERT(outputs >= 18);
+	TEST_ASSERT(imu_array_get_status(full, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.gyro_used_mask == 0xFF);
+}
+
+int main(void)
+{
+	imu_array_cfg_t cfg;
+	const float identity[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.num_imu = TEST_NUM_IMU;
+
+	for (uint8_t i = 0; i < TEST_NUM_IMU; i++)
+	{
+		imu[i] = test_setup(i, IMU_SIM_CHIP_MPU6050, test_signal_still(), &sim[i]);
+		if (imu[i] == NULL)
+		{
+			printf("setup failed\n");
+			return 1;
+		}
+
+		cfg.imu[i] = imu[i];
+		memcpy(cfg.rotation[i], identity, sizeof(identity));
+		cfg.accel_var[i] = 1e-4f;
+		cfg.gyro_var[i] = 1e-2f;
+	}
+
+	/* max_skew_us left at 0 for the default */
+	array = imu_array_init();
+	if ((array == NULL) || (imu_array_set_config(array, cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_array_config(array) != ERR_CODE_SUCCESS))
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_array_all_healthy);
+	TEST_RUN(test_array_stalled_imu);
+	TEST_RUN(test_array_failed_poll);
+	TEST_RUN(test_array_no_time_source);
+	TEST_RUN(test_array_full);
+
+	return TEST_RESULT();
+}
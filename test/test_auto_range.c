@@ -0,0 +1,106 @@
+#include "math.h"
+
+#include "test.h"
+
+#define TEST_GYRO_AMPLITUDE_DPS 	400.0f 		/*!< Clips the narrowest range, fits the next wider one */
+#define TEST_GYRO_FREQ_HZ 			1.0f
+#define TEST_GYRO_STEP_DPS 			3.0f 		/*!< Largest change of the sine per 1 ms period plus noise */
+
+static imu_handle_t handle;
+static imu_sim_handle_t sim;
+
+static const imu_auto_range_cfg_t range_cfg = {
+	.accel_enable = true,
+	.gyro_enable = true,
+	.up_threshold = 30000,
+	.down_threshold = 12000,
+	.window_samples = 30,
+};
+
+static void test_auto_range_down(void)
+{
+	imu_config_regs_t regs;
+	imu_sample_t sample;
+	bool data_ready;
+
+	/* Defaults are 8 g and 2000 deg/s, a device lying still ends in the narrowest gyroscope range */
+	for (uint32_t i = 0; i < 500; i++)
+	{
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+	}
+
+	TEST_ASSERT(sample.gyro_range == 0);
+	TEST_ASSERT(sample.accel_range == 0);
+
+	imu_get_config_regs(handle, &regs);
+	TEST_ASSERT(((regs.gyro_config >> 3) & 0x03) == sample.gyro_range);
+	TEST_ASSERT(((regs.accel_config >> 3) & 0x03) == sample.accel_range);
+}
+
+static void test_auto_range_up(void)
+{
+	imu_sim_signal_t signal = test_signal_still();
+	imu_sample_t sample;
+	imu_sample_scale_t scale;
+	bool data_ready, valid = false;
+	uint32_t last_seq = 0, switches = 0;
+	uint8_t last_range = 0;
+	float last_gyro = 0, peak = 0;
+
+	signal.gyro_amplitude_dps[0] = TEST_GYRO_AMPLITUDE_DPS;
+	signal.gyro_freq_hz = TEST_GYRO_FREQ_HZ;
+	imu_sim_set_signal(sim, signal);
+
+	/* The signal starts with a step, checks begin one sine period later */
+	for (uint32_t i = 0; i < 3000; i++)
+	{
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+		if (!data_ready || (i < 1000))
+		{
+			continue;
+		}
+
+		/* A sample never clips, the range is wide enough before the signal gets there */
+		TEST_ASSERT((sample.gyro_raw_x < 32767) && (sample.gyro_raw_x > -32768));
+
+		TEST_ASSERT(imu_scale_sample(handle, &sample, &scale) == ERR_CODE_SUCCESS);
+		if (fabsf(scale.gyro_x) > peak) {
+			peak = fabsf(scale.gyro_x);
+		}
+
+		/* Scaling by the tag keeps the signal continuous across range changes */
+		if (valid)
+		{
+			uint32_t periods = sample.seq - last_seq;
+			TEST_ASSERT(fabsf(scale.gyro_x - last_gyro) <= periods * TEST_GYRO_STEP_DPS);
+			switches += (sample.gyro_range != last_range) ? 1 : 0;
+		}
+
+		valid = true;
+		last_seq = sample.seq;
+		last_gyro = scale.gyro_x;
+		last_range = sample.gyro_range;
+	}
+
+	TEST_ASSERT(switches >= 2);
+	TEST_ASSERT(peak >= TEST_GYRO_AMPLITUDE_DPS - 10.0f);
+	TEST_ASSERT(peak <= TEST_GYRO_AMPLITUDE_DPS + 10.0f);
+}
+
+int main(void)
+{
+	handle = test_setup(0, IMU_SIM_CHIP_MPU6050, test_signal_still(), &sim);
+	if ((handle == NULL) || (imu_set_rate(handle, 1, 0) != ERR_CODE_SUCCESS) ||
+	        (imu_config_auto_range(handle, range_cfg) != ERR_CODE_SUCCESS))
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_auto_range_down);
+	TEST_RUN(test_auto_range_up);
+
+	return TEST_RESULT();
+}
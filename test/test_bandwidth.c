@@ -0,0 +1,148 @@
+#include "stdlib.h"
+
+#include "test.h"
+#include "mpu6500/mpu6500.h"
+#include "mpu6500/mpu6500_register.h"
+
+#define TEST_MAX_SAMPLES 			64
+#define TEST_RUN_US 				100000
+
+static imu_handle_t handle;
+static imu_sim_handle_t sim;
+static imu_bus_func_t func;
+
+static uint8_t test_read_reg(uint8_t reg)
+{
+	uint8_t value = 0;
+
+	TEST_ASSERT(func.read_bytes(reg, &value, 1, 10) == ERR_CODE_SUCCESS);
+
+	return value;
+}
+
+/* Drain the FIFO every drain_us, return the number of samples */
+static uint32_t test_drain(uint32_t drain_us, float period_us)
+{
+	static imu_sample_t samples[TEST_MAX_SAMPLES];
+	imu_sim_stats_t stats;
+	uint32_t total = 0, last_seq = 0;
+	uint16_t num;
+
+	TEST_ASSERT(imu_config_fifo(handle, true) == ERR_CODE_SUCCESS);
+	imu_sim_reset_stats(sim);
+
+	for (uint32_t t = 0; t < TEST_RUN_US; t += drain_us)
+	{
+		imu_sim_advance_us(drain_us);
+		TEST_ASSERT(imu_read_fifo(handle, samples, TEST_MAX_SAMPLES, &num) == ERR_CODE_SUCCESS);
+		TEST_ASSERT(num < TEST_MAX_SAMPLES);
+
+		for (uint16_t i = 0; i < num; i++)
+		{
+			TEST_ASSERT((total == 0) || (samples[i].seq == last_seq + 1));
+			TEST_ASSERT(samples[i].period_us == period_us);
+			last_seq = samples[i].seq;
+			total++;
+		}
+	}
+
+	/* Every frame produced was drained */
+	imu_sim_get_stats(sim, &stats);
+	TEST_ASSERT(stats.fifo_overflows == 0);
+	TEST_ASSERT(total + 1 >= stats.samples);
+
+	TEST_ASSERT(imu_config_fifo(handle, false) == ERR_CODE_SUCCESS);
+
+	return total;
+}
+
+static void test_bandwidth_registers(void)
+{
+	float period_us;
+
+	/* Accelerometer bandwidth apart from the shared DLPF */
+	TEST_ASSERT(imu_set_bandwidth(handle, MPU6500_GYRO_FCHOICE_DLPF, MPU6500_ACCEL_DLPF_41_HZ) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(test_read_reg(MPU6500_ACCEL_CONFIG2) == 0x03);
+	TEST_ASSERT((test_read_reg(MPU6500_GYRO_CONFIG) & 0x03) == 0);
+
+	TEST_ASSERT(imu_set_bandwidth(handle, MPU6500_GYRO_FCHOICE_DLPF, MPU6500_ACCEL_DLPF_1130_HZ) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(test_read_reg(MPU6500_ACCEL_CONFIG2) == 0x08);
+
+	/* Bypassing the gyroscope DLPF keeps the full scale */
+	uint8_t full_scale = test_read_reg(MPU6500_GYRO_CONFIG) & 0x18;
+	TEST_ASSERT(imu_set_bandwidth(handle, MPU6500_GYRO_FCHOICE_8800_HZ, MPU6500_ACCEL_DLPF_41_HZ) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(test_read_reg(MPU6500_GYRO_CONFIG) == (full_scale | 0x01));
+	TEST_ASSERT(imu_get_sample_period(handle, &period_us) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(period_us == 31.25f);
+
+	TEST_ASSERT(imu_set_bandwidth(handle, MPU6500_GYRO_FCHOICE_DLPF, MPU6500_ACCEL_DLPF_41_HZ) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(test_read_reg(MPU6500_GYRO_CONFIG) == full_scale);
+	TEST_ASSERT(imu_get_sample_period(handle, &period_us) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(period_us == 5000.0f);
+
+	TEST_ASSERT(imu_set_bandwidth(handle, MPU6500_GYRO_FCHOICE_MAX, MPU6500_ACCEL_DLPF_41_HZ) != ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_set_bandwidth(handle, MPU6500_GYRO_FCHOICE_DLPF, MPU6500_ACCEL_DLPF_MAX) != ERR_CODE_SUCCESS);
+}
+
+static void test_bandwidth_8k(void)
+{
+	/* DLPF_CFG 0 runs at 8 kHz whatever the divider */
+	TEST_ASSERT(imu_set_rate(handle, 0, 9) == ERR_CODE_SUCCESS);
+
+	uint32_t total = test_drain(2000, 125.0f);
+	TEST_ASSERT((total >= 799) && (total <= 801));
+
+	TEST_ASSERT(imu_set_rate(handle, 3, 4) == ERR_CODE_SUCCESS);
+}
+
+static void test_bandwidth_32k(void)
+{
+	/* 512 bytes hold 42 frames, 1.3 ms at 32 kHz */
+	TEST_ASSERT(imu_set_bandwidth(handle, MPU6500_GYRO_FCHOICE_3600_HZ, MPU6500_ACCEL_DLPF_1130_HZ) == ERR_CODE_SUCCESS);
+
+	uint32_t total = test_drain(500, 31.25f);
+	TEST_ASSERT((total >= 3199) && (total <= 3201));
+
+	TEST_ASSERT(imu_set_bandwidth(handle, MPU6500_GYRO_FCHOICE_DLPF, MPU6500_ACCEL_DLPF_41_HZ) == ERR_CODE_SUCCESS);
+}
+
+int main(void)
+{
+	imu_sim_cfg_t sim_cfg;
+	imu_cfg_t cfg;
+
+	sim = imu_sim_init();
+	memset(&sim_cfg, 0, sizeof(sim_cfg));
+	sim_cfg.chip = IMU_SIM_CHIP_MPU6500;
+	sim_cfg.seed = 1;
+	sim_cfg.signal = test_signal_still();
+
+	handle = imu_init();
+	memset(&cfg, 0, sizeof(cfg));
+
+	if ((sim == NULL) || (handle == NULL) || (imu_sim_set_config(sim, sim_cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_sim_config(sim) != ERR_CODE_SUCCESS) || (imu_bus_bind(0, imu_sim_get_ops(), sim, &func) != ERR_CODE_SUCCESS))
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	cfg.mpu6500_read_bytes = func.read_bytes;
+	cfg.mpu6500_write_bytes = func.write_bytes;
+	cfg.func_delay = imu_sim_delay;
+	cfg.func_get_time_us = imu_sim_get_time_us;
+
+	if ((imu_set_config(handle, cfg) != ERR_CODE_SUCCESS) || (imu_config(handle) != ERR_CODE_SUCCESS))
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_bandwidth_registers);
+	TEST_RUN(test_bandwidth_8k);
+	TEST_RUN(test_bandwidth_32k);
+
+	free(handle);
+
+	return TEST_RESULT();
+}
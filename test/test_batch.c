@@ -0,0 +1,147 @@
+#include "stdlib.h"
+
+#include "test.h"
+
+#define TEST_PERIOD_US 				5000.0f 	/*!< 200 Hz output data rate of the default configuration */
+#define TEST_NUM_POLLS 				1000
+#define TEST_NUM_DRAINS 			10
+#define TEST_MAX_SAMPLES 			128
+#define TEST_ACCEL_1G_8G 			4096
+
+static imu_handle_t plain, batched;
+static imu_sim_handle_t plain_sim, batched_sim;
+
+/* Every transaction has a fixed setup cost on the simulated bus, data bytes are free */
+static imu_handle_t test_batch_setup(uint8_t slot, bool batch, imu_sim_handle_t *sim)
+{
+	imu_sim_cfg_t sim_cfg;
+	imu_bus_func_t func;
+	imu_cfg_t cfg;
+
+	*sim = imu_sim_init();
+	memset(&sim_cfg, 0, sizeof(sim_cfg));
+	sim_cfg.chip = IMU_SIM_CHIP_MPU6050;
+	sim_cfg.seed = 1 + slot;
+	sim_cfg.latency_us = 100.0f;
+	sim_cfg.signal = test_signal_still();
+
+	if ((*sim == NULL) || (imu_sim_set_config(*sim, sim_cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_sim_config(*sim) != ERR_CODE_SUCCESS) || (imu_bus_bind(slot, imu_sim_get_ops(), *sim, &func) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	imu_handle_t handle = imu_init();
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.mpu6050_read_bytes = func.read_bytes;
+	cfg.mpu6050_write_bytes = func.write_bytes;
+	cfg.mpu6050_transfer = batch ? func.transfer : NULL;
+	cfg.func_delay = imu_sim_delay;
+	cfg.func_get_time_us = imu_sim_get_time_us;
+
+	if ((imu_set_config(handle, cfg) != ERR_CODE_SUCCESS) || (imu_config(handle) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+/* Poll every millisecond, return the number of samples */
+static uint32_t test_poll(imu_handle_t handle, imu_sim_handle_t sim, imu_sim_stats_t *stats)
+{
+	imu_sample_t sample;
+	bool data_ready;
+	uint32_t ready = 0, last_seq = 0;
+
+	imu_sim_reset_stats(sim);
+
+	for (uint32_t i = 0; i < TEST_NUM_POLLS; i++)
+	{
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+		if (!data_ready)
+		{
+			continue;
+		}
+
+		TEST_ASSERT((ready == 0) || (sample.seq == last_seq + 1));
+		TEST_ASSERT(abs(sample.accel_raw_z - TEST_ACCEL_1G_8G) < 100);
+		last_seq = sample.seq;
+		ready++;
+	}
+
+	imu_sim_get_stats(sim, stats);
+
+	return ready;
+}
+
+/* Drain the FIFO every ten sample periods */
+static void test_drain(imu_handle_t handle, imu_sim_handle_t sim, imu_sim_stats_t *stats)
+{
+	static imu_sample_t samples[TEST_MAX_SAMPLES];
+	uint16_t num;
+
+	TEST_ASSERT(imu_config_fifo(handle, true) == ERR_CODE_SUCCESS);
+	imu_sim_reset_stats(sim);
+
+	for (uint8_t i = 0; i < TEST_NUM_DRAINS; i++)
+	{
+		imu_sim_advance_us(10 * TEST_PERIOD_US);
+		TEST_ASSERT(imu_read_fifo(handle, samples, TEST_MAX_SAMPLES, &num) == ERR_CODE_SUCCESS);
+		TEST_ASSERT((num >= 9) && (num <= 11));
+		TEST_ASSERT(abs(samples[0].accel_raw_z - TEST_ACCEL_1G_8G) < 100);
+	}
+
+	imu_sim_get_stats(sim, stats);
+}
+
+static void test_batch_poll(void)
+{
+	imu_sim_stats_t plain_stats, batched_stats;
+
+	uint32_t plain_ready = test_poll(plain, plain_sim, &plain_stats);
+	uint32_t batched_ready = test_poll(batched, batched_sim, &batched_stats);
+
+	TEST_ASSERT(plain_ready >= TEST_NUM_POLLS * 1000 / TEST_PERIOD_US - 1);
+	TEST_ASSERT(batched_ready >= TEST_NUM_POLLS * 1000 / TEST_PERIOD_US - 1);
+
+	/* Status and output registers share one transaction, unbatched a new
+	 * sample costs a second one.
+	 */
+	TEST_ASSERT(batched_stats.transactions == TEST_NUM_POLLS);
+	TEST_ASSERT(plain_stats.transactions == TEST_NUM_POLLS + plain_ready);
+	TEST_ASSERT(batched_stats.bus_time_us < plain_stats.bus_time_us);
+}
+
+static void test_batch_fifo(void)
+{
+	imu_sim_stats_t plain_stats, batched_stats;
+
+	test_drain(plain, plain_sim, &plain_stats);
+	test_drain(batched, batched_sim, &batched_stats);
+
+	/* FIFO count comes with the status, one transaction less per drain */
+	TEST_ASSERT(plain_stats.transactions == batched_stats.transactions + TEST_NUM_DRAINS);
+}
+
+int main(void)
+{
+	plain = test_batch_setup(0, false, &plain_sim);
+	batched = test_batch_setup(1, true, &batched_sim);
+	if ((plain == NULL) || (batched == NULL))
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_batch_poll);
+	TEST_RUN(test_batch_fifo);
+
+	return TEST_RESULT();
+}
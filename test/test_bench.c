@@ -0,0 +1,125 @@
+#include "stdlib.h"
+#include "math.h"
+
+#include "test.h"
+
+#define TEST_BENCH_CMD 				"../bench/imu_bench 20"
+#define TEST_MAX_LINES 				64
+#define TEST_LINE_LEN 				512
+
+static char lines[TEST_MAX_LINES][TEST_LINE_LEN];
+static uint32_t num_lines;
+
+/* Result line of a case, NULL if the bench did not report it */
+static const char *test_find(const char *name)
+{
+	char key[64];
+
+	snprintf(key, sizeof(key), "\"name\": \"%s\"", name);
+	for (uint32_t i = 0; i < num_lines; i++)
+	{
+		if (strstr(lines[i], key) != NULL)
+		{
+			return lines[i];
+		}
+	}
+
+	return NULL;
+}
+
+static double test_field(const char *line, const char *field)
+{
+	char key[64];
+
+	snprintf(key, sizeof(key), "\"%s\": ", field);
+	const char *p = (line != NULL) ? strstr(line, key) : NULL;
+
+	return (p != NULL) ? strtod(p + strlen(key), NULL) : -1.0;
+}
+
+static void test_bench_errors(void)
+{
+	uint32_t results = 0;
+
+	/* Every case ran without errors, only the magnetometer paths may be missing */
+	for (uint32_t i = 0; i < num_lines; i++)
+	{
+		if (strstr(lines[i], "\"name\": ") == NULL)
+		{
+			continue;
+		}
+
+		results++;
+		if (strstr(lines[i], "\"error\": ") != NULL)
+		{
+			TEST_ASSERT(strstr(lines[i], "get_mag_") != NULL);
+			continue;
+		}
+		TEST_ASSERT((strstr(lines[i], "\"errors\": ") == NULL) || (test_field(lines[i], "errors") == 0));
+		TEST_ASSERT((strstr(lines[i], "\"restarts\": ") == NULL) || (test_field(lines[i], "restarts") == 0));
+	}
+
+	TEST_ASSERT(results >= 30);
+}
+
+static void test_bench_bus_cost(void)
+{
+	/* Transfers per sample are fixed by the read path */
+	TEST_ASSERT(test_field(test_find("get_accel_raw"), "transactions") == 1.0);
+	TEST_ASSERT(test_field(test_find("get_accel_raw"), "bytes") == 6.0);
+	TEST_ASSERT(test_field(test_find("read_channels"), "bytes") == 14.0);
+	TEST_ASSERT(test_field(test_find("poll_sample"), "transactions") == 2.0);
+	TEST_ASSERT(test_field(test_find("poll_sample"), "bytes") == 15.0);
+	TEST_ASSERT(test_field(test_find("poll_sample_batched"), "transactions") == 1.0);
+	TEST_ASSERT(test_field(test_find("poll_sample_batched"), "bytes") == 15.0);
+
+	/* Polling without a new sample reads INT_STATUS only */
+	TEST_ASSERT(test_field(test_find("poll_sample_stale"), "samples") <= 1);
+
+	/* FIFO reads deliver every frame, batching saves the count read */
+	TEST_ASSERT(test_field(test_find("read_fifo"), "samples") == 200);
+	TEST_ASSERT(test_field(test_find("read_fifo_batched"), "samples") == 200);
+	TEST_ASSERT(test_field(test_find("read_fifo_batched"), "transactions") < test_field(test_find("read_fifo"), "transactions"));
+}
+
+static void test_bench_pipelines(void)
+{
+	/* One output per ratio inputs */
+	double inputs = test_field(test_find("decim_8_raw"), "inputs");
+	double outputs = test_field(test_find("decim_8_raw"), "outputs");
+	TEST_ASSERT(inputs > 0);
+	TEST_ASSERT(fabs(outputs - inputs / 8) <= 8);
+
+	TEST_ASSERT(test_field(test_find("filter_1k_dyn_notch"), "retunes") > 0);
+	TEST_ASSERT(test_field(test_find("fft_256_q15"), "frames") > 0);
+	TEST_ASSERT(test_field(test_find("preint_1k"), "intervals") > 0);
+	TEST_ASSERT(test_field(test_find("preint_1k"), "gaps") == 0);
+}
+
+int main(void)
+{
+	FILE *pipe = popen(TEST_BENCH_CMD, "r");
+
+	if (pipe == NULL)
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	while ((num_lines < TEST_MAX_LINES) && (fgets(lines[num_lines], TEST_LINE_LEN, pipe) != NULL))
+	{
+		num_lines++;
+	}
+
+	if (pclose(pipe) != 0)
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_bench_errors);
+	TEST_RUN(test_bench_bus_cost);
+	TEST_RUN(test_bench_pipelines);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,148 @@
+#include "stdlib.h"
+
+#include "test.h"
+#include "imu_linux/imu_linux.h"
+
+#define TEST_REG_INT_STATUS 		0x3A
+#define TEST_REG_ACCEL_XOUT_H 		0x3B
+#define TEST_REG_PWR_MGMT_1 		0x6B
+#define TEST_READ_FLAG 				0x80
+
+static imu_bus_regmap_handle_t test_regmap_setup(uint8_t read_flag)
+{
+	imu_bus_regmap_handle_t regmap = imu_bus_regmap_init();
+	imu_bus_regmap_cfg_t cfg = {
+		.read_flag = read_flag,
+		.clear_on_read_reg = TEST_REG_INT_STATUS,
+		.clear_on_read_enable = 1,
+	};
+
+	if ((regmap == NULL) || (imu_bus_regmap_set_config(regmap, cfg) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	return regmap;
+}
+
+static void test_bus_regmap(void)
+{
+	imu_bus_regmap_handle_t regmap = test_regmap_setup(TEST_READ_FLAG);
+	imu_bus_regmap_stats_t stats;
+	imu_bus_func_t func;
+	uint8_t value, frame[15];
+
+	TEST_ASSERT(regmap != NULL);
+	TEST_ASSERT(imu_bus_bind(0, imu_bus_regmap_get_ops(), regmap, &func) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(func.transfer != NULL);
+	TEST_ASSERT(func.set_bus_clock != NULL);
+
+	/* Writes land in the register map, reads strip the SPI read flag */
+	value = 0x01;
+	TEST_ASSERT(func.write_bytes(TEST_REG_PWR_MGMT_1, &value, 1, 10) == ERR_CODE_SUCCESS);
+	value = 0;
+	TEST_ASSERT(func.read_bytes(TEST_REG_PWR_MGMT_1 | TEST_READ_FLAG, &value, 1, 10) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(value == 0x01);
+
+	/* Data ready clears once a read covers it */
+	value = 0x01;
+	TEST_ASSERT(imu_bus_regmap_set_reg(regmap, TEST_REG_INT_STATUS, &value, 1) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(func.read_bytes(TEST_REG_INT_STATUS | TEST_READ_FLAG, frame, sizeof(frame), 10) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(frame[0] == 0x01);
+	TEST_ASSERT(imu_bus_regmap_get_reg(regmap, TEST_REG_INT_STATUS, &value, 1) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(value == 0);
+
+	/* A batch is one backend call */
+	imu_transfer_t transfers[2] = {
+		{TEST_REG_INT_STATUS | TEST_READ_FLAG, &value, 1, IMU_TRANSFER_READ},
+		{TEST_REG_ACCEL_XOUT_H | TEST_READ_FLAG, frame, 14, IMU_TRANSFER_READ},
+	};
+	TEST_ASSERT(func.transfer(transfers, 2, 10) == ERR_CODE_SUCCESS);
+
+	func.set_bus_clock(1000000);
+
+	TEST_ASSERT(imu_bus_regmap_get_stats(regmap, &stats) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(stats.calls == 4);
+	TEST_ASSERT(stats.reads == 4);
+	TEST_ASSERT(stats.writes == 1);
+	TEST_ASSERT(stats.bytes == 1 + 1 + 15 + 1 + 14);
+	TEST_ASSERT(stats.clock_hz == 1000000);
+
+	/* Accesses past the last register fail */
+	TEST_ASSERT(func.write_bytes(0xF8, frame, 14, 10) != ERR_CODE_SUCCESS);
+
+	TEST_ASSERT(imu_bus_unbind(0) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(func.read_bytes(TEST_REG_PWR_MGMT_1, &value, 1, 10) != ERR_CODE_SUCCESS);
+
+	free(regmap);
+}
+
+static void test_bus_slots(void)
+{
+	imu_bus_regmap_handle_t first = test_regmap_setup(0);
+	imu_bus_regmap_handle_t last = test_regmap_setup(0);
+	imu_bus_func_t first_func, last_func, func;
+	uint8_t value;
+
+	TEST_ASSERT((first != NULL) && (last != NULL));
+	TEST_ASSERT(imu_bus_bind(IMU_BUS_MAX_SLOT, imu_bus_regmap_get_ops(), first, &func) != ERR_CODE_SUCCESS);
+
+	/* Every slot has its own functions forwarding to its own context */
+	TEST_ASSERT(imu_bus_bind(0, imu_bus_regmap_get_ops(), first, &first_func) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_bus_bind(IMU_BUS_MAX_SLOT - 1, imu_bus_regmap_get_ops(), last, &last_func) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(first_func.read_bytes != last_func.read_bytes);
+
+	value = 0x11;
+	TEST_ASSERT(first_func.write_bytes(TEST_REG_PWR_MGMT_1, &value, 1, 10) == ERR_CODE_SUCCESS);
+	value = 0x22;
+	TEST_ASSERT(last_func.write_bytes(TEST_REG_PWR_MGMT_1, &value, 1, 10) == ERR_CODE_SUCCESS);
+
+	TEST_ASSERT(imu_bus_regmap_get_reg(first, TEST_REG_PWR_MGMT_1, &value, 1) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(value == 0x11);
+	TEST_ASSERT(imu_bus_regmap_get_reg(last, TEST_REG_PWR_MGMT_1, &value, 1) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(value == 0x22);
+
+	imu_bus_unbind(0);
+	imu_bus_unbind(IMU_BUS_MAX_SLOT - 1);
+	free(first);
+	free(last);
+}
+
+static void test_bus_linux(void)
+{
+	imu_linux_handle_t linux_bus = imu_linux_init();
+	char long_path[128];
+	imu_linux_cfg_t cfg = {
+		.bus = IMU_LINUX_BUS_I2C,
+		.dev_path = "/dev/i2c-does-not-exist",
+		.i2c_addr = 0x68,
+	};
+
+	TEST_ASSERT(linux_bus != NULL);
+	TEST_ASSERT(imu_linux_get_ops() != NULL);
+	TEST_ASSERT(imu_linux_get_ops()->transfer != NULL);
+
+	/* A missing device fails in config, not on the first transfer */
+	TEST_ASSERT(imu_linux_set_config(linux_bus, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_linux_config(linux_bus) != ERR_CODE_SUCCESS);
+
+	memset(long_path, 'a', sizeof(long_path) - 1);
+	long_path[sizeof(long_path) - 1] = 0;
+	cfg.dev_path = long_path;
+	TEST_ASSERT(imu_linux_set_config(linux_bus, cfg) != ERR_CODE_SUCCESS);
+
+	cfg.dev_path = "/dev/spidev0.0";
+	cfg.bus = IMU_LINUX_BUS_MAX;
+	TEST_ASSERT(imu_linux_set_config(linux_bus, cfg) != ERR_CODE_SUCCESS);
+
+	TEST_ASSERT(imu_linux_deinit(linux_bus) == ERR_CODE_SUCCESS);
+}
+
+int main(void)
+{
+	TEST_RUN(test_bus_regmap);
+	TEST_RUN(test_bus_slots);
+	TEST_RUN(test_bus_linux);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,163 @@
+#include "test.h"
+
+#define TEST_PERIOD_US 				5000.0f 	/*!< 200 Hz output data rate of the default configuration */
+
+static imu_handle_t source, target;
+static imu_sim_handle_t source_sim, target_sim;
+static uint8_t blob[IMU_CALIB_BLOB_SIZE];
+static uint32_t blob_len;
+
+static void test_calib_round_trip(void)
+{
+	int16_t x, y, z, x2, y2, z2;
+	float fx, fy, fz;
+
+	TEST_ASSERT(imu_auto_calib(source) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_set_mag_soft_iron_bias(source, 1.02f, 0.98f, 1.01f) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_calib_save(source, blob, sizeof(blob), &blob_len) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(blob_len == IMU_CALIB_BLOB_SIZE);
+
+	TEST_ASSERT(imu_calib_load(target, blob, blob_len) == ERR_CODE_SUCCESS);
+
+	imu_get_accel_bias(source, &x, &y, &z);
+	imu_get_accel_bias(target, &x2, &y2, &z2);
+	TEST_ASSERT((x != 0) || (y != 0) || (z != 0));
+	TEST_ASSERT((x == x2) && (y == y2) && (z == z2));
+
+	imu_get_gyro_bias(source, &x, &y, &z);
+	imu_get_gyro_bias(target, &x2, &y2, &z2);
+	TEST_ASSERT((x != 0) || (y != 0) || (z != 0));
+	TEST_ASSERT((x == x2) && (y == y2) && (z == z2));
+
+	imu_get_mag_soft_iron_bias(target, &fx, &fy, &fz);
+	TEST_ASSERT((fx == 1.02f) && (fy == 0.98f) && (fz == 1.01f));
+}
+
+static void test_calib_reject_corrupt(void)
+{
+	int16_t x, y, z, x2, y2, z2;
+
+	TEST_ASSERT(imu_set_gyro_bias(target, 1, 2, 3) == ERR_CODE_SUCCESS);
+
+	/* Any flipped bit fails the CRC */
+	blob[20] ^= 0x01;
+	TEST_ASSERT(imu_calib_load(target, blob, blob_len) != ERR_CODE_SUCCESS);
+	blob[20] ^= 0x01;
+
+	blob[blob_len - 1] ^= 0x80;
+	TEST_ASSERT(imu_calib_load(target, blob, blob_len) != ERR_CODE_SUCCESS);
+	blob[blob_len - 1] ^= 0x80;
+
+	TEST_ASSERT(imu_calib_load(target, blob, blob_len - 1) != ERR_CODE_SUCCESS);
+
+	/* Rejected blobs leave the calibration alone */
+	imu_get_gyro_bias(target, &x, &y, &z);
+	TEST_ASSERT((x == 1) && (y == 2) && (z == 3));
+
+	/* The intact blob still loads */
+	TEST_ASSERT(imu_calib_load(target, blob, blob_len) == ERR_CODE_SUCCESS);
+	imu_get_gyro_bias(source, &x, &y, &z);
+	imu_get_gyro_bias(target, &x2, &y2, &z2);
+	TEST_ASSERT((x == x2) && (y == y2) && (z == z2));
+}
+
+/* Gyroscope x in deg/s of a sample reading 0 in the given range, the negative bias */
+static float test_gyro_bias_dps(imu_handle_t handle, uint8_t gyro_range)
+{
+	imu_sample_t sample;
+	imu_sample_scale_t scale;
+
+	memset(&sample, 0, sizeof(sample));
+	sample.gyro_range = gyro_range;
+	sample.accel_range = 2;
+	TEST_ASSERT(imu_scale_sample(handle, &sample, &scale) == ERR_CODE_SUCCESS);
+
+	return -scale.gyro_x;
+}
+
+static void test_calib_other_range(void)
+{
+	imu_config_regs_t saved, now;
+	imu_auto_range_cfg_t range_cfg = {
+		.accel_enable = true,
+		.gyro_enable = true,
+		.up_threshold = 30000,
+		.down_threshold = 12000,
+		.window_samples = 20,
+	};
+	imu_sample_t sample;
+	bool data_ready;
+	int16_t x, y, z, x2, y2, z2;
+
+	imu_get_config_regs(target, &saved);
+
+	/* Quiet motion lets auto-range step the gyroscope down */
+	TEST_ASSERT(imu_config_auto_range(target, range_cfg) == ERR_CODE_SUCCESS);
+	for (uint16_t i = 0; i < 200; i++)
+	{
+		imu_sim_advance_us(TEST_PERIOD_US);
+		imu_poll_sample(target, &sample, &data_ready);
+	}
+
+	imu_get_config_regs(target, &now);
+	uint8_t saved_range = (saved.gyro_config >> 3) & 0x03;
+	uint8_t now_range = (now.gyro_config >> 3) & 0x03;
+	TEST_ASSERT(now_range != saved_range);
+
+	/* A blob of the configured range still loads, the bias keeps its value in deg/s */
+	TEST_ASSERT(imu_set_gyro_bias(target, 1, 2, 3) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_calib_load(target, blob, blob_len) == ERR_CODE_SUCCESS);
+	imu_get_gyro_bias(source, &x, &y, &z);
+	imu_get_gyro_bias(target, &x2, &y2, &z2);
+	TEST_ASSERT((x == x2) && (y == y2) && (z == z2));
+	TEST_ASSERT(test_gyro_bias_dps(target, now_range) == test_gyro_bias_dps(source, saved_range));
+
+	/* Saved after the switch it loads into a device in the configured range */
+	TEST_ASSERT(imu_calib_save(target, blob, sizeof(blob), &blob_len) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_set_gyro_bias(source, 1, 2, 3) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_calib_load(source, blob, blob_len) == ERR_CODE_SUCCESS);
+	imu_get_gyro_bias(source, &x, &y, &z);
+	TEST_ASSERT((x == x2) && (y == y2) && (z == z2));
+}
+
+static void test_calib_slow_rate(void)
+{
+	imu_sim_handle_t slow_sim;
+	int16_t x, y, z;
+	imu_sim_signal_t signal = test_signal_still();
+
+	signal.gyro_offset_dps[1] = 1.5f;
+
+	/* 1 kHz divided by 20, auto calibration waits longer for every sample */
+	imu_handle_t slow = test_setup(2, IMU_SIM_CHIP_MPU6050, signal, &slow_sim);
+	TEST_ASSERT(slow != NULL);
+	TEST_ASSERT(imu_set_rate(slow, 1, 19) == ERR_CODE_SUCCESS);
+
+	TEST_ASSERT(imu_auto_calib(slow) == ERR_CODE_SUCCESS);
+	imu_get_gyro_bias(slow, &x, &y, &z);
+	TEST_ASSERT(y != 0);
+}
+
+int main(void)
+{
+	imu_sim_signal_t signal = test_signal_still();
+
+	/* Offsets for auto calibration to find */
+	signal.accel_offset_g[0] = 0.05f;
+	signal.gyro_offset_dps[1] = 1.5f;
+
+	source = test_setup(0, IMU_SIM_CHIP_MPU6050, signal, &source_sim);
+	target = test_setup(1, IMU_SIM_CHIP_MPU6050, signal, &target_sim);
+	if ((source == NULL) || (target == NULL))
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_calib_round_trip);
+	TEST_RUN(test_calib_reject_corrupt);
+	TEST_RUN(test_calib_other_range);
+	TEST_RUN(test_calib_slow_rate);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,138 @@
+#include "stdlib.h"
+#include "math.h"
+
+#include "test.h"
+#include "imu_clock/imu_clock.h"
+
+#define TEST_NOMINAL_PERIOD_US 		5000.0f
+#define TEST_DRIFT_PPM 				300.0f 		/*!< Sensor runs slow */
+#define TEST_JITTER_US 				200 		/*!< Host time of a frame is late by up to this much */
+#define TEST_NUM_OBSERVATIONS 		2000
+#define TEST_SIM_PPM 				500.0f 		/*!< Simulated sensor runs fast */
+
+static imu_clock_handle_t test_clock_setup(uint32_t min_observations)
+{
+	imu_clock_handle_t clock = imu_clock_init();
+	imu_clock_cfg_t cfg = {
+		.nominal_period_us = TEST_NOMINAL_PERIOD_US,
+		.forget_factor = 1.0f,
+		.min_observations = min_observations,
+	};
+
+	if ((clock == NULL) || (imu_clock_set_config(clock, cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_clock_config(clock) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	return clock;
+}
+
+/* Host time of a frame on a sensor clock off by TEST_DRIFT_PPM, with read latency */
+static uint64_t test_frame_time_us(uint32_t index, uint32_t *rand_state)
+{
+	*rand_state = *rand_state * 1103515245 + 12345;
+
+	double true_us = index * TEST_NOMINAL_PERIOD_US * (1.0 + TEST_DRIFT_PPM * 1e-6);
+
+	return 1000000 + (uint64_t)true_us + ((*rand_state >> 16) % TEST_JITTER_US);
+}
+
+static void test_clock_fit(void)
+{
+	imu_clock_handle_t clock = test_clock_setup(16);
+	uint32_t rand_state = 1;
+	float period_us, drift_ppm;
+	uint64_t time_us;
+
+	TEST_ASSERT(clock != NULL);
+
+	/* Frame index starts close to the wrap, the fit works relative to the first observation */
+	for (uint32_t i = 0; i < TEST_NUM_OBSERVATIONS; i++)
+	{
+		TEST_ASSERT(imu_clock_update(clock, 0xFFFFFF00 + i, test_frame_time_us(i, &rand_state)) == ERR_CODE_SUCCESS);
+	}
+
+	TEST_ASSERT(imu_clock_get_period(clock, &period_us) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_clock_get_drift(clock, &drift_ppm) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(fabsf(period_us - TEST_NOMINAL_PERIOD_US * (1.0f + TEST_DRIFT_PPM * 1e-6f)) < 0.05f);
+	TEST_ASSERT(fabsf(drift_ppm - TEST_DRIFT_PPM) < 10.0f);
+
+	/* The fitted line sits in the middle of the latency spread */
+	uint32_t index = TEST_NUM_OBSERVATIONS / 2;
+	double true_us = 1000000 + index * TEST_NOMINAL_PERIOD_US * (1.0 + TEST_DRIFT_PPM * 1e-6);
+	TEST_ASSERT(imu_clock_get_time(clock, 0xFFFFFF00 + index, &time_us) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(fabs((double)time_us - true_us - TEST_JITTER_US / 2) < 20.0);
+
+	free(clock);
+}
+
+static void test_clock_nominal(void)
+{
+	imu_clock_handle_t clock = test_clock_setup(16);
+	uint32_t rand_state = 1;
+	float period_us, drift_ppm;
+	uint64_t time_us;
+
+	TEST_ASSERT(clock != NULL);
+
+	TEST_ASSERT(imu_clock_get_time(clock, 0, &time_us) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(time_us == 0);
+
+	/* Too few observations for a fit, the nominal period stays */
+	for (uint32_t i = 0; i < 15; i++)
+	{
+		imu_clock_update(clock, i, test_frame_time_us(i, &rand_state));
+	}
+
+	TEST_ASSERT(imu_clock_get_period(clock, &period_us) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_clock_get_drift(clock, &drift_ppm) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(period_us == TEST_NOMINAL_PERIOD_US);
+	TEST_ASSERT(drift_ppm == 0);
+
+	imu_clock_update(clock, 15, test_frame_time_us(15, &rand_state));
+	TEST_ASSERT(imu_clock_get_period(clock, &period_us) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(period_us != TEST_NOMINAL_PERIOD_US);
+
+	free(clock);
+}
+
+static void test_clock_sim(void)
+{
+	imu_sim_handle_t sim;
+	imu_sim_cfg_t sim_cfg;
+	imu_sample_t sample;
+	bool data_ready;
+	float drift_ppm;
+
+	imu_handle_t handle = test_setup(0, IMU_SIM_CHIP_MPU6050, test_signal_still(), &sim);
+	TEST_ASSERT(handle != NULL);
+
+	/* Detune the simulated oscillator, the rate change restarts it and the fit */
+	memset(&sim_cfg, 0, sizeof(sim_cfg));
+	sim_cfg.chip = IMU_SIM_CHIP_MPU6050;
+	sim_cfg.seed = 1;
+	sim_cfg.clock_ppm = TEST_SIM_PPM;
+	sim_cfg.signal = test_signal_still();
+	TEST_ASSERT(imu_sim_set_config(sim, sim_cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_set_rate(handle, 1, 4) == ERR_CODE_SUCCESS);
+
+	for (uint32_t i = 0; i < 20000; i++)
+	{
+		imu_sim_advance_us(250);
+		TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+	}
+
+	/* A fast sensor has a shorter period than nominal */
+	TEST_ASSERT(imu_get_clock_drift(handle, &drift_ppm) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(fabsf(drift_ppm + TEST_SIM_PPM) < 20.0f);
+}
+
+int main(void)
+{
+	TEST_RUN(test_clock_fit);
+	TEST_RUN(test_clock_nominal);
+	TEST_RUN(test_clock_sim);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,212 @@
+#include "stdlib.h"
+
+#include "test.h"
+#include "imu_codec/imu_codec.h"
+
+#define TEST_NUM_SAMPLES 			100
+#define TEST_BLOCK_SAMPLES 			32
+#define TEST_STREAM_SIZE 			(4 * IMU_CODEC_BLOCK_MAX_SIZE)
+#define TEST_ALL_CHANNELS 			(IMU_CHANNEL_ACCEL | IMU_CHANNEL_TEMP | IMU_CHANNEL_GYRO | IMU_CHANNEL_MAG)
+
+static imu_sample_t samples[TEST_NUM_SAMPLES];
+static int16_t axes[IMU_CODEC_MAX_AXES * IMU_CODEC_BLOCK_MAX_SAMPLES];
+static uint8_t block[IMU_CODEC_BLOCK_MAX_SIZE];
+static uint8_t stream[TEST_STREAM_SIZE];
+static uint32_t stream_len;
+
+static err_code_t test_output(const uint8_t *data, uint32_t len)
+{
+	if (stream_len + len > sizeof(stream))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	memcpy(&stream[stream_len], data, len);
+	stream_len += len;
+
+	return ERR_CODE_SUCCESS;
+}
+
+/* Axis k of the block layout order: accel, temp, gyro, mag */
+static int16_t test_get_axis(const imu_sample_t *sample, uint8_t axis)
+{
+	const int16_t values[IMU_CODEC_MAX_AXES] = {
+		sample->accel_raw_x, sample->accel_raw_y, sample->accel_raw_z, sample->temp_raw,
+		sample->gyro_raw_x, sample->gyro_raw_y, sample->gyro_raw_z,
+		sample->mag_raw_x, sample->mag_raw_y, sample->mag_raw_z,
+	};
+
+	return values[axis];
+}
+
+/* Slow random walk, deltas of a few LSB like a still sensor */
+static void test_make_samples(void)
+{
+	memset(samples, 0, sizeof(samples));
+	srand(1);
+
+	for (uint16_t i = 0; i < TEST_NUM_SAMPLES; i++)
+	{
+		const imu_sample_t *prev = (i > 0) ? &samples[i - 1] : &samples[0];
+
+		samples[i].accel_raw_x = (int16_t)(prev->accel_raw_x + (rand() % 7) - 3);
+		samples[i].accel_raw_y = (int16_t)(prev->accel_raw_y + (rand() % 7) - 3);
+		samples[i].accel_raw_z = (i == 0) ? 4096 : (int16_t)(prev->accel_raw_z + (rand() % 7) - 3);
+		samples[i].temp_raw = -1200;
+		samples[i].gyro_raw_x = (int16_t)(prev->gyro_raw_x + (rand() % 31) - 15);
+		samples[i].gyro_raw_y = (int16_t)(prev->gyro_raw_y + (rand() % 31) - 15);
+		samples[i].gyro_raw_z = (int16_t)(prev->gyro_raw_z + (rand() % 31) - 15);
+		samples[i].mag_raw_x = 200;
+		samples[i].mag_raw_y = (int16_t)(i * 2);
+		samples[i].mag_raw_z = -300;
+	}
+}
+
+static bool test_round_trip(const imu_sample_t *input, uint16_t num, uint8_t channels, uint32_t *len)
+{
+	uint8_t decoded_channels;
+	uint16_t decoded_num;
+	uint32_t used;
+
+	if ((imu_codec_encode_block(input, num, channels, block, sizeof(block), len) != ERR_CODE_SUCCESS) ||
+	        (imu_codec_decode_block(block, *len, axes, IMU_CODEC_BLOCK_MAX_SAMPLES, &decoded_channels, &decoded_num, &used) != ERR_CODE_SUCCESS) ||
+	        (decoded_channels != channels) || (decoded_num != num) || (used != *len))
+	{
+		return false;
+	}
+
+	uint8_t k = 0;
+	for (uint8_t axis = 0; axis < IMU_CODEC_MAX_AXES; axis++)
+	{
+		uint8_t channel = (axis < 3) ? IMU_CHANNEL_ACCEL : (axis == 3) ? IMU_CHANNEL_TEMP : (axis < 7) ? IMU_CHANNEL_GYRO : IMU_CHANNEL_MAG;
+		if (!(channels & channel))
+		{
+			continue;
+		}
+
+		for (uint16_t i = 0; i < num; i++)
+		{
+			if (axes[k * IMU_CODEC_BLOCK_MAX_SAMPLES + i] != test_get_axis(&input[i], axis))
+			{
+				return false;
+			}
+		}
+		k++;
+	}
+
+	return true;
+}
+
+static void test_codec_width(void)
+{
+	imu_sample_t input[IMU_CODEC_BLOCK_MAX_SAMPLES];
+	uint32_t len;
+
+	/* Constant axes code no deltas at all */
+	memset(input, 0, sizeof(input));
+	for (uint16_t i = 0; i < IMU_CODEC_BLOCK_MAX_SAMPLES; i++)
+	{
+		input[i].accel_raw_x = -32768;
+		input[i].accel_raw_y = 32767;
+		input[i].accel_raw_z = 4096;
+	}
+	TEST_ASSERT(test_round_trip(input, IMU_CODEC_BLOCK_MAX_SAMPLES, IMU_CHANNEL_ACCEL, &len));
+	TEST_ASSERT(len == 2 + 3 * 3);
+	TEST_ASSERT(block[4] == 0);
+
+	/* Half range steps need the full 16 bits, steps of one LSB across the
+	 * wrap only two
+	 */
+	for (uint16_t i = 0; i < IMU_CODEC_BLOCK_MAX_SAMPLES; i++)
+	{
+		input[i].accel_raw_x = (i & 1) ? -32768 : 0;
+		input[i].accel_raw_y = (i & 1) ? -32768 : 32767;
+	}
+	TEST_ASSERT(test_round_trip(input, IMU_CODEC_BLOCK_MAX_SAMPLES, IMU_CHANNEL_ACCEL, &len));
+	TEST_ASSERT(block[4] == 16);
+	TEST_ASSERT(block[4 + 3 + (IMU_CODEC_BLOCK_MAX_SAMPLES - 1) * 2] == 2);
+	TEST_ASSERT(len <= IMU_CODEC_BLOCK_MAX_SIZE);
+
+	/* A single sample has no deltas */
+	TEST_ASSERT(test_round_trip(&samples[5], 1, TEST_ALL_CHANNELS, &len));
+	TEST_ASSERT(len == 2 + IMU_CODEC_MAX_AXES * 3);
+}
+
+static void test_codec_channels(void)
+{
+	uint32_t len;
+
+	/* Every channel subset decodes to its own axes */
+	for (uint8_t channels = 1; channels <= TEST_ALL_CHANNELS; channels++)
+	{
+		TEST_ASSERT(test_round_trip(samples, IMU_CODEC_BLOCK_MAX_SAMPLES, channels, &len));
+	}
+
+	/* Truncated and oversized blocks are rejected */
+	uint8_t decoded_channels;
+	uint16_t decoded_num;
+	uint32_t used;
+	TEST_ASSERT(test_round_trip(samples, IMU_CODEC_BLOCK_MAX_SAMPLES, TEST_ALL_CHANNELS, &len));
+	TEST_ASSERT(imu_codec_decode_block(block, len - 1, axes, IMU_CODEC_BLOCK_MAX_SAMPLES, &decoded_channels, &decoded_num, &used) != ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_codec_encode_block(samples, IMU_CODEC_BLOCK_MAX_SAMPLES + 1, TEST_ALL_CHANNELS, block, sizeof(block), &len) != ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_codec_encode_block(samples, 0, TEST_ALL_CHANNELS, block, sizeof(block), &len) != ERR_CODE_SUCCESS);
+}
+
+static void test_codec_encoder(void)
+{
+	imu_codec_encoder_handle_t encoder = imu_codec_encoder_init();
+	imu_codec_encoder_cfg_t cfg = {
+		.channels = IMU_CHANNEL_ACCEL | IMU_CHANNEL_GYRO,
+		.block_samples = TEST_BLOCK_SAMPLES,
+		.func_output = test_output,
+	};
+	imu_codec_encoder_stats_t stats;
+	uint8_t channels;
+	uint16_t num, decoded = 0;
+	uint32_t used, pos = 0;
+
+	TEST_ASSERT(encoder != NULL);
+	TEST_ASSERT(imu_codec_encoder_set_config(encoder, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_codec_encoder_config(encoder) == ERR_CODE_SUCCESS);
+
+	/* Full blocks go out as they fill, the flush sends the short rest */
+	stream_len = 0;
+	TEST_ASSERT(imu_codec_encoder_write(encoder, samples, TEST_NUM_SAMPLES) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_codec_encoder_get_stats(encoder, &stats) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(stats.blocks == TEST_NUM_SAMPLES / TEST_BLOCK_SAMPLES);
+	TEST_ASSERT(imu_codec_encoder_flush(encoder) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_codec_encoder_get_stats(encoder, &stats) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(stats.blocks == TEST_NUM_SAMPLES / TEST_BLOCK_SAMPLES + 1);
+	TEST_ASSERT(stats.samples == TEST_NUM_SAMPLES);
+	TEST_ASSERT(stats.coded_bytes == stream_len);
+	TEST_ASSERT(stats.raw_bytes == TEST_NUM_SAMPLES * 6 * sizeof(int16_t));
+	TEST_ASSERT(stats.ratio > 2.0f);
+
+	/* The concatenated blocks decode back to the input */
+	while (pos < stream_len)
+	{
+		TEST_ASSERT(imu_codec_decode_block(&stream[pos], stream_len - pos, axes, IMU_CODEC_BLOCK_MAX_SAMPLES, &channels, &num, &used) == ERR_CODE_SUCCESS);
+		TEST_ASSERT(channels == cfg.channels);
+		for (uint16_t i = 0; i < num; i++)
+		{
+			TEST_ASSERT(axes[2 * IMU_CODEC_BLOCK_MAX_SAMPLES + i] == samples[decoded + i].accel_raw_z);
+			TEST_ASSERT(axes[5 * IMU_CODEC_BLOCK_MAX_SAMPLES + i] == samples[decoded + i].gyro_raw_z);
+		}
+		decoded += num;
+		pos += used;
+	}
+	TEST_ASSERT(decoded == TEST_NUM_SAMPLES);
+
+	free(encoder);
+}
+
+int main(void)
+{
+	test_make_samples();
+
+	TEST_RUN(test_codec_width);
+	TEST_RUN(test_codec_channels);
+	TEST_RUN(test_codec_encoder);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,153 @@
+#include "stdlib.h"
+#include "math.h"
+
+#include "test.h"
+#include "imu_decim/imu_decim.h"
+
+#define TEST_RATIO 					8
+#define TEST_TAPS 					63
+#define TEST_DELAY 					((TEST_TAPS - 1) / 2)
+#define TEST_NUM_SAMPLES 			1024
+#define TEST_PERIOD_US 				1000
+#define TEST_PI 					3.14159265f
+
+static imu_decim_handle_t decim;
+static imu_sample_scale_t input[TEST_NUM_SAMPLES];
+static imu_decim_sample_t output[TEST_NUM_SAMPLES / TEST_RATIO + 1];
+
+static void test_decim_start(void)
+{
+	imu_decim_cfg_t cfg = {
+		.ratio = TEST_RATIO,
+		.taps = TEST_TAPS,
+		.attenuation_db = 60.0f,
+	};
+
+	if (decim == NULL)
+	{
+		decim = imu_decim_init();
+	}
+	TEST_ASSERT(decim != NULL);
+	TEST_ASSERT(imu_decim_set_config(decim, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_decim_config(decim) == ERR_CODE_SUCCESS);
+}
+
+/* Sine on gyroscope x at cycles per input sample, ramp on accelerometer x */
+static uint16_t test_run(float cycles, uint32_t first_seq)
+{
+	uint16_t num_out;
+
+	memset(input, 0, sizeof(input));
+	for (uint16_t i = 0; i < TEST_NUM_SAMPLES; i++)
+	{
+		input[i].seq = first_seq + i;
+		input[i].timestamp_us = 1000000 + (uint64_t)i * TEST_PERIOD_US;
+		input[i].accel_x = (float)i;
+		input[i].accel_z = 1.0f;
+		input[i].gyro_x = sinf(2 * TEST_PI * cycles * i);
+		input[i].temp = 25.0f;
+	}
+
+	test_decim_start();
+	TEST_ASSERT(imu_decim_write_scale(decim, input, TEST_NUM_SAMPLES, output, sizeof(output) / sizeof(output[0]), &num_out) == ERR_CODE_SUCCESS);
+
+	return num_out;
+}
+
+static float test_peak(uint16_t num_out)
+{
+	float peak = 0;
+
+	/* Skip the outputs that still see the held first sample */
+	for (uint16_t i = TEST_TAPS / TEST_RATIO + 1; i < num_out; i++)
+	{
+		peak = fmaxf(peak, fabsf(output[i].gyro_x));
+	}
+
+	return peak;
+}
+
+static void test_decim_dc(void)
+{
+	imu_decim_status_t status;
+	uint16_t num_out = test_run(0, 500);
+
+	/* One output per ratio inputs once the filter center reached the first sample */
+	TEST_ASSERT(imu_decim_get_status(decim, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.delay_samples == TEST_DELAY);
+	TEST_ASSERT(status.inputs == TEST_NUM_SAMPLES);
+	TEST_ASSERT(num_out == (TEST_NUM_SAMPLES - TEST_DELAY + TEST_RATIO - 1) / TEST_RATIO);
+	TEST_ASSERT(status.outputs == num_out);
+	TEST_ASSERT(status.restarts == 0);
+
+	/* Unity gain at DC from the first output on */
+	for (uint16_t i = 0; i < num_out; i++)
+	{
+		TEST_ASSERT(fabsf(output[i].accel_z - 1.0f) < 1e-4f);
+		TEST_ASSERT(fabsf(output[i].temp - 25.0f) < 1e-3f);
+	}
+}
+
+static void test_decim_delay(void)
+{
+	uint16_t num_out = test_run(0, 500);
+
+	/* Outputs are dated by the input at the filter center */
+	for (uint16_t i = 0; i < num_out; i++)
+	{
+		TEST_ASSERT(output[i].seq == 500 + (uint32_t)i * TEST_RATIO);
+		TEST_ASSERT(output[i].timestamp_us == input[output[i].seq - 500].timestamp_us);
+
+		/* A linear phase filter passes a ramp at its center */
+		if (output[i].seq >= 500 + TEST_DELAY)
+		{
+			TEST_ASSERT(fabsf(output[i].accel_x - (float)(output[i].seq - 500)) < 0.05f);
+		}
+	}
+}
+
+static void test_decim_band(void)
+{
+	/* Output Nyquist is 1 / 16 of the input rate */
+	TEST_ASSERT(fabsf(test_peak(test_run(0.01f, 0)) - 1.0f) < 0.02f);
+	TEST_ASSERT(test_peak(test_run(0.2f, 0)) < 2e-3f);
+	TEST_ASSERT(test_peak(test_run(0.45f, 0)) < 2e-3f);
+}
+
+static void test_decim_restart(void)
+{
+	imu_decim_status_t status;
+	uint16_t num_out;
+
+	test_run(0, 0);
+
+	/* A lost input restarts the filter, outputs resume at the new sample */
+	uint32_t seq = input[TEST_NUM_SAMPLES - 1].seq + 5;
+	for (uint16_t i = 0; i < TEST_NUM_SAMPLES; i++)
+	{
+		input[i].seq = seq + i;
+	}
+	TEST_ASSERT(imu_decim_write_scale(decim, input, TEST_NUM_SAMPLES, output, sizeof(output) / sizeof(output[0]), &num_out) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_decim_get_status(decim, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.restarts == 1);
+	TEST_ASSERT(num_out > 0);
+	TEST_ASSERT(output[0].seq == seq);
+
+	/* A full output buffer drops */
+	TEST_ASSERT(imu_decim_write_scale(decim, input, TEST_NUM_SAMPLES, output, 4, &num_out) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(num_out == 4);
+	TEST_ASSERT(imu_decim_get_status(decim, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.dropped > 0);
+}
+
+int main(void)
+{
+	TEST_RUN(test_decim_dc);
+	TEST_RUN(test_decim_delay);
+	TEST_RUN(test_decim_band);
+	TEST_RUN(test_decim_restart);
+
+	free(decim);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,175 @@
+#include "stdlib.h"
+#include "math.h"
+
+#include "test.h"
+#include "imu_fft/imu_fft.h"
+
+#define TEST_POINTS 				256
+#define TEST_RATE_HZ 				1000.0f
+#define TEST_RESOLUTION_HZ 			(TEST_RATE_HZ / TEST_POINTS)
+#define TEST_GYRO_LSB_PER_DPS 		16.384f 	/*!< 2000 deg/s full scale */
+#define TEST_ACCEL_LSB_PER_G 		4096.0f 	/*!< 8 g full scale */
+#define TEST_TONE_Y_HZ 				(77 * TEST_RESOLUTION_HZ) 	/*!< Gyroscope y tone on a bin centre, 300.8 Hz */
+#define TEST_PI 					3.14159265f
+
+static float buf[IMU_FFT_BUF_SIZE(TEST_POINTS, IMU_FFT_MAX_AXES, sizeof(float)) / sizeof(float)];
+static imu_sample_t samples[2 * TEST_POINTS];
+static imu_fft_handle_t fft;
+static imu_fft_features_t features;
+static uint32_t frames;
+
+static void test_features(const imu_fft_features_t *f)
+{
+	features = *f;
+	frames++;
+}
+
+static void test_fft_start(imu_fft_format_t format, imu_fft_window_t window)
+{
+	imu_fft_cfg_t cfg = {
+		.points = TEST_POINTS,
+		.format = format,
+		.window = window,
+		.channels = IMU_CHANNEL_ACCEL | IMU_CHANNEL_GYRO,
+		.sample_rate_hz = TEST_RATE_HZ,
+		.band_edges_hz = {0.0f, 50.0f, 150.0f, 500.0f},
+		.num_bands = 3,
+		.buf = buf,
+		.buf_size = sizeof(buf),
+		.func_features = test_features,
+	};
+
+	if (fft == NULL)
+	{
+		fft = imu_fft_init();
+	}
+	TEST_ASSERT(fft != NULL);
+	TEST_ASSERT(imu_fft_set_config(fft, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_fft_config(fft) == ERR_CODE_SUCCESS);
+	frames = 0;
+}
+
+/* 100 deg/s at freq_hz on gyroscope x, 20 deg/s at 300.8 Hz on gyroscope y,
+ * 1 g on accelerometer z
+ */
+static void test_make_samples(float freq_hz)
+{
+	memset(samples, 0, sizeof(samples));
+
+	for (uint16_t i = 0; i < 2 * TEST_POINTS; i++)
+	{
+		float t = i / TEST_RATE_HZ;
+
+		samples[i].seq = 100 + i;
+		samples[i].timestamp_us = 1000 * (uint64_t)i;
+		samples[i].accel_range = 2;
+		samples[i].gyro_range = 3;
+		samples[i].accel_raw_z = (int16_t)TEST_ACCEL_LSB_PER_G;
+		samples[i].gyro_raw_x = (int16_t)lroundf(100.0f * TEST_GYRO_LSB_PER_DPS * sinf(2 * TEST_PI * freq_hz * t));
+		samples[i].gyro_raw_y = (int16_t)lroundf(20.0f * TEST_GYRO_LSB_PER_DPS * sinf(2 * TEST_PI * TEST_TONE_Y_HZ * t));
+	}
+}
+
+/* Peaks and amplitudes of one frame within the relative tolerance, bands
+ * without a tone below floor_dps
+ */
+static void test_check(float freq_hz, float freq_tol_hz, float amp_tol, float floor_dps)
+{
+	const imu_fft_axis_features_t *gx = &features.axis[3];
+	const imu_fft_axis_features_t *gy = &features.axis[4];
+	const imu_fft_axis_features_t *az = &features.axis[2];
+
+	TEST_ASSERT(features.num_axes == 6);
+	TEST_ASSERT(features.first_seq == 100);
+	TEST_ASSERT(features.resolution_hz == TEST_RESOLUTION_HZ);
+
+	TEST_ASSERT(fabsf(gx->peak_hz[0] - freq_hz) < freq_tol_hz);
+	TEST_ASSERT(fabsf(gx->peak_amp[0] - 100.0f) < 100.0f * amp_tol);
+	TEST_ASSERT(fabsf(gx->rms - 100.0f / sqrtf(2)) < 100.0f * amp_tol);
+	TEST_ASSERT(fabsf(gx->band_rms[1] - 100.0f / sqrtf(2)) < 100.0f * amp_tol);
+	TEST_ASSERT(gx->band_rms[2] < floor_dps);
+
+	TEST_ASSERT(fabsf(gy->peak_hz[0] - TEST_TONE_Y_HZ) < freq_tol_hz);
+	TEST_ASSERT(fabsf(gy->peak_amp[0] - 20.0f) < 20.0f * amp_tol);
+	TEST_ASSERT(gy->band_rms[1] < floor_dps);
+
+	/* Gravity is all mean, no spectrum */
+	TEST_ASSERT(fabsf(az->mean - 1.0f) < 1e-3f);
+	TEST_ASSERT(az->rms < 1e-3f);
+}
+
+static void test_fft_float(void)
+{
+	/* On a bin centre with a rectangular window the peak is exact */
+	float freq_hz = 25 * TEST_RESOLUTION_HZ;
+	test_make_samples(freq_hz);
+	test_fft_start(IMU_FFT_FORMAT_FLOAT, IMU_FFT_WINDOW_RECT);
+	TEST_ASSERT(imu_fft_write(fft, samples, TEST_POINTS) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(frames == 1);
+	test_check(freq_hz, 0.01f, 0.005f, 0.1f);
+
+	/* Between bins the Hann window interpolates the frequency */
+	test_make_samples(101.0f);
+	test_fft_start(IMU_FFT_FORMAT_FLOAT, IMU_FFT_WINDOW_HANN);
+	TEST_ASSERT(imu_fft_write(fft, samples, TEST_POINTS) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(frames == 1);
+	test_check(101.0f, 0.5f, 0.16f, 0.1f);
+}
+
+static void test_fft_q15(void)
+{
+	/* Same frames in fixed point, the noise floor is about 0.1 % of full scale */
+	float freq_hz = 25 * TEST_RESOLUTION_HZ;
+	test_make_samples(freq_hz);
+	test_fft_start(IMU_FFT_FORMAT_Q15, IMU_FFT_WINDOW_RECT);
+	TEST_ASSERT(imu_fft_write(fft, samples, TEST_POINTS) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(frames == 1);
+	test_check(freq_hz, 0.01f, 0.02f, 2.0f);
+
+	test_make_samples(101.0f);
+	test_fft_start(IMU_FFT_FORMAT_Q15, IMU_FFT_WINDOW_HANN);
+	TEST_ASSERT(imu_fft_write(fft, samples, TEST_POINTS) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(frames == 1);
+	test_check(101.0f, 0.5f, 0.16f, 2.0f);
+}
+
+static void test_fft_restart(void)
+{
+	imu_fft_status_t status;
+
+	test_make_samples(100.0f);
+	test_fft_start(IMU_FFT_FORMAT_FLOAT, IMU_FFT_WINDOW_HANN);
+
+	/* A lost sample drops the partial frame, the next frame starts after it */
+	samples[TEST_POINTS / 2].seq += 1000;
+	TEST_ASSERT(imu_fft_write(fft, samples, TEST_POINTS) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(frames == 0);
+	TEST_ASSERT(imu_fft_write(fft, &samples[TEST_POINTS / 2], 1) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_fft_get_status(fft, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.restarts >= 1);
+
+	/* A range change does the same */
+	for (uint16_t i = 0; i < 2 * TEST_POINTS; i++)
+	{
+		samples[i].seq = 100 + i;
+		samples[i].gyro_range = (i < 10) ? 2 : 3;
+	}
+	test_fft_start(IMU_FFT_FORMAT_FLOAT, IMU_FFT_WINDOW_HANN);
+	TEST_ASSERT(imu_fft_write(fft, samples, 2 * TEST_POINTS) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(frames == 1);
+	TEST_ASSERT(features.first_seq == 110);
+	TEST_ASSERT(imu_fft_get_status(fft, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.restarts == 1);
+	TEST_ASSERT(status.frames == 1);
+}
+
+int main(void)
+{
+	TEST_RUN(test_fft_float);
+	TEST_RUN(test_fft_q15);
+	TEST_RUN(test_fft_restart);
+
+	free(fft);
+
+	return TEST_RESULT();
+}
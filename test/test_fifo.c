@@ -0,0 +1,187 @@
+#include "test.h"
+
+#define TEST_PERIOD_US 				5000.0f 	/*!< 200 Hz output data rate of the default configuration */
+#define TEST_MAX_SAMPLES 			128
+
+static imu_handle_t handle;
+static imu_sim_handle_t sim;
+static imu_sample_t samples[TEST_MAX_SAMPLES];
+
+static uint16_t test_drain(void)
+{
+	uint16_t num = 0;
+
+	TEST_ASSERT(imu_read_fifo(handle, samples, TEST_MAX_SAMPLES, &num) == ERR_CODE_SUCCESS);
+
+	return num;
+}
+
+static void test_fifo_frames(void)
+{
+	TEST_ASSERT(imu_config_fifo(handle, true) == ERR_CODE_SUCCESS);
+
+	imu_sim_advance_us(10 * TEST_PERIOD_US);
+	uint16_t num = test_drain();
+	TEST_ASSERT((num >= 9) && (num <= 11));
+
+	/* Frames are numbered and dated one period apart */
+	for (uint16_t i = 1; i < num; i++)
+	{
+		TEST_ASSERT(samples[i].seq == samples[i - 1].seq + 1);
+		TEST_ASSERT(samples[i].timestamp_us - samples[i - 1].timestamp_us == (uint64_t)TEST_PERIOD_US);
+	}
+
+	/* The next drain continues the numbering */
+	uint32_t last_seq = samples[num - 1].seq;
+	imu_sim_advance_us(5 * TEST_PERIOD_US);
+	num = test_drain();
+	TEST_ASSERT(num > 0);
+	TEST_ASSERT(samples[0].seq == last_seq + 1);
+}
+
+static void test_fifo_overflow(void)
+{
+	imu_sim_stats_t stats;
+
+	TEST_ASSERT(imu_config_fifo(handle, true) == ERR_CODE_SUCCESS);
+
+	imu_sim_advance_us(5 * TEST_PERIOD_US);
+	uint16_t num = test_drain();
+	TEST_ASSERT(num > 0);
+	uint32_t last_seq = samples[num - 1].seq;
+	uint64_t last_time_us = samples[num - 1].timestamp_us;
+
+	/* One second fills the FIFO several times over */
+	imu_sim_reset_stats(sim);
+	imu_sim_advance_us(200 * TEST_PERIOD_US);
+	imu_sim_get_stats(sim, &stats);
+	TEST_ASSERT(stats.fifo_overflows > 0);
+
+	/* The overflowed FIFO is reset, nothing misaligned is returned */
+	num = test_drain();
+	TEST_ASSERT(num == 0);
+
+	/* Frames after the reset account for every period lost before it */
+	imu_sim_advance_us(5 * TEST_PERIOD_US);
+	num = test_drain();
+	TEST_ASSERT(num > 0);
+
+	uint32_t lost = (uint32_t)((samples[0].timestamp_us - last_time_us) / TEST_PERIOD_US + 0.5f);
+	uint32_t gap = samples[0].seq - last_seq;
+	TEST_ASSERT(gap >= 200);
+	TEST_ASSERT((gap + 1 >= lost) && (gap <= lost + 1));
+
+	for (uint16_t i = 1; i < num; i++)
+	{
+		TEST_ASSERT(samples[i].seq == samples[i - 1].seq + 1);
+	}
+}
+
+static void test_fifo_rate_change(void)
+{
+	TEST_ASSERT(imu_config_fifo(handle, true) == ERR_CODE_SUCCESS);
+
+	/* Ten frames at 200 Hz queued when the rate goes to 1 kHz */
+	imu_sim_advance_us(10 * TEST_PERIOD_US + TEST_PERIOD_US / 2);
+	TEST_ASSERT(imu_set_rate(handle, 1, 0) == ERR_CODE_SUCCESS);
+	imu_sim_advance_us(20 * 1000);
+
+	uint16_t num = test_drain();
+	TEST_ASSERT((num >= 28) && (num <= 32));
+
+	/* Every frame keeps the period it was produced at */
+	uint16_t old = 0;
+	while ((old < num) && (samples[old].period_us == TEST_PERIOD_US))
+	{
+		old++;
+	}
+	TEST_ASSERT(old == 10);
+
+	for (uint16_t i = 1; i < num; i++)
+	{
+		float period_us = (i < old) ? TEST_PERIOD_US : 1000.0f;
+		TEST_ASSERT(samples[i].seq == samples[i - 1].seq + 1);
+		TEST_ASSERT(samples[i].timestamp_us - samples[i - 1].timestamp_us == (uint64_t)period_us);
+		TEST_ASSERT((i < old) || (samples[i].period_us == 1000.0f));
+	}
+
+	/* The newest frame is dated by the drain, not the old frames before it */
+	TEST_ASSERT(imu_sim_get_time_us() - samples[num - 1].timestamp_us <= 1000);
+
+	TEST_ASSERT(imu_set_rate(handle, 1, 4) == ERR_CODE_SUCCESS);
+}
+
+/* Time source of a device that booted at test_boot_us */
+static uint64_t test_boot_us;
+
+static uint64_t test_boot_time_us(void)
+{
+	uint64_t now = imu_sim_get_time_us();
+
+	return (now > test_boot_us) ? now - test_boot_us : 0;
+}
+
+static void test_fifo_early_drain(void)
+{
+	imu_sim_cfg_t sim_cfg;
+	imu_bus_func_t func;
+	imu_cfg_t cfg;
+	uint16_t num = 0;
+
+	memset(&sim_cfg, 0, sizeof(sim_cfg));
+	sim_cfg.chip = IMU_SIM_CHIP_MPU6050;
+	sim_cfg.signal = test_signal_still();
+
+	imu_sim_handle_t boot_sim = imu_sim_init();
+	TEST_ASSERT(imu_sim_set_config(boot_sim, sim_cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_sim_config(boot_sim) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_bus_bind(1, imu_sim_get_ops(), boot_sim, &func) == ERR_CODE_SUCCESS);
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.mpu6050_read_bytes = func.read_bytes;
+	cfg.mpu6050_write_bytes = func.write_bytes;
+	cfg.func_delay = imu_sim_delay;
+	cfg.func_get_time_us = test_boot_time_us;
+
+	imu_handle_t boot = imu_init();
+	TEST_ASSERT(imu_set_config(boot, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_config(boot) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_config_fifo(boot, true) == ERR_CODE_SUCCESS);
+
+	/* Align to a frame, then let the time source start shortly before the next one */
+	for (uint16_t i = 0; (i < 100) && (num == 0); i++)
+	{
+		imu_sim_advance_us(100);
+		TEST_ASSERT(imu_read_fifo(boot, samples, TEST_MAX_SAMPLES, &num) == ERR_CODE_SUCCESS);
+	}
+	test_boot_us = imu_sim_get_time_us() + 4000;
+
+	/* The first frame is drained less than half a period after time zero */
+	num = 0;
+	for (uint16_t i = 0; (i < 100) && (num == 0); i++)
+	{
+		imu_sim_advance_us(100);
+		TEST_ASSERT(imu_read_fifo(boot, samples, TEST_MAX_SAMPLES, &num) == ERR_CODE_SUCCESS);
+	}
+
+	TEST_ASSERT(num == 1);
+	TEST_ASSERT(test_boot_time_us() < TEST_PERIOD_US / 2);
+	TEST_ASSERT(samples[0].timestamp_us <= test_boot_time_us());
+}
+
+int main(void)
+{
+	handle = test_setup(0, IMU_SIM_CHIP_MPU6050, test_signal_still(), &sim);
+	if (handle == NULL)
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_fifo_frames);
+	TEST_RUN(test_fifo_overflow);
+	TEST_RUN(test_fifo_rate_change);
+	TEST_RUN(test_fifo_early_drain);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,158 @@
+#include "stdlib.h"
+#include "math.h"
+
+#include "test.h"
+#include "imu_filter/imu_filter.h"
+
+#define TEST_RATE_HZ 				1000.0f
+#define TEST_NUM_SAMPLES 			2000
+#define TEST_SETTLE 				1000 		/*!< Samples before the output is measured */
+#define TEST_DYN_BLOCK 				32 			/*!< Resolves about the 23 Hz bin spacing */
+#define TEST_PI 					3.14159265f
+
+static imu_filter_handle_t filter;
+static imu_sample_scale_t samples[TEST_NUM_SAMPLES];
+static uint32_t phase;
+static float accel_gain;
+
+static void test_filter_start(imu_filter_cfg_t cfg)
+{
+	if (filter == NULL)
+	{
+		filter = imu_filter_init();
+	}
+	TEST_ASSERT(filter != NULL);
+	TEST_ASSERT(imu_filter_set_config(filter, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_filter_config(filter) == ERR_CODE_SUCCESS);
+	phase = 0;
+}
+
+/* Sine of freq_hz on gyroscope x and accelerometer x, 1 g on z, return the
+ * RMS gain of gyroscope x after settling, accel_gain is the one of
+ * accelerometer x.
+ */
+static float test_run(float freq_hz)
+{
+	float in_sq = 0, out_sq = 0, accel_sq = 0;
+
+	memset(samples, 0, sizeof(samples));
+	for (uint16_t i = 0; i < TEST_NUM_SAMPLES; i++)
+	{
+		float x = sinf(2 * TEST_PI * freq_hz * (phase++) / TEST_RATE_HZ);
+		samples[i].seq = phase;
+		samples[i].accel_x = x;
+		samples[i].accel_z = 1.0f;
+		samples[i].gyro_x = x;
+		samples[i].temp = 25.0f;
+		in_sq += (i >= TEST_SETTLE) ? x * x : 0;
+	}
+
+	TEST_ASSERT(imu_filter_apply(filter, samples, TEST_NUM_SAMPLES) == ERR_CODE_SUCCESS);
+
+	for (uint16_t i = TEST_SETTLE; i < TEST_NUM_SAMPLES; i++)
+	{
+		out_sq += samples[i].gyro_x * samples[i].gyro_x;
+		accel_sq += samples[i].accel_x * samples[i].accel_x;
+	}
+	accel_gain = sqrtf(accel_sq / in_sq);
+
+	return sqrtf(out_sq / in_sq);
+}
+
+static void test_filter_notch(void)
+{
+	imu_filter_cfg_t cfg = {
+		.sample_rate_hz = TEST_RATE_HZ,
+		.gyro_stages = {
+			{IMU_FILTER_NOTCH, 100.0f, 5.0f},
+		},
+	};
+
+	test_filter_start(cfg);
+
+	/* The centre frequency is removed, well away from it passes */
+	TEST_ASSERT(test_run(100.0f) < 0.01f);
+	TEST_ASSERT(test_run(20.0f) > 0.98f);
+	TEST_ASSERT(test_run(400.0f) > 0.98f);
+
+	/* Axes without stages pass unchanged */
+	for (uint16_t i = 0; i < TEST_NUM_SAMPLES; i++)
+	{
+		TEST_ASSERT(samples[i].accel_z == 1.0f);
+		TEST_ASSERT(samples[i].temp == 25.0f);
+	}
+}
+
+static void test_filter_lowpass(void)
+{
+	imu_filter_cfg_t cfg = {
+		.sample_rate_hz = TEST_RATE_HZ,
+		.accel_stages = {
+			{IMU_FILTER_LOWPASS, 50.0f, 0.7071f},
+		},
+		.gyro_stages = {
+			{IMU_FILTER_LOWPASS, 50.0f, 0.7071f},
+			{IMU_FILTER_LOWPASS, 50.0f, 0.7071f},
+		},
+	};
+
+	test_filter_start(cfg);
+
+	/* Two stages fall at 80 dB per decade, unity gain at DC */
+	TEST_ASSERT(test_run(5.0f) > 0.99f);
+	TEST_ASSERT(test_run(400.0f) < 0.001f);
+	TEST_ASSERT(fabsf(samples[TEST_NUM_SAMPLES - 1].accel_z - 1.0f) < 1e-4f);
+
+	imu_filter_status_t status;
+	TEST_ASSERT(imu_filter_get_status(filter, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.samples == 2 * TEST_NUM_SAMPLES);
+	TEST_ASSERT(status.estimates == 0);
+	TEST_ASSERT(status.dyn_notch_hz == 0);
+}
+
+static void test_filter_dyn_notch(void)
+{
+	imu_filter_cfg_t cfg = {
+		.sample_rate_hz = TEST_RATE_HZ,
+		.dyn_notch_enable = true,
+		.dyn_notch_min_hz = 50.0f,
+		.dyn_notch_max_hz = 400.0f,
+		.dyn_notch_q = 3.0f,
+		.dyn_notch_block = TEST_DYN_BLOCK,
+	};
+	imu_filter_status_t status;
+
+	test_filter_start(cfg);
+
+	/* The notch finds the peak and removes it, 20 dB with the estimate
+	 * interpolated between bins
+	 */
+	float gain = test_run(180.0f);
+	TEST_ASSERT(imu_filter_get_status(filter, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(fabsf(status.dyn_notch_hz - 180.0f) < 5.0f);
+	TEST_ASSERT(status.estimates == TEST_NUM_SAMPLES / TEST_DYN_BLOCK);
+	TEST_ASSERT(status.retunes > 0);
+	TEST_ASSERT(gain < 0.1f);
+
+	/* The accelerometer is left alone by default */
+	TEST_ASSERT(fabsf(accel_gain - 1.0f) < 1e-3f);
+
+	/* A moving peak moves the notch */
+	uint32_t retunes = status.retunes;
+	gain = test_run(300.0f);
+	TEST_ASSERT(imu_filter_get_status(filter, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(fabsf(status.dyn_notch_hz - 300.0f) < 5.0f);
+	TEST_ASSERT(status.retunes > retunes);
+	TEST_ASSERT(gain < 0.1f);
+}
+
+int main(void)
+{
+	TEST_RUN(test_filter_notch);
+	TEST_RUN(test_filter_lowpass);
+	TEST_RUN(test_filter_dyn_notch);
+
+	free(filter);
+
+	return TEST_RESULT();
+}
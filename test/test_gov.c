@@ -0,0 +1,249 @@
+#include "stdlib.h"
+#include "math.h"
+
+#include "test.h"
+#include "imu_gov/imu_gov.h"
+#include "mpu6050/mpu6050_register.h"
+
+#define TEST_GYRO_LSB_PER_DPS 		16.4f 		/*!< 2000 deg/s full scale of the default configuration */
+#define TEST_HOLD_MS 				200
+#define TEST_MAX_EVENTS 			16
+
+static imu_handle_t handle;
+static imu_gov_handle_t gov;
+static imu_bus_func_t func;
+static imu_sample_t still;
+static uint32_t config_writes, smplrt_div_writes, seq, event_seq;
+static imu_gov_event_t events[TEST_MAX_EVENTS];
+static uint8_t num_events;
+
+static const float periods_us[] = {20000.0f, 5000.0f, 1000.0f};
+
+static err_code_t test_write_bytes(uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	config_writes += (reg_addr == MPU6050_CONFIG) ? 1 : 0;
+	smplrt_div_writes += (reg_addr == MPU6050_SMPLRT_DIV) ? 1 : 0;
+
+	return func.write_bytes(reg_addr, buf, len, timeout_ms);
+}
+
+static void test_rate_change(const imu_gov_event_t *event)
+{
+	if (num_events < TEST_MAX_EVENTS)
+	{
+		events[num_events++] = *event;
+	}
+
+	/* Sample being evaluated, test_feed already counted it */
+	event_seq = seq - 1;
+}
+
+static imu_handle_t test_gov_setup(void)
+{
+	imu_sim_handle_t sim = imu_sim_init();
+	imu_sim_cfg_t sim_cfg;
+	imu_cfg_t cfg;
+	bool data_ready = false;
+
+	memset(&sim_cfg, 0, sizeof(sim_cfg));
+	sim_cfg.chip = IMU_SIM_CHIP_MPU6050;
+	sim_cfg.seed = 1;
+	sim_cfg.signal = test_signal_still();
+
+	if ((sim == NULL) || (imu_sim_set_config(sim, sim_cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_sim_config(sim) != ERR_CODE_SUCCESS) || (imu_bus_bind(0, imu_sim_get_ops(), sim, &func) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	imu_handle_t imu = imu_init();
+	if (imu == NULL)
+	{
+		return NULL;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.mpu6050_read_bytes = func.read_bytes;
+	cfg.mpu6050_write_bytes = test_write_bytes;
+	cfg.func_delay = imu_sim_delay;
+	cfg.func_get_time_us = imu_sim_get_time_us;
+
+	if ((imu_set_config(imu, cfg) != ERR_CODE_SUCCESS) || (imu_config(imu) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	/* A real sample carries the range tags, the tests only change the rates.
+	 * Skip the sample produced while the ranges were configured.
+	 */
+	imu_sim_advance_us(20000);
+	while (!data_ready)
+	{
+		imu_sim_advance_us(1000);
+		if (imu_poll_sample(imu, &still, &data_ready) != ERR_CODE_SUCCESS)
+		{
+			return NULL;
+		}
+	}
+	still.gyro_raw_x = 0;
+	still.gyro_raw_y = 0;
+	still.gyro_raw_z = 0;
+
+	return imu;
+}
+
+static void test_gov_start(void)
+{
+	imu_gov_cfg_t cfg = {
+		.imu = handle,
+		.profiles = {
+			{3, 19, 10.0f, 20.0f, 0.0f, 0.0f},
+			{3, 4, 10.0f, 100.0f, 1.0f, 10.0f},
+			{1, 0, 10.0f, 1000.0f, 1.0f, 50.0f},
+		},
+		.num_profiles = 3,
+		.initial_profile = 0,
+		.window_ms = 50.0f,
+		.hold_ms = TEST_HOLD_MS,
+		.func_rate_change = test_rate_change,
+	};
+
+	if (gov == NULL)
+	{
+		gov = imu_gov_init();
+	}
+	TEST_ASSERT(gov != NULL);
+	TEST_ASSERT(imu_gov_set_config(gov, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_gov_config(gov) == ERR_CODE_SUCCESS);
+	num_events = 0;
+}
+
+/* Feed samples one at a time at the rate of the current profile */
+static void test_feed(float rate_dps, uint32_t duration_ms)
+{
+	imu_gov_status_t status;
+	uint64_t elapsed_us = 0;
+
+	while (elapsed_us < (uint64_t)duration_ms * 1000)
+	{
+		TEST_ASSERT(imu_gov_get_status(gov, &status) == ERR_CODE_SUCCESS);
+
+		imu_sample_t sample = still;
+		sample.seq = seq++;
+		sample.period_us = periods_us[status.profile];
+		sample.gyro_raw_x = (int16_t)lroundf(rate_dps * TEST_GYRO_LSB_PER_DPS);
+		TEST_ASSERT(imu_gov_update(gov, &sample, 1) == ERR_CODE_SUCCESS);
+		elapsed_us += (uint64_t)sample.period_us;
+	}
+}
+
+static uint8_t test_profile(void)
+{
+	imu_gov_status_t status;
+
+	TEST_ASSERT(imu_gov_get_status(gov, &status) == ERR_CODE_SUCCESS);
+
+	return status.profile;
+}
+
+static void test_gov_hysteresis(void)
+{
+	test_gov_start();
+
+	/* Below the up threshold nothing changes */
+	test_feed(15.0f, 1000);
+	TEST_ASSERT(test_profile() == 0);
+	TEST_ASSERT(num_events == 0);
+
+	test_feed(30.0f, 500);
+	TEST_ASSERT(test_profile() == 1);
+	TEST_ASSERT(num_events == 1);
+	TEST_ASSERT(events[0].from_profile == 0);
+	TEST_ASSERT(events[0].to_profile == 1);
+	TEST_ASSERT(events[0].period_us == periods_us[1]);
+	TEST_ASSERT(events[0].gyro_activity_dps > 20.0f);
+	TEST_ASSERT(events[0].last_seq == event_seq);
+
+	/* Between the down threshold of 1 and the up threshold of 0 it stays */
+	test_feed(15.0f, 2000);
+	TEST_ASSERT(test_profile() == 1);
+	TEST_ASSERT(num_events == 1);
+
+	test_feed(5.0f, 1000);
+	TEST_ASSERT(test_profile() == 0);
+	TEST_ASSERT(num_events == 2);
+
+	imu_gov_status_t status;
+	TEST_ASSERT(imu_gov_get_status(gov, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.changes == 2);
+	TEST_ASSERT(status.time_in_profile_us[1] >= 2000000);
+}
+
+static void test_gov_hold(void)
+{
+	test_gov_start();
+
+	/* Up one profile per update, at once */
+	test_feed(500.0f, 20);
+	TEST_ASSERT(test_profile() == 1);
+	test_feed(500.0f, 5);
+	TEST_ASSERT(test_profile() == 2);
+
+	/* Down only after the hold time in the profile */
+	test_feed(0.0f, TEST_HOLD_MS - 10);
+	TEST_ASSERT(test_profile() == 2);
+	test_feed(0.0f, 20);
+	TEST_ASSERT(test_profile() == 1);
+
+	/* Part of the last feed already ran in profile 1 */
+	test_feed(0.0f, TEST_HOLD_MS - 40);
+	TEST_ASSERT(test_profile() == 1);
+	test_feed(0.0f, 40);
+	TEST_ASSERT(test_profile() == 0);
+
+	float period_us;
+	TEST_ASSERT(imu_get_sample_period(handle, &period_us) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(period_us == periods_us[0]);
+}
+
+static void test_gov_registers(void)
+{
+	test_gov_start();
+
+	/* Only registers that differ from the current rate are written */
+	config_writes = 0;
+	smplrt_div_writes = 0;
+	test_feed(30.0f, 500);
+	TEST_ASSERT(test_profile() == 1);
+	TEST_ASSERT(config_writes == 0);
+	TEST_ASSERT(smplrt_div_writes == 1);
+
+	test_feed(500.0f, 20);
+	TEST_ASSERT(test_profile() == 2);
+	TEST_ASSERT(config_writes == 1);
+	TEST_ASSERT(smplrt_div_writes == 2);
+
+	/* The same rate again writes nothing */
+	TEST_ASSERT(imu_set_rate(handle, 1, 0) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(config_writes == 1);
+	TEST_ASSERT(smplrt_div_writes == 2);
+}
+
+int main(void)
+{
+	handle = test_gov_setup();
+	if (handle == NULL)
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_gov_hysteresis);
+	TEST_RUN(test_gov_hold);
+	TEST_RUN(test_gov_registers);
+
+	free(gov);
+	free(handle);
+
+	return TEST_RESULT();
+}
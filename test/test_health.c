@@ -0,0 +1,194 @@
+#include "stdlib.h"
+
+#include "test.h"
+
+#define TEST_PERIOD_US 				5000 		/*!< 200 Hz output data rate of the default configuration */
+#define TEST_STUCK_SAMPLES 			20
+#define TEST_MAX_STEP 				500
+#define TEST_SCORE_WINDOW 			10
+
+static imu_handle_t handle;
+static imu_sim_handle_t sim;
+
+static const imu_health_cfg_t health_cfg = {
+	.enable = true,
+	.stuck_samples = TEST_STUCK_SAMPLES,
+	.accel_max_step = TEST_MAX_STEP,
+	.gyro_max_step = TEST_MAX_STEP,
+	.score_window = TEST_SCORE_WINDOW,
+};
+
+/* Noise of a few LSB on every axis, no axis repeats for long */
+static imu_sim_signal_t test_signal_noisy(void)
+{
+	imu_sim_signal_t signal = test_signal_still();
+
+	signal.gyro_noise_dps = 0.5f;
+
+	return signal;
+}
+
+/* Poll num samples, return the health bits of all of them */
+static uint16_t test_poll(uint32_t num, imu_health_status_t *status)
+{
+	imu_sample_t sample;
+	bool data_ready;
+	uint16_t flags = 0;
+
+	for (uint32_t ready = 0; ready < num;)
+	{
+		imu_sim_advance_us(TEST_PERIOD_US);
+		TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+		if (!data_ready)
+		{
+			continue;
+		}
+
+		flags |= sample.health;
+		ready++;
+	}
+
+	TEST_ASSERT(imu_get_health_status(handle, status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status->last_flags == sample.health);
+
+	return flags;
+}
+
+static void test_health_config(void)
+{
+	imu_health_cfg_t cfg = health_cfg;
+	imu_health_status_t status;
+
+	TEST_ASSERT(imu_config_health(NULL, cfg) == ERR_CODE_NULL_PTR);
+	TEST_ASSERT(imu_get_health_status(handle, NULL) == ERR_CODE_NULL_PTR);
+
+	/* A run of one would flag every sample */
+	cfg.stuck_samples = 1;
+	TEST_ASSERT(imu_config_health(handle, cfg) == ERR_CODE_FAIL);
+	cfg = health_cfg;
+	cfg.saturation_threshold = 32769;
+	TEST_ASSERT(imu_config_health(handle, cfg) == ERR_CODE_FAIL);
+
+	/* Disabled, samples pass unchecked */
+	cfg.enable = false;
+	cfg.saturation_threshold = 0;
+	TEST_ASSERT(imu_config_health(handle, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(test_poll(20, &status) == 0);
+	TEST_ASSERT(status.samples == 0);
+	TEST_ASSERT(status.score == 1.0f);
+}
+
+static void test_health_clean(void)
+{
+	imu_health_status_t status;
+
+	TEST_ASSERT(imu_config_health(handle, health_cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(test_poll(200, &status) == 0);
+	TEST_ASSERT(status.samples == 200);
+	TEST_ASSERT(status.faulty_samples == 0);
+	TEST_ASSERT(status.flags == 0);
+	TEST_ASSERT(status.score == 1.0f);
+}
+
+static void test_health_stuck(void)
+{
+	imu_sim_signal_t signal = test_signal_noisy();
+	imu_health_status_t status;
+	float last_score = 1.0f;
+
+	TEST_ASSERT(imu_config_health(handle, health_cfg) == ERR_CODE_SUCCESS);
+
+	/* Without noise every axis repeats its value, flagged from the stuck_samples-th sample on */
+	signal.accel_noise_g = 0;
+	signal.gyro_noise_dps = 0;
+	imu_sim_set_signal(sim, signal);
+
+	TEST_ASSERT(test_poll(TEST_STUCK_SAMPLES - 1, &status) == 0);
+	TEST_ASSERT(status.score == 1.0f);
+
+	for (uint32_t i = 0; i < 50; i++)
+	{
+		test_poll(1, &status);
+		TEST_ASSERT(status.score < last_score);
+		last_score = status.score;
+	}
+	TEST_ASSERT(status.last_flags == (IMU_HEALTH_ACCEL_STUCK | IMU_HEALTH_GYRO_STUCK));
+	TEST_ASSERT(status.stuck == 50);
+	TEST_ASSERT(status.stuck == status.faulty_samples);
+	TEST_ASSERT(status.spikes == 0);
+	TEST_ASSERT(status.score < 0.01f);
+
+	/* Noise back, the score climbs to 1 within a few windows and the flags stay latched */
+	imu_sim_set_signal(sim, test_signal_noisy());
+	test_poll(1, &status);
+	for (uint32_t i = 0; i < 50; i++)
+	{
+		TEST_ASSERT(test_poll(1, &status) == 0);
+		TEST_ASSERT(status.score > last_score);
+		last_score = status.score;
+	}
+	TEST_ASSERT(status.score > 0.99f);
+	TEST_ASSERT(status.flags == (IMU_HEALTH_ACCEL_STUCK | IMU_HEALTH_GYRO_STUCK));
+}
+
+static void test_health_spike(void)
+{
+	imu_sim_signal_t signal = test_signal_noisy();
+	imu_health_status_t status;
+
+	TEST_ASSERT(imu_config_health(handle, health_cfg) == ERR_CODE_SUCCESS);
+	test_poll(10, &status);
+
+	/* A 100 deg/s step is 1640 LSB, one sample jumps and the next ones agree */
+	signal.gyro_offset_dps[1] = 100.0f;
+	imu_sim_set_signal(sim, signal);
+
+	TEST_ASSERT(test_poll(20, &status) == IMU_HEALTH_GYRO_SPIKE);
+	TEST_ASSERT(status.spikes == 1);
+	TEST_ASSERT(status.faulty_samples == 1);
+	TEST_ASSERT(status.last_flags == 0);
+	TEST_ASSERT((status.score > 0.85f) && (status.score < 1.0f));
+}
+
+static void test_health_saturated(void)
+{
+	imu_sim_signal_t signal = test_signal_noisy();
+	imu_health_status_t status;
+
+	TEST_ASSERT(imu_config_health(handle, health_cfg) == ERR_CODE_SUCCESS);
+	test_poll(10, &status);
+
+	/* Beyond the 2000 deg/s range an axis sits at the limit, that is not stuck */
+	signal.gyro_offset_dps[2] = 2500.0f;
+	imu_sim_set_signal(sim, signal);
+
+	TEST_ASSERT(test_poll(2 * TEST_STUCK_SAMPLES, &status) == (IMU_HEALTH_GYRO_SATURATED | IMU_HEALTH_GYRO_SPIKE));
+	TEST_ASSERT(status.last_flags == IMU_HEALTH_GYRO_SATURATED);
+	TEST_ASSERT(status.saturated == 2 * TEST_STUCK_SAMPLES);
+	TEST_ASSERT(status.stuck == 0);
+	TEST_ASSERT(status.spikes == 1);
+	TEST_ASSERT(status.score < 0.05f);
+}
+
+int main(void)
+{
+	handle = test_setup(0, IMU_SIM_CHIP_MPU6050, test_signal_noisy(), &sim);
+	if (handle == NULL)
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	/* The first samples may still come from the power on range */
+	imu_sim_advance_us(20000);
+
+	TEST_RUN(test_health_config);
+	TEST_RUN(test_health_clean);
+	TEST_RUN(test_health_stuck);
+	TEST_RUN(test_health_spike);
+	TEST_RUN(test_health_saturated);
+
+	free(handle);
+
+	return TEST_RESULT();
+}
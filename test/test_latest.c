@@ -0,0 +1,132 @@
+#include "pthread.h"
+#include "stdatomic.h"
+
+#include "test.h"
+
+#define TEST_NUM_READER 			2
+#define TEST_NUM_POLLS 				200000
+
+static imu_handle_t handle;
+static atomic_bool done;
+static atomic_uint torn;
+
+/* A consistent copy has both halves from the same sample, seq never goes back */
+static void *test_sample_reader(void *arg)
+{
+	imu_sample_t sample;
+	imu_sample_scale_t scale;
+	uint32_t last_seq = 0;
+
+	(void)arg;
+
+	while (!atomic_load(&done))
+	{
+		if (imu_get_latest_sample(handle, &sample, &scale) != ERR_CODE_SUCCESS)
+		{
+			continue;
+		}
+
+		/* Scaling dates the sample with the corrected timestamp once there is one */
+		uint64_t timestamp_us = (sample.timestamp_corrected_us != 0) ? sample.timestamp_corrected_us : sample.timestamp_us;
+		if ((sample.seq != scale.seq) || (timestamp_us != scale.timestamp_us) || (sample.seq < last_seq))
+		{
+			atomic_fetch_add(&torn, 1);
+		}
+		last_seq = sample.seq;
+	}
+
+	return NULL;
+}
+
+/* The setter writes the same bias to all three axes */
+static void *test_bias_reader(void *arg)
+{
+	int16_t x, y, z;
+
+	(void)arg;
+
+	while (!atomic_load(&done))
+	{
+		imu_get_gyro_bias(handle, &x, &y, &z);
+		if ((x != y) || (y != z))
+		{
+			atomic_fetch_add(&torn, 1);
+		}
+	}
+
+	return NULL;
+}
+
+static void test_latest_single(void)
+{
+	imu_sample_t sample, latest;
+	bool data_ready = false;
+
+	/* Nothing published before the first sample */
+	TEST_ASSERT(imu_get_latest_sample(handle, &latest, NULL) != ERR_CODE_SUCCESS);
+
+	while (!data_ready)
+	{
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+	}
+
+	TEST_ASSERT(imu_get_latest_sample(handle, &latest, NULL) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(memcmp(&latest, &sample, sizeof(sample)) == 0);
+}
+
+static void test_latest_threads(void)
+{
+	pthread_t reader[TEST_NUM_READER + 1];
+	imu_sample_t sample, latest;
+	uint32_t last_seq = 0;
+	bool data_ready;
+
+	atomic_store(&done, false);
+	atomic_store(&torn, 0);
+
+	for (uint8_t i = 0; i < TEST_NUM_READER; i++)
+	{
+		TEST_ASSERT(pthread_create(&reader[i], NULL, test_sample_reader, NULL) == 0);
+	}
+	TEST_ASSERT(pthread_create(&reader[TEST_NUM_READER], NULL, test_bias_reader, NULL) == 0);
+
+	for (uint32_t i = 0; i < TEST_NUM_POLLS; i++)
+	{
+		int16_t bias = (int16_t)(i % 100);
+
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+		last_seq = data_ready ? sample.seq : last_seq;
+		TEST_ASSERT(imu_set_gyro_bias(handle, bias, bias, bias) == ERR_CODE_SUCCESS);
+	}
+
+	atomic_store(&done, true);
+	for (uint8_t i = 0; i < TEST_NUM_READER + 1; i++)
+	{
+		pthread_join(reader[i], NULL);
+	}
+
+	TEST_ASSERT(atomic_load(&torn) == 0);
+
+	/* Readers do not disturb the publisher */
+	TEST_ASSERT(imu_get_latest_sample(handle, &latest, NULL) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(latest.seq == last_seq);
+}
+
+int main(void)
+{
+	imu_sim_handle_t sim;
+
+	handle = test_setup(0, IMU_SIM_CHIP_MPU6050, test_signal_still(), &sim);
+	if (handle == NULL)
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_latest_single);
+	TEST_RUN(test_latest_threads);
+
+	return TEST_RESULT();
+}
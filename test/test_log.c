@@ -0,0 +1,295 @@
+#include "stdlib.h"
+
+#include "test.h"
+#include "imu_log/imu_log.h"
+
+#define TEST_PATH 					"test_log.bin"
+#define TEST_RECORD_PATH 			"test_log_record.bin"
+#define TEST_RECORD_POLLS 			500
+#define TEST_NUM_SAMPLES 			100
+#define TEST_RANGE_CHANGE 			40 			/*!< First sample after auto-range narrowed the gyroscope */
+#define TEST_BUF_SIZE 				256 		/*!< Small, the writer flushes many times */
+
+#define TEST_REG_GYRO_CONFIG 		0x1B
+#define TEST_REG_INT_STATUS 		0x3A
+#define TEST_REG_ACCEL_XOUT_H 		0x3B
+
+static FILE *file;
+static uint8_t buf[TEST_BUF_SIZE];
+static imu_sample_t samples[TEST_NUM_SAMPLES];
+static imu_sample_t recorded[TEST_RECORD_POLLS];
+static imu_sample_scale_t recorded_scale[TEST_RECORD_POLLS];
+
+static err_code_t test_flush(const uint8_t *data, uint32_t len)
+{
+	return (fwrite(data, 1, len, file) == len) ? ERR_CODE_SUCCESS : ERR_CODE_FAIL;
+}
+
+static void test_make_samples(void)
+{
+	memset(samples, 0, sizeof(samples));
+
+	for (uint16_t i = 0; i < TEST_NUM_SAMPLES; i++)
+	{
+		samples[i].seq = 1000 + i;
+		samples[i].timestamp_us = 20000 + 5000 * (uint64_t)i;
+		samples[i].accel_range = 2;
+		samples[i].gyro_range = (i < TEST_RANGE_CHANGE) ? 3 : 1;
+		samples[i].accel_raw_x = (int16_t)(100 * i);
+		samples[i].accel_raw_z = 4096;
+		samples[i].gyro_raw_y = (int16_t)(-7 * i);
+		samples[i].temp_raw = 1200;
+	}
+
+	/* One lost sample and a long pause, both need absolute records */
+	samples[70].seq += 1;
+	samples[80].timestamp_us += 100000;
+	for (uint16_t i = 71; i < TEST_NUM_SAMPLES; i++)
+	{
+		samples[i].seq += 1;
+		samples[i].timestamp_us += (i > 80) ? 100000 : 0;
+	}
+}
+
+static bool test_write_log(void)
+{
+	imu_log_writer_handle_t writer = imu_log_writer_init();
+	imu_log_writer_cfg_t cfg = {
+		.buf = buf,
+		.buf_size = sizeof(buf),
+		.func_flush = test_flush,
+	};
+	imu_log_header_t header;
+
+	memset(&header, 0, sizeof(header));
+	header.regs.who_am_i = 0x68;
+	header.regs.gyro_config = 0x18;
+	header.regs.accel_config = 0x10;
+	header.sample_period_us = 5000.0f;
+
+	file = fopen(TEST_PATH, "wb");
+	if ((writer == NULL) || (file == NULL) || (imu_log_writer_set_config(writer, cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_log_writer_config(writer) != ERR_CODE_SUCCESS) || (imu_log_writer_start(writer, &header) != ERR_CODE_SUCCESS))
+	{
+		return false;
+	}
+
+	for (uint16_t i = 0; i < TEST_NUM_SAMPLES; i++)
+	{
+		TEST_ASSERT(imu_log_writer_write(writer, &samples[i], IMU_CHANNEL_ACCEL | IMU_CHANNEL_TEMP | IMU_CHANNEL_GYRO) == ERR_CODE_SUCCESS);
+	}
+
+	TEST_ASSERT(imu_log_writer_flush(writer) == ERR_CODE_SUCCESS);
+	fclose(file);
+	free(writer);
+
+	return true;
+}
+
+static imu_log_reader_handle_t test_open_log(void)
+{
+	imu_log_reader_handle_t reader = imu_log_reader_init();
+	imu_log_reader_cfg_t cfg = {
+		.path = TEST_PATH,
+	};
+
+	if ((reader == NULL) || (imu_log_reader_set_config(reader, cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_log_reader_config(reader) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	return reader;
+}
+
+static void test_log_range_direct(void)
+{
+	imu_log_reader_handle_t reader = test_open_log();
+	imu_sample_t sample;
+	uint8_t channels;
+	bool end;
+
+	TEST_ASSERT(reader != NULL);
+	if (reader == NULL) {
+		return;
+	}
+
+	/* Every sample comes back tagged with the range it was recorded in */
+	for (uint16_t i = 0; i < TEST_NUM_SAMPLES; i++)
+	{
+		TEST_ASSERT(imu_log_reader_next(reader, &sample, &channels, &end) == ERR_CODE_SUCCESS);
+		TEST_ASSERT(!end);
+		TEST_ASSERT(sample.seq == samples[i].seq);
+		TEST_ASSERT(sample.timestamp_us == samples[i].timestamp_us);
+		TEST_ASSERT(sample.accel_range == samples[i].accel_range);
+		TEST_ASSERT(sample.gyro_range == samples[i].gyro_range);
+		TEST_ASSERT(sample.accel_raw_x == samples[i].accel_raw_x);
+		TEST_ASSERT(sample.gyro_raw_y == samples[i].gyro_raw_y);
+	}
+
+	TEST_ASSERT(imu_log_reader_next(reader, &sample, &channels, &end) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(end);
+
+	imu_log_reader_deinit(reader);
+}
+
+static void test_log_range_replay(void)
+{
+	imu_log_reader_handle_t reader = test_open_log();
+	imu_bus_func_t func;
+	uint8_t status, frame[14], gyro_config;
+
+	TEST_ASSERT(reader != NULL);
+	if (reader == NULL) {
+		return;
+	}
+
+	TEST_ASSERT(imu_bus_bind(0, imu_log_reader_get_ops(), imu_log_reader_get_ctx(reader, IMU_LOG_PORT_MPU), &func) == ERR_CODE_SUCCESS);
+
+	/* The range register follows the sample the replay serves */
+	for (uint16_t i = 0; i < TEST_NUM_SAMPLES; i++)
+	{
+		TEST_ASSERT(func.read_bytes(TEST_REG_INT_STATUS, &status, 1, 10) == ERR_CODE_SUCCESS);
+		TEST_ASSERT(status & 0x01);
+		TEST_ASSERT(func.read_bytes(TEST_REG_ACCEL_XOUT_H, frame, sizeof(frame), 10) == ERR_CODE_SUCCESS);
+		TEST_ASSERT((int16_t)((frame[0] << 8) | frame[1]) == samples[i].accel_raw_x);
+		TEST_ASSERT(func.read_bytes(TEST_REG_GYRO_CONFIG, &gyro_config, 1, 10) == ERR_CODE_SUCCESS);
+		TEST_ASSERT(((gyro_config >> 3) & 0x03) == samples[i].gyro_range);
+	}
+
+	imu_bus_unbind(0);
+	imu_log_reader_deinit(reader);
+}
+
+/* Record a live IMU, return the number of samples */
+static uint32_t test_record(void)
+{
+	imu_sim_handle_t sim;
+	imu_sim_signal_t signal = test_signal_still();
+	imu_log_writer_handle_t writer = imu_log_writer_init();
+	imu_log_writer_cfg_t cfg = {
+		.buf = buf,
+		.buf_size = sizeof(buf),
+		.func_flush = test_flush,
+	};
+	imu_log_header_t header;
+	bool data_ready;
+	uint32_t num = 0;
+
+	signal.gyro_offset_dps[0] = 1.5f;
+	imu_handle_t live = test_setup(1, IMU_SIM_CHIP_MPU6050, signal, &sim);
+
+	file = fopen(TEST_RECORD_PATH, "wb");
+	if ((live == NULL) || (writer == NULL) || (file == NULL) ||
+	        (imu_set_accel_bias(live, 20, -30, 40) != ERR_CODE_SUCCESS) ||
+	        (imu_set_gyro_bias(live, 98, -5, 7) != ERR_CODE_SUCCESS) ||
+	        (imu_log_header_from_imu(live, &header) != ERR_CODE_SUCCESS) ||
+	        (imu_log_writer_set_config(writer, cfg) != ERR_CODE_SUCCESS) || (imu_log_writer_config(writer) != ERR_CODE_SUCCESS) ||
+	        (imu_log_writer_start(writer, &header) != ERR_CODE_SUCCESS))
+	{
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < TEST_RECORD_POLLS; i++)
+	{
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_poll_sample(live, &recorded[num], &data_ready) == ERR_CODE_SUCCESS);
+		if (!data_ready)
+		{
+			continue;
+		}
+
+		TEST_ASSERT(imu_log_writer_write(writer, &recorded[num], IMU_CHANNEL_ACCEL | IMU_CHANNEL_TEMP | IMU_CHANNEL_GYRO) == ERR_CODE_SUCCESS);
+		TEST_ASSERT(imu_scale_sample(live, &recorded[num], &recorded_scale[num]) == ERR_CODE_SUCCESS);
+		num++;
+	}
+
+	TEST_ASSERT(imu_log_writer_flush(writer) == ERR_CODE_SUCCESS);
+	fclose(file);
+	free(writer);
+	free(live);
+
+	return num;
+}
+
+static void test_log_record_replay(void)
+{
+	uint32_t num = test_record();
+	imu_log_reader_cfg_t reader_cfg = {
+		.path = TEST_RECORD_PATH,
+	};
+	imu_log_reader_handle_t reader = imu_log_reader_init();
+	imu_log_header_t header;
+	imu_bus_func_t func;
+	imu_cfg_t cfg;
+	imu_sample_t sample;
+	imu_sample_scale_t scale;
+	bool data_ready;
+
+	TEST_ASSERT(num > 0);
+	TEST_ASSERT(reader != NULL);
+	if ((num == 0) || (reader == NULL)) {
+		return;
+	}
+
+	TEST_ASSERT(imu_log_reader_set_config(reader, reader_cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_log_reader_config(reader) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_log_reader_get_header(reader, &header) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(header.gyro_bias_x == 98);
+	TEST_ASSERT(imu_bus_bind(2, imu_log_reader_get_ops(), imu_log_reader_get_ctx(reader, IMU_LOG_PORT_MPU), &func) == ERR_CODE_SUCCESS);
+
+	/* The unchanged IMU runs on the recording, with the recorded calibration */
+	imu_handle_t replay = imu_init();
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.mpu6050_read_bytes = func.read_bytes;
+	cfg.mpu6050_write_bytes = func.write_bytes;
+	cfg.func_delay = imu_log_reader_delay;
+	cfg.func_get_time_us = func.get_time_us;
+	TEST_ASSERT(replay != NULL);
+	TEST_ASSERT(imu_set_config(replay, cfg) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_config(replay) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_set_accel_bias(replay, header.accel_bias_x, header.accel_bias_y, header.accel_bias_z) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_set_gyro_bias(replay, header.gyro_bias_x, header.gyro_bias_y, header.gyro_bias_z) == ERR_CODE_SUCCESS);
+
+	/* Every recorded sample comes back bit exact, scaled the same way */
+	for (uint32_t i = 0; i < num; i++)
+	{
+		TEST_ASSERT(imu_poll_sample(replay, &sample, &data_ready) == ERR_CODE_SUCCESS);
+		TEST_ASSERT(data_ready);
+		TEST_ASSERT(sample.timestamp_us == recorded[i].timestamp_us);
+		TEST_ASSERT(sample.accel_raw_z == recorded[i].accel_raw_z);
+		TEST_ASSERT(sample.gyro_raw_x == recorded[i].gyro_raw_x);
+		TEST_ASSERT(sample.temp_raw == recorded[i].temp_raw);
+		TEST_ASSERT(imu_scale_sample(replay, &sample, &scale) == ERR_CODE_SUCCESS);
+		TEST_ASSERT(scale.accel_z == recorded_scale[i].accel_z);
+		TEST_ASSERT(scale.gyro_x == recorded_scale[i].gyro_x);
+		TEST_ASSERT(scale.temp == recorded_scale[i].temp);
+	}
+
+	/* The end of the log is no new data */
+	TEST_ASSERT(imu_poll_sample(replay, &sample, &data_ready) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(!data_ready);
+
+	imu_bus_unbind(2);
+	imu_log_reader_deinit(reader);
+	free(replay);
+}
+
+int main(void)
+{
+	test_make_samples();
+	if (!test_write_log())
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_log_range_direct);
+	TEST_RUN(test_log_range_replay);
+	TEST_RUN(test_log_record_replay);
+
+	remove(TEST_PATH);
+	remove(TEST_RECORD_PATH);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,126 @@
+#include "stdlib.h"
+#include "math.h"
+
+#include "test.h"
+#include "imu_preint/imu_preint.h"
+
+#define TEST_RATE_HZ 				200.0f
+#define TEST_PERIOD_US 				5000
+#define TEST_NUM_SAMPLES 			200 		/*!< One second */
+#define TEST_RATE_DPS 				90.0f
+#define TEST_ACCEL_DENSITY 			0.01f
+
+static imu_sample_scale_t samples[TEST_NUM_SAMPLES];
+
+static imu_preint_handle_t test_preint_setup(float gyro_density, float accel_density)
+{
+	imu_preint_handle_t handle = imu_preint_init();
+	imu_preint_cfg_t cfg;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.sample_rate_hz = TEST_RATE_HZ;
+	cfg.noise.gyro_noise_density = gyro_density;
+	cfg.noise.accel_noise_density = accel_density;
+
+	if ((handle == NULL) || (imu_preint_set_config(handle, cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_preint_config(handle) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+/* Device turning about z at a constant rate, 1 g on z */
+static void test_make_samples(float rate_dps, bool timed)
+{
+	memset(samples, 0, sizeof(samples));
+
+	for (uint16_t i = 0; i < TEST_NUM_SAMPLES; i++)
+	{
+		samples[i].seq = 100 + i;
+		samples[i].timestamp_us = timed ? 1000000 + (uint64_t)TEST_PERIOD_US * i : 0;
+		samples[i].accel_z = 1.0f;
+		samples[i].gyro_z = rate_dps;
+	}
+}
+
+static void test_preint_rotation(void)
+{
+	imu_preint_handle_t handle = test_preint_setup(1e-3f, TEST_ACCEL_DENSITY);
+	imu_preint_result_t result;
+
+	test_make_samples(TEST_RATE_DPS, true);
+	TEST_ASSERT(handle != NULL);
+	TEST_ASSERT(imu_preint_write(handle, samples, TEST_NUM_SAMPLES) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_preint_read(handle, &result) == ERR_CODE_SUCCESS);
+
+	/* First sample has no predecessor and is held for one nominal period */
+	TEST_ASSERT(result.num_samples == TEST_NUM_SAMPLES);
+	TEST_ASSERT(result.gaps == 0);
+	TEST_ASSERT(fabsf(result.dt_s - 1.0f) < 1e-4f);
+	TEST_ASSERT(fabsf(result.delta_angle[2] - 3.14159265f / 2.0f) < 1e-3f);
+	TEST_ASSERT(fabsf(result.delta_angle[0]) < 1e-5f);
+	TEST_ASSERT(fabsf(result.delta_angle[1]) < 1e-5f);
+
+	/* Specific force along the rotation axis is not turned */
+	TEST_ASSERT(fabsf(result.delta_v[2] - 9.80665f) < 1e-3f);
+	TEST_ASSERT(fabsf(result.delta_v[0]) < 1e-4f);
+	TEST_ASSERT(fabsf(result.delta_v[1]) < 1e-4f);
+
+	free(handle);
+}
+
+static void test_preint_cov(void)
+{
+	imu_preint_handle_t handle = test_preint_setup(0, TEST_ACCEL_DENSITY);
+	imu_preint_result_t result;
+
+	test_make_samples(0, true);
+	TEST_ASSERT(handle != NULL);
+	TEST_ASSERT(imu_preint_write(handle, samples, TEST_NUM_SAMPLES) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_preint_read(handle, &result) == ERR_CODE_SUCCESS);
+
+	/* Velocity random walk: variance grows with density^2 * time */
+	float expected = TEST_ACCEL_DENSITY * TEST_ACCEL_DENSITY * result.dt_s;
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		TEST_ASSERT(fabsf(result.cov[3 + i][3 + i] - expected) < 0.01f * expected);
+		TEST_ASSERT(result.cov[i][i] == 0);
+	}
+
+	free(handle);
+}
+
+static void test_preint_untimed(void)
+{
+	imu_preint_handle_t handle = test_preint_setup(1e-3f, TEST_ACCEL_DENSITY);
+	imu_preint_result_t result;
+	imu_preint_status_t status;
+
+	/* No timestamps, contiguous samples use the nominal period without a gap */
+	test_make_samples(TEST_RATE_DPS, false);
+	TEST_ASSERT(handle != NULL);
+	TEST_ASSERT(imu_preint_write(handle, samples, TEST_NUM_SAMPLES) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_preint_read(handle, &result) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(result.gaps == 0);
+	TEST_ASSERT(fabsf(result.dt_s - 1.0f) < 1e-4f);
+	TEST_ASSERT(fabsf(result.delta_angle[2] - 3.14159265f / 2.0f) < 1e-3f);
+
+	/* A lost sample is still a gap */
+	samples[0].seq = samples[TEST_NUM_SAMPLES - 1].seq + 2;
+	TEST_ASSERT(imu_preint_write(handle, samples, 1) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_preint_get_status(handle, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.gaps == 1);
+
+	free(handle);
+}
+
+int main(void)
+{
+	TEST_RUN(test_preint_rotation);
+	TEST_RUN(test_preint_cov);
+	TEST_RUN(test_preint_untimed);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,160 @@
+#include "stdlib.h"
+
+#include "test.h"
+#include "imu_sched/imu_sched.h"
+
+#define TEST_NUM_IMU 				2
+#define TEST_NUM_TICKS 				1000 		/*!< One second */
+#define TEST_BUS_CLOCK_HZ 			400000
+
+static imu_handle_t handle[TEST_NUM_IMU];
+static uint32_t published[TEST_NUM_IMU][4];
+static uint32_t first_seq[TEST_NUM_IMU], last_seq[TEST_NUM_IMU];
+static uint32_t num_published[TEST_NUM_IMU], bad_seq;
+
+static void test_publish(uint8_t imu_index, uint8_t channels, const imu_sample_t *sample)
+{
+	/* seq counts the reads of one IMU */
+	if (num_published[imu_index] == 0) {
+		first_seq[imu_index] = sample->seq;
+	} else if (sample->seq != last_seq[imu_index] + 1) {
+		bad_seq++;
+	}
+	last_seq[imu_index] = sample->seq;
+	num_published[imu_index]++;
+
+	published[imu_index][0] += (channels & IMU_CHANNEL_ACCEL) ? 1 : 0;
+	published[imu_index][1] += (channels & IMU_CHANNEL_GYRO) ? 1 : 0;
+	published[imu_index][2] += (channels & IMU_CHANNEL_TEMP) ? 1 : 0;
+	published[imu_index][3] += (channels & IMU_CHANNEL_MAG) ? 1 : 0;
+}
+
+static imu_sched_handle_t test_sched_setup(imu_sched_cfg_t cfg)
+{
+	imu_sched_handle_t sched = imu_sched_init();
+
+	cfg.tick_rate_hz = 1000.0f;
+	cfg.bus_clock_hz = TEST_BUS_CLOCK_HZ;
+	cfg.func_publish = test_publish;
+
+	if ((sched == NULL) || (imu_sched_set_config(sched, cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_sched_config(sched) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	for (uint8_t i = 0; i < TEST_NUM_IMU; i++)
+	{
+		if (imu_sched_add_imu(sched, handle[i]) != ERR_CODE_SUCCESS)
+		{
+			return NULL;
+		}
+	}
+
+	memset(published, 0, sizeof(published));
+	memset(num_published, 0, sizeof(num_published));
+	bad_seq = 0;
+
+	return sched;
+}
+
+static void test_sched_rates(void)
+{
+	imu_sched_cfg_t cfg = {
+		.accel_rate_hz = 500.0f,
+		.gyro_rate_hz = 1000.0f,
+		.temp_rate_hz = 10.0f,
+	};
+	imu_sched_handle_t sched = test_sched_setup(cfg);
+	imu_sched_stats_t stats;
+	imu_sample_t sample;
+
+	TEST_ASSERT(sched != NULL);
+
+	for (uint32_t i = 0; i < TEST_NUM_TICKS; i++)
+	{
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_sched_tick(sched) == ERR_CODE_SUCCESS);
+	}
+
+	for (uint8_t i = 0; i < TEST_NUM_IMU; i++)
+	{
+		TEST_ASSERT(published[i][0] == 500);
+		TEST_ASSERT(published[i][1] == 1000);
+		TEST_ASSERT(published[i][2] == 10);
+		TEST_ASSERT(published[i][3] == 0);
+		TEST_ASSERT(last_seq[i] - first_seq[i] + 1 == TEST_NUM_TICKS);
+	}
+	TEST_ASSERT(bad_seq == 0);
+
+	/* Every tick is one burst per IMU: 14 bytes with the accelerometer,
+	 * the 6 gyroscope bytes on their own otherwise.
+	 */
+	TEST_ASSERT(imu_sched_get_stats(sched, &stats) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(stats.ticks == TEST_NUM_TICKS);
+	TEST_ASSERT(stats.errors == 0);
+	TEST_ASSERT(stats.transactions == TEST_NUM_IMU * TEST_NUM_TICKS);
+	TEST_ASSERT(stats.bytes == TEST_NUM_IMU * (500 * 14 + 500 * 6));
+	TEST_ASSERT(stats.bus_utilisation > 0.59f);
+	TEST_ASSERT(stats.bus_utilisation < 0.61f);
+
+	/* Scheduled reads stay out of the latest sample */
+	TEST_ASSERT(imu_get_latest_sample(handle[0], &sample, NULL) != ERR_CODE_SUCCESS);
+
+	free(sched);
+}
+
+static void test_sched_mag_phase(void)
+{
+	imu_sched_cfg_t cfg = {
+		.accel_rate_hz = 100.0f,
+		.mag_rate_hz = 100.0f,
+	};
+	imu_sched_handle_t sched = test_sched_setup(cfg);
+	imu_sched_stats_t stats;
+
+	TEST_ASSERT(sched != NULL);
+
+	/* The magnetometer is due half a period after the accelerometer, never
+	 * in the same tick. Without a magnetometer it costs no bus time.
+	 */
+	for (uint32_t i = 0; i < TEST_NUM_TICKS; i++)
+	{
+		uint32_t before = published[0][0] + published[0][3];
+
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_sched_tick(sched) == ERR_CODE_SUCCESS);
+
+		uint32_t due = published[0][0] + published[0][3] - before;
+		TEST_ASSERT(due == ((((i % 10) == 0) || ((i % 10) == 5)) ? 1 : 0));
+	}
+
+	TEST_ASSERT(published[0][0] == 100);
+	TEST_ASSERT(published[0][3] == 100);
+
+	TEST_ASSERT(imu_sched_get_stats(sched, &stats) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(stats.transactions == TEST_NUM_IMU * 100);
+	TEST_ASSERT(stats.bytes == TEST_NUM_IMU * 100 * 6);
+
+	free(sched);
+}
+
+int main(void)
+{
+	imu_sim_handle_t sim;
+
+	for (uint8_t i = 0; i < TEST_NUM_IMU; i++)
+	{
+		handle[i] = test_setup(i, IMU_SIM_CHIP_MPU6050, test_signal_still(), &sim);
+		if (handle[i] == NULL)
+		{
+			printf("setup failed\n");
+			return 1;
+		}
+	}
+
+	TEST_RUN(test_sched_rates);
+	TEST_RUN(test_sched_mag_phase);
+
+	return TEST_RESULT();
+}
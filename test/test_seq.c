@@ -0,0 +1,101 @@
+#include "test.h"
+
+#define TEST_PERIOD_US 				5000.0f 	/*!< 200 Hz output data rate of the default configuration */
+
+static imu_handle_t handle;
+static imu_sim_handle_t sim;
+
+/* Poll once per period until a sample arrives */
+static bool test_next_sample(imu_sample_t *sample)
+{
+	bool data_ready = false;
+
+	for (uint8_t i = 0; (i < 4) && !data_ready; i++)
+	{
+		imu_sim_advance_us(TEST_PERIOD_US);
+		TEST_ASSERT(imu_poll_sample(handle, sample, &data_ready) == ERR_CODE_SUCCESS);
+	}
+
+	return data_ready;
+}
+
+static void test_seq_consecutive(void)
+{
+	imu_sample_t sample;
+	uint32_t prev_seq;
+
+	TEST_ASSERT(test_next_sample(&sample));
+	prev_seq = sample.seq;
+
+	for (uint8_t i = 0; i < 50; i++)
+	{
+		TEST_ASSERT(test_next_sample(&sample));
+		TEST_ASSERT(sample.seq == prev_seq + 1);
+		prev_seq = sample.seq;
+	}
+}
+
+static void test_seq_duplicate_read(void)
+{
+	imu_sample_t sample;
+	bool data_ready;
+
+	TEST_ASSERT(test_next_sample(&sample));
+
+	/* No new sample within the same period */
+	TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(data_ready == false);
+}
+
+static void test_seq_gap(void)
+{
+	imu_sample_t sample;
+	bool data_ready;
+
+	TEST_ASSERT(test_next_sample(&sample));
+	uint32_t prev_seq = sample.seq;
+
+	/* Four periods without a read, three samples are lost */
+	imu_sim_advance_us(4 * TEST_PERIOD_US);
+	TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(data_ready);
+	TEST_ASSERT(sample.seq == prev_seq + 4);
+
+	/* Back to consecutive numbers */
+	prev_seq = sample.seq;
+	TEST_ASSERT(test_next_sample(&sample));
+	TEST_ASSERT(sample.seq == prev_seq + 1);
+}
+
+static void test_seq_channel_read(void)
+{
+	imu_sample_t sample, channel, latest;
+
+	TEST_ASSERT(test_next_sample(&sample));
+
+	/* Channel reads count on their own and leave the latest sample alone */
+	imu_sim_advance_us(TEST_PERIOD_US);
+	TEST_ASSERT(imu_read_channels(handle, IMU_CHANNEL_ACCEL | IMU_CHANNEL_GYRO, &channel) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_get_latest_sample(handle, &latest, NULL) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(latest.seq == sample.seq);
+
+	TEST_ASSERT(test_next_sample(&latest));
+	TEST_ASSERT(latest.seq == sample.seq + 2);
+}
+
+int main(void)
+{
+	handle = test_setup(0, IMU_SIM_CHIP_MPU6050, test_signal_still(), &sim);
+	if (handle == NULL)
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_seq_consecutive);
+	TEST_RUN(test_seq_duplicate_read);
+	TEST_RUN(test_seq_gap);
+	TEST_RUN(test_seq_channel_read);
+
+	return TEST_RESULT();
+}
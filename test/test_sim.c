@@ -0,0 +1,191 @@
+#include "test.h"
+#include "mpu6050/mpu6050_register.h"
+#include "ak8963/ak8963_register.h"
+
+#define TEST_LATENCY_US 			50.0f
+#define TEST_BYTE_TIME_US 			10.0f
+#define TEST_ACCEL_1G_8G 			4096
+#define TEST_MPU6050_FIFO_SIZE 		1024
+#define TEST_FIFO_FRAME_SIZE 		12 			/*!< Accelerometer and gyroscope */
+
+static uint32_t data_ready_calls;
+
+static void test_data_ready(void)
+{
+	data_ready_calls++;
+}
+
+static imu_sim_handle_t test_sim_setup(uint8_t slot, imu_sim_chip_t chip, imu_bus_func_t *func)
+{
+	imu_sim_handle_t sim = imu_sim_init();
+	imu_sim_cfg_t cfg;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.chip = chip;
+	cfg.seed = 1 + slot;
+	cfg.latency_us = TEST_LATENCY_US;
+	cfg.byte_time_us = TEST_BYTE_TIME_US;
+	cfg.signal = test_signal_still();
+	cfg.signal.mag_offset_ut[0] = 30.0f;
+	cfg.signal.mag_offset_ut[2] = -45.0f;
+	cfg.func_data_ready = test_data_ready;
+
+	if ((sim == NULL) || (imu_sim_set_config(sim, cfg) != ERR_CODE_SUCCESS) || (imu_sim_config(sim) != ERR_CODE_SUCCESS) ||
+	        (imu_bus_bind(slot, imu_sim_get_ops(), sim, func) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	return sim;
+}
+
+static void test_write_reg(imu_bus_func_t *func, uint8_t reg, uint8_t value)
+{
+	TEST_ASSERT(func->write_bytes(reg, &value, 1, 10) == ERR_CODE_SUCCESS);
+}
+
+static uint8_t test_read_reg(imu_bus_func_t *func, uint8_t reg)
+{
+	uint8_t value = 0;
+
+	TEST_ASSERT(func->read_bytes(reg, &value, 1, 10) == ERR_CODE_SUCCESS);
+
+	return value;
+}
+
+static void test_sim_reset(void)
+{
+	imu_bus_func_t func;
+	imu_sim_stats_t stats;
+
+	TEST_ASSERT(test_sim_setup(0, IMU_SIM_CHIP_MPU6050, &func) != NULL);
+	TEST_ASSERT(test_read_reg(&func, MPU6050_WHO_AM_I) == 0x68);
+	TEST_ASSERT(test_sim_setup(1, IMU_SIM_CHIP_MPU6500, &func) != NULL);
+	TEST_ASSERT(test_read_reg(&func, MPU6050_WHO_AM_I) == 0x70);
+
+	/* Sleeping after power on, no samples */
+	imu_sim_handle_t sim = test_sim_setup(2, IMU_SIM_CHIP_MPU6050, &func);
+	TEST_ASSERT(test_read_reg(&func, MPU6050_PWR_MGMT_1) == 0x40);
+	imu_sim_advance_us(100000);
+	imu_sim_get_stats(sim, &stats);
+	TEST_ASSERT(stats.samples == 0);
+}
+
+static void test_sim_rate(void)
+{
+	imu_bus_func_t func;
+	imu_sim_stats_t stats;
+	uint8_t frame[14];
+
+	imu_sim_handle_t sim = test_sim_setup(3, IMU_SIM_CHIP_MPU6050, &func);
+	TEST_ASSERT(sim != NULL);
+
+	/* DLPF on, 1 kHz / (1 + 9) */
+	test_write_reg(&func, MPU6050_CONFIG, 0x03);
+	test_write_reg(&func, MPU6050_SMPLRT_DIV, 9);
+	test_write_reg(&func, MPU6050_ACCEL_CONFIG, 0x10);
+	test_write_reg(&func, MPU6050_INT_ENABLE, 0x01);
+	test_write_reg(&func, MPU6050_PWR_MGMT_1, 0x00);
+
+	imu_sim_reset_stats(sim);
+	data_ready_calls = 0;
+	imu_sim_advance_us(1000000);
+
+	/* Nobody read the samples, every one after the first was an overrun */
+	imu_sim_get_stats(sim, &stats);
+	TEST_ASSERT(stats.samples == 100);
+	TEST_ASSERT(stats.overruns == 99);
+	TEST_ASSERT(data_ready_calls == 100);
+
+	/* Reading INT_STATUS clears data ready */
+	TEST_ASSERT(test_read_reg(&func, MPU6050_INT_STATUS) & 0x01);
+	TEST_ASSERT((test_read_reg(&func, MPU6050_INT_STATUS) & 0x01) == 0);
+
+	TEST_ASSERT(func.read_bytes(MPU6050_ACCEL_XOUT_H, frame, sizeof(frame), 10) == ERR_CODE_SUCCESS);
+	int16_t accel_z = (int16_t)((frame[4] << 8) | frame[5]);
+	TEST_ASSERT((accel_z > TEST_ACCEL_1G_8G - 100) && (accel_z < TEST_ACCEL_1G_8G + 100));
+
+	/* Every transaction costs the latency plus the data bytes */
+	imu_sim_reset_stats(sim);
+	uint64_t start_us = imu_sim_get_time_us();
+	TEST_ASSERT(func.read_bytes(MPU6050_ACCEL_XOUT_H, frame, sizeof(frame), 10) == ERR_CODE_SUCCESS);
+	imu_sim_get_stats(sim, &stats);
+	TEST_ASSERT(stats.transactions == 1);
+	TEST_ASSERT(stats.bytes == sizeof(frame));
+	TEST_ASSERT(stats.bus_time_us == (uint64_t)(TEST_LATENCY_US + sizeof(frame) * TEST_BYTE_TIME_US));
+	TEST_ASSERT(imu_sim_get_time_us() - start_us == stats.bus_time_us);
+}
+
+static void test_sim_fifo_overflow(void)
+{
+	imu_bus_func_t func;
+	imu_sim_stats_t stats;
+	uint8_t count[2];
+
+	imu_sim_handle_t sim = test_sim_setup(4, IMU_SIM_CHIP_MPU6050, &func);
+	TEST_ASSERT(sim != NULL);
+
+	test_write_reg(&func, MPU6050_CONFIG, 0x03);
+	test_write_reg(&func, MPU6050_SMPLRT_DIV, 0);
+	test_write_reg(&func, MPU6050_FIFO_EN, 0x78);
+	test_write_reg(&func, MPU6050_USER_CTRL, 0x40);
+	test_write_reg(&func, MPU6050_PWR_MGMT_1, 0x00);
+
+	/* 12 byte frames at 1 kHz fill 1024 bytes in 86 ms */
+	imu_sim_reset_stats(sim);
+	imu_sim_advance_us(80000);
+	imu_sim_get_stats(sim, &stats);
+	TEST_ASSERT(stats.fifo_overflows == 0);
+	TEST_ASSERT(func.read_bytes(MPU6050_FIFO_COUNTH, count, 2, 10) == ERR_CODE_SUCCESS);
+	TEST_ASSERT((uint32_t)((count[0] << 8) | count[1]) == stats.samples * TEST_FIFO_FRAME_SIZE);
+
+	imu_sim_advance_us(20000);
+	imu_sim_get_stats(sim, &stats);
+	TEST_ASSERT(stats.fifo_overflows > 0);
+	TEST_ASSERT(test_read_reg(&func, MPU6050_INT_STATUS) & 0x10);
+	TEST_ASSERT(func.read_bytes(MPU6050_FIFO_COUNTH, count, 2, 10) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(((count[0] << 8) | count[1]) == TEST_MPU6050_FIFO_SIZE);
+}
+
+static void test_sim_ak8963(void)
+{
+	imu_bus_func_t func;
+	imu_sim_stats_t stats;
+	uint8_t data[7];
+
+	imu_sim_handle_t sim = test_sim_setup(5, IMU_SIM_CHIP_AK8963, &func);
+	TEST_ASSERT(sim != NULL);
+	TEST_ASSERT(test_read_reg(&func, AK8963_ASAX) == 128);
+
+	/* Continuous measurement 2, 100 Hz in 16 bit */
+	imu_sim_reset_stats(sim);
+	test_write_reg(&func, AK8963_CNTL, 0x16);
+	imu_sim_advance_us(1000000);
+	imu_sim_get_stats(sim, &stats);
+	TEST_ASSERT((stats.samples >= 99) && (stats.samples <= 100));
+
+	/* Output is little endian, 0.15 uT per LSB, ST2 ends the read */
+	TEST_ASSERT(test_read_reg(&func, AK8963_ST1) & 0x01);
+	TEST_ASSERT(func.read_bytes(AK8963_XOUT_L, data, sizeof(data), 10) == ERR_CODE_SUCCESS);
+	TEST_ASSERT((int16_t)((data[1] << 8) | data[0]) == 200);
+	TEST_ASSERT((int16_t)((data[5] << 8) | data[4]) == -300);
+	TEST_ASSERT(data[6] == 0x10);
+
+	/* A single measurement returns to power down */
+	test_write_reg(&func, AK8963_CNTL, 0x11);
+	imu_sim_reset_stats(sim);
+	imu_sim_advance_us(100000);
+	imu_sim_get_stats(sim, &stats);
+	TEST_ASSERT(stats.samples == 1);
+	TEST_ASSERT(test_read_reg(&func, AK8963_CNTL) == 0x10);
+}
+
+int main(void)
+{
+	TEST_RUN(test_sim_reset);
+	TEST_RUN(test_sim_rate);
+	TEST_RUN(test_sim_fifo_overflow);
+	TEST_RUN(test_sim_ak8963);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,143 @@
+#include "test.h"
+#include "mpu6500/mpu6500.h"
+#include "mpu6500/mpu6500_register.h"
+
+#define TEST_READ_FLAG 				0x80
+#define TEST_USER_CTRL_I2C_IF_DIS 	0x10
+#define TEST_ACCEL_1G_8G 			4096
+
+static imu_bus_func_t func;
+static uint32_t bus_clock_hz, clock_switches, bad_reads, bad_writes;
+static uint8_t spi;
+
+static void test_set_bus_clock(uint32_t clock_hz)
+{
+	bus_clock_hz = clock_hz;
+	clock_switches++;
+}
+
+/* SPI reads carry the read flag and run at the data clock */
+static err_code_t test_read_bytes(uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	if (spi && (!(reg_addr & TEST_READ_FLAG) || (bus_clock_hz != MPU6500_SPI_DATA_CLOCK_HZ))) {
+		bad_reads++;
+	}
+	if (!spi && (reg_addr & TEST_READ_FLAG)) {
+		bad_reads++;
+	}
+
+	return func.read_bytes(reg_addr, buf, len, timeout_ms);
+}
+
+/* Register writes never exceed the configuration clock */
+static err_code_t test_write_bytes(uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	if ((reg_addr & TEST_READ_FLAG) || (spi && (bus_clock_hz != MPU6500_SPI_CONFIG_CLOCK_HZ))) {
+		bad_writes++;
+	}
+
+	return func.write_bytes(reg_addr, buf, len, timeout_ms);
+}
+
+static err_code_t test_init(uint8_t slot, mpu6500_dev_t *dev, mpu6500_transport_t transport)
+{
+	imu_sim_handle_t sim = imu_sim_init();
+	imu_sim_cfg_t sim_cfg;
+
+	memset(&sim_cfg, 0, sizeof(sim_cfg));
+	sim_cfg.chip = IMU_SIM_CHIP_MPU6500;
+	sim_cfg.spi = (transport == MPU6500_TRANSPORT_SPI);
+	sim_cfg.seed = 1 + slot;
+	sim_cfg.signal = test_signal_still();
+
+	if ((sim == NULL) || (imu_sim_set_config(sim, sim_cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_sim_config(sim) != ERR_CODE_SUCCESS) || (imu_bus_bind(slot, imu_sim_get_ops(), sim, &func) != ERR_CODE_SUCCESS))
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	spi = sim_cfg.spi;
+	bus_clock_hz = 0;
+	clock_switches = 0;
+	bad_reads = 0;
+	bad_writes = 0;
+	memset(dev, 0, sizeof(*dev));
+
+	return mpu6500_init(dev, test_read_bytes, test_write_bytes, imu_sim_delay,
+	                    MPU6500_CLKSEL_AUTO, MPU6500_41ACEL_42GYRO_BW_HZ, MPU6500_DISABLE_SLEEP_MODE,
+	                    MPU6500_AFS_SEL_8G, MPU6500_GFS_SEL_2000, transport, test_set_bus_clock);
+}
+
+static void test_spi_init(void)
+{
+	mpu6500_dev_t dev;
+	uint8_t value;
+	int16_t accel[3], gyro[3], temp;
+
+	TEST_ASSERT(test_init(0, &dev, MPU6500_TRANSPORT_SPI) == ERR_CODE_SUCCESS);
+
+	/* The I2C interface stays off after the reset, bypass is not enabled */
+	TEST_ASSERT(func.read_bytes(MPU6500_USER_CTRL | TEST_READ_FLAG, &value, 1, 10) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(value & TEST_USER_CTRL_I2C_IF_DIS);
+	TEST_ASSERT(func.read_bytes(MPU6500_INT_PIN_CFG | TEST_READ_FLAG, &value, 1, 10) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(value == 0x20);
+
+	imu_sim_advance_us(10000);
+	TEST_ASSERT(mpu6500_get_motion_raw(&dev, test_read_bytes, &accel[0], &accel[1], &accel[2], &temp,
+	                                   &gyro[0], &gyro[1], &gyro[2]) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(accel[2] > TEST_ACCEL_1G_8G - 100);
+	TEST_ASSERT(accel[2] < TEST_ACCEL_1G_8G + 100);
+	TEST_ASSERT(bad_reads == 0);
+	TEST_ASSERT(bad_writes == 0);
+}
+
+static void test_spi_clock_switch(void)
+{
+	mpu6500_dev_t dev;
+	int16_t x, y, z;
+
+	TEST_ASSERT(test_init(1, &dev, MPU6500_TRANSPORT_SPI) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(bad_reads == 0);
+	TEST_ASSERT(bad_writes == 0);
+
+	/* Back to back reads stay at the data clock, one switch per direction change */
+	uint32_t switches = clock_switches;
+	for (uint8_t i = 0; i < 10; i++)
+	{
+		TEST_ASSERT(mpu6500_get_accel_raw(&dev, test_read_bytes, &x, &y, &z) == ERR_CODE_SUCCESS);
+	}
+	TEST_ASSERT(clock_switches - switches <= 1);
+
+	switches = clock_switches;
+	TEST_ASSERT(mpu6500_set_smplrt_div(&dev, test_write_bytes, 9) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(mpu6500_get_gyro_raw(&dev, test_read_bytes, &x, &y, &z) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(clock_switches - switches == 2);
+	TEST_ASSERT(bad_reads == 0);
+	TEST_ASSERT(bad_writes == 0);
+}
+
+static void test_spi_i2c(void)
+{
+	mpu6500_dev_t dev;
+	uint8_t value;
+	int16_t x, y, z;
+
+	/* I2C transport leaves the read flag and the clock alone */
+	TEST_ASSERT(test_init(2, &dev, MPU6500_TRANSPORT_I2C) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(mpu6500_get_accel_raw(&dev, test_read_bytes, &x, &y, &z) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(clock_switches == 0);
+	TEST_ASSERT(bad_reads == 0);
+	TEST_ASSERT(bad_writes == 0);
+
+	TEST_ASSERT(func.read_bytes(MPU6500_INT_PIN_CFG, &value, 1, 10) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(value == 0x22);
+}
+
+int main(void)
+{
+	TEST_RUN(test_spi_init);
+	TEST_RUN(test_spi_clock_switch);
+	TEST_RUN(test_spi_i2c);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,203 @@
+#include "stdlib.h"
+#include "math.h"
+
+#include "test.h"
+
+#define TEST_LATENCY_US 			100.0f
+#define TEST_PERIOD_US 				5000.0f 	/*!< 200 Hz output data rate of the default configuration */
+#define TEST_NUM_POLLS 				1000
+#define TEST_LATENCY_BIN 			6 			/*!< 64 to 127 cycles, one cycle per microsecond */
+
+static imu_handle_t handle;
+static imu_sim_handle_t sim;
+static imu_bus_func_t func;
+static err_code_t fail_err;
+static bool fail_timeout;
+
+/* Sim time is the cycle counter, one cycle per microsecond */
+static uint32_t test_get_cycles(void)
+{
+	return (uint32_t)imu_sim_get_time_us();
+}
+
+/* Reads fail on request, a timeout uses up the whole timeout first */
+static err_code_t test_read_bytes(uint8_t reg_addr, uint8_t *buf, uint16_t len, uint32_t timeout_ms)
+{
+	if (fail_err != ERR_CODE_SUCCESS)
+	{
+		if (fail_timeout)
+		{
+			imu_sim_advance_us((uint64_t)timeout_ms * 1000);
+		}
+		return fail_err;
+	}
+
+	return func.read_bytes(reg_addr, buf, len, timeout_ms);
+}
+
+static imu_handle_t test_stats_setup(void)
+{
+	imu_sim_cfg_t sim_cfg;
+	imu_cfg_t cfg;
+
+	sim = imu_sim_init();
+	memset(&sim_cfg, 0, sizeof(sim_cfg));
+	sim_cfg.chip = IMU_SIM_CHIP_MPU6050;
+	sim_cfg.seed = 1;
+	sim_cfg.latency_us = TEST_LATENCY_US;
+	sim_cfg.signal = test_signal_still();
+
+	if ((sim == NULL) || (imu_sim_set_config(sim, sim_cfg) != ERR_CODE_SUCCESS) ||
+	        (imu_sim_config(sim) != ERR_CODE_SUCCESS) || (imu_bus_bind(0, imu_sim_get_ops(), sim, &func) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	imu_handle_t imu = imu_init();
+	if (imu == NULL)
+	{
+		return NULL;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.mpu6050_read_bytes = test_read_bytes;
+	cfg.mpu6050_write_bytes = func.write_bytes;
+	cfg.func_delay = imu_sim_delay;
+	cfg.func_get_time_us = imu_sim_get_time_us;
+	cfg.func_get_cycles = test_get_cycles;
+	cfg.cycles_per_us = 1;
+
+	if ((imu_set_config(imu, cfg) != ERR_CODE_SUCCESS) || (imu_config(imu) != ERR_CODE_SUCCESS))
+	{
+		return NULL;
+	}
+
+	return imu;
+}
+
+static void test_stats_config(void)
+{
+	imu_stats_t stats;
+
+	/* Configuration went through the counting transport */
+	TEST_ASSERT(imu_get_stats(handle, &stats) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(stats.write_transactions > 0);
+	TEST_ASSERT(stats.errors == 0);
+
+	/* Cleared counters are all zero */
+	imu_stats_t zero;
+	memset(&zero, 0, sizeof(zero));
+	TEST_ASSERT(imu_reset_stats(handle) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_get_stats(handle, &stats) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(memcmp(&stats, &zero, sizeof(stats)) == 0);
+}
+
+static void test_stats_poll(void)
+{
+	imu_stats_t stats;
+	imu_sample_t sample;
+	bool data_ready;
+	uint32_t ready = 0;
+
+	TEST_ASSERT(imu_reset_stats(handle) == ERR_CODE_SUCCESS);
+	uint64_t start_us = imu_sim_get_time_us();
+
+	for (uint32_t i = 0; i < TEST_NUM_POLLS; i++)
+	{
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+		ready += data_ready ? 1 : 0;
+	}
+
+	/* Bus latency stretches the run, every sample period in it was seen */
+	TEST_ASSERT(imu_get_stats(handle, &stats) == ERR_CODE_SUCCESS);
+	float expected = (float)(imu_sim_get_time_us() - start_us) / TEST_PERIOD_US;
+	TEST_ASSERT(fabsf((float)ready - expected) <= 1.0f);
+
+	/* Every poll reads INT_STATUS, a new sample adds the output registers */
+	TEST_ASSERT(stats.read_transactions == TEST_NUM_POLLS + ready);
+	TEST_ASSERT(stats.read_bytes == TEST_NUM_POLLS + 14 * ready);
+	TEST_ASSERT(stats.write_transactions == 0);
+	TEST_ASSERT(stats.stale_samples == TEST_NUM_POLLS - ready);
+	TEST_ASSERT(stats.duplicate_samples == 0);
+
+	/* Every read costs the bus latency */
+	TEST_ASSERT(stats.read_latency_hist[TEST_LATENCY_BIN] == stats.read_transactions);
+	TEST_ASSERT(stats.read_cycles_max == (uint32_t)TEST_LATENCY_US);
+}
+
+static void test_stats_duplicate(void)
+{
+	imu_stats_t stats;
+	int16_t x, y, z;
+
+	TEST_ASSERT(imu_reset_stats(handle) == ERR_CODE_SUCCESS);
+
+	/* A second read within the sample period returns the same sample */
+	TEST_ASSERT(imu_get_accel_raw(handle, &x, &y, &z) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_get_accel_raw(handle, &x, &y, &z) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_get_stats(handle, &stats) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(stats.duplicate_samples == 1);
+
+	/* One period later the output registers hold a new sample */
+	imu_sim_advance_us(10000);
+	TEST_ASSERT(imu_get_accel_raw(handle, &x, &y, &z) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_get_gyro_raw(handle, &x, &y, &z) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_get_stats(handle, &stats) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(stats.duplicate_samples == 1);
+	TEST_ASSERT(stats.read_transactions == 4);
+	TEST_ASSERT(stats.read_bytes == 4 * 6);
+}
+
+static void test_stats_errors(void)
+{
+	imu_stats_t stats;
+	int16_t x, y, z;
+
+	TEST_ASSERT(imu_reset_stats(handle) == ERR_CODE_SUCCESS);
+
+	/* Failures are counted per code in order of first occurrence */
+	fail_err = ERR_CODE_FAIL;
+	fail_timeout = false;
+	TEST_ASSERT(imu_get_accel_raw(handle, &x, &y, &z) != ERR_CODE_SUCCESS);
+	TEST_ASSERT(imu_get_accel_raw(handle, &x, &y, &z) != ERR_CODE_SUCCESS);
+
+	/* Only a failure that took the whole timeout is a timeout */
+	fail_err = ERR_CODE_NULL_PTR;
+	fail_timeout = true;
+	TEST_ASSERT(imu_get_accel_raw(handle, &x, &y, &z) != ERR_CODE_SUCCESS);
+
+	fail_err = ERR_CODE_SUCCESS;
+	TEST_ASSERT(imu_get_accel_raw(handle, &x, &y, &z) == ERR_CODE_SUCCESS);
+
+	TEST_ASSERT(imu_get_stats(handle, &stats) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(stats.read_transactions == 4);
+	TEST_ASSERT(stats.errors == 3);
+	TEST_ASSERT(stats.error_code[0] == ERR_CODE_FAIL);
+	TEST_ASSERT(stats.error_count[0] == 2);
+	TEST_ASSERT(stats.error_code[1] == ERR_CODE_NULL_PTR);
+	TEST_ASSERT(stats.error_count[1] == 1);
+	TEST_ASSERT(stats.error_count[2] == 0);
+	TEST_ASSERT(stats.error_other == 0);
+	TEST_ASSERT(stats.timeouts == 1);
+	TEST_ASSERT(stats.read_cycles_max >= 1000);
+}
+
+int main(void)
+{
+	handle = test_stats_setup();
+	if (handle == NULL)
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_stats_config);
+	TEST_RUN(test_stats_poll);
+	TEST_RUN(test_stats_duplicate);
+	TEST_RUN(test_stats_errors);
+
+	free(handle);
+
+	return TEST_RESULT();
+}
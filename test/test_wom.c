@@ -0,0 +1,148 @@
+#include "test.h"
+
+#define TEST_NUM_REG 				5
+
+#define TEST_REG_ACCEL_CONFIG2 		0x1D
+#define TEST_REG_INT_ENABLE 		0x38
+#define TEST_REG_MOT_DETECT_CTRL 	0x69
+#define TEST_REG_PWR_MGMT_1 		0x6B
+#define TEST_REG_PWR_MGMT_2 		0x6C
+
+#define TEST_PWR_MGMT_1_CYCLE 		0x20
+#define TEST_ACCEL_DLPF 			0x03 		/*!< Not the driver default, must survive wake-on-motion */
+
+static const uint8_t test_reg[TEST_NUM_REG] = {
+	TEST_REG_ACCEL_CONFIG2,
+	TEST_REG_INT_ENABLE,
+	TEST_REG_MOT_DETECT_CTRL,
+	TEST_REG_PWR_MGMT_1,
+	TEST_REG_PWR_MGMT_2,
+};
+
+static imu_handle_t handle;
+static imu_sim_handle_t sim;
+static imu_bus_func_t func;
+static imu_sim_signal_t still, moving;
+
+static uint8_t test_read_reg(uint8_t reg)
+{
+	uint8_t value = 0;
+
+	TEST_ASSERT(func.read_bytes(reg, &value, 1, 10) == ERR_CODE_SUCCESS);
+
+	return value;
+}
+
+static void test_snapshot(uint8_t *value)
+{
+	for (uint8_t i = 0; i < TEST_NUM_REG; i++)
+	{
+		value[i] = test_read_reg(test_reg[i]);
+	}
+}
+
+static imu_power_state_t test_power_state(void)
+{
+	imu_power_status_t status;
+
+	TEST_ASSERT(imu_get_power_status(handle, &status) == ERR_CODE_SUCCESS);
+
+	return status.state;
+}
+
+/* Poll every millisecond, return the number of samples */
+static uint32_t test_poll(uint32_t time_ms)
+{
+	imu_sample_t sample;
+	bool data_ready;
+	uint32_t samples = 0;
+
+	for (uint32_t i = 0; i < time_ms; i++)
+	{
+		imu_sim_advance_us(1000);
+		TEST_ASSERT(imu_poll_sample(handle, &sample, &data_ready) == ERR_CODE_SUCCESS);
+		samples += data_ready ? 1 : 0;
+	}
+
+	return samples;
+}
+
+static void test_wom_enter(void)
+{
+	TEST_ASSERT(imu_enter_low_power(handle, 100, 31.25f) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(test_power_state() == IMU_POWER_WAKE_ON_MOTION);
+	TEST_ASSERT(test_read_reg(TEST_REG_PWR_MGMT_1) & TEST_PWR_MGMT_1_CYCLE);
+	TEST_ASSERT(test_read_reg(TEST_REG_PWR_MGMT_2) == 0x07);
+}
+
+static void test_wom_manual_exit(void)
+{
+	uint8_t before[TEST_NUM_REG], after[TEST_NUM_REG];
+
+	test_snapshot(before);
+	TEST_ASSERT(before[0] == TEST_ACCEL_DLPF);
+
+	test_wom_enter();
+
+	/* No motion, no samples and no wake-up */
+	TEST_ASSERT(test_poll(500) == 0);
+	TEST_ASSERT(test_power_state() == IMU_POWER_WAKE_ON_MOTION);
+
+	TEST_ASSERT(imu_exit_low_power(handle) == ERR_CODE_SUCCESS);
+	test_snapshot(after);
+	for (uint8_t i = 0; i < TEST_NUM_REG; i++)
+	{
+		TEST_ASSERT(after[i] == before[i]);
+	}
+
+	/* Samples resume once the gyroscope started up */
+	TEST_ASSERT(test_poll(200) > 0);
+	TEST_ASSERT(test_power_state() == IMU_POWER_FULL);
+}
+
+static void test_wom_motion_exit(void)
+{
+	uint8_t before[TEST_NUM_REG], after[TEST_NUM_REG];
+	imu_power_status_t status;
+
+	test_snapshot(before);
+	test_wom_enter();
+	TEST_ASSERT(test_poll(200) == 0);
+
+	imu_sim_set_signal(sim, moving);
+	test_poll(500);
+	imu_sim_set_signal(sim, still);
+
+	TEST_ASSERT(imu_get_power_status(handle, &status) == ERR_CODE_SUCCESS);
+	TEST_ASSERT(status.state == IMU_POWER_FULL);
+	TEST_ASSERT(status.wakeups == 2);
+
+	test_snapshot(after);
+	for (uint8_t i = 0; i < TEST_NUM_REG; i++)
+	{
+		TEST_ASSERT(after[i] == before[i]);
+	}
+
+	TEST_ASSERT(test_poll(100) > 0);
+}
+
+int main(void)
+{
+	still = test_signal_still();
+	moving = still;
+	moving.accel_amplitude_g[0] = 0.5f;
+	moving.accel_freq_hz = 5.0f;
+
+	handle = test_setup(0, IMU_SIM_CHIP_MPU6500, still, &sim);
+	if ((handle == NULL) || (imu_bus_bind(0, imu_sim_get_ops(), sim, &func) != ERR_CODE_SUCCESS) ||
+	        (imu_set_bandwidth(handle, 0, TEST_ACCEL_DLPF) != ERR_CODE_SUCCESS))
+	{
+		printf("setup failed\n");
+		return 1;
+	}
+
+	TEST_RUN(test_wom_manual_exit);
+	TEST_RUN(test_wom_motion_exit);
+
+	return TEST_RESULT();
+}